@@ -15,6 +15,14 @@
 #define APP_ENABLE_ADP910_TASK 1
 #endif
 
+#ifndef APP_ENABLE_BLOWER_TEST_TASK
+#define APP_ENABLE_BLOWER_TEST_TASK 1
+#endif
+
+#ifndef APP_DIMMER_ON_CORE1
+#define APP_DIMMER_ON_CORE1 0
+#endif
+
 #ifndef APP_ENABLE_DEBUG_HTTP_ROUTES
 #define APP_ENABLE_DEBUG_HTTP_ROUTES 0
 #endif
@@ -23,8 +31,68 @@
 #define APP_FIRMWARE_VERSION "0.0.0-dev"
 #endif
 
+// HTTP connections persist between requests. An idle connection is closed
+// after APP_HTTP_KEEPALIVE_IDLE_MS, or sooner when another client is waiting.
+#ifndef APP_HTTP_KEEPALIVE_IDLE_MS
+#define APP_HTTP_KEEPALIVE_IDLE_MS 5000u
+#endif
+
+#ifndef APP_HTTP_KEEPALIVE_MAX_REQUESTS
+#define APP_HTTP_KEEPALIVE_MAX_REQUESTS 100u
+#endif
+
+// Longest pause allowed inside one request before the connection is dropped.
+#ifndef APP_HTTP_REQUEST_TIMEOUT_MS
+#define APP_HTTP_REQUEST_TIMEOUT_MS 5000u
+#endif
+
+// Connections are served by a fixed pool of worker tasks fed by an accept
+// queue. When the queue stays full for APP_HTTP_ACCEPT_QUEUE_WAIT_MS the
+// client gets 503.
+#ifndef APP_HTTP_WORKER_COUNT
+#define APP_HTTP_WORKER_COUNT 3u
+#endif
+
+#ifndef APP_HTTP_WORKER_STACK_WORDS
+#define APP_HTTP_WORKER_STACK_WORDS 2048u
+#endif
+
+#ifndef APP_HTTP_WORKER_PRIORITY
+#define APP_HTTP_WORKER_PRIORITY APP_WIFI_TASK_PRIORITY
+#endif
+
+#ifndef APP_HTTP_ACCEPT_QUEUE_LENGTH
+#define APP_HTTP_ACCEPT_QUEUE_LENGTH 4u
+#endif
+
+#ifndef APP_HTTP_ACCEPT_QUEUE_WAIT_MS
+#define APP_HTTP_ACCEPT_QUEUE_WAIT_MS 500u
+#endif
+
+// /events clients share one broadcaster task. Each frame is rendered once
+// into a ring of APP_SSE_BACKLOG_FRAMES slots of APP_SSE_FRAME_BYTES; a client
+// that leaves that many frames unacknowledged is dropped.
+#ifndef APP_SSE_MAX_CLIENTS
+#define APP_SSE_MAX_CLIENTS 4u
+#endif
+
+#ifndef APP_SSE_BACKLOG_FRAMES
+#define APP_SSE_BACKLOG_FRAMES 4u
+#endif
+
+#ifndef APP_SSE_FRAME_BYTES
+#define APP_SSE_FRAME_BYTES 2048u
+#endif
+
+// Web assets are sent straight from flash (NETCONN_NOCOPY). Set to 0 to copy
+// them through the lwIP heap like every other response, for comparison.
+#ifndef APP_HTTP_ASSET_ZERO_COPY
+#define APP_HTTP_ASSET_ZERO_COPY 1
+#endif
+
+// The WiFi task only joins the network and accepts connections.
 #ifndef APP_WIFI_TASK_STACK_WORDS
-#define APP_WIFI_TASK_STACK_WORDS 4096u
+#define APP_WIFI_TASK_STACK_WORDS 2048u
 #endif
 
 #ifndef APP_DIMMER_TASK_STACK_WORDS
@@ -35,6 +103,14 @@
 #define APP_ADP910_TASK_STACK_WORDS 2048u
 #endif
 
+// Reports are encoded into and appended from static buffers. The deepest
+// chain is the end-of-run fit (point array plus the robust regression
+// scratch, under 1 KB) followed by a journal append with its flash_safe_execute
+// frames; 4 KB leaves more than half free.
+#ifndef APP_BLOWER_TEST_TASK_STACK_WORDS
+#define APP_BLOWER_TEST_TASK_STACK_WORDS 1024u
+#endif
+
 #ifndef APP_WIFI_TASK_PRIORITY
 #define APP_WIFI_TASK_PRIORITY 2u
 #endif
@@ -47,6 +123,10 @@
 #define APP_ADP910_TASK_PRIORITY 1u
 #endif
 
+#ifndef APP_BLOWER_TEST_TASK_PRIORITY
+#define APP_BLOWER_TEST_TASK_PRIORITY 2u
+#endif
+
 #ifndef APP_ADP910_SAMPLE_PERIOD_MS
 #define APP_ADP910_SAMPLE_PERIOD_MS 20u
 #endif
@@ -163,6 +243,102 @@
 #define APP_CONTROL_LOOP_PERIOD_MS 20u
 #endif
 
+#ifndef APP_BLOWER_TEST_PERIOD_MS
+#define APP_BLOWER_TEST_PERIOD_MS APP_CONTROL_LOOP_PERIOD_MS
+#endif
+
+// Steady-state detection ends stabilization early; settle_time_s stays the cap.
+#ifndef APP_TEST_STEADY_WINDOW_MS
+#define APP_TEST_STEADY_WINDOW_MS 3000u
+#endif
+
+#ifndef APP_TEST_STEADY_MIN_SAMPLES
+#define APP_TEST_STEADY_MIN_SAMPLES 30u
+#endif
+
+// Allowed drift over one window, as a fraction of target_tolerance_pa.
+#ifndef APP_TEST_STEADY_PRESSURE_DRIFT_RATIO
+#define APP_TEST_STEADY_PRESSURE_DRIFT_RATIO 0.25f
+#endif
+
+#ifndef APP_TEST_STEADY_FLOW_DRIFT_RATIO
+#define APP_TEST_STEADY_FLOW_DRIFT_RATIO 0.02f
+#endif
+
+#ifndef APP_TEST_STEADY_SLOPE_T_QUANTILE
+#define APP_TEST_STEADY_SLOPE_T_QUANTILE 2.0f
+#endif
+
+#ifndef APP_TEST_STEADY_MAX_VARIANCE_RATIO
+#define APP_TEST_STEADY_MAX_VARIANCE_RATIO 3.0f
+#endif
+
+// Measurement standard errors come from block means, which absorb the
+// sample-to-sample correlation of wind and control-loop ripple.
+#ifndef APP_TEST_MEASURE_BLOCK_MS
+#define APP_TEST_MEASURE_BLOCK_MS 1000u
+#endif
+
+#ifndef APP_TEST_MEASURE_MIN_BLOCKS
+#define APP_TEST_MEASURE_MIN_BLOCKS 3u
+#endif
+
+// Raw per-point samples kept in RAM for re-analysis of the latest test.
+// 96 KB holds 24 points of 30 s at 10 Hz.
+#ifndef APP_TEST_RAW_SAMPLE_PERIOD_MS
+#define APP_TEST_RAW_SAMPLE_PERIOD_MS 100u
+#endif
+
+#ifndef APP_TEST_RAW_STORE_BYTES
+#define APP_TEST_RAW_STORE_BYTES (96u * 1024u)
+#endif
+
+// Tests whose raw samples are also kept in the report journal, so re-analysis
+// works after a reboot or a later test. Each takes the used part of the RAM
+// store (about 60 KB for 16 points of 30 s).
+#ifndef APP_TEST_RAW_JOURNAL_SLOTS
+#define APP_TEST_RAW_JOURNAL_SLOTS 2u
+#endif
+
+// Curve fit: inverse-variance point weights and Huber outlier down-weighting.
+#ifndef APP_TEST_FIT_WEIGHTED
+#define APP_TEST_FIT_WEIGHTED 1
+#endif
+
+#ifndef APP_TEST_FIT_ROBUST
+#define APP_TEST_FIT_ROBUST 1
+#endif
+
+#ifndef APP_TEST_FIT_HUBER_K
+#define APP_TEST_FIT_HUBER_K 1.345f
+#endif
+
+// Queued runs re-zero the envelope channel in between: fan power is cut (the
+// relay stays closed) until fan pressure shows the flow has died away, then
+// the envelope reading is averaged as the new baseline. If the fan has not
+// slowed within the timeout the previous zero is kept.
+#ifndef APP_TEST_QUEUE_ZERO_FAN_MAX_PA
+#define APP_TEST_QUEUE_ZERO_FAN_MAX_PA 2.0f
+#endif
+
+#ifndef APP_TEST_QUEUE_SPINDOWN_TIMEOUT_MS
+#define APP_TEST_QUEUE_SPINDOWN_TIMEOUT_MS 20000u
+#endif
+
+#ifndef APP_TEST_QUEUE_BASELINE_MS
+#define APP_TEST_QUEUE_BASELINE_MS 5000u
+#endif
+
+#ifndef APP_TEST_QUEUE_BASELINE_MIN_SAMPLES
+#define APP_TEST_QUEUE_BASELINE_MIN_SAMPLES 20u
+#endif
+
+// A report append that failed (e.g. a compaction erase refused while the fan
+// runs) is retried after this long.
+#ifndef APP_TEST_PERSIST_RETRY_MS
+#define APP_TEST_PERSIST_RETRY_MS 5000u
+#endif
+
 #ifndef APP_CONTROL_STARTUP_MIN_HOLD_MS
 #define APP_CONTROL_STARTUP_MIN_HOLD_MS 80u
 #endif
@@ -255,6 +431,36 @@
 #define APP_OTA_STAGING_SIZE_BYTES (1536u * 1024u)
 #endif
 
+// The rest of flash after the OTA staging slot holds the test config and
+// report journal (src/services/flash_journal.c).
+#ifndef APP_PERSISTENT_STORAGE_OFFSET_BYTES
+#define APP_PERSISTENT_STORAGE_OFFSET_BYTES \
+  (APP_OTA_STAGING_OFFSET_BYTES + APP_OTA_STAGING_SIZE_BYTES)
+#endif
+
+#ifndef APP_PERSISTENT_STORAGE_SIZE_BYTES
+#define APP_PERSISTENT_STORAGE_SIZE_BYTES (512u * 1024u)
+#endif
+
+// Live journal records tracked by the RAM index (config, reports and raw
+// sample chunks).
+#ifndef APP_JOURNAL_MAX_RECORDS
+#define APP_JOURNAL_MAX_RECORDS 320u
+#endif
+
+// Gap after a gate pulse that a page program must fit in (typ. 0.4-0.8 ms).
+#ifndef APP_FLASH_WRITER_PAGE_WINDOW_US
+#define APP_FLASH_WRITER_PAGE_WINDOW_US 1000u
+#endif
+
+#ifndef APP_FLASH_WRITER_WINDOW_TIMEOUT_MS
+#define APP_FLASH_WRITER_WINDOW_TIMEOUT_MS 100u
+#endif
+
+#ifndef APP_FLASH_WRITER_LOCKOUT_TIMEOUT_MS
+#define APP_FLASH_WRITER_LOCKOUT_TIMEOUT_MS 100u
+#endif
+
 #ifndef APP_OTA_TARGET_MAX_IMAGE_SIZE_BYTES
 #define APP_OTA_TARGET_MAX_IMAGE_SIZE_BYTES APP_OTA_STAGING_OFFSET_BYTES
 #endif
@@ -275,6 +481,59 @@
 #define APP_LINE_SYNC_TIMEOUT_US 100000u
 #endif
 
+#ifndef APP_ZERO_CROSS_PIO_CLOCK_HZ
+#define APP_ZERO_CROSS_PIO_CLOCK_HZ 1000000u
+#endif
+
+#ifndef APP_ZERO_CROSS_GLITCH_FILTER_US
+#define APP_ZERO_CROSS_GLITCH_FILTER_US 100u
+#endif
+
+#ifndef APP_MAINS_MIN_FREQUENCY_HZ
+#define APP_MAINS_MIN_FREQUENCY_HZ 40.0f
+#endif
+
+#ifndef APP_MAINS_MAX_FREQUENCY_HZ
+#define APP_MAINS_MAX_FREQUENCY_HZ 70.0f
+#endif
+
+#ifndef APP_MAINS_PLL_PHASE_GAIN
+#define APP_MAINS_PLL_PHASE_GAIN 0.25f
+#endif
+
+#ifndef APP_MAINS_PLL_FREQUENCY_GAIN
+#define APP_MAINS_PLL_FREQUENCY_GAIN 0.02f
+#endif
+
+#ifndef APP_MAINS_PLL_CAPTURE_WINDOW_RATIO
+#define APP_MAINS_PLL_CAPTURE_WINDOW_RATIO 0.15f
+#endif
+
+#ifndef APP_MAINS_PLL_LOCK_THRESHOLD_US
+#define APP_MAINS_PLL_LOCK_THRESHOLD_US 150.0f
+#endif
+
+#ifndef APP_MAINS_PLL_LOCK_EDGES
+#define APP_MAINS_PLL_LOCK_EDGES 8u
+#endif
+
+#ifndef APP_MAINS_PLL_UNLOCK_EDGES
+#define APP_MAINS_PLL_UNLOCK_EDGES 4u
+#endif
+
+#ifndef APP_MAINS_PLL_REACQUIRE_REJECTS
+#define APP_MAINS_PLL_REACQUIRE_REJECTS 6u
+#endif
+
+#ifndef APP_DIMMER_ASYMMETRY_THRESHOLD_US
+#define APP_DIMMER_ASYMMETRY_THRESHOLD_US 100u
+#endif
+
+// Gate pulses landing more than this after their target count as late.
+#ifndef APP_DIMMER_TRACE_LATE_US
+#define APP_DIMMER_TRACE_LATE_US 50u
+#endif
+
 #ifndef APP_FAN_FLOW_COEFFICIENT_C
 #define APP_FAN_FLOW_COEFFICIENT_C 236.0f
 #endif
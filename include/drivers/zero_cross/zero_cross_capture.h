@@ -0,0 +1,33 @@
+#ifndef ZERO_CROSS_CAPTURE_H
+#define ZERO_CROSS_CAPTURE_H
+
+#include "hardware/timer.h"
+#include "pico/types.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Called from the PIO IRQ for every captured edge, oldest first, on the core
+// that ran zero_cross_capture_init(). The timestamp is the raw low word of
+// timestamp_timer (timer_hw when NULL) and already compensated for the glitch
+// filter, so it reflects the physical edge rather than IRQ entry.
+typedef void (*zero_cross_capture_handler_t)(uint32_t edge_us, void *context);
+
+typedef struct {
+  uint gpio;
+  bool pull_up;
+  uint32_t glitch_filter_us;
+  timer_hw_t *timestamp_timer;
+  zero_cross_capture_handler_t handler;
+  void *handler_context;
+} zero_cross_capture_config_t;
+
+typedef struct {
+  bool running;
+  uint32_t captured_edges;
+  uint32_t last_edge_us;
+} zero_cross_capture_stats_t;
+
+bool zero_cross_capture_init(const zero_cross_capture_config_t *config);
+void zero_cross_capture_get_stats(zero_cross_capture_stats_t *out_stats);
+
+#endif
@@ -23,6 +23,10 @@
 #define MEM_SIZE 4000
 #define MEMP_NUM_TCP_SEG 32
 #define MEMP_NUM_ARP_QUEUE 10
+// Listener, SSE subscribers, the WebSocket, one connection per HTTP worker,
+// the accept queue and connections still closing.
+#define MEMP_NUM_NETCONN 16
+#define MEMP_NUM_TCP_PCB 16
 #define PBUF_POOL_SIZE 24
 #define LWIP_ARP 1
 #define LWIP_ETHERNET 1
@@ -35,9 +39,11 @@
 #define LWIP_NETIF_STATUS_CALLBACK 1
 #define LWIP_NETIF_LINK_CALLBACK 1
 #define LWIP_NETIF_HOSTNAME 1
-#define MEM_STATS 0
+// Heap and pool usage is served at GET /api/diag/net.
+#define LWIP_STATS 1
+#define MEM_STATS 1
 #define SYS_STATS 0
-#define MEMP_STATS 0
+#define MEMP_STATS 1
 #define LINK_STATS 0
 // #define ETH_PAD_SIZE                2
 #define LWIP_CHKSUM_ALGORITHM 3
@@ -47,20 +53,25 @@
 #define LWIP_UDP 1
 #define LWIP_DNS 1
 #define LWIP_TCP_KEEPALIVE 1
-#define LWIP_NETIF_TX_SINGLE_PBUF 1
+#define LWIP_SO_RCVTIMEO 1
+// tcp_write() copies every NETCONN_NOCOPY write into the heap when this is
+// set. The cyw43 driver copies chained pbufs into its SPI buffer anyway, so
+// web assets are sent as references to flash instead.
+#define LWIP_NETIF_TX_SINGLE_PBUF 0
+// PBUF_ROM/PBUF_REF references to flash assets and shared SSE frames: up to
+// TCP_SND_QUEUELEN per sending connection.
+#define MEMP_NUM_PBUF 32
 #define DHCP_DOES_ARP_CHECK 0
 #define LWIP_DHCP_DOES_ACD_CHECK 0
 
 #ifndef NDEBUG
 #define LWIP_DEBUG 1
-#define LWIP_STATS 1
 #define LWIP_PLATFORM_DIAG(x)                                                  \
   do {                                                                         \
     printf x;                                                                  \
   } while (0)
 #else
 #define LWIP_DEBUG 0
-#define LWIP_STATS 0
 #define LWIP_PLATFORM_DIAG(x)
 #endif
 
@@ -23,6 +23,8 @@ typedef struct {
   float pd_max_step_percent;
   bool line_sync;
   float line_frequency_hz;
+  bool line_pll_locked;
+  float line_phase_error_us;
 } blower_control_snapshot_t;
 
 void blower_control_initialize(void);
@@ -34,7 +36,9 @@ void blower_control_set_target_pressure_pa(float target_pressure_pa);
 
 uint8_t blower_control_step(float envelope_pressure_pa, bool measurement_valid,
                             uint32_t now_tick_ms);
-void blower_control_update_line_feedback(bool line_sync, float line_frequency_hz);
+void blower_control_update_line_feedback(bool line_sync, float line_frequency_hz,
+                                         bool line_pll_locked,
+                                         float line_phase_error_us);
 void blower_control_get_snapshot(blower_control_snapshot_t *out_snapshot);
 
 #endif
@@ -56,6 +56,8 @@ void blower_metrics_service_update(const adp910_sample_t *fan_sample,
                                    bool envelope_sample_valid);
 bool blower_metrics_service_get_snapshot(blower_metrics_snapshot_t *out_snapshot);
 bool blower_metrics_service_capture_zero_offsets(void);
+// Moves the envelope zero so that residual_pa (in corrected units) reads 0.
+bool blower_metrics_service_shift_envelope_zero(float residual_pa);
 void blower_metrics_service_begin_calibration(void);
 
 float blower_linear_fan_speed_model(float fan_pressure_pa, const void *context);
@@ -0,0 +1,153 @@
+#ifndef BLOWER_TEST_REPORT_H
+#define BLOWER_TEST_REPORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BLOWER_TEST_MAX_PRESSURE_POINTS 12u
+
+typedef enum {
+  BLOWER_TEST_DIRECTION_NONE = 0,
+  BLOWER_TEST_DIRECTION_PRESSURIZATION = 1,
+  BLOWER_TEST_DIRECTION_DEPRESSURIZATION = 2,
+} blower_test_direction_t;
+
+typedef struct {
+  float target_pressure_pa;
+  float avg_pressure_pa;
+  float avg_fan_flow_m3h;
+  float avg_fan_temperature_c;
+  float avg_envelope_temperature_c;
+  float avg_pwm_percent;
+  float settle_time_s;
+  float pressure_std_error_pa;
+  float flow_std_error_m3h;
+  // Achieved 95 % confidence half-width on log(Q), in percent.
+  float log_flow_ci_pct;
+  uint16_t sample_count;
+  // Samples retained in the raw store (APP_TEST_RAW_SAMPLE_PERIOD_MS apart).
+  uint16_t raw_sample_count;
+  bool valid;
+} blower_test_point_result_t;
+
+typedef struct {
+  float cl_m3h_pan;
+  float exponent_n;
+  float correlation_r;
+  float q_ref_m3h;
+  float ach_ref_h1;
+  float w_ref_m3h_m2;
+  float q_ref_envelope_m3h_m2;
+  float eqla10_cm2;
+  float eqla10_cm2_per_m2_envelope;
+  float lbl_ela4_cm2;
+  float lbl_ela4_cm2_per_m2_envelope;
+  float uncertainty_pct;
+  // 95 % confidence intervals (ISO 9972 Annex C, t-distribution).
+  float cl_ci_low_m3h_pan;
+  float cl_ci_high_m3h_pan;
+  float exponent_n_ci_low;
+  float exponent_n_ci_high;
+  float q_ref_ci_low_m3h;
+  float q_ref_ci_high_m3h;
+  // Points the robust fit down-weighted as outliers.
+  uint8_t downweighted_points;
+  bool valid;
+} blower_test_curve_summary_t;
+
+typedef struct {
+  blower_test_direction_t direction;
+  uint8_t point_count;
+  // Remaining points were skipped by the opt-in confidence stop: the
+  // provisional ACH interval cleared target_ach_ref_h1 (see
+  // blower_test_config_t).
+  bool confidence_stop;
+  blower_test_point_result_t points[BLOWER_TEST_MAX_PRESSURE_POINTS];
+  blower_test_curve_summary_t summary;
+} blower_test_direction_report_t;
+
+// Working form, only used while a test runs or is re-analyzed.
+typedef struct {
+  uint32_t report_id;
+  // Measured report this one re-analyzes; 0 for a measured report.
+  uint32_t source_report_id;
+  uint32_t completed_tick_ms;
+  uint8_t reference_pressure_pa;
+  bool has_pressurization;
+  bool has_depressurization;
+  blower_test_direction_report_t pressurization;
+  blower_test_direction_report_t depressurization;
+  blower_test_curve_summary_t mean_summary;
+} blower_test_report_t;
+
+// Stored form: a little-endian byte stream with a 16-byte header, the mean
+// summary, then one section (direction, point count, flags, summary, points)
+// per direction that ran. Point averages are fixed-point at the precision
+// the API reports them; fit results stay float. Accessors read it in place,
+// from XIP flash or a RAM slot, and bounds-check every field so a torn copy
+// can only yield wrong values, never an out-of-range read. The last header
+// field holds report_id - source_report_id (0 for a measured report), which
+// was reserved as zero before re-analyses became separate reports.
+#define BLOWER_TEST_REPORT_FORMAT_VERSION 1u
+#define BLOWER_TEST_REPORT_HEADER_BYTES 16u
+#define BLOWER_TEST_REPORT_SUMMARY_BYTES 74u
+#define BLOWER_TEST_REPORT_SECTION_HEADER_BYTES 3u
+#define BLOWER_TEST_REPORT_POINT_BYTES 29u
+#define BLOWER_TEST_REPORT_MAX_ENCODED_BYTES                              \
+  (BLOWER_TEST_REPORT_HEADER_BYTES + BLOWER_TEST_REPORT_SUMMARY_BYTES +   \
+   2u * (BLOWER_TEST_REPORT_SECTION_HEADER_BYTES +                        \
+         BLOWER_TEST_REPORT_SUMMARY_BYTES +                               \
+         BLOWER_TEST_MAX_PRESSURE_POINTS * BLOWER_TEST_REPORT_POINT_BYTES))
+
+typedef struct {
+  const uint8_t *data;
+  uint32_t length;
+} blower_test_report_view_t;
+
+typedef struct {
+  uint32_t report_id;
+  uint32_t source_report_id;
+  uint32_t completed_tick_ms;
+  uint8_t reference_pressure_pa;
+  bool has_pressurization;
+  bool has_depressurization;
+} blower_test_report_header_t;
+
+typedef struct {
+  blower_test_direction_t direction;
+  uint8_t point_count;
+  bool confidence_stop;
+} blower_test_report_direction_info_t;
+
+typedef struct {
+  const uint8_t *data;
+  uint32_t end;
+  uint32_t offset;
+  uint8_t remaining;
+} blower_test_report_point_iter_t;
+
+// Returns the encoded length, or 0 if capacity is too small.
+uint32_t blower_test_report_encode(const blower_test_report_t *report, uint8_t *out_data,
+                                   uint32_t capacity);
+bool blower_test_report_view_init(blower_test_report_view_t *view, const void *data,
+                                  uint32_t length);
+bool blower_test_report_get_header(const blower_test_report_view_t *view,
+                                   blower_test_report_header_t *out_header);
+// BLOWER_TEST_DIRECTION_NONE selects the mean summary. False if the direction
+// did not run.
+bool blower_test_report_get_summary(const blower_test_report_view_t *view,
+                                    blower_test_direction_t direction,
+                                    blower_test_curve_summary_t *out_summary);
+bool blower_test_report_get_direction(const blower_test_report_view_t *view,
+                                      blower_test_direction_t direction,
+                                      blower_test_report_direction_info_t *out_info);
+bool blower_test_report_points_begin(const blower_test_report_view_t *view,
+                                     blower_test_direction_t direction,
+                                     blower_test_report_point_iter_t *out_iter);
+bool blower_test_report_points_next(blower_test_report_point_iter_t *iter,
+                                    blower_test_point_result_t *out_point);
+// Expands a stored report back into the working form.
+bool blower_test_report_decode(const blower_test_report_view_t *view,
+                               blower_test_report_t *out_report);
+
+#endif
@@ -3,35 +3,36 @@
 
 #include "services/blower_control.h"
 #include "services/blower_metrics.h"
+#include "services/blower_test_report.h"
+#include "services/flash_journal.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-#define BLOWER_TEST_MAX_PRESSURE_POINTS 12u
-#define BLOWER_TEST_HISTORY_CAPACITY 4u
-
 typedef enum {
   BLOWER_TEST_MODE_PRESSURIZATION = 0,
   BLOWER_TEST_MODE_DEPRESSURIZATION = 1,
   BLOWER_TEST_MODE_BOTH = 2,
 } blower_test_mode_t;
 
-typedef enum {
-  BLOWER_TEST_DIRECTION_NONE = 0,
-  BLOWER_TEST_DIRECTION_PRESSURIZATION = 1,
-  BLOWER_TEST_DIRECTION_DEPRESSURIZATION = 2,
-} blower_test_direction_t;
-
 typedef enum {
   BLOWER_TEST_STATE_IDLE = 0,
   BLOWER_TEST_STATE_PREPARING,
   BLOWER_TEST_STATE_STABILIZING,
   BLOWER_TEST_STATE_MEASURING,
+  // Between queued runs: fan power cut, envelope zero being re-measured.
+  BLOWER_TEST_STATE_REZEROING,
   BLOWER_TEST_STATE_COMPLETED,
   BLOWER_TEST_STATE_ABORTED,
   BLOWER_TEST_STATE_ERROR,
 } blower_test_state_t;
 
+typedef enum {
+  BLOWER_TEST_VERDICT_NONE = 0,
+  BLOWER_TEST_VERDICT_PASS,
+  BLOWER_TEST_VERDICT_FAIL,
+} blower_test_verdict_t;
+
 typedef struct {
   float building_volume_m3;
   float floor_area_m2;
@@ -44,7 +45,22 @@ typedef struct {
   float fan_curve_n;
   float target_tolerance_pa;
   uint16_t settle_time_s;
+  // Measurement stops once the 95 % confidence half-width on log(Q) is below
+  // measure_target_ci_pct, after at least measure_min_time_s and at most
+  // measure_time_s. A target of 0 measures for exactly measure_time_s.
+  uint16_t measure_min_time_s;
   uint16_t measure_time_s;
+  float measure_target_ci_pct;
+  // Pass/fail limit on ACH at the reference pressure; 0 disables the
+  // provisional verdict.
+  float target_ach_ref_h1;
+  // Confidence-based stop, off by default: a direction ends once the
+  // provisional 95 % ACH interval of at least min_points_required points lies
+  // wholly on one side of target_ach_ref_h1, skipping its lower-pressure
+  // points. The interval is re-checked after every point, so the chance of a
+  // wrong verdict is somewhat above the nominal 5 %; the final summary of the
+  // shortened curve is what the report holds.
+  bool confidence_stop_enabled;
   uint8_t reference_pressure_pa;
   uint8_t min_points_required;
   bool enforce_iso_9972_rules;
@@ -52,50 +68,70 @@ typedef struct {
   float pressure_points_pa[BLOWER_TEST_MAX_PRESSURE_POINTS];
 } blower_test_config_t;
 
+// Listing entry read in place from the report journal.
 typedef struct {
-  float target_pressure_pa;
-  float avg_pressure_pa;
-  float avg_fan_flow_m3h;
-  float avg_fan_temperature_c;
-  float avg_envelope_temperature_c;
-  float avg_pwm_percent;
-  uint16_t sample_count;
+  uint32_t report_id;
+  // Measured report this one re-analyzes; 0 for a measured report.
+  uint32_t source_report_id;
+  uint32_t completed_tick_ms;
+  bool has_pressurization;
+  bool has_depressurization;
   bool valid;
-} blower_test_point_result_t;
-
-typedef struct {
-  float cl_m3h_pan;
+  float ach_ref_h1;
   float exponent_n;
-  float correlation_r;
   float q_ref_m3h;
-  float ach_ref_h1;
-  float w_ref_m3h_m2;
-  float q_ref_envelope_m3h_m2;
-  float eqla10_cm2;
-  float eqla10_cm2_per_m2_envelope;
-  float lbl_ela4_cm2;
-  float lbl_ela4_cm2_per_m2_envelope;
   float uncertainty_pct;
+} blower_test_report_info_t;
+
+#define BLOWER_TEST_QUEUE_MAX_RUNS 8u
+
+typedef enum {
+  BLOWER_TEST_QUEUE_STATE_IDLE = 0,
+  BLOWER_TEST_QUEUE_STATE_RUNNING,
+  // The next run uses another aperture ring; the fan is stopped until the
+  // operator has swapped it and resumes the queue.
+  BLOWER_TEST_QUEUE_STATE_WAITING_OPERATOR,
+  BLOWER_TEST_QUEUE_STATE_COMPLETED,
+  BLOWER_TEST_QUEUE_STATE_ABORTED,
+} blower_test_queue_state_t;
+
+typedef struct {
+  blower_test_mode_t mode;
+  float fan_aperture_cm;
+  bool finished;
+  // 0 until the run completes.
+  uint32_t report_id;
   bool valid;
-} blower_test_curve_summary_t;
+  float ach_ref_h1;
+  float q_ref_m3h;
+  float exponent_n;
+  // Envelope zero correction applied before the run; false if the fan did not
+  // spin down in time and the previous zero was kept.
+  bool rezeroed;
+  float baseline_shift_pa;
+} blower_test_queue_run_t;
 
+// Spread over the finished runs with a valid fit; sample standard deviations.
 typedef struct {
-  blower_test_direction_t direction;
-  uint8_t point_count;
-  blower_test_point_result_t points[BLOWER_TEST_MAX_PRESSURE_POINTS];
-  blower_test_curve_summary_t summary;
-} blower_test_direction_report_t;
+  uint8_t valid_runs;
+  float ach_mean_h1;
+  float ach_stddev_h1;
+  float ach_cov_pct;
+  float ach_min_h1;
+  float ach_max_h1;
+  float q_ref_mean_m3h;
+  float q_ref_stddev_m3h;
+  float n_mean;
+  float n_stddev;
+} blower_test_queue_aggregate_t;
 
 typedef struct {
-  uint32_t report_id;
-  uint32_t completed_tick_ms;
-  uint8_t reference_pressure_pa;
-  bool has_pressurization;
-  bool has_depressurization;
-  blower_test_direction_report_t pressurization;
-  blower_test_direction_report_t depressurization;
-  blower_test_curve_summary_t mean_summary;
-} blower_test_report_t;
+  blower_test_queue_state_t state;
+  uint8_t run_count;
+  uint8_t current_run;
+  blower_test_queue_run_t runs[BLOWER_TEST_QUEUE_MAX_RUNS];
+  blower_test_queue_aggregate_t aggregate;
+} blower_test_queue_status_t;
 
 typedef struct {
   bool active;
@@ -109,31 +145,114 @@ typedef struct {
   float current_measured_flow_m3h;
   uint32_t state_elapsed_ms;
   uint16_t active_sample_count;
+  float active_log_flow_ci_pct;
+  // Stabilization time the steady-state detector saved against the fixed
+  // settle timer over the current test.
+  uint32_t settle_time_saved_ms;
+  // Fit of the points completed so far in the current direction.
+  bool provisional_valid;
+  uint8_t provisional_point_count;
+  float provisional_exponent_n;
+  float provisional_q_ref_m3h;
+  float provisional_ach_ref_h1;
+  float provisional_ach_ci_low_h1;
+  float provisional_ach_ci_high_h1;
+  blower_test_verdict_t provisional_verdict;
   bool report_ready;
   uint32_t latest_report_id;
   float latest_ach_ref_h1;
+  // The last report append failed; the report is kept in RAM and retried.
+  bool persist_failed;
+  uint32_t persist_failures;
 } blower_test_runtime_status_t;
 
 void blower_test_service_init(void);
 
+typedef enum {
+  BLOWER_TEST_SET_CONFIG_OK = 0,
+  BLOWER_TEST_SET_CONFIG_INVALID,
+  // A test or queue is running.
+  BLOWER_TEST_SET_CONFIG_BUSY,
+  // Applied, but the journal append failed: it is lost on reboot.
+  BLOWER_TEST_SET_CONFIG_STORAGE_UNAVAILABLE,
+} blower_test_set_config_result_t;
+
 void blower_test_service_get_config(blower_test_config_t *out_config);
-bool blower_test_service_set_config(const blower_test_config_t *config);
-void blower_test_service_reset_config_to_defaults(void);
+blower_test_set_config_result_t blower_test_service_set_config(
+    const blower_test_config_t *config);
+blower_test_set_config_result_t blower_test_service_reset_config_to_defaults(void);
 
 bool blower_test_service_start(blower_test_mode_t mode);
+// Also aborts a running queue.
 void blower_test_service_stop(void);
 
+// Runs queued configurations back to back, each with its own report. Between
+// runs fan power is cut but the relay stays closed: the rotor coasts down, and
+// once fan pressure is within APP_TEST_QUEUE_ZERO_FAN_MAX_PA the envelope
+// zero is re-taken before the next run starts. A run that needs another
+// aperture ring waits for the operator instead. The operator's own config is
+// restored when the queue ends; adding to a finished or aborted queue starts
+// a new one.
+bool blower_test_service_queue_add(const blower_test_config_t *config,
+                                   blower_test_mode_t mode);
+bool blower_test_service_queue_clear(void);
+// Starts the queue from its first run, or resumes one waiting for the operator.
+bool blower_test_service_queue_start(void);
+void blower_test_service_get_queue(blower_test_queue_status_t *out_status);
+
 void blower_test_service_update(const blower_metrics_snapshot_t *metrics_snapshot,
                                 const blower_control_snapshot_t *control_snapshot,
                                 uint32_t now_tick_ms);
 
 void blower_test_service_get_runtime(blower_test_runtime_status_t *out_runtime);
-bool blower_test_service_get_latest_report(blower_test_report_t *out_report);
-bool blower_test_service_get_report_snapshot(blower_test_report_t *out_report,
-                                             bool *out_is_active);
+
+// Reports are read in place: the view points at the journal payload in XIP
+// flash or at the service's single encoded RAM slot, which holds the running
+// test or, once it completes, the latest report. The mutex is only held to
+// open a handle; read through the view afterwards and re-open if
+// blower_test_service_report_is_current() says the bytes were rewritten.
+typedef struct {
+  blower_test_report_view_t view;
+  bool is_active;
+  bool in_slot;
+  uint32_t generation;
+} blower_test_report_handle_t;
+
+bool blower_test_service_open_latest_report(blower_test_report_handle_t *out_handle);
+// The running test if there is one, else the latest report.
+bool blower_test_service_open_current_report(blower_test_report_handle_t *out_handle);
+bool blower_test_service_open_report(uint32_t report_id,
+                                     blower_test_report_handle_t *out_handle);
+bool blower_test_service_report_is_current(const blower_test_report_handle_t *handle);
+// Stored reports, newest first, starting offset entries in. Returns the number
+// written; out_total is the number of reports in the journal.
+uint32_t blower_test_service_list_reports(uint32_t offset,
+                                          blower_test_report_info_t *out_infos,
+                                          uint32_t max_infos, uint32_t *out_total);
+void blower_test_service_get_storage_stats(flash_journal_stats_t *out_stats);
+typedef enum {
+  BLOWER_TEST_REANALYZE_OK = 0,
+  BLOWER_TEST_REANALYZE_INVALID_CONFIG,
+  // A test is running, or the last test's raw samples are still being saved.
+  BLOWER_TEST_REANALYZE_BUSY,
+  BLOWER_TEST_REANALYZE_NOT_FOUND,
+  // The journal keeps raw samples for the last APP_TEST_RAW_JOURNAL_SLOTS
+  // tests only.
+  BLOWER_TEST_REANALYZE_RAW_UNAVAILABLE,
+} blower_test_reanalyze_result_t;
+
+// Recomputes flows and fits of a measured report from its raw samples with
+// config and stores the result as a new report whose source_report_id names
+// the measured one, which is left untouched. report_id 0 selects the latest
+// report; a re-analysis resolves to the report it was derived from. The new
+// id is written to out_report_id.
+blower_test_reanalyze_result_t blower_test_service_reanalyze(
+    uint32_t report_id, const blower_test_config_t *config, uint32_t *out_report_id);
 
 const char *blower_test_mode_name(blower_test_mode_t mode);
 const char *blower_test_state_name(blower_test_state_t state);
 const char *blower_test_direction_name(blower_test_direction_t direction);
+const char *blower_test_verdict_name(blower_test_verdict_t verdict);
+const char *blower_test_queue_state_name(blower_test_queue_state_t state);
 
 #endif
@@ -3,7 +3,24 @@
 
 #include <stdint.h>
 
-void dimmer_control_set_power_percent(uint8_t power_percent);
+typedef struct {
+  uint32_t submitted_sequence;
+  uint32_t command_sequence;
+  uint8_t power_percent;
+  uint32_t half_cycle_sequence;
+  uint32_t commit_us;
+  uint32_t fire_us;
+  uint32_t fire_delay_us;
+  uint32_t command_latency_last_us;
+  uint32_t command_latency_max_us;
+  uint32_t asymmetric_cycle_count;
+  int32_t last_asymmetry_us;
+} dimmer_control_actuation_t;
+
+// Queues a command for the next zero-cross and returns its sequence number;
+// the gate ISR never sees a value change mid half-cycle.
+uint32_t dimmer_control_set_power_percent(uint8_t power_percent);
 uint8_t dimmer_control_get_power_percent(void);
+void dimmer_control_get_actuation(dimmer_control_actuation_t *out_actuation);
 
 #endif
@@ -0,0 +1,48 @@
+#ifndef DIMMER_TRACE_H
+#define DIMMER_TRACE_H
+
+#include <stdint.h>
+
+// Log2 histograms: bin 0 holds zero, bin i holds [2^(i-1), 2^i) units and the
+// last bin is open-ended.
+#define DIMMER_TRACE_BIN_COUNT 16u
+// ISR cost is binned in units of 1 << DIMMER_TRACE_CYCLE_BIN_SHIFT cycles.
+#define DIMMER_TRACE_CYCLE_BIN_SHIFT 4u
+
+typedef struct {
+  uint32_t count;
+  uint32_t max;
+  uint32_t total;
+  uint32_t bins[DIMMER_TRACE_BIN_COUNT];
+} dimmer_trace_histogram_t;
+
+typedef struct {
+  uint32_t reset_count;
+  uint32_t cpu_hz;
+  // Physical edge (PIO capture timestamp) to handler entry, in us.
+  dimmer_trace_histogram_t edge_latency_us;
+  // Zero-cross handler execution time, in CPU cycles.
+  dimmer_trace_histogram_t zero_cross_isr_cycles;
+  // Actual minus intended gate firing time, in us; early pulses count as 0.
+  dimmer_trace_histogram_t fire_error_us;
+  uint32_t early_pulse_count;
+  uint32_t late_pulse_count;
+  uint32_t missed_pulse_count;
+} dimmer_trace_snapshot_t;
+
+// Called once on the core that owns gate timing; enables its cycle counter.
+void dimmer_trace_init(void);
+
+// Gate-timing core only, from its ISRs. The zero-cross handler and the gate
+// alarm (which preempts it) both call note_fire/note_missed; updates are
+// atomic, so the two never lose counts.
+uint32_t dimmer_trace_zero_cross_begin(uint32_t edge_us, uint32_t now_us);
+void dimmer_trace_zero_cross_end(uint32_t start_cycles);
+void dimmer_trace_note_fire(uint32_t target_us, uint32_t fire_us);
+void dimmer_trace_note_missed(void);
+
+// Any core; the writer clears the histograms on its next zero-cross.
+void dimmer_trace_request_reset(void);
+void dimmer_trace_get_snapshot(dimmer_trace_snapshot_t *out_snapshot);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef FLASH_JOURNAL_H
+#define FLASH_JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Append-only record log over the APP_PERSISTENT_STORAGE_* flash region.
+// Every sector starts with a header carrying its write sequence and erase
+// count; records are CRC-framed and packed behind it, so an append programs
+// only the pages the new record covers. A record with the same type and key
+// supersedes older ones. When free sectors run out, the oldest sector is
+// compacted: live records move to the head (evictable ones are dropped when
+// keeping them would free no space) and the sector is retired: its magic is
+// zeroed but the header, and so its erase count, stays. A free sector is
+// erased only when it is taken, right before its new header is written.
+// Free sectors are taken lowest erase count first.
+#define FLASH_JOURNAL_MAX_SECTORS 128u
+
+typedef struct {
+  uint8_t type;
+  uint32_t key;
+  // Absolute flash offset of the payload, readable in place through XIP.
+  uint32_t payload_offset;
+  uint32_t length;
+} flash_journal_entry_t;
+
+typedef struct {
+  uint16_t sector_count;
+  uint16_t free_sectors;
+  uint32_t min_erase_count;
+  uint32_t max_erase_count;
+  uint32_t live_records;
+  uint32_t live_bytes;
+  uint32_t capacity_bytes;
+  uint32_t compactions;
+  uint32_t evicted_records;
+} flash_journal_stats_t;
+
+// Not thread-safe: the owner (blower_test_service) serializes all calls.
+// Sectors written with another format_version are treated as free.
+bool flash_journal_mount(uint16_t format_version);
+bool flash_journal_append(uint8_t type, uint32_t key, bool evictable,
+                          const void *data, uint32_t length);
+bool flash_journal_find(uint8_t type, uint32_t key, flash_journal_entry_t *out_entry);
+// Entries of one type, newest first, skipping the first skip matches.
+uint32_t flash_journal_list(uint8_t type, uint32_t skip, flash_journal_entry_t *out_entries,
+                            uint32_t max_entries, uint32_t *out_total);
+bool flash_journal_read(const flash_journal_entry_t *entry, uint32_t offset, void *out_data,
+                        uint32_t length);
+// In-place XIP view of the payload. It stays valid until the sector holding
+// it is erased, i.e. while flash_journal_generation() is unchanged; the
+// generation is a plain counter and may be read without the owner's lock.
+const uint8_t *flash_journal_payload(const flash_journal_entry_t *entry);
+uint32_t flash_journal_generation(void);
+void flash_journal_get_stats(flash_journal_stats_t *out_stats);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef FLASH_WRITER_H
+#define FLASH_WRITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Every flash erase/program goes through here. Each step runs from SRAM
+// under flash_safe_execute(); core1 keeps its RAM-resident gate timing.
+// When core0 owns gate timing, a page program waits until the current
+// half-cycle's gate has fired so it finishes before the next zero-cross. A
+// sector erase is longer than a half-cycle, so it only runs while the dimmer
+// is committed to 0% with no other command pending, and is refused otherwise.
+typedef struct {
+  uint32_t erase_count;
+  uint32_t program_count;
+  uint32_t failed_count;
+  // Steps that had to wait for a gap between gate pulses.
+  uint32_t window_wait_count;
+  // Pages run without a gap after APP_FLASH_WRITER_WINDOW_TIMEOUT_MS.
+  uint32_t forced_count;
+  // Erases refused because the dimmer was not at 0% within the same timeout.
+  uint32_t erase_refused_count;
+  uint32_t lockout_last_us;
+  uint32_t lockout_max_us;
+  // Gate alarms dropped while a step was in progress; should stay zero.
+  uint32_t missed_alarm_count;
+} flash_writer_stats_t;
+
+// Offsets are relative to the start of flash. page_data must live in SRAM:
+// XIP is off while the page is programmed.
+bool flash_writer_erase_sector(uint32_t flash_offset);
+bool flash_writer_program_page(uint32_t flash_offset, const uint8_t *page_data);
+// True when an erase may run now (always, when core1 owns gate timing).
+bool flash_writer_erase_allowed(void);
+// True when timestamp_us fell inside the last flash lockout.
+bool flash_writer_lockout_covers(uint32_t timestamp_us);
+void flash_writer_get_stats(flash_writer_stats_t *out_stats);
+
+#endif
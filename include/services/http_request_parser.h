@@ -0,0 +1,79 @@
+#ifndef HTTP_REQUEST_PARSER_H
+#define HTTP_REQUEST_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest request line or header line kept. Longer header lines are skipped
+// (nothing the server reads is that long); a longer request line is an error.
+#ifndef HTTP_REQUEST_PARSER_LINE_CAPACITY
+#define HTTP_REQUEST_PARSER_LINE_CAPACITY 256u
+#endif
+
+// Request line plus headers, so a client cannot stream headers forever.
+#ifndef HTTP_REQUEST_PARSER_MAX_HEADER_BYTES
+#define HTTP_REQUEST_PARSER_MAX_HEADER_BYTES 8192u
+#endif
+
+typedef enum {
+  HTTP_REQUEST_PARSER_REQUEST_LINE = 0,
+  HTTP_REQUEST_PARSER_HEADERS,
+  HTTP_REQUEST_PARSER_BODY,
+  HTTP_REQUEST_PARSER_DONE,
+  HTTP_REQUEST_PARSER_ERROR,
+} http_request_parser_state_t;
+
+// Why the parser stopped in the error state. The connection cannot be reused
+// after any of them: the end of the request is unknown.
+typedef enum {
+  HTTP_REQUEST_PARSER_ERROR_NONE = 0,
+  HTTP_REQUEST_PARSER_ERROR_BAD_REQUEST,
+  // Transfer-Encoding without Content-Length; bodies are only framed by length.
+  HTTP_REQUEST_PARSER_ERROR_NOT_IMPLEMENTED,
+} http_request_parser_error_t;
+
+// Strings passed to the callbacks are not NUL-terminated and only valid for
+// the call. Returning false from a callback stops the parser in the error
+// state.
+typedef struct {
+  bool (*on_request_line)(void *context, const char *method, size_t method_length,
+                          const char *target, size_t target_length, bool http_1_1);
+  // Content-Length and Transfer-Encoding are also interpreted by the parser.
+  bool (*on_header)(void *context, const char *name, size_t name_length,
+                    const char *value, size_t value_length);
+  bool (*on_headers_complete)(void *context, size_t content_length);
+  bool (*on_body)(void *context, const uint8_t *data, size_t length);
+} http_request_parser_callbacks_t;
+
+// Resumable HTTP/1.x request parser. Bytes are fed as they arrive, in slices
+// of any size; only the current header line is buffered and the body goes
+// straight to on_body, so a request costs HTTP_REQUEST_PARSER_LINE_CAPACITY
+// bytes whatever its size. Parsing stops at the end of the request, leaving
+// the bytes of a pipelined request unconsumed.
+typedef struct {
+  const http_request_parser_callbacks_t *callbacks;
+  void *context;
+  http_request_parser_state_t state;
+  http_request_parser_error_t error;
+  size_t line_length;
+  bool line_overflow;
+  size_t header_bytes;
+  size_t content_length;
+  bool has_content_length;
+  bool has_transfer_encoding;
+  size_t body_remaining;
+  char line[HTTP_REQUEST_PARSER_LINE_CAPACITY];
+} http_request_parser_t;
+
+// Also starts the next request on the same parser.
+void http_request_parser_init(http_request_parser_t *parser,
+                              const http_request_parser_callbacks_t *callbacks,
+                              void *context);
+
+// Returns the bytes consumed, which is less than length once the request is
+// complete or the parser has failed; check parser->state.
+size_t http_request_parser_feed(http_request_parser_t *parser, const uint8_t *data,
+                                size_t length);
+
+#endif
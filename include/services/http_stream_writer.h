@@ -0,0 +1,70 @@
+#ifndef HTTP_STREAM_WRITER_H
+#define HTTP_STREAM_WRITER_H
+
+#include "lwip/api.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes buffered before a flush; also the largest single formatted item.
+#ifndef HTTP_STREAM_WRITER_CAPACITY
+#define HTTP_STREAM_WRITER_CAPACITY 1024u
+#endif
+
+// Four hex digits and CRLF in front of every chunk.
+#define HTTP_STREAM_CHUNK_HEADER_BYTES 6u
+
+// Incremental response body in constant memory. Output is formatted into a
+// fixed buffer and flushed with one netconn_write() per chunk, so a response
+// of any size costs HTTP_STREAM_WRITER_CAPACITY bytes. Responses use HTTP/1.1
+// chunked encoding; raw mode writes the bytes unframed, WebSocket mode sends
+// one message, a frame per flush, and memory mode renders into a caller
+// buffer (SSE frames shared by every subscriber).
+// Headers are already out when something fails mid-body, so a failed stream
+// ends without the terminating chunk and the client sees a truncated
+// response rather than a well-formed wrong one.
+typedef struct {
+  struct netconn *connection;
+  bool chunked;
+  bool websocket;
+  uint8_t websocket_opcode;
+  char *memory;
+  size_t memory_capacity;
+  bool discard;
+  bool failed;
+  size_t length;
+  uint32_t total_bytes;
+  char buffer[HTTP_STREAM_CHUNK_HEADER_BYTES + HTTP_STREAM_WRITER_CAPACITY + 2u];
+} http_stream_writer_t;
+
+// Sends the headers; with head_only the body is accepted and dropped.
+bool http_stream_begin_response(http_stream_writer_t *stream,
+                                struct netconn *connection, const char *status_line,
+                                const char *content_type, bool head_only,
+                                bool keep_alive);
+void http_stream_begin_raw(http_stream_writer_t *stream, struct netconn *connection);
+// Frames after the first are continuations; http_stream_end() sends the final
+// one, so a message that fits the buffer goes out as a single frame.
+void http_stream_begin_websocket(http_stream_writer_t *stream,
+                                 struct netconn *connection, uint8_t opcode);
+
+// Flushes append to out; the stream fails once capacity would be exceeded.
+// total_bytes is the rendered length after http_stream_end().
+void http_stream_begin_memory(http_stream_writer_t *stream, char *out,
+                              size_t capacity);
+
+bool http_stream_write(http_stream_writer_t *stream, const char *data, size_t length);
+bool http_stream_puts(http_stream_writer_t *stream, const char *text);
+bool http_stream_printf(http_stream_writer_t *stream, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+// Quoted and escaped JSON string.
+bool http_stream_json_string(http_stream_writer_t *stream, const char *text);
+// CSV field, quoted only when it holds a separator, quote or line break.
+bool http_stream_csv_field(http_stream_writer_t *stream, const char *text);
+
+bool http_stream_flush(http_stream_writer_t *stream);
+// Flushes and, for chunked responses, writes the terminating chunk (for a
+// WebSocket message, the final frame). Returns false if any write failed.
+bool http_stream_end(http_stream_writer_t *stream);
+
+#endif
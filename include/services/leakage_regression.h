@@ -0,0 +1,59 @@
+#ifndef LEAKAGE_REGRESSION_H
+#define LEAKAGE_REGRESSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LEAKAGE_REGRESSION_MAX_POINTS 16u
+#define LEAKAGE_REGRESSION_MAX_ITERATIONS 10u
+
+typedef struct {
+  float pressure_pa;
+  float flow_m3h;
+  // Standard uncertainty of log(Q) at this point; 0 when unknown.
+  float log_flow_sigma;
+} leakage_regression_point_t;
+
+typedef struct {
+  // Inverse-variance weights from log_flow_sigma; ignored unless every point
+  // carries a sigma.
+  bool use_weights;
+  // Huber IRLS down-weighting of points far from the fit.
+  bool robust;
+  float huber_k;
+} leakage_regression_options_t;
+
+// Q = C * dp^n fitted as ln(Q) = ln(C) + n ln(dp). Weights are normalized to
+// a mean of one, so the ISO 9972 Annex C expressions apply unchanged.
+typedef struct {
+  bool valid;
+  // False with only two points: the fit exists but has no degrees of freedom.
+  bool has_confidence;
+  uint8_t point_count;
+  uint8_t iterations;
+  uint8_t downweighted_count;
+  float ln_c;
+  float exponent_n;
+  float correlation_r;
+  float residual_scale;
+  float se_ln_c;
+  float se_n;
+  float t_quantile;
+  float mean_log_pressure;
+  float weight_sum;
+  float sxx;
+} leakage_regression_result_t;
+
+bool leakage_regression_fit(const leakage_regression_point_t *points, uint8_t count,
+                            const leakage_regression_options_t *options,
+                            leakage_regression_result_t *out_result);
+
+// Flow predicted at pressure_pa with its 95 % confidence interval.
+bool leakage_regression_predict(const leakage_regression_result_t *result,
+                                float pressure_pa, float *out_flow_m3h,
+                                float *out_ci_low_m3h, float *out_ci_high_m3h);
+
+// Two-sided 95 % Student t quantile.
+float leakage_regression_t_quantile_975(uint32_t degrees_of_freedom);
+
+#endif
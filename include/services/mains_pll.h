@@ -0,0 +1,56 @@
+#ifndef MAINS_PLL_H
+#define MAINS_PLL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+  MAINS_PLL_EDGE_REJECTED = 0,
+  MAINS_PLL_EDGE_ACQUIRING,
+  MAINS_PLL_EDGE_TRACKED
+} mains_pll_edge_result_t;
+
+typedef struct {
+  bool has_edge;
+  bool locked;
+  uint8_t half_cycles_per_edge;
+  uint8_t lock_streak;
+  uint8_t unlock_streak;
+  uint8_t reject_streak;
+  uint32_t last_edge_us;
+  uint32_t predicted_edge_us;
+  float edge_period_us;
+  float phase_error_us;
+  float phase_error_ms2;
+  uint32_t accepted_edges;
+  uint32_t rejected_edges;
+  uint32_t missed_edges;
+  uint32_t lock_events;
+  uint32_t unlock_events;
+} mains_pll_t;
+
+typedef struct {
+  bool tracking;
+  bool locked;
+  uint8_t half_cycles_per_edge;
+  float mains_frequency_hz;
+  float half_cycle_us;
+  float phase_error_us;
+  float phase_error_rms_us;
+  uint32_t accepted_edges;
+  uint32_t rejected_edges;
+  uint32_t missed_edges;
+  uint32_t lock_events;
+  uint32_t unlock_events;
+} mains_pll_status_t;
+
+void mains_pll_reset(mains_pll_t *pll);
+// Feeds one raw detector edge. On MAINS_PLL_EDGE_ACQUIRING / _TRACKED the
+// best zero-cross estimate for this edge is written to out_zero_cross_us:
+// the raw edge while acquiring, the loop-filtered phase once tracking.
+mains_pll_edge_result_t mains_pll_process_edge(mains_pll_t *pll, uint32_t edge_us,
+                                               uint32_t *out_zero_cross_us);
+float mains_pll_half_cycle_us(const mains_pll_t *pll);
+void mains_pll_get_status(const mains_pll_t *pll, mains_pll_status_t *out_status);
+
+#endif
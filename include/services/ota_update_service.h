@@ -49,6 +49,9 @@ ota_update_result_t ota_update_service_write_chunk(uint32_t offset,
                                                    const uint8_t *chunk_data,
                                                    size_t chunk_length);
 ota_update_result_t ota_update_service_finish(void);
+// Ends a session that is still receiving, so a new one can begin after an
+// upload broke off.
+void ota_update_service_abort(const char *reason);
 ota_update_result_t ota_update_service_request_apply_async(void);
 
 void ota_update_service_get_status(ota_update_status_t *out_status);
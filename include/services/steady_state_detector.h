@@ -0,0 +1,57 @@
+#ifndef STEADY_STATE_DETECTOR_H
+#define STEADY_STATE_DETECTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define STEADY_STATE_MAX_SAMPLES 192u
+
+typedef struct {
+  // Analysis window; older samples are dropped as new ones arrive.
+  uint32_t window_ms;
+  uint16_t min_samples;
+  // Largest drift over one window still treated as flat (upper confidence
+  // bound of the regression slope times the window length).
+  float max_pressure_drift_pa;
+  float max_flow_drift_ratio;
+  // Two-sided t quantile used for the slope confidence bound.
+  float slope_t_quantile;
+  // Late-half over early-half variance must stay within [1/limit, limit].
+  float max_variance_ratio;
+} steady_state_config_t;
+
+typedef struct {
+  uint32_t t_ms;
+  float pressure_pa;
+  float flow_m3h;
+} steady_state_sample_t;
+
+typedef struct {
+  bool steady;
+  uint16_t sample_count;
+  uint32_t span_ms;
+  float pressure_mean_pa;
+  float flow_mean_m3h;
+  float pressure_drift_pa;
+  float flow_drift_ratio;
+  float pressure_variance_ratio;
+  float flow_variance_ratio;
+} steady_state_status_t;
+
+typedef struct {
+  steady_state_config_t config;
+  steady_state_sample_t samples[STEADY_STATE_MAX_SAMPLES];
+  uint16_t head;
+  uint16_t count;
+  steady_state_status_t status;
+} steady_state_detector_t;
+
+void steady_state_reset(steady_state_detector_t *detector,
+                        const steady_state_config_t *config);
+// Returns true once both pressure and flow are statistically flat.
+bool steady_state_add_sample(steady_state_detector_t *detector, uint32_t t_ms,
+                             float pressure_pa, float flow_m3h);
+void steady_state_get_status(const steady_state_detector_t *detector,
+                             steady_state_status_t *out_status);
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef TEST_SAMPLE_STORE_H
+#define TEST_SAMPLE_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Raw test samples as int16 deltas against the previous sample, in fixed
+// blocks that each start from a full int32 base sample. A series (one test
+// point) occupies consecutive blocks because points are measured in order.
+#define TEST_SAMPLE_STORE_BLOCK_SAMPLES 32u
+#define TEST_SAMPLE_STORE_MAX_SERIES 24u
+
+typedef enum {
+  TEST_SAMPLE_CHANNEL_TIME_MS = 0,
+  TEST_SAMPLE_CHANNEL_ENVELOPE_PRESSURE,
+  TEST_SAMPLE_CHANNEL_FAN_PRESSURE,
+  TEST_SAMPLE_CHANNEL_ENVELOPE_TEMPERATURE,
+  TEST_SAMPLE_CHANNEL_FAN_TEMPERATURE,
+  TEST_SAMPLE_CHANNEL_PWM,
+  TEST_SAMPLE_CHANNEL_COUNT,
+} test_sample_channel_t;
+
+typedef struct {
+  uint32_t t_ms;
+  float envelope_pressure_pa;
+  float fan_pressure_pa;
+  float envelope_temperature_c;
+  float fan_temperature_c;
+  float pwm_percent;
+} test_sample_t;
+
+typedef struct {
+  int32_t base[TEST_SAMPLE_CHANNEL_COUNT];
+  int16_t delta[TEST_SAMPLE_STORE_BLOCK_SAMPLES - 1u][TEST_SAMPLE_CHANNEL_COUNT];
+  uint8_t count;
+} test_sample_block_t;
+
+typedef struct {
+  uint8_t series_id;
+  uint16_t block;
+  uint16_t block_end;
+  uint8_t index;
+  int32_t value[TEST_SAMPLE_CHANNEL_COUNT];
+} test_sample_cursor_t;
+
+// Not thread-safe: the owner (blower_test_service) serializes all calls.
+void test_sample_store_reset(void);
+bool test_sample_store_begin_series(uint8_t series_id);
+// False once the pool is full; the series is then marked truncated.
+bool test_sample_store_append(const test_sample_t *sample);
+uint16_t test_sample_store_series_count(uint8_t series_id);
+bool test_sample_store_series_truncated(uint8_t series_id);
+void test_sample_store_get_usage(size_t *out_used_bytes, size_t *out_capacity_bytes);
+
+// Flat image of the store, for saving it outside RAM: the series table, then
+// the used blocks. Only meaningful to the firmware build that wrote it.
+size_t test_sample_store_image_size(void);
+size_t test_sample_store_image_read(size_t offset, void *out_data, size_t length);
+// Loading replaces the store: write the image in any order, then finish with
+// its size. A size or table that does not check out leaves the store empty.
+bool test_sample_store_image_write(size_t offset, const void *data, size_t length);
+bool test_sample_store_image_finish(size_t size);
+
+void test_sample_store_cursor_init(test_sample_cursor_t *cursor, uint8_t series_id);
+bool test_sample_store_cursor_next(test_sample_cursor_t *cursor, test_sample_t *out_sample);
+
+#endif
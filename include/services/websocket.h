@@ -0,0 +1,87 @@
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest client data message kept, across fragments. Clients only send
+// commands, so anything longer is a protocol error.
+#ifndef WEBSOCKET_MAX_MESSAGE_BYTES
+#define WEBSOCKET_MAX_MESSAGE_BYTES 256u
+#endif
+
+#define WEBSOCKET_MAX_CONTROL_BYTES 125u
+// Base64 of a SHA-1 digest.
+#define WEBSOCKET_ACCEPT_KEY_LENGTH 28u
+// Server frames are unmasked: 2 bytes, plus 2 or 8 for the extended length.
+#define WEBSOCKET_MAX_FRAME_HEADER_BYTES 10u
+
+#define WEBSOCKET_OPCODE_CONTINUATION 0x0u
+#define WEBSOCKET_OPCODE_TEXT 0x1u
+#define WEBSOCKET_OPCODE_BINARY 0x2u
+#define WEBSOCKET_OPCODE_CLOSE 0x8u
+#define WEBSOCKET_OPCODE_PING 0x9u
+#define WEBSOCKET_OPCODE_PONG 0xAu
+
+#define WEBSOCKET_CLOSE_NORMAL 1000u
+#define WEBSOCKET_CLOSE_GOING_AWAY 1001u
+#define WEBSOCKET_CLOSE_PROTOCOL_ERROR 1002u
+#define WEBSOCKET_CLOSE_UNSUPPORTED_DATA 1003u
+#define WEBSOCKET_CLOSE_TOO_BIG 1009u
+
+typedef enum {
+  WEBSOCKET_PARSER_HEADER = 0,
+  WEBSOCKET_PARSER_PAYLOAD,
+  WEBSOCKET_PARSER_MESSAGE,
+  WEBSOCKET_PARSER_ERROR,
+} websocket_parser_state_t;
+
+// Resumable parser for client frames (RFC 6455 section 5). Bytes are fed as
+// they arrive; payloads are unmasked into the parser. Parsing stops in the
+// MESSAGE state when a data message or a control frame is complete: opcode,
+// payload and payload_length describe it until websocket_parser_next().
+// A control frame can arrive between the fragments of a data message and is
+// reported without disturbing it.
+typedef struct {
+  websocket_parser_state_t state;
+  uint8_t header[14];
+  size_t header_length;
+  size_t header_needed;
+  bool frame_fin;
+  uint8_t frame_opcode;
+  uint8_t mask[4];
+  uint64_t frame_remaining;
+  uint32_t frame_offset;
+  uint8_t message_opcode;
+  size_t message_length;
+  size_t control_length;
+  uint8_t opcode;
+  const uint8_t *payload;
+  size_t payload_length;
+  uint16_t close_code;
+  uint8_t control[WEBSOCKET_MAX_CONTROL_BYTES];
+  uint8_t message[WEBSOCKET_MAX_MESSAGE_BYTES];
+} websocket_parser_t;
+
+// Sec-WebSocket-Accept for a Sec-WebSocket-Key: base64(SHA-1(key + GUID)).
+// Returns false for a key that is not a 16-byte base64 nonce.
+bool websocket_accept_key(const char *key, size_t key_length,
+                          char accept[WEBSOCKET_ACCEPT_KEY_LENGTH + 1u]);
+
+// Writes an unmasked server frame header; returns its length.
+size_t websocket_frame_header(uint8_t *header, bool fin, uint8_t opcode,
+                              uint64_t payload_length);
+
+void websocket_parser_init(websocket_parser_t *parser);
+
+// Returns the bytes consumed, which is less than length once a message is
+// complete or the parser has failed; check parser->state. close_code holds
+// the status to close with after an error.
+size_t websocket_parser_feed(websocket_parser_t *parser, const uint8_t *data,
+                             size_t length);
+
+// Releases the reported message and goes on with the next frame.
+void websocket_parser_next(websocket_parser_t *parser);
+
+#endif
@@ -1,15 +1,61 @@
 #ifndef BLOWER_SHARED_STATE_H
 #define BLOWER_SHARED_STATE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 // Shared between cores:
-// - Core0 writes desired dimmer power percent [0..100]
-// - Core1 reads it from ISR for phase-angle control
+// - Core0 submits dimmer power commands [0..100] into a pending slot
+// - The gate-timing ISR (core0 or core1) commits the pending command only at
+//   zero-cross and publishes which command drove which half-cycle
+// - Whichever side owns gate timing publishes health counters back
+
+typedef struct {
+  uint32_t zero_cross_count;
+  uint32_t gate_pulse_count;
+  uint32_t missed_alarm_count;
+  // Missed alarms whose edge fell inside a core0 flash lockout; also counted
+  // in missed_alarm_count.
+  uint32_t blanked_half_cycle_count;
+  uint32_t fire_latency_last_us;
+  uint32_t fire_latency_max_us;
+  uint32_t fire_latency_total_us;
+  bool line_pll_locked;
+  uint32_t line_frequency_mhz;
+  uint32_t line_phase_error_ms_us2;
+} shared_dimmer_health_t;
+
+// Actuation timestamps use the time_us_32() timebase on both cores.
+typedef struct {
+  uint32_t command_sequence;
+  uint8_t power_percent;
+  uint32_t half_cycle_sequence;
+  uint32_t commit_us;
+  uint32_t fire_us;
+  uint32_t fire_delay_us;
+  uint32_t fire_half_cycle_sequence;
+  uint32_t asymmetric_cycle_count;
+  int32_t last_asymmetry_us;
+} shared_dimmer_actuation_t;
 
 void shared_state_init(void);
 
 void shared_set_dimmer_power_percent(uint8_t percent);
 uint8_t shared_get_dimmer_power_percent(void);
 
+uint32_t shared_dimmer_submit_command(uint8_t percent);
+uint8_t shared_dimmer_commit_half_cycles(uint32_t zero_cross_us, uint32_t half_cycles,
+                                         uint32_t *out_first_half_cycle_sequence);
+void shared_dimmer_note_fire(uint32_t half_cycle_sequence, uint32_t zero_cross_us,
+                             uint32_t fire_us);
+void shared_dimmer_get_actuation(shared_dimmer_actuation_t *out_actuation);
+
+void shared_dimmer_note_zero_cross(void);
+void shared_dimmer_note_gate_pulse(uint32_t fire_latency_us);
+void shared_dimmer_note_missed_alarm(void);
+void shared_dimmer_note_blanked_half_cycle(void);
+void shared_dimmer_set_line_status(bool pll_locked, uint32_t frequency_mhz,
+                                   uint32_t phase_error_ms_us2);
+void shared_dimmer_get_health(shared_dimmer_health_t *out_health);
+
 #endif // BLOWER_SHARED_STATE_H
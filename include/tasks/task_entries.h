@@ -4,5 +4,6 @@
 void wifi_task_entry(void *params);
 void dimmer_task_entry(void *params);
 void adp910_sampling_task_entry(void *params);
+void blower_test_task_entry(void *params);
 
 #endif
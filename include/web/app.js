@@ -1,4 +1,7 @@
 let eventSource = null;
+let socket = null;
+let socketSeq = 0;
+const socketAcks = new Map();
 let sseReconnectTimer = null;
 let sseRetryDelayMs = 1500;
 let hasReceivedSseEvent = false;
@@ -15,9 +18,25 @@ const SEA_LEVEL_AIR_DENSITY = 1.225;
 const DEFAULT_ALTITUDE_M = 650;
 const SETTINGS_KEY = 'blower_ui_v2';
 const OTA_CHUNK_SIZE = 768;
+const SOCKET_ACK_TIMEOUT_MS = 3000;
+const SOCKET_COMMANDS = new Set(['pwm', 'led', 'relay']);
+/* Binary status frames are preferred; firmware answers with the one it picked. */
+const SOCKET_PROTOCOLS = ['blower.v1.bin', 'blower.v1.json'];
+const STATUS_FRAME_VERSION = 1;
+const STATUS_FRAME_FLOATS = [
+    'frequency', 'phase_error_us', 'dp1_pressure', 'dp1_temperature',
+    'dp2_pressure', 'dp2_temperature', 'fan_wind_speed_ms', 'fan_flow_m3h',
+    'target_pressure_pa', 'cal_fan', 'cal_env', 'test_ach', 'test_ach_ci_low',
+    'test_ach_ci_high',
+];
+const STATUS_FRAME_FIXED_BYTES = 18 + 4 * STATUS_FRAME_FLOATS.length;
+const TEST_STATE_NAMES = ['idle', 'preparing', 'stabilizing', 'measuring', 'rezeroing', 'completed', 'aborted', 'error'];
+const TEST_VERDICT_NAMES = ['none', 'pass', 'fail'];
+const textDecoder = new TextDecoder();
 
 const API = Object.freeze({
     events: '/events',
+    socket: '/ws',
     pwm: '/api/pwm',
     led: '/api/led',
     relay: '/api/relay',
@@ -174,7 +193,23 @@ async function postJson(url, body) {
     return parsed;
 }
 
+function sendSocketCmd(cmd, value) {
+    const seq = ++socketSeq;
+    return new Promise((resolve, reject) => {
+        const timer = setTimeout(() => {
+            socketAcks.delete(seq);
+            reject(new Error('WS ack timeout'));
+        }, SOCKET_ACK_TIMEOUT_MS);
+        socketAcks.set(seq, { resolve, reject, timer });
+        socket.send(JSON.stringify({ seq, cmd, value }));
+    });
+}
+
 async function sendCmd(endpoint, value) {
+    if (socket?.readyState === WebSocket.OPEN && SOCKET_COMMANDS.has(endpoint)) {
+        await sendSocketCmd(endpoint, value);
+        return;
+    }
     await postJson(API[endpoint] || `/api/${endpoint}`, { value });
 }
 
@@ -584,11 +619,81 @@ function handleTelemetry(data, detail) {
     stampUpdate();
 }
 
-/* ── SSE ── */
+/* ── WebSocket (telemetry and commands), SSE fallback ── */
+
+function settleSocketAcks(error) {
+    socketAcks.forEach(({ reject, timer }) => { clearTimeout(timer); reject(error); });
+    socketAcks.clear();
+}
+
+/* Packed status frame (docs/web_endpoint_mapping.md) to the same message as
+   the JSON one, including the fields the firmware leaves out as duplicates. */
+function decodeStatusFrame(buffer) {
+    const view = new DataView(buffer);
+    if (view.byteLength < STATUS_FRAME_FIXED_BYTES || view.getUint8(0) !== STATUS_FRAME_VERSION) return null;
+    const flags = view.getUint8(1);
+    const fwLength = view.getUint8(9);
+    let offset = STATUS_FRAME_FIXED_BYTES + fwLength;
+    if (offset > view.byteLength) return null;
+
+    const data = {
+        fw: textDecoder.decode(new Uint8Array(buffer, STATUS_FRAME_FIXED_BYTES, fwLength)),
+        pwm: view.getUint8(2),
+        led: flags & 0x01 ? 1 : 0,
+        relay: flags & 0x02 ? 1 : 0,
+        line_sync: flags & 0x04 ? 1 : 0,
+        pll_locked: flags & 0x08 ? 1 : 0,
+        dp1_ok: Boolean(flags & 0x10),
+        dp2_ok: Boolean(flags & 0x20),
+        cal: view.getUint8(3),
+        cal_pct: view.getUint8(4),
+        test_state: TEST_STATE_NAMES[view.getUint8(5)] ?? 'unknown',
+        test_point: view.getUint8(6),
+        test_points: view.getUint8(7),
+        test_verdict: TEST_VERDICT_NAMES[view.getUint8(8)] ?? 'none',
+        sample_sequence: view.getUint32(14, true),
+        logs_enabled: Boolean(flags & 0x40),
+    };
+    STATUS_FRAME_FLOATS.forEach((name, i) => { data[name] = view.getFloat32(18 + 4 * i, true); });
+    data.input = data.line_sync;
+    data.dp_pressure = data.dp1_pressure;
+    data.dp_temperature = data.dp1_temperature;
+    data.fan_wind_speed_kmh = data.fan_wind_speed_ms * 3.6;
+    data.test_ach_ci = [data.test_ach_ci_low, data.test_ach_ci_high];
+    delete data.test_ach_ci_low;
+    delete data.test_ach_ci_high;
+    if (data.logs_enabled) {
+        const logsLength = offset < view.byteLength ? view.getUint8(offset) : 0;
+        offset += 1;
+        if (offset + logsLength > view.byteLength) return null;
+        data.logs = textDecoder.decode(new Uint8Array(buffer, offset, logsLength));
+    }
+    return { type: 'status', seq: view.getUint32(10, true), data };
+}
+
+function handleSocketMessage(msg) {
+    if (msg.type === 'status') {
+        handleTelemetry(msg.data, 'WS');
+        hasReceivedSseEvent = true;
+    } else if (msg.type === 'ack') {
+        const pending = socketAcks.get(msg.ack);
+        if (!pending) return;
+        socketAcks.delete(msg.ack);
+        clearTimeout(pending.timer);
+        if (msg.status === 'ok') pending.resolve(msg);
+        else pending.reject(new Error(msg.reason || 'WS command error'));
+    }
+}
 
 function closeSSE() {
     if (sseReconnectTimer) { clearTimeout(sseReconnectTimer); sseReconnectTimer = null; }
     if (eventSource) { eventSource.close(); eventSource = null; }
+    if (socket) {
+        socket.onclose = null;
+        socket.close();
+        socket = null;
+        settleSocketAcks(new Error('WS closed'));
+    }
 }
 
 function scheduleReconnect() {
@@ -596,10 +701,44 @@ function scheduleReconnect() {
     sseReconnectTimer = setTimeout(() => {
         sseReconnectTimer = null;
         sseRetryDelayMs = Math.min(sseRetryDelayMs * 2, SSE_RETRY_MAX_MS);
-        connectSSE();
+        connectLink();
     }, sseRetryDelayMs);
 }
 
+function connectLink() {
+    closeSSE();
+    const scheme = location.protocol === 'https:' ? 'wss' : 'ws';
+    let opened = false;
+    try { socket = new WebSocket(`${scheme}://${location.host}${API.socket}`, SOCKET_PROTOCOLS); }
+    catch { connectSSE(); return; }
+    socket.binaryType = 'arraybuffer';
+
+    socket.onopen = () => {
+        opened = true;
+        sseRetryDelayMs = SSE_RETRY_BASE_MS;
+        hasReceivedSseEvent = false;
+        setConn('ok', 'Connected');
+    };
+
+    socket.onmessage = (ev) => {
+        try {
+            const msg = typeof ev.data === 'string' ? JSON.parse(ev.data) : decodeStatusFrame(ev.data);
+            if (msg) handleSocketMessage(msg);
+        } catch {}
+    };
+
+    socket.onclose = () => {
+        socket = null;
+        settleSocketAcks(new Error('WS closed'));
+        /* Refused (the /ws slot is held by another browser, 503) or firmware
+           without /ws: stay on SSE and POST commands. */
+        if (!opened) { connectSSE(); return; }
+        setConn('err', hasReceivedSseEvent ? 'Reconnecting...' : 'Connecting...');
+        hasReceivedSseEvent = false;
+        scheduleReconnect();
+    };
+}
+
 function connectSSE() {
     closeSSE();
     try { eventSource = new EventSource(API.events); }
@@ -878,7 +1017,7 @@ function bootstrap() {
     setStatus('Idle');
     setConn('idle', 'Connecting');
     bindEvents();
-    connectSSE();
+    connectLink();
 }
 
 window.addEventListener('load', bootstrap);
@@ -5,7 +5,38 @@
 #include <stddef.h>
 #include <stdint.h>
 
-bool web_assets_get(const char *request_path, const char **content_type,
-                    const uint8_t **body, size_t *body_length);
+// One embedded file, generated by scripts/generate_web_assets.py. gzip_body is
+// NULL when compressing did not make the file smaller. The ETags are quoted
+// content hashes, one per encoding.
+typedef struct {
+  const char *path;
+  const char *content_type;
+  const char *etag;
+  const char *gzip_etag;
+  const char *cache_control;
+  const uint8_t *body;
+  size_t body_length;
+  const uint8_t *gzip_body;
+  size_t gzip_length;
+} web_asset_t;
+
+#define WEB_ROUTE_METHOD_GET 0x01u
+#define WEB_ROUTE_METHOD_HEAD 0x02u
+#define WEB_ROUTE_METHOD_POST 0x04u
+#define WEB_ROUTE_METHOD_OTHER 0x08u
+
+// One request path: an HTTP route from src/tasks/http_routes.txt (route is an
+// http_route_t from the generated web/http_routes.h) or an embedded asset
+// (route is HTTP_ROUTE_NONE). methods is a WEB_ROUTE_METHOD_* mask.
+typedef struct {
+  const char *path;
+  uint8_t route;
+  uint8_t methods;
+  const web_asset_t *asset;
+} web_route_t;
+
+// Perfect-hash lookups: one hash of the path and one string compare.
+const web_route_t *web_routes_find(const char *request_path);
+const web_asset_t *web_assets_find(const char *request_path);
 
 #endif
@@ -13,6 +13,7 @@ BUILD_TYPE="${BUILD_TYPE:-Release}"
 PROBE_CHIP="${PROBE_RS_CHIP:-RP235x}"
 PROBE_PROTOCOL="${PROBE_RS_PROTOCOL:-swd}"
 SKIP_FLASH="${SKIP_FLASH:-0}"
+DIMMER_ON_CORE1="${DIMMER_ON_CORE1:-0}"
 
 require_cmd() {
     local cmd="$1"
@@ -135,6 +136,7 @@ cmake -S "${REPO_ROOT}" -B "${BUILD_DIR}" -G "${CMAKE_GENERATOR}" \
     -DPICO_PLATFORM=rp2350 \
     -DFREERTOS_KERNEL_PATH="${FREERTOS_DIR}" \
     -DBLOWER_WEB_SOURCE_DIR="${WEB_DIR}" \
+    -DBLOWER_DIMMER_ON_CORE1="$([[ "${DIMMER_ON_CORE1}" == "1" ]] && echo ON || echo OFF)" \
     ${FIRMWARE_VERSION_OVERRIDE:+-DBLOWER_FIRMWARE_VERSION_OVERRIDE="${FIRMWARE_VERSION_OVERRIDE}"} \
     ${PICO_TOOLCHAIN_PATH:+-DPICO_TOOLCHAIN_PATH="${PICO_TOOLCHAIN_PATH}"}
 
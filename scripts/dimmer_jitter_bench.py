@@ -0,0 +1,293 @@
+#!/usr/bin/env python3
+
+from __future__ import annotations
+
+import argparse
+import base64
+import json
+import pathlib
+import sys
+import threading
+import time
+import urllib.error
+import urllib.request
+import zlib
+
+DIAG_PATH = "/api/diag/dimmer"
+TRACE_PATH = "/api/diag/dimmer/trace"
+TRACE_RESET_PATH = "/api/diag/dimmer/trace/reset"
+HTTP_LOAD_PATHS = ("/", "/app.js", "/api/status", "/api/ota/status")
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Measure dimmer gate-timing jitter on Blower Pico while the "
+            "network stack is idle, under HTTP load and during OTA staging"
+        )
+    )
+    parser.add_argument(
+        "--host",
+        required=True,
+        help="Target host or URL (example: 192.168.0.31 or http://192.168.0.31)",
+    )
+    parser.add_argument(
+        "--phase-seconds",
+        type=float,
+        default=20.0,
+        help="Duration of each load phase in seconds (default: 20)",
+    )
+    parser.add_argument(
+        "--http-workers",
+        type=int,
+        default=6,
+        help="Concurrent HTTP clients for the HTTP load phase (default: 6)",
+    )
+    parser.add_argument(
+        "--ota-file",
+        help="Optional firmware .bin streamed to the staging slot (never applied)",
+    )
+    parser.add_argument(
+        "--chunk-size",
+        type=int,
+        default=768,
+        help="Raw OTA chunk size in bytes before base64 (default: 768)",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=5.0,
+        help="HTTP timeout in seconds (default: 5)",
+    )
+    parser.add_argument(
+        "--json",
+        action="store_true",
+        help="Print results as JSON instead of a table",
+    )
+    return parser.parse_args()
+
+
+def normalize_base_url(host: str) -> str:
+    value = host.strip()
+    if value.startswith("http://") or value.startswith("https://"):
+        return value.rstrip("/")
+    return f"http://{value.rstrip('/')}"
+
+
+def get_json(base_url: str, path: str, timeout: float) -> dict:
+    with urllib.request.urlopen(f"{base_url}{path}", timeout=timeout) as response:
+        return json.loads(response.read().decode("utf-8", errors="replace"))
+
+
+def post_json(base_url: str, path: str, payload: dict, timeout: float) -> None:
+    request = urllib.request.Request(
+        f"{base_url}{path}",
+        data=json.dumps(payload, separators=(",", ":")).encode("utf-8"),
+        method="POST",
+        headers={"Content-Type": "application/json"},
+    )
+    with urllib.request.urlopen(request, timeout=timeout) as response:
+        response.read()
+
+
+def histogram_percentile(histogram: dict, fraction: float) -> int | None:
+    """Upper bound of the log2 bin holding the given fraction of samples."""
+    count = histogram["count"]
+    if count <= 0:
+        return None
+    target = fraction * count
+    seen = 0
+    for index, bin_count in enumerate(histogram["bins"]):
+        seen += bin_count
+        if seen >= target:
+            if index == len(histogram["bins"]) - 1:
+                return histogram["max"]
+            return min((1 << index) * histogram["bin_unit"], histogram["max"])
+    return histogram["max"]
+
+
+def trace_summary(trace: dict) -> dict:
+    edge = trace["edge_latency_us"]
+    isr = trace["zero_cross_isr_cycles"]
+    fire = trace["fire_error_us"]
+    return {
+        "edge_latency_p99_us": histogram_percentile(edge, 0.99),
+        "edge_latency_max_us": edge["max"],
+        "zc_isr_max_cycles": isr["max"],
+        "fire_error_p99_us": histogram_percentile(fire, 0.99),
+        "fire_error_max_us": fire["max"],
+        "late_pulses": trace["late_pulses"],
+        "missed_pulses": trace["missed_pulses"],
+    }
+
+
+def http_load_worker(base_url: str, timeout: float, stop: threading.Event,
+                     counters: dict) -> None:
+    index = 0
+    while not stop.is_set():
+        path = HTTP_LOAD_PATHS[index % len(HTTP_LOAD_PATHS)]
+        index += 1
+        try:
+            with urllib.request.urlopen(f"{base_url}{path}", timeout=timeout) as response:
+                response.read()
+            counters["ok"] += 1
+        except (urllib.error.URLError, OSError):
+            counters["failed"] += 1
+
+
+def ota_load_worker(base_url: str, firmware: bytes, chunk_size: int, timeout: float,
+                    stop: threading.Event, counters: dict) -> None:
+    crc32 = zlib.crc32(firmware) & 0xFFFFFFFF
+    while not stop.is_set():
+        try:
+            post_json(
+                base_url,
+                "/api/ota/begin",
+                {"size": len(firmware), "crc32": crc32, "version": "jitter-bench"},
+                timeout,
+            )
+            offset = 0
+            while offset < len(firmware) and not stop.is_set():
+                chunk = firmware[offset : offset + chunk_size]
+                post_json(
+                    base_url,
+                    "/api/ota/chunk",
+                    {"offset": offset, "data": base64.b64encode(chunk).decode("ascii")},
+                    timeout,
+                )
+                offset += len(chunk)
+                counters["ok"] += len(chunk)
+        except (urllib.error.URLError, OSError):
+            counters["failed"] += 1
+            time.sleep(0.5)
+
+
+def diag_delta(before: dict, after: dict, seconds: float) -> dict:
+    pulses = after["gate_pulse_count"] - before["gate_pulse_count"]
+    latency_total_before = before["fire_latency_avg_us"] * before["gate_pulse_count"]
+    latency_total_after = after["fire_latency_avg_us"] * after["gate_pulse_count"]
+    return {
+        "seconds": round(seconds, 1),
+        "zero_crossings": after["zero_cross_count"] - before["zero_cross_count"],
+        "gate_pulses": pulses,
+        "missed_alarms": after["missed_alarm_count"] - before["missed_alarm_count"],
+        "avg_fire_latency_us": (
+            round((latency_total_after - latency_total_before) / pulses, 2)
+            if pulses > 0
+            else None
+        ),
+        # The firmware only keeps a since-boot maximum.
+        "max_fire_latency_us_since_boot": after["fire_latency_max_us"],
+        "pll_locked": after["pll_locked"],
+        "phase_error_us": after["phase_error_us"],
+    }
+
+
+def run_phase(base_url: str, name: str, args: argparse.Namespace,
+              firmware: bytes | None) -> dict:
+    stop = threading.Event()
+    counters = {"ok": 0, "failed": 0}
+    workers: list[threading.Thread] = []
+
+    if name == "http":
+        for _ in range(max(1, args.http_workers)):
+            workers.append(
+                threading.Thread(
+                    target=http_load_worker,
+                    args=(base_url, args.timeout, stop, counters),
+                    daemon=True,
+                )
+            )
+    elif name == "ota" and firmware is not None:
+        workers.append(
+            threading.Thread(
+                target=ota_load_worker,
+                args=(base_url, firmware, args.chunk_size, args.timeout, stop, counters),
+                daemon=True,
+            )
+        )
+
+    post_json(base_url, TRACE_RESET_PATH, {}, args.timeout)
+    before = get_json(base_url, DIAG_PATH, args.timeout)
+    started = time.monotonic()
+    for worker in workers:
+        worker.start()
+    time.sleep(args.phase_seconds)
+    stop.set()
+    for worker in workers:
+        worker.join(timeout=args.timeout + 1.0)
+    elapsed = time.monotonic() - started
+    after = get_json(base_url, DIAG_PATH, args.timeout)
+    trace = get_json(base_url, TRACE_PATH, args.timeout)
+
+    result = diag_delta(before, after, elapsed)
+    result.update(trace_summary(trace))
+    result["phase"] = name
+    result["timing_core"] = after.get("timing_core", "unknown")
+    result["load_ok"] = counters["ok"]
+    result["load_failed"] = counters["failed"]
+    return result
+
+
+def format_optional(value: int | None) -> str:
+    return "-" if value is None else str(value)
+
+
+def print_table(results: list[dict]) -> None:
+    header = (
+        f"{'phase':<6} {'core':<6} {'pulses':>7} {'missed':>7} "
+        f"{'avg_us':>8} {'max_us*':>8} {'locked':>7} {'phase_err':>10} "
+        f"{'zc_p99':>7} {'zc_max':>7} {'fire_p99':>9} {'fire_max':>9} {'late':>5}"
+    )
+    print(header)
+    print("-" * len(header))
+    for row in results:
+        avg = "-" if row["avg_fire_latency_us"] is None else f"{row['avg_fire_latency_us']:.2f}"
+        print(
+            f"{row['phase']:<6} {row['timing_core']:<6} {row['gate_pulses']:>7} "
+            f"{row['missed_alarms']:>7} {avg:>8} "
+            f"{row['max_fire_latency_us_since_boot']:>8} "
+            f"{str(row['pll_locked']):>7} {row['phase_error_us']:>10.1f} "
+            f"{format_optional(row['edge_latency_p99_us']):>7} "
+            f"{row['edge_latency_max_us']:>7} "
+            f"{format_optional(row['fire_error_p99_us']):>9} "
+            f"{row['fire_error_max_us']:>9} {row['late_pulses']:>5}"
+        )
+    print("* max latency is tracked since boot by the firmware")
+    print("zc/fire columns come from the per-phase trace histograms (us, p99 = log2 bin bound)")
+
+
+def main() -> int:
+    args = parse_args()
+    base_url = normalize_base_url(args.host)
+    firmware = None
+
+    if args.ota_file:
+        firmware_path = pathlib.Path(args.ota_file).expanduser().resolve()
+        if not firmware_path.is_file():
+            print(f"Error: firmware file not found: {firmware_path}", file=sys.stderr)
+            return 1
+        firmware = firmware_path.read_bytes()
+
+    try:
+        get_json(base_url, DIAG_PATH, args.timeout)
+    except (urllib.error.URLError, OSError, json.JSONDecodeError) as exc:
+        print(f"Error: cannot read {DIAG_PATH} from {base_url}: {exc}", file=sys.stderr)
+        return 1
+
+    phases = ["idle", "http"] + (["ota"] if firmware is not None else [])
+    results = []
+    for phase in phases:
+        if not args.json:
+            print(f"Running {phase} phase for {args.phase_seconds:.0f} s...")
+        results.append(run_phase(base_url, phase, args, firmware))
+
+    if args.json:
+        print(json.dumps(results, indent=2))
+    else:
+        print_table(results)
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+
+from __future__ import annotations
+
+import argparse
+import pathlib
+import shutil
+import subprocess
+import sys
+import tempfile
+
+REPO_ROOT = pathlib.Path(__file__).resolve().parent.parent
+JOURNAL_SOURCE = REPO_ROOT / "src" / "services" / "flash_journal.c"
+SECTOR_COUNT = 8
+MAX_RECORDS = 64
+
+# Stand-ins for the Pico SDK headers flash_journal.c includes; flash is a RAM
+# image that behaves like NOR (erase sets bits, programming only clears them).
+STUB_HEADERS = {
+    "hardware/i2c.h": "",
+    "hardware/flash.h": "#define FLASH_SECTOR_SIZE 4096u\n#define FLASH_PAGE_SIZE 256u\n",
+    "hardware/regs/addressmap.h": (
+        "#include <stdint.h>\n"
+        "extern uint8_t g_flash_image[];\n"
+        "#define XIP_BASE ((uintptr_t)g_flash_image)\n"
+    ),
+}
+
+# Runs the scenarios against flash_journal.c and prints "FAIL ..." lines.
+DRIVER_SOURCE = r"""
+#include "services/flash_journal.h"
+#include "services/flash_writer.h"
+
+#include "hardware/flash.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CONFIG_TYPE 1u
+#define REPORT_TYPE 2u
+#define REPORT_BYTES 900u
+
+uint8_t g_flash_image[PICO_FLASH_SIZE_BYTES];
+static bool g_refuse_erase;
+static uint32_t g_erases;
+static int g_failures;
+
+bool flash_writer_erase_sector(uint32_t flash_offset) {
+  if (g_refuse_erase) {
+    return false;
+  }
+  memset(g_flash_image + flash_offset, 0xff, FLASH_SECTOR_SIZE);
+  g_erases += 1u;
+  return true;
+}
+
+bool flash_writer_program_page(uint32_t flash_offset, const uint8_t *page_data) {
+  uint32_t index = 0u;
+
+  for (index = 0u; index < FLASH_PAGE_SIZE; ++index) {
+    g_flash_image[flash_offset + index] &= page_data[index];
+  }
+  return true;
+}
+
+static void check(bool condition, const char *what, uint32_t value) {
+  if (!condition) {
+    printf("FAIL %s (%u)\n", what, (unsigned)value);
+    g_failures += 1;
+  }
+}
+
+static void fill_report(uint8_t *report, uint32_t key, uint32_t version) {
+  uint32_t index = 0u;
+
+  for (index = 0u; index < REPORT_BYTES; ++index) {
+    report[index] = (uint8_t)(key * 31u + version * 7u + index);
+  }
+}
+
+static bool report_matches(uint32_t key, uint32_t version) {
+  uint8_t expected[REPORT_BYTES];
+  flash_journal_entry_t entry;
+
+  fill_report(expected, key, version);
+  return flash_journal_find(REPORT_TYPE, key, &entry) && entry.length == REPORT_BYTES &&
+         memcmp(flash_journal_payload(&entry), expected, REPORT_BYTES) == 0;
+}
+
+static bool config_matches(uint32_t version) {
+  flash_journal_entry_t entry;
+  uint32_t stored = 0u;
+
+  return flash_journal_find(CONFIG_TYPE, 0u, &entry) &&
+         flash_journal_read(&entry, 0u, &stored, sizeof(stored)) && stored == version;
+}
+
+static void format(void) {
+  memset(g_flash_image, 0xff, sizeof(g_flash_image));
+  check(flash_journal_mount(1u), "mount blank", 0u);
+}
+
+// Reports written once, then a draft rewritten many times: compaction must
+// move the old reports along, never evict them, however often it wraps.
+static void rewrite_keeps_live_reports(void) {
+  uint8_t report[REPORT_BYTES];
+  flash_journal_stats_t stats;
+  uint32_t round = 0u;
+  uint32_t key = 0u;
+
+  format();
+  check(flash_journal_append(CONFIG_TYPE, 0u, false, &round, sizeof(round)),
+        "append config", 0u);
+  for (key = 1u; key <= 8u; ++key) {
+    fill_report(report, key, 0u);
+    check(flash_journal_append(REPORT_TYPE, key, true, report, sizeof(report)),
+          "append report", key);
+  }
+  for (round = 0u; round < 200u; ++round) {
+    fill_report(report, 100u, round);
+    check(flash_journal_append(REPORT_TYPE, 100u, true, report, sizeof(report)),
+          "rewrite append", round);
+  }
+
+  flash_journal_get_stats(&stats);
+  check(stats.compactions > 0u, "rewrite compacted", stats.compactions);
+  check(stats.evicted_records == 0u, "rewrite evicted nothing", stats.evicted_records);
+  check(config_matches(0u), "rewrite config kept", 0u);
+  check(report_matches(100u, 199u), "rewritten report kept", 100u);
+  for (key = 1u; key <= 8u; ++key) {
+    check(report_matches(key, 0u), "rewrite report kept", key);
+  }
+
+  check(flash_journal_mount(1u), "rewrite remount", 0u);
+  check(config_matches(0u), "rewrite config after remount", 0u);
+  check(report_matches(100u, 199u), "rewritten report after remount", 100u);
+  for (key = 1u; key <= 8u; ++key) {
+    check(report_matches(key, 0u), "rewrite report after remount", key);
+  }
+}
+
+// New reports until the journal is full several times over: the oldest
+// reports are evicted, the newest and the config survive intact.
+static void fill_evicts_oldest_reports(void) {
+  uint8_t report[REPORT_BYTES];
+  flash_journal_stats_t stats;
+  uint32_t config = 7u;
+  uint32_t key = 0u;
+  uint32_t total = 0u;
+  uint32_t oldest = 0u;
+
+  format();
+  check(flash_journal_append(CONFIG_TYPE, 0u, false, &config, sizeof(config)),
+        "append config", 0u);
+  for (key = 1u; key <= 120u; ++key) {
+    fill_report(report, key, 0u);
+    check(flash_journal_append(REPORT_TYPE, key, true, report, sizeof(report)),
+          "fill append", key);
+  }
+
+  flash_journal_get_stats(&stats);
+  (void)flash_journal_list(REPORT_TYPE, 0u, NULL, 0u, &total);
+  check(stats.evicted_records > 0u, "fill evicted", stats.evicted_records);
+  check(stats.free_sectors >= 1u, "fill keeps the reserve", stats.free_sectors);
+  check(total + stats.evicted_records == 120u, "fill accounting", total);
+  // At least half the space past the reserve still holds reports.
+  check(total * (REPORT_BYTES + 16u) >= (SECTOR_COUNT - 2u) * FLASH_SECTOR_SIZE / 2u,
+        "fill keeps most reports", total);
+  check(config_matches(7u), "fill config kept", 0u);
+  oldest = 121u - total;
+  for (key = oldest; key <= 120u; ++key) {
+    check(report_matches(key, 0u), "fill newest report kept", key);
+  }
+
+  check(flash_journal_mount(1u), "fill remount", 0u);
+  check(config_matches(7u), "fill config after remount", 0u);
+  for (key = oldest; key <= 120u; ++key) {
+    check(report_matches(key, 0u), "fill report after remount", key);
+  }
+}
+
+// A refused erase fails the append without counting wear; the next append
+// after the dimmer stops succeeds.
+static void refused_erase_counts_no_wear(void) {
+  uint8_t report[REPORT_BYTES];
+  flash_journal_stats_t before;
+  flash_journal_stats_t after;
+  uint32_t key = 0u;
+  bool refused = false;
+
+  format();
+  for (key = 1u; key <= 120u && !refused; ++key) {
+    fill_report(report, key, 0u);
+    g_refuse_erase = true;
+    flash_journal_get_stats(&before);
+    if (!flash_journal_append(REPORT_TYPE, key, true, report, sizeof(report))) {
+      refused = true;
+      flash_journal_get_stats(&after);
+      check(after.max_erase_count == before.max_erase_count, "refused erase no wear",
+            after.max_erase_count);
+      g_refuse_erase = false;
+      check(flash_journal_append(REPORT_TYPE, key, true, report, sizeof(report)),
+            "append after refusal", key);
+      check(report_matches(key, 0u), "report after refusal", key);
+    }
+  }
+  g_refuse_erase = false;
+  check(refused, "an erase was needed", key);
+}
+
+int main(void) {
+  rewrite_keeps_live_reports();
+  fill_evicts_oldest_reports();
+  refused_erase_counts_no_wear();
+  printf("erases %u\n", (unsigned)g_erases);
+  return g_failures == 0 ? 0 : 1;
+}
+"""
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Build src/services/flash_journal.c for the host over a RAM flash "
+            "image and check that compaction keeps live records"
+        )
+    )
+    parser.add_argument("--cc", default="cc", help="Host C compiler (default: cc)")
+    return parser.parse_args()
+
+
+def build_driver(compiler: str, work_dir: pathlib.Path) -> pathlib.Path:
+    driver_path = work_dir / "flash_journal_driver.c"
+    binary_path = work_dir / "flash_journal_driver"
+    for name, text in STUB_HEADERS.items():
+        header_path = work_dir / "stubs" / name
+        header_path.parent.mkdir(parents=True, exist_ok=True)
+        header_path.write_text(text, encoding="utf-8")
+    driver_path.write_text(DRIVER_SOURCE, encoding="utf-8")
+    subprocess.run(
+        [
+            compiler,
+            "-std=c11",
+            "-O2",
+            "-Wall",
+            "-Wextra",
+            f"-DPICO_FLASH_SIZE_BYTES={SECTOR_COUNT * 4096}u",
+            "-DAPP_PERSISTENT_STORAGE_OFFSET_BYTES=0u",
+            f"-DAPP_PERSISTENT_STORAGE_SIZE_BYTES={SECTOR_COUNT * 4096}u",
+            f"-DAPP_JOURNAL_MAX_RECORDS={MAX_RECORDS}u",
+            f"-DSECTOR_COUNT={SECTOR_COUNT}u",
+            "-I",
+            str(work_dir / "stubs"),
+            "-I",
+            str(REPO_ROOT / "include"),
+            str(driver_path),
+            str(JOURNAL_SOURCE),
+            "-o",
+            str(binary_path),
+        ],
+        check=True,
+    )
+    return binary_path
+
+
+def main() -> int:
+    args = parse_args()
+    if shutil.which(args.cc) is None:
+        print(f"Compiler not found: {args.cc}", file=sys.stderr)
+        return 1
+
+    with tempfile.TemporaryDirectory() as work_dir:
+        binary = build_driver(args.cc, pathlib.Path(work_dir))
+        result = subprocess.run([str(binary)], capture_output=True, text=True)
+
+    print(result.stdout, end="")
+    print("flash journal: " + ("ok" if result.returncode == 0 else "FAILED"))
+    return result.returncode
+
+
+if __name__ == "__main__":
+    sys.exit(main())
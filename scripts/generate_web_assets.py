@@ -1,10 +1,22 @@
 #!/usr/bin/env python3
 
-"""Generate C web assets for firmware embedding."""
+"""Generate C web assets for firmware embedding.
+
+Each asset is minified, optionally inlined into index.html and pre-gzipped.
+The generated table carries a strong ETag (content hash) and a Cache-Control
+policy per asset: index.html is revalidated on every load, while the files it
+references are requested with a ?v=<hash> suffix and cached as immutable.
+
+With --routes, the HTTP routes of a manifest are merged with the assets into
+one path table indexed by a perfect hash, so web_routes_find() costs one hash
+and one string compare, and the route ids are written to --output-h.
+"""
 
 from __future__ import annotations
 
 import argparse
+import gzip
+import hashlib
 from pathlib import Path
 import re
 import sys
@@ -24,11 +36,47 @@ CONTENT_TYPES = {
     ".txt": "text/plain; charset=utf-8",
 }
 
+# Already compressed formats are not gzipped again.
+COMPRESSIBLE_SUFFIXES = {".html", ".css", ".js", ".json", ".svg", ".txt", ".ico"}
+
+CACHE_REVALIDATE = "no-cache"
+CACHE_IMMUTABLE = "public, max-age=31536000, immutable"
+
+# Route manifest method names and the WEB_ROUTE_METHOD_* bits they set.
+ROUTE_METHODS = {"GET": 0x01, "HEAD": 0x02, "POST": 0x04, "ANY": 0x0F}
+ROUTE_ID = re.compile(r"[A-Z][A-Z0-9_]*")
+# Seeds tried per table size before the table is doubled.
+ROUTE_HASH_SEED_ATTEMPTS = 4096
+
+JS_WORD = re.compile(r"[0-9A-Za-z_$]")
+# A '/' after one of these starts a regular expression, not a division.
+JS_REGEX_PRECEDERS = set("(,=:[!&|?{};+-*%<>~^")
+JS_REGEX_KEYWORDS = {"return", "typeof", "case", "do", "else", "in", "of", "void", "yield"}
+# Whitespace next to these characters never separates two tokens.
+JS_TIGHT = set("{}()[];,:=<>!&|?~^%")
+
 
 def parse_args() -> argparse.Namespace:
     parser = argparse.ArgumentParser(description="Generate embedded web assets C source.")
     parser.add_argument("--input-dir", required=True, help="Source directory with web files.")
     parser.add_argument("--output-c", required=True, help="Output .c file path.")
+    parser.add_argument(
+        "--no-minify", action="store_true", help="Embed HTML, CSS and JS unchanged."
+    )
+    parser.add_argument(
+        "--no-gzip", action="store_true", help="Do not embed gzip-encoded copies."
+    )
+    parser.add_argument(
+        "--inline",
+        action="store_true",
+        help="Inline the stylesheets and scripts index.html references into it.",
+    )
+    parser.add_argument(
+        "--routes", help="Route manifest to merge into the path table."
+    )
+    parser.add_argument(
+        "--output-h", help="Output header for the route ids (required with --routes)."
+    )
     return parser.parse_args()
 
 
@@ -55,10 +103,332 @@ def content_type_for_path(path: Path) -> str:
     return CONTENT_TYPES.get(path.suffix.lower(), "application/octet-stream")
 
 
+def minify_js(source: str) -> str:
+    """Drops comments and collapses whitespace outside strings, templates and
+    regular expressions. A line break is kept unless a neighbour rules out
+    automatic semicolon insertion, so statement boundaries are unchanged."""
+    out: list[str] = []
+    length = len(source)
+    index = 0
+    # Brace depth at which each open template literal's ${ started.
+    template_stack: list[int] = []
+    depth = 0
+
+    def last_char() -> str:
+        return out[-1][-1] if out and out[-1] else ""
+
+    def regex_allowed() -> bool:
+        previous = "".join(out[-8:]).rstrip()
+        if not previous or previous[-1] in JS_REGEX_PRECEDERS:
+            return True
+        word = re.search(r"[0-9A-Za-z_$]+$", previous)
+        return word is not None and word.group(0) in JS_REGEX_KEYWORDS
+
+    def copy_quoted(start: int, quote: str) -> int:
+        position = start + 1
+        while position < length:
+            char = source[position]
+            if char == "\\":
+                position += 2
+                continue
+            position += 1
+            if char == quote:
+                break
+        out.append(source[start:position])
+        return position
+
+    def copy_template(start: int) -> int:
+        # Copies template text from start up to the closing backtick or the
+        # next ${, whichever comes first.
+        position = start
+        while position < length:
+            char = source[position]
+            if char == "\\":
+                position += 2
+                continue
+            if char == "`":
+                out.append(source[start : position + 1])
+                return position + 1
+            if char == "$" and position + 1 < length and source[position + 1] == "{":
+                out.append(source[start : position + 2])
+                template_stack.append(depth)
+                return position + 2
+            position += 1
+        out.append(source[start:])
+        return length
+
+    def copy_regex(start: int) -> int:
+        position = start + 1
+        in_class = False
+        while position < length:
+            char = source[position]
+            if char == "\\":
+                position += 2
+                continue
+            position += 1
+            if char == "[":
+                in_class = True
+            elif char == "]":
+                in_class = False
+            elif char == "/" and not in_class:
+                break
+        while position < length and JS_WORD.match(source[position]):
+            position += 1
+        out.append(source[start:position])
+        return position
+
+    def skip_gap(start: int) -> tuple[int, bool]:
+        # Whitespace and comments; reports whether a line break was crossed.
+        position = start
+        newline = False
+        while position < length:
+            if source[position].isspace():
+                newline = newline or source[position] == "\n"
+                position += 1
+            elif source.startswith("//", position):
+                end = source.find("\n", position)
+                position = length if end < 0 else end
+            elif source.startswith("/*", position):
+                end = source.find("*/", position + 2)
+                end = length if end < 0 else end + 2
+                newline = newline or "\n" in source[position:end]
+                position = end
+            else:
+                break
+        return position, newline
+
+    while index < length:
+        char = source[index]
+
+        if char.isspace() or source.startswith("//", index) or source.startswith("/*", index):
+            index, newline = skip_gap(index)
+            previous = last_char()
+            following = source[index] if index < length else ""
+            if not previous or not following:
+                continue
+            if newline and previous not in "{;,([" and following not in ")]},;":
+                out.append("\n")
+            elif previous not in JS_TIGHT and following not in JS_TIGHT:
+                out.append(" ")
+        elif char in "\"'":
+            index = copy_quoted(index, char)
+        elif char == "`":
+            out.append("`")
+            index = copy_template(index + 1)
+        elif char == "/" and regex_allowed():
+            index = copy_regex(index)
+        elif char == "}" and template_stack and template_stack[-1] == depth:
+            template_stack.pop()
+            out.append("}")
+            index = copy_template(index + 1)
+        else:
+            if char == "{":
+                depth += 1
+            elif char == "}":
+                depth -= 1
+            out.append(char)
+            index += 1
+
+    return "".join(out) + "\n"
+
+
+def minify_css(source: str) -> str:
+    """Drops comments and whitespace that separates nothing. Spaces before ':'
+    and after ')' are kept: "a :hover" and ":not(.x) .y" are selectors."""
+    out: list[str] = []
+    length = len(source)
+    index = 0
+
+    while index < length:
+        char = source[index]
+        if char in "\"'":
+            end = index + 1
+            while end < length and source[end] != char:
+                end += 2 if source[end] == "\\" else 1
+            out.append(source[index : end + 1])
+            index = end + 1
+        elif char.isspace() or source.startswith("/*", index):
+            while index < length:
+                if source[index].isspace():
+                    index += 1
+                elif source.startswith("/*", index):
+                    end = source.find("*/", index + 2)
+                    index = length if end < 0 else end + 2
+                else:
+                    break
+            previous = out[-1][-1] if out else ""
+            following = source[index] if index < length else ""
+            if previous and following and previous not in "{};,>(:" and \
+                    following not in "{};,>)":
+                out.append(" ")
+        else:
+            if char == "}" and out and out[-1] == ";":
+                out.pop()
+            out.append(char)
+            index += 1
+
+    return "".join(out) + "\n"
+
+
+def minify_html(source: str) -> str:
+    """Drops comments and collapses whitespace runs outside pre, textarea,
+    script and style; inline scripts and styles are minified as such."""
+    parts = re.split(r"(<(pre|textarea|script|style)\b[^>]*>.*?</\2\s*>)", source,
+                     flags=re.IGNORECASE | re.DOTALL)
+    out: list[str] = []
+    index = 0
+    while index < len(parts):
+        text = parts[index]
+        if index % 3 == 0:
+            text = re.sub(r"<!--(?!\[if).*?-->", "", text, flags=re.DOTALL)
+            text = re.sub(r"\s*\n\s*", "\n", text)
+            text = re.sub(r"[ \t]+", " ", text)
+            out.append(text)
+            index += 1
+            continue
+
+        tag = parts[index + 1].lower()
+        match = re.match(r"(<[^>]*>)(.*)(</[^>]*>)$", text, flags=re.DOTALL)
+        if match and tag == "script" and "src=" not in match.group(1).lower():
+            text = match.group(1) + minify_js(match.group(2)) + match.group(3)
+        elif match and tag == "style":
+            text = match.group(1) + minify_css(match.group(2)) + match.group(3)
+        out.append(text)
+        index += 2
+    return "".join(out).strip() + "\n"
+
+
+def minify(path: Path, data: bytes) -> bytes:
+    suffix = path.suffix.lower()
+    if suffix not in (".html", ".css", ".js"):
+        return data
+    text = data.decode("utf-8")
+    if suffix == ".html":
+        return minify_html(text).encode("utf-8")
+    if suffix == ".css":
+        return minify_css(text).encode("utf-8")
+    return minify_js(text).encode("utf-8")
+
+
+def referenced_assets(index_html: str) -> list[str]:
+    return re.findall(r'(?:href|src)="([^"/:?#][^":?#]*\.(?:css|js))"', index_html)
+
+
+def inline_references(index_html: str, bodies: dict[str, bytes]) -> tuple[str, set[str]]:
+    inlined: set[str] = set()
+
+    def replace_stylesheet(match: re.Match[str]) -> str:
+        name = match.group(1)
+        if name not in bodies:
+            return match.group(0)
+        inlined.add(name)
+        return "<style>" + bodies[name].decode("utf-8") + "</style>"
+
+    def replace_script(match: re.Match[str]) -> str:
+        name = match.group(1)
+        if name not in bodies:
+            return match.group(0)
+        inlined.add(name)
+        script = bodies[name].decode("utf-8").replace("</script", "<\\/script")
+        return "<script>" + script + "</script>"
+
+    index_html = re.sub(r'<link\s+rel="stylesheet"\s+href="([^"]+)"\s*/?>',
+                        replace_stylesheet, index_html)
+    index_html = re.sub(r'<script\s+src="([^"]+)"\s*>\s*</script>', replace_script,
+                        index_html)
+    return index_html, inlined
+
+
+def version_references(index_html: str, hashes: dict[str, str]) -> tuple[str, set[str]]:
+    versioned: set[str] = set()
+
+    def replace(match: re.Match[str]) -> str:
+        name = match.group(2)
+        if name not in hashes:
+            return match.group(0)
+        versioned.add(name)
+        return f'{match.group(1)}="{name}?v={hashes[name][:8]}"'
+
+    index_html = re.sub(r'(href|src)="([^"/:?#][^":?#]*\.(?:css|js))"', replace, index_html)
+    return index_html, versioned
+
+
+def content_hash(data: bytes) -> str:
+    return hashlib.sha256(data).hexdigest()[:16]
+
+
+def parse_routes(manifest: Path) -> list[tuple[int, str, str]]:
+    """Returns (method mask, path, id) per manifest line."""
+    routes: list[tuple[int, str, str]] = []
+    paths: set[str] = set()
+    ids: set[str] = set()
+    for number, line in enumerate(manifest.read_text(encoding="utf-8").splitlines(), 1):
+        fields = line.split("#", 1)[0].split()
+        if not fields:
+            continue
+        where = f"{manifest}:{number}"
+        if len(fields) != 3:
+            raise ValueError(f"{where}: expected 'methods path id'")
+        methods, path, route_id = fields
+        mask = 0
+        for method in methods.split(","):
+            if method not in ROUTE_METHODS:
+                raise ValueError(f"{where}: unknown method {method}")
+            mask |= ROUTE_METHODS[method]
+        if not path.startswith("/") or "?" in path:
+            raise ValueError(f"{where}: path must start with / and have no query")
+        if not ROUTE_ID.fullmatch(route_id) or route_id == "NONE":
+            raise ValueError(f"{where}: invalid route id {route_id}")
+        if path in paths or route_id in ids:
+            raise ValueError(f"{where}: duplicate path or route id")
+        paths.add(path)
+        ids.add(route_id)
+        routes.append((mask, path, route_id))
+    return routes
+
+
+def route_hash(seed: int, path: str) -> int:
+    # FNV-1a seeded through the offset basis; mirrored by web_routes_find().
+    value = seed ^ 0x811C9DC5
+    for byte in path.encode("utf-8"):
+        value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return value ^ (value >> 16)
+
+
+def perfect_hash(paths: list[str]) -> tuple[int, list[int]]:
+    """Finds a seed that sends every path to its own slot of a power-of-two
+    table. Returns the seed and the slots, each holding entry index + 1."""
+    size = 1
+    while size < len(paths):
+        size *= 2
+    while True:
+        for seed in range(ROUTE_HASH_SEED_ATTEMPTS):
+            slots = [0] * size
+            for index, path in enumerate(paths):
+                slot = route_hash(seed, path) & (size - 1)
+                if slots[slot]:
+                    break
+                slots[slot] = index + 1
+            else:
+                return seed, slots
+        size *= 2
+
+
 def main() -> int:
     args = parse_args()
     input_dir = Path(args.input_dir).resolve()
     output_c = Path(args.output_c).resolve()
+    routes: list[tuple[int, str, str]] = []
+
+    if args.routes:
+        if not args.output_h:
+            print("--output-h is required with --routes", file=sys.stderr)
+            return 1
+        try:
+            routes = parse_routes(Path(args.routes).resolve())
+        except (OSError, ValueError) as exc:
+            print(f"Invalid route manifest: {exc}", file=sys.stderr)
+            return 1
 
     if not input_dir.exists() or not input_dir.is_dir():
         print(f"Input directory not found: {input_dir}", file=sys.stderr)
@@ -77,74 +447,190 @@ def main() -> int:
         print(f"index.html is required in {input_dir}", file=sys.stderr)
         return 1
 
+    raw: dict[str, bytes] = {path.name: path.read_bytes() for path in files}
+    bodies: dict[str, bytes] = {
+        path.name: raw[path.name] if args.no_minify else minify(path, raw[path.name])
+        for path in files
+    }
+    hashes = {name: content_hash(body) for name, body in bodies.items()}
+    cache_control = {name: CACHE_REVALIDATE for name in bodies}
+
+    index_html = bodies["index.html"].decode("utf-8")
+    page_assets = [name for name in referenced_assets(index_html) if name in bodies]
+    page_raw = sum(len(raw[name]) for name in ["index.html", *page_assets])
+    if args.inline:
+        index_html, inlined = inline_references(index_html, bodies)
+        for name in inlined:
+            del bodies[name]
+        page_assets = [name for name in page_assets if name not in inlined]
+    index_html, versioned = version_references(index_html, hashes)
+    for name in versioned:
+        cache_control[name] = CACHE_IMMUTABLE
+    bodies["index.html"] = index_html.encode("utf-8")
+    hashes["index.html"] = content_hash(bodies["index.html"])
+
     output_c.parent.mkdir(parents=True, exist_ok=True)
 
     lines: list[str] = []
     lines.append('#include "web/web_assets.h"')
     lines.append("")
+    if routes:
+        lines.append('#include "web/http_routes.h"')
     lines.append("#include <stddef.h>")
     lines.append("#include <stdint.h>")
     lines.append("#include <string.h>")
     lines.append("")
-    lines.append("typedef struct {")
-    lines.append("  const char *path;")
-    lines.append("  const char *content_type;")
-    lines.append("  const uint8_t *body;")
-    lines.append("  size_t body_length;")
-    lines.append("} web_asset_t;")
-    lines.append("")
 
-    symbols: dict[Path, str] = {}
-    sizes: dict[Path, int] = {}
+    symbols: dict[str, str] = {}
+    gzipped: dict[str, bytes] = {}
     for path in files:
-        symbol = sanitize_identifier(path.name)
-        data = path.read_bytes()
-        symbols[path] = symbol
-        sizes[path] = len(data)
+        name = path.name
+        if name not in bodies:
+            continue
+        symbol = sanitize_identifier(name)
+        symbols[name] = symbol
         lines.append(f"static const uint8_t k_asset_{symbol}[] = {{")
-        lines.append(bytes_to_c_array(data))
+        lines.append(bytes_to_c_array(bodies[name]))
         lines.append("};")
         lines.append("")
 
-    lines.append("static const web_asset_t k_assets[] = {")
-    for path in files:
-        symbol = symbols[path]
-        content_type = content_type_for_path(path)
-        route = f"/{path.name}"
-        lines.append(
-            f'    {{.path = "{route}", .content_type = "{content_type}", '
-            f".body = k_asset_{symbol}, .body_length = {sizes[path]}u}},"
+        if not args.no_gzip and path.suffix.lower() in COMPRESSIBLE_SUFFIXES:
+            # mtime=0 keeps the output, and so the firmware image, reproducible.
+            compressed = gzip.compress(bodies[name], compresslevel=9, mtime=0)
+            if len(compressed) < len(bodies[name]):
+                gzipped[name] = compressed
+                lines.append(f"static const uint8_t k_asset_{symbol}_gz[] = {{")
+                lines.append(bytes_to_c_array(compressed))
+                lines.append("};")
+                lines.append("")
+
+    def table_entry(route: str, name: str) -> str:
+        symbol = symbols[name]
+        gzip_body = f"k_asset_{symbol}_gz" if name in gzipped else "NULL"
+        gzip_length = len(gzipped.get(name, b""))
+        return (
+            f'    {{.path = "{route}", .content_type = "{content_type_for_path(Path(name))}", '
+            f'.etag = "\\"{hashes[name]}\\"", .gzip_etag = "\\"{hashes[name]}-gz\\"", '
+            f'.cache_control = "{cache_control[name]}", '
+            f".body = k_asset_{symbol}, .body_length = {len(bodies[name])}u, "
+            f".gzip_body = {gzip_body}, .gzip_length = {gzip_length}u}},"
         )
+
+    asset_paths: list[tuple[str, str]] = []
+    for path in files:
+        if path.name not in bodies:
+            continue
+        asset_paths.append((f"/{path.name}", path.name))
         if path.name == "index.html":
-            lines.append(
-                f'    {{.path = "/", .content_type = "{content_type}", '
-                f".body = k_asset_{symbol}, .body_length = {sizes[path]}u}},"
-            )
+            asset_paths.append(("/", path.name))
+
+    lines.append("static const web_asset_t k_assets[] = {")
+    for route, name in asset_paths:
+        lines.append(table_entry(route, name))
+    lines.append("};")
+    lines.append("")
+
+    # Path table: the manifest routes, then one GET/HEAD entry per asset.
+    entries: list[str] = []
+    table_paths: list[str] = []
+    for mask, path, route_id in routes:
+        if any(path == asset_path for asset_path, _ in asset_paths):
+            print(f"Route {path} collides with an embedded asset", file=sys.stderr)
+            return 1
+        table_paths.append(path)
+        entries.append(
+            f'    {{.path = "{path}", .route = HTTP_ROUTE_{route_id}, '
+            f".methods = 0x{mask:02x}u, .asset = NULL}},"
+        )
+    for index, (path, _) in enumerate(asset_paths):
+        table_paths.append(path)
+        route_none = "HTTP_ROUTE_NONE" if routes else "0u"
+        entries.append(
+            f'    {{.path = "{path}", .route = {route_none}, '
+            f".methods = 0x{ROUTE_METHODS['GET'] | ROUTE_METHODS['HEAD']:02x}u, "
+            f".asset = &k_assets[{index}]}},"
+        )
+    if len(table_paths) > 255:
+        print("Too many routes and assets for the 8-bit path table", file=sys.stderr)
+        return 1
+    seed, slots = perfect_hash(table_paths)
+
+    lines.append("static const web_route_t k_routes[] = {")
+    lines.extend(entries)
+    lines.append("};")
+    lines.append("")
+    lines.append("// Perfect hash of the request path: entry index + 1, 0 for an unused slot.")
+    lines.append(f"#define WEB_ROUTE_HASH_SEED 0x{seed ^ 0x811C9DC5:08x}u")
+    lines.append(f"#define WEB_ROUTE_SLOT_MASK {len(slots) - 1}u")
+    lines.append("static const uint8_t k_route_slots[] = {")
+    lines.append(bytes_to_c_array(bytes(slots)))
     lines.append("};")
     lines.append("")
-    lines.append("bool web_assets_get(const char *request_path, const char **content_type,")
-    lines.append("                    const uint8_t **body, size_t *body_length) {")
-    lines.append("  size_t index = 0u;")
+    lines.append("const web_route_t *web_routes_find(const char *request_path) {")
+    lines.append("  const unsigned char *cursor = (const unsigned char *)request_path;")
+    lines.append("  uint32_t hash = WEB_ROUTE_HASH_SEED;")
+    lines.append("  uint8_t slot = 0u;")
     lines.append("")
-    lines.append("  if (request_path == NULL || content_type == NULL || body == NULL ||")
-    lines.append("      body_length == NULL) {")
-    lines.append("    return false;")
+    lines.append("  if (request_path == NULL) {")
+    lines.append("    return NULL;")
     lines.append("  }")
     lines.append("")
-    lines.append("  for (index = 0u; index < sizeof(k_assets) / sizeof(k_assets[0]); ++index) {")
-    lines.append("    if (strcmp(request_path, k_assets[index].path) == 0) {")
-    lines.append("      *content_type = k_assets[index].content_type;")
-    lines.append("      *body = k_assets[index].body;")
-    lines.append("      *body_length = k_assets[index].body_length;")
-    lines.append("      return true;")
-    lines.append("    }")
+    lines.append("  for (; *cursor != '\\0'; ++cursor) {")
+    lines.append("    hash = (hash ^ *cursor) * 0x01000193u;")
     lines.append("  }")
+    lines.append("  slot = k_route_slots[(hash ^ (hash >> 16)) & WEB_ROUTE_SLOT_MASK];")
+    lines.append("  if (slot == 0u || strcmp(request_path, k_routes[slot - 1u].path) != 0) {")
+    lines.append("    return NULL;")
+    lines.append("  }")
+    lines.append("  return &k_routes[slot - 1u];")
+    lines.append("}")
+    lines.append("")
+    lines.append("const web_asset_t *web_assets_find(const char *request_path) {")
+    lines.append("  const web_route_t *route = web_routes_find(request_path);")
     lines.append("")
-    lines.append("  return false;")
+    lines.append("  return route != NULL ? route->asset : NULL;")
     lines.append("}")
     lines.append("")
 
+    if routes:
+        output_h = Path(args.output_h).resolve()
+        header = [
+            "#ifndef WEB_HTTP_ROUTES_H",
+            "#define WEB_HTTP_ROUTES_H",
+            "",
+            f"// Generated from {Path(args.routes).name} by scripts/generate_web_assets.py.",
+            "typedef enum {",
+            "  HTTP_ROUTE_NONE = 0,",
+            *[f"  HTTP_ROUTE_{route_id}," for _, _, route_id in routes],
+            "} http_route_t;",
+            "",
+            "#endif",
+            "",
+        ]
+        output_h.parent.mkdir(parents=True, exist_ok=True)
+        output_h.write_text("\n".join(header), encoding="utf-8")
+
     output_c.write_text("\n".join(lines), encoding="utf-8")
+
+    flash_bytes = 0
+    for name in bodies:
+        sent = len(gzipped.get(name, bodies[name]))
+        flash_bytes += len(bodies[name]) + len(gzipped.get(name, b""))
+        print(
+            f"web asset {name}: raw {len(raw[name])} B, embedded {len(bodies[name])} B, "
+            f"sent {sent} B{' (gzip)' if name in gzipped else ''}"
+        )
+    page_transfer = sum(
+        len(gzipped.get(name, bodies[name])) for name in ["index.html", *page_assets]
+    )
+    print(
+        f"web assets: {flash_bytes} B of flash; a first page load transfers "
+        f"{page_transfer} B (was {page_raw} B), repeat loads only revalidate index.html"
+    )
+    print(
+        f"web routes: {len(routes)} routes and {len(asset_paths)} asset paths in "
+        f"{len(slots)} hash slots"
+    )
     return 0
 
 
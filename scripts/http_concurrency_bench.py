@@ -0,0 +1,268 @@
+#!/usr/bin/env python3
+
+from __future__ import annotations
+
+import argparse
+import http.client
+import json
+import socket
+import sys
+import threading
+import time
+import urllib.parse
+
+STATUS_PATH = "/api/status"
+CONTROL_PATH = "/api/led"
+SLOW_PATH = "/api/ota/chunk"
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Measure HTTP throughput and tail latency on Blower Pico with several "
+            "concurrent clients, optionally next to a client that trickles a slow "
+            "request"
+        )
+    )
+    parser.add_argument(
+        "--host",
+        required=True,
+        help="Target host or URL (example: 192.168.0.31 or http://192.168.0.31)",
+    )
+    parser.add_argument(
+        "--clients",
+        default="1,2,4,8",
+        help="Comma-separated client counts to run (default: 1,2,4,8)",
+    )
+    parser.add_argument(
+        "--requests",
+        type=int,
+        default=50,
+        help="Requests per client and run (default: 50)",
+    )
+    parser.add_argument(
+        "--slow-client",
+        action="store_true",
+        help="Keep one extra client sending a request body a few bytes per second",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=10.0,
+        help="HTTP timeout in seconds (default: 10)",
+    )
+    parser.add_argument(
+        "--json",
+        action="store_true",
+        help="Print results as JSON instead of a table",
+    )
+    return parser.parse_args()
+
+
+def parse_target(host: str) -> tuple[str, int]:
+    value = host.strip()
+    if not value.startswith("http://"):
+        value = f"http://{value}"
+    parsed = urllib.parse.urlsplit(value)
+    return parsed.hostname or "", parsed.port or 80
+
+
+def percentile(values: list[float], fraction: float) -> float | None:
+    if not values:
+        return None
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, max(0, round(fraction * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def read_led(target: tuple[str, int], timeout: float) -> int:
+    connection = http.client.HTTPConnection(*target, timeout=timeout)
+    try:
+        connection.request("GET", STATUS_PATH)
+        status = json.loads(connection.getresponse().read().decode("utf-8"))
+    finally:
+        connection.close()
+    return 1 if status.get("led") else 0
+
+
+class Client(threading.Thread):
+    """Alternates status reads and control commands on one persistent connection."""
+
+    def __init__(self, target: tuple[str, int], requests: int, led: int,
+                 timeout: float, start: threading.Event) -> None:
+        super().__init__(daemon=True)
+        self.target = target
+        self.requests = requests
+        # Re-sending the current auto-hold state keeps the benchmark harmless.
+        self.control_body = json.dumps({"value": led})
+        self.timeout = timeout
+        self.start_event = start
+        self.latencies_ms: list[float] = []
+        self.rejected = 0
+        self.errors = 0
+
+    def run(self) -> None:
+        connection = http.client.HTTPConnection(*self.target, timeout=self.timeout)
+        self.start_event.wait()
+        for index in range(self.requests):
+            started = time.monotonic()
+            try:
+                if index % 2 == 0:
+                    connection.request("GET", STATUS_PATH)
+                else:
+                    connection.request(
+                        "POST",
+                        CONTROL_PATH,
+                        body=self.control_body,
+                        headers={"Content-Type": "application/json"},
+                    )
+                response = connection.getresponse()
+                response.read()
+            except (OSError, http.client.HTTPException):
+                self.errors += 1
+                connection.close()
+                continue
+            if response.status == 503:
+                self.rejected += 1
+            elif response.status >= 400:
+                self.errors += 1
+            else:
+                self.latencies_ms.append(1000.0 * (time.monotonic() - started))
+            if response.will_close:
+                connection.close()
+        connection.close()
+
+
+class SlowClient(threading.Thread):
+    """Holds one request open by sending its body a few bytes at a time.
+
+    The body is an OTA chunk without data, which the firmware rejects before
+    touching the staging slot.
+    """
+
+    def __init__(self, target: tuple[str, int], stop: threading.Event) -> None:
+        super().__init__(daemon=True)
+        self.target = target
+        self.stop_event = stop
+
+    def run(self) -> None:
+        body = json.dumps({"offset": 0, "data": ""}).encode("ascii")
+        padded = body + b" " * 2048
+        while not self.stop_event.is_set():
+            try:
+                with socket.create_connection(self.target, timeout=10.0) as sock:
+                    sock.sendall(
+                        (
+                            f"POST {SLOW_PATH} HTTP/1.1\r\n"
+                            f"Host: {self.target[0]}\r\n"
+                            "Content-Type: application/json\r\n"
+                            f"Content-Length: {len(padded)}\r\n"
+                            "Connection: close\r\n"
+                            "\r\n"
+                        ).encode("ascii")
+                    )
+                    for offset in range(0, len(padded), 4):
+                        if self.stop_event.wait(0.5):
+                            break
+                        sock.sendall(padded[offset : offset + 4])
+            except OSError:
+                self.stop_event.wait(0.5)
+
+
+def run_clients(target: tuple[str, int], clients: int, args: argparse.Namespace,
+                led: int) -> dict:
+    start = threading.Event()
+    workers = [Client(target, args.requests, led, args.timeout, start)
+               for _ in range(clients)]
+    for worker in workers:
+        worker.start()
+
+    started = time.monotonic()
+    start.set()
+    for worker in workers:
+        worker.join()
+    elapsed = time.monotonic() - started
+
+    latencies = [value for worker in workers for value in worker.latencies_ms]
+    return {
+        "clients": clients,
+        "ok": len(latencies),
+        "rejected": sum(worker.rejected for worker in workers),
+        "errors": sum(worker.errors for worker in workers),
+        "seconds": round(elapsed, 3),
+        "requests_per_s": round(len(latencies) / elapsed, 1) if elapsed > 0 else None,
+        "p50_ms": percentile(latencies, 0.50),
+        "p95_ms": percentile(latencies, 0.95),
+        "p99_ms": percentile(latencies, 0.99),
+        "max_ms": max(latencies) if latencies else None,
+    }
+
+
+def format_ms(value: float | None) -> str:
+    return f"{value:8.1f}" if value is not None else f"{'-':>8}"
+
+
+def print_table(results: list[dict], slow_client: bool) -> None:
+    header = (
+        f"{'clients':>7} {'ok':>6} {'503':>5} {'errors':>6} {'req/s':>8} "
+        f"{'p50_ms':>8} {'p95_ms':>8} {'p99_ms':>8} {'max_ms':>8}"
+    )
+    print(header)
+    print("-" * len(header))
+    for row in results:
+        rate = row["requests_per_s"] if row["requests_per_s"] is not None else 0.0
+        print(
+            f"{row['clients']:>7} {row['ok']:>6} {row['rejected']:>5} "
+            f"{row['errors']:>6} {rate:>8.1f} {format_ms(row['p50_ms'])} "
+            f"{format_ms(row['p95_ms'])} {format_ms(row['p99_ms'])} "
+            f"{format_ms(row['max_ms'])}"
+        )
+    if slow_client:
+        print("A slow client held one connection open during every run")
+
+
+def main() -> int:
+    args = parse_args()
+    target = parse_target(args.host)
+
+    try:
+        counts = [int(value) for value in args.clients.split(",") if value.strip()]
+    except ValueError:
+        print("Error: --clients must be a comma-separated list of integers",
+              file=sys.stderr)
+        return 1
+    if not counts or min(counts) <= 0 or args.requests <= 0:
+        print("Error: --clients and --requests must be > 0", file=sys.stderr)
+        return 1
+
+    try:
+        led = read_led(target, args.timeout)
+    except (OSError, ValueError, http.client.HTTPException) as exc:
+        print(f"Error: cannot read {STATUS_PATH} from {target[0]}: {exc}", file=sys.stderr)
+        return 1
+
+    stop = threading.Event()
+    slow = None
+    if args.slow_client:
+        slow = SlowClient(target, stop)
+        slow.start()
+        time.sleep(0.5)
+
+    results = []
+    try:
+        for clients in counts:
+            results.append(run_clients(target, clients, args, led))
+    finally:
+        stop.set()
+        if slow is not None:
+            slow.join(timeout=2.0)
+
+    if args.json:
+        print(json.dumps(results, indent=2))
+    else:
+        print_table(results, args.slow_client)
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,283 @@
+#!/usr/bin/env python3
+
+from __future__ import annotations
+
+import argparse
+import base64
+import http.client
+import json
+import pathlib
+import socket
+import sys
+import time
+import urllib.parse
+import zlib
+
+STATUS_PATH = "/api/status"
+CONTROL_PATH = "/api/led"
+MODES = ("close", "keep-alive", "pipelined")
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Measure HTTP requests per second on Blower Pico for the control "
+            "command and OTA chunk paths, with a new connection per request, "
+            "one persistent connection and pipelined requests"
+        )
+    )
+    parser.add_argument(
+        "--host",
+        required=True,
+        help="Target host or URL (example: 192.168.0.31 or http://192.168.0.31)",
+    )
+    parser.add_argument(
+        "--requests",
+        type=int,
+        default=200,
+        help="Requests per mode and path (default: 200)",
+    )
+    parser.add_argument(
+        "--pipeline-depth",
+        type=int,
+        default=4,
+        help="Requests written before reading responses in pipelined mode (default: 4)",
+    )
+    parser.add_argument(
+        "--ota-file",
+        help="Optional firmware .bin streamed to the staging slot (never applied)",
+    )
+    parser.add_argument(
+        "--chunk-size",
+        type=int,
+        default=768,
+        help="Raw OTA chunk size in bytes before base64 (default: 768)",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=5.0,
+        help="HTTP timeout in seconds (default: 5)",
+    )
+    parser.add_argument(
+        "--json",
+        action="store_true",
+        help="Print results as JSON instead of a table",
+    )
+    return parser.parse_args()
+
+
+def parse_target(host: str) -> tuple[str, int]:
+    value = host.strip()
+    if not value.startswith("http://"):
+        value = f"http://{value}"
+    parsed = urllib.parse.urlsplit(value)
+    return parsed.hostname or "", parsed.port or 80
+
+
+def encode_request(host: str, path: str, payload: dict, close: bool) -> bytes:
+    body = json.dumps(payload, separators=(",", ":")).encode("utf-8")
+    head = (
+        f"POST {path} HTTP/1.1\r\n"
+        f"Host: {host}\r\n"
+        "Content-Type: application/json\r\n"
+        f"Content-Length: {len(body)}\r\n"
+        f"Connection: {'close' if close else 'keep-alive'}\r\n"
+        "\r\n"
+    )
+    return head.encode("ascii") + body
+
+
+def read_response(stream) -> tuple[int, bytes]:
+    """Reads one response, framed by Content-Length or chunked encoding."""
+    status_line = stream.readline()
+    if not status_line:
+        raise ConnectionError("connection closed before the response")
+    status = int(status_line.split()[1])
+    headers = {}
+    while True:
+        line = stream.readline().decode("latin-1").strip()
+        if not line:
+            break
+        name, _, value = line.partition(":")
+        headers[name.strip().lower()] = value.strip()
+
+    if headers.get("transfer-encoding", "").lower() == "chunked":
+        body = bytearray()
+        while True:
+            size = int(stream.readline().split(b";")[0], 16)
+            if size == 0:
+                stream.readline()
+                return status, bytes(body)
+            body += stream.read(size)
+            stream.readline()
+    return status, stream.read(int(headers.get("content-length", "0")))
+
+
+def connect(target: tuple[str, int], timeout: float) -> socket.socket:
+    sock = socket.create_connection(target, timeout=timeout)
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    return sock
+
+
+def check_status(status: int, body: bytes) -> None:
+    if status >= 400:
+        raise RuntimeError(f"HTTP {status}: {body.decode('utf-8', errors='replace')}")
+
+
+def run_close(target: tuple[str, int], requests: list[tuple[str, dict]],
+              timeout: float) -> None:
+    for path, payload in requests:
+        with connect(target, timeout) as sock:
+            sock.sendall(encode_request(target[0], path, payload, close=True))
+            check_status(*read_response(sock.makefile("rb")))
+
+
+def run_keep_alive(target: tuple[str, int], requests: list[tuple[str, dict]],
+                   timeout: float) -> None:
+    with connect(target, timeout) as sock:
+        stream = sock.makefile("rb")
+        for path, payload in requests:
+            sock.sendall(encode_request(target[0], path, payload, close=False))
+            check_status(*read_response(stream))
+
+
+def run_pipelined(target: tuple[str, int], requests: list[tuple[str, dict]],
+                  timeout: float, depth: int) -> None:
+    with connect(target, timeout) as sock:
+        stream = sock.makefile("rb")
+        for start in range(0, len(requests), depth):
+            batch = requests[start : start + depth]
+            sock.sendall(
+                b"".join(
+                    encode_request(target[0], path, payload, close=False)
+                    for path, payload in batch
+                )
+            )
+            for _ in batch:
+                check_status(*read_response(stream))
+
+
+def measure(name: str, mode: str, target: tuple[str, int],
+            requests: list[tuple[str, dict]], args: argparse.Namespace) -> dict:
+    started = time.monotonic()
+    if mode == "close":
+        run_close(target, requests, args.timeout)
+    elif mode == "keep-alive":
+        run_keep_alive(target, requests, args.timeout)
+    else:
+        run_pipelined(target, requests, args.timeout, max(1, args.pipeline_depth))
+    elapsed = time.monotonic() - started
+    return {
+        "path": name,
+        "mode": mode,
+        "requests": len(requests),
+        "seconds": round(elapsed, 3),
+        "requests_per_s": round(len(requests) / elapsed, 1) if elapsed > 0 else None,
+        "avg_ms": round(1000.0 * elapsed / len(requests), 2) if requests else None,
+    }
+
+
+def control_requests(target: tuple[str, int], count: int, timeout: float) -> list:
+    # Re-send the current auto-hold state so the benchmark changes nothing.
+    connection = http.client.HTTPConnection(*target, timeout=timeout)
+    try:
+        connection.request("GET", STATUS_PATH)
+        status = json.loads(connection.getresponse().read().decode("utf-8"))
+    finally:
+        connection.close()
+    value = 1 if status.get("led") else 0
+    return [(CONTROL_PATH, {"value": value})] * count
+
+
+def ota_requests(firmware: bytes, chunk_size: int, count: int) -> list:
+    requests = []
+    offset = 0
+    while len(requests) < count and offset < len(firmware):
+        chunk = firmware[offset : offset + chunk_size]
+        requests.append(
+            ("/api/ota/chunk",
+             {"offset": offset, "data": base64.b64encode(chunk).decode("ascii")})
+        )
+        offset += len(chunk)
+    return requests
+
+
+def begin_ota(target: tuple[str, int], firmware: bytes, timeout: float) -> None:
+    crc32 = zlib.crc32(firmware) & 0xFFFFFFFF
+    with connect(target, timeout) as sock:
+        sock.sendall(
+            encode_request(
+                target[0],
+                "/api/ota/begin",
+                {"size": len(firmware), "crc32": crc32, "version": "keepalive-bench"},
+                close=True,
+            )
+        )
+        check_status(*read_response(sock.makefile("rb")))
+
+
+def print_table(results: list[dict]) -> None:
+    header = f"{'path':<8} {'mode':<11} {'requests':>8} {'seconds':>8} {'req/s':>8} {'avg_ms':>8}"
+    print(header)
+    print("-" * len(header))
+    for row in results:
+        print(
+            f"{row['path']:<8} {row['mode']:<11} {row['requests']:>8} "
+            f"{row['seconds']:>8.2f} {row['requests_per_s']:>8.1f} {row['avg_ms']:>8.2f}"
+        )
+    print("'close' opens a new connection per request, as every request did before keep-alive")
+
+
+def main() -> int:
+    args = parse_args()
+    target = parse_target(args.host)
+    firmware = None
+
+    if args.requests <= 0:
+        print("Error: --requests must be > 0", file=sys.stderr)
+        return 1
+    if args.ota_file:
+        firmware_path = pathlib.Path(args.ota_file).expanduser().resolve()
+        if not firmware_path.is_file():
+            print(f"Error: firmware file not found: {firmware_path}", file=sys.stderr)
+            return 1
+        firmware = firmware_path.read_bytes()
+
+    try:
+        control = control_requests(target, args.requests, args.timeout)
+    except (OSError, ValueError, http.client.HTTPException) as exc:
+        print(f"Error: cannot read {STATUS_PATH} from {target[0]}: {exc}", file=sys.stderr)
+        return 1
+
+    results = []
+    try:
+        for mode in MODES:
+            results.append(measure("control", mode, target, control, args))
+        if firmware is not None:
+            # The staging session only accepts chunks in order, so the modes
+            # take consecutive slices of one upload.
+            chunks = ota_requests(firmware, args.chunk_size, args.requests * len(MODES))
+            per_mode = len(chunks) // len(MODES)
+            if per_mode == 0:
+                print("Error: firmware too small for --chunk-size", file=sys.stderr)
+                return 1
+            begin_ota(target, firmware, args.timeout)
+            for index, mode in enumerate(MODES):
+                results.append(
+                    measure("ota", mode, target,
+                            chunks[index * per_mode : (index + 1) * per_mode], args)
+                )
+    except (OSError, RuntimeError, ValueError) as exc:
+        print(f"Error: benchmark failed: {exc}", file=sys.stderr)
+        return 1
+
+    if args.json:
+        print(json.dumps(results, indent=2))
+    else:
+        print_table(results)
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
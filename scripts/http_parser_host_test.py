@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+
+from __future__ import annotations
+
+import argparse
+import pathlib
+import shutil
+import subprocess
+import sys
+import tempfile
+
+REPO_ROOT = pathlib.Path(__file__).resolve().parent.parent
+PARSER_SOURCE = REPO_ROOT / "src" / "services" / "http_request_parser.c"
+
+# Feeds stdin to http_request_parser in slices of argv[1] bytes, as the
+# worker does with pbufs, and prints one line per request:
+#   R <method> <target> body=<bytes> | E <error>
+# A finished request restarts the parser on the remaining bytes, so pipelined
+# requests show up in order; an error stops, as the worker closes then.
+DRIVER_SOURCE = r"""
+#include "services/http_request_parser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static char g_method[16];
+static char g_target[128];
+static size_t g_body_bytes;
+
+static bool on_request_line(void *context, const char *method, size_t method_length,
+                            const char *target, size_t target_length, bool http_1_1) {
+  (void)context;
+  (void)http_1_1;
+  snprintf(g_method, sizeof(g_method), "%.*s", (int)method_length, method);
+  snprintf(g_target, sizeof(g_target), "%.*s", (int)target_length, target);
+  return true;
+}
+
+static bool on_body(void *context, const uint8_t *data, size_t length) {
+  (void)context;
+  (void)data;
+  g_body_bytes += length;
+  return true;
+}
+
+static const http_request_parser_callbacks_t k_callbacks = {
+    .on_request_line = on_request_line,
+    .on_body = on_body,
+};
+
+int main(int argc, char **argv) {
+  static uint8_t input[65536];
+  const size_t slice = argc > 1 ? strtoul(argv[1], NULL, 10) : 1u;
+  const size_t length = fread(input, 1u, sizeof(input), stdin);
+  http_request_parser_t parser;
+  size_t offset = 0u;
+
+  http_request_parser_init(&parser, &k_callbacks, NULL);
+  while (offset < length) {
+    const size_t wanted = length - offset < slice ? length - offset : slice;
+
+    offset += http_request_parser_feed(&parser, input + offset, wanted);
+    if (parser.state == HTTP_REQUEST_PARSER_ERROR) {
+      printf("E %d\n", (int)parser.error);
+      return 0;
+    }
+    if (parser.state == HTTP_REQUEST_PARSER_DONE) {
+      printf("R %s %s body=%zu\n", g_method, g_target, g_body_bytes);
+      g_body_bytes = 0u;
+      http_request_parser_init(&parser, &k_callbacks, NULL);
+    }
+  }
+  return 0;
+}
+"""
+
+BAD_REQUEST = "E 1"
+NOT_IMPLEMENTED = "E 2"
+
+CASES: list[tuple[str, bytes, list[str]]] = [
+    ("get", b"GET /api/status HTTP/1.1\r\nHost: x\r\n\r\n", ["R GET /api/status body=0"]),
+    (
+        "content-length body",
+        b"POST /api/pwm HTTP/1.1\r\nContent-Length: 11\r\n\r\n{\"value\":5}",
+        ["R POST /api/pwm body=11"],
+    ),
+    (
+        "pipelined",
+        b"POST /api/pwm HTTP/1.1\r\nContent-Length: 2\r\n\r\n{}"
+        b"GET /api/status HTTP/1.1\r\n\r\n",
+        ["R POST /api/pwm body=2", "R GET /api/status body=0"],
+    ),
+    (
+        "chunked body is refused",
+        b"POST /api/pwm HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+        b"5\r\nGET /\r\n0\r\n\r\n",
+        [NOT_IMPLEMENTED],
+    ),
+    (
+        "transfer-encoding is case-insensitive",
+        b"POST /api/pwm HTTP/1.1\r\ntransfer-encoding: gzip, chunked\r\n\r\n",
+        [NOT_IMPLEMENTED],
+    ),
+    (
+        "transfer-encoding with content-length",
+        b"POST /api/pwm HTTP/1.1\r\nContent-Length: 4\r\nTransfer-Encoding: chunked\r\n\r\n"
+        b"0\r\n\r\n",
+        [BAD_REQUEST],
+    ),
+    (
+        "conflicting content-length",
+        b"POST /api/pwm HTTP/1.1\r\nContent-Length: 2\r\nContent-Length: 7\r\n\r\n{}",
+        [BAD_REQUEST],
+    ),
+    (
+        "repeated equal content-length",
+        b"POST /api/pwm HTTP/1.1\r\nContent-Length: 2\r\nContent-Length: 2\r\n\r\n{}",
+        ["R POST /api/pwm body=2"],
+    ),
+    ("bad request line", b"GET /api/status\r\n\r\n", [BAD_REQUEST]),
+]
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Build src/services/http_request_parser.c for the host and check "
+            "request framing, fed in several slice sizes"
+        )
+    )
+    parser.add_argument("--cc", default="cc", help="Host C compiler (default: cc)")
+    return parser.parse_args()
+
+
+def build_driver(compiler: str, work_dir: pathlib.Path) -> pathlib.Path:
+    driver_path = work_dir / "http_parser_driver.c"
+    binary_path = work_dir / "http_parser_driver"
+    driver_path.write_text(DRIVER_SOURCE, encoding="utf-8")
+    subprocess.run(
+        [
+            compiler,
+            "-std=c11",
+            "-O2",
+            "-Wall",
+            "-Wextra",
+            "-I",
+            str(REPO_ROOT / "include"),
+            str(driver_path),
+            str(PARSER_SOURCE),
+            "-o",
+            str(binary_path),
+        ],
+        check=True,
+    )
+    return binary_path
+
+
+def main() -> int:
+    args = parse_args()
+    if shutil.which(args.cc) is None:
+        print(f"Compiler not found: {args.cc}", file=sys.stderr)
+        return 1
+
+    failures = 0
+    with tempfile.TemporaryDirectory() as work_dir:
+        binary = build_driver(args.cc, pathlib.Path(work_dir))
+        for name, request, expected in CASES:
+            for slice_size in (1, 7, 4096):
+                result = subprocess.run(
+                    [str(binary), str(slice_size)],
+                    input=request,
+                    capture_output=True,
+                    check=True,
+                )
+                lines = result.stdout.decode("ascii").splitlines()
+                if lines != expected:
+                    failures += 1
+                    print(f"FAIL {name} (slice {slice_size}): {lines} != {expected}")
+
+    print(f"{len(CASES)} cases, {failures} failures")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -4,11 +4,11 @@ from __future__ import annotations
 
 import argparse
 import base64
+import http.client
 import json
 import pathlib
 import sys
-import urllib.error
-import urllib.request
+import urllib.parse
 import zlib
 
 
@@ -46,7 +46,15 @@ def parse_args() -> argparse.Namespace:
         "--chunk-size",
         type=int,
         default=768,
-        help="Raw chunk size in bytes before base64 (default: 768)",
+        help="Raw chunk size in bytes before base64, with --chunked (default: 768)",
+    )
+    parser.add_argument(
+        "--chunked",
+        action="store_true",
+        help=(
+            "Upload with begin/chunk/finish JSON requests instead of one "
+            "application/octet-stream POST to /api/ota/upload"
+        ),
     )
     parser.add_argument(
         "--timeout",
@@ -69,34 +77,121 @@ def normalize_base_url(host: str) -> str:
     return f"http://{value.rstrip('/')}"
 
 
-def post_json(base_url: str, path: str, payload: dict, timeout: float) -> dict | None:
-    request_data = json.dumps(payload, separators=(",", ":")).encode("utf-8")
-    request = urllib.request.Request(
-        f"{base_url}{path}",
-        data=request_data,
-        method="POST",
-        headers={"Content-Type": "application/json"},
+class HttpStatusError(Exception):
+    def __init__(self, status: int, path: str, body: str) -> None:
+        super().__init__(f"HTTP {status} on {path}: {body}")
+        self.status = status
+        self.path = path
+        self.body = body
+
+
+class TargetConnection:
+    """One persistent HTTP/1.1 connection to the target for the whole upload."""
+
+    def __init__(self, base_url: str, timeout: float) -> None:
+        parsed = urllib.parse.urlsplit(base_url)
+        self.host = parsed.hostname or ""
+        self.port = parsed.port or 80
+        self.timeout = timeout
+        self.connection: http.client.HTTPConnection | None = None
+
+    def close(self) -> None:
+        if self.connection is not None:
+            self.connection.close()
+            self.connection = None
+
+    def request(self, method: str, path: str, payload: dict | None = None) -> dict | None:
+        body = None
+        headers = {}
+        if payload is not None:
+            body = json.dumps(payload, separators=(",", ":")).encode("utf-8")
+            headers["Content-Type"] = "application/json"
+        return self.send(method, path, body, headers)
+
+    def upload(self, path: str, image: bytes, crc32: int, version: str) -> dict | None:
+        headers = {
+            "Content-Type": "application/octet-stream",
+            "X-OTA-CRC32": f"{crc32:08x}",
+            "X-OTA-Version": version,
+        }
+        return self.send("POST", path, image, headers)
+
+    def send(self, method: str, path: str, body: bytes | None,
+             headers: dict) -> dict | None:
+        # The target closes idle or exhausted connections; a request that
+        # finds its connection gone before any response is sent once more
+        # on a new one.
+        for attempt in range(2):
+            if self.connection is None:
+                self.connection = http.client.HTTPConnection(
+                    self.host, self.port, timeout=self.timeout
+                )
+            try:
+                self.connection.request(method, path, body=body, headers=headers)
+                response = self.connection.getresponse()
+                data = response.read().decode("utf-8", errors="replace").strip()
+            except (http.client.RemoteDisconnected, BrokenPipeError, ConnectionResetError):
+                self.close()
+                if attempt == 1:
+                    raise
+                continue
+            if response.will_close:
+                self.close()
+            break
+
+        if response.status >= 400:
+            raise HttpStatusError(response.status, path, data)
+        if not data:
+            return None
+        try:
+            return json.loads(data)
+        except json.JSONDecodeError:
+            return None
+
+
+def upload_chunked(target: TargetConnection, firmware_bytes: bytes, firmware_crc32: int,
+                   args: argparse.Namespace) -> bool:
+    total_size = len(firmware_bytes)
+
+    print("[3/5] Initializing OTA session")
+    begin_response = target.request(
+        "POST",
+        "/api/ota/begin",
+        {
+            "size": total_size,
+            "crc32": firmware_crc32,
+            "version": args.version,
+        },
     )
-    with urllib.request.urlopen(request, timeout=timeout) as response:
-        body = response.read().decode("utf-8", errors="replace").strip()
-    if not body:
-        return None
-    try:
-        return json.loads(body)
-    except json.JSONDecodeError:
-        return None
+    if begin_response and begin_response.get("status") != "ok":
+        print(f"Error: OTA begin failed: {begin_response}", file=sys.stderr)
+        return False
 
+    print("[4/5] Uploading chunks")
+    offset = 0
+    while offset < total_size:
+        chunk = firmware_bytes[offset : offset + args.chunk_size]
+        payload = {
+            "offset": offset,
+            "data": base64.b64encode(chunk).decode("ascii"),
+        }
+        chunk_response = target.request("POST", "/api/ota/chunk", payload)
+        if chunk_response and chunk_response.get("status") != "ok":
+            print(
+                f"Error: OTA chunk failed at offset {offset}: {chunk_response}",
+                file=sys.stderr,
+            )
+            return False
+        offset += len(chunk)
+        progress = (offset * 100) // total_size
+        print(f"      {progress:3d}% ({offset}/{total_size})", end="\r", flush=True)
+    print("")
 
-def get_json(base_url: str, path: str, timeout: float) -> dict | None:
-    request = urllib.request.Request(f"{base_url}{path}", method="GET")
-    with urllib.request.urlopen(request, timeout=timeout) as response:
-        body = response.read().decode("utf-8", errors="replace").strip()
-    if not body:
-        return None
-    try:
-        return json.loads(body)
-    except json.JSONDecodeError:
-        return None
+    finish_response = target.request("POST", "/api/ota/finish", {})
+    if finish_response and finish_response.get("status") != "ok":
+        print(f"Error: OTA finish failed: {finish_response}", file=sys.stderr)
+        return False
+    return True
 
 
 def main() -> int:
@@ -123,57 +218,31 @@ def main() -> int:
     print(f"      Size: {total_size} bytes")
     print(f"      CRC32: {firmware_crc32}")
 
+    target = TargetConnection(base_url, args.timeout)
     try:
-        status = get_json(base_url, "/api/ota/status", args.timeout)
+        status = target.request("GET", "/api/ota/status")
         if status:
             firmware_version = status.get("firmware_version", "unknown")
             print(f"[2/5] Target current version: {firmware_version}")
         else:
             print("[2/5] Target status endpoint returned no JSON")
-    except urllib.error.URLError as exc:
+    except (OSError, http.client.HTTPException, HttpStatusError) as exc:
         print(f"Error: cannot reach target {base_url}: {exc}", file=sys.stderr)
         return 1
 
     try:
-        print("[3/5] Initializing OTA session")
-        begin_response = post_json(
-            base_url,
-            "/api/ota/begin",
-            {
-                "size": total_size,
-                "crc32": firmware_crc32,
-                "version": args.version,
-            },
-            args.timeout,
-        )
-        if begin_response and begin_response.get("status") != "ok":
-            print(f"Error: OTA begin failed: {begin_response}", file=sys.stderr)
-            return 1
-
-        print("[4/5] Uploading chunks")
-        offset = 0
-        while offset < total_size:
-            chunk = firmware_bytes[offset : offset + args.chunk_size]
-            payload = {
-                "offset": offset,
-                "data": base64.b64encode(chunk).decode("ascii"),
-            }
-            chunk_response = post_json(base_url, "/api/ota/chunk", payload, args.timeout)
-            if chunk_response and chunk_response.get("status") != "ok":
-                print(
-                    f"Error: OTA chunk failed at offset {offset}: {chunk_response}",
-                    file=sys.stderr,
-                )
+        if args.chunked:
+            if not upload_chunked(target, firmware_bytes, firmware_crc32, args):
                 return 1
-            offset += len(chunk)
-            progress = (offset * 100) // total_size
-            print(f"      {progress:3d}% ({offset}/{total_size})", end="\r", flush=True)
-        print("")
-
-        finish_response = post_json(base_url, "/api/ota/finish", {}, args.timeout)
-        if finish_response and finish_response.get("status") != "ok":
-            print(f"Error: OTA finish failed: {finish_response}", file=sys.stderr)
-            return 1
+        else:
+            print("[3/5] Streaming image to /api/ota/upload")
+            upload_response = target.upload(
+                "/api/ota/upload", firmware_bytes, firmware_crc32, args.version
+            )
+            if upload_response and upload_response.get("status") != "ok":
+                print(f"Error: OTA upload failed: {upload_response}", file=sys.stderr)
+                return 1
+            print("[4/5] Upload verified")
 
         if args.no_apply:
             print("[5/5] Upload complete. Apply skipped (--no-apply).")
@@ -181,25 +250,23 @@ def main() -> int:
 
         print("[5/5] Applying OTA and rebooting target")
         try:
-            apply_response = post_json(base_url, "/api/ota/apply", {}, args.timeout)
+            apply_response = target.request("POST", "/api/ota/apply", {})
             if apply_response and apply_response.get("status") not in ("ok", None):
                 print(f"Warning: OTA apply response: {apply_response}")
-        except urllib.error.URLError:
+        except (OSError, http.client.HTTPException, HttpStatusError):
             # The device can drop connection while rebooting; treat as expected.
             pass
 
         print("OTA request sent successfully. Device should reboot with new firmware.")
         return 0
-    except urllib.error.HTTPError as exc:
-        error_body = exc.read().decode("utf-8", errors="replace")
-        print(
-            f"Error: HTTP {exc.code} on {exc.url}: {error_body}",
-            file=sys.stderr,
-        )
+    except HttpStatusError as exc:
+        print(f"Error: {exc}", file=sys.stderr)
         return 1
-    except urllib.error.URLError as exc:
+    except (OSError, http.client.HTTPException) as exc:
         print(f"Error: network failure during OTA: {exc}", file=sys.stderr)
         return 1
+    finally:
+        target.close()
 
 
 if __name__ == "__main__":
@@ -0,0 +1,288 @@
+#!/usr/bin/env python3
+
+from __future__ import annotations
+
+import argparse
+import base64
+import http.server
+import json
+import pathlib
+import sys
+import threading
+import time
+import zlib
+
+from ota_update import HttpStatusError, TargetConnection, normalize_base_url
+
+MODES = ("chunked", "raw")
+SEGMENT_SIZE = 1460
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Compare OTA upload time on Blower Pico for the begin/chunk/finish JSON "
+            "path and the raw application/octet-stream upload, against a device "
+            "or a local HTTP stand-in"
+        )
+    )
+    parser.add_argument(
+        "--file",
+        required=True,
+        help="Firmware binary file (.bin) generated by the build",
+    )
+    parser.add_argument(
+        "--host",
+        help=(
+            "Target host or URL; the image is staged but never applied "
+            "(default: a local stand-in server)"
+        ),
+    )
+    parser.add_argument(
+        "--chunk-size",
+        type=int,
+        default=768,
+        help="Raw chunk size in bytes before base64 for the chunked path (default: 768)",
+    )
+    parser.add_argument(
+        "--runs",
+        type=int,
+        default=3,
+        help="Uploads per mode (default: 3)",
+    )
+    parser.add_argument(
+        "--rtt-ms",
+        type=float,
+        default=4.0,
+        help="Stand-in only: delay before each response, like a Wi-Fi round trip (default: 4)",
+    )
+    parser.add_argument(
+        "--link-kbps",
+        type=float,
+        default=8000.0,
+        help="Stand-in only: request body bandwidth in kbit/s, 0 for unlimited (default: 8000)",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=15.0,
+        help="HTTP timeout in seconds (default: 15)",
+    )
+    parser.add_argument(
+        "--json",
+        action="store_true",
+        help="Print results as JSON instead of a table",
+    )
+    return parser.parse_args()
+
+
+class StandInSession:
+    """The OTA service state machine, enough to check what each path sends."""
+
+    def __init__(self) -> None:
+        self.lock = threading.Lock()
+        self.reset()
+
+    def reset(self) -> None:
+        self.size = 0
+        self.crc32 = 0
+        self.image = bytearray()
+        self.receiving = False
+        self.ready = False
+
+    def begin(self, size: int, crc32: int) -> str:
+        if self.receiving:
+            return "busy"
+        if size <= 0:
+            return "size_out_of_range"
+        self.reset()
+        self.size = size
+        self.crc32 = crc32
+        self.receiving = True
+        return "ok"
+
+    def write(self, offset: int, data: bytes) -> str:
+        if not self.receiving:
+            return "invalid_state"
+        if offset != len(self.image) or offset + len(data) > self.size:
+            self.receiving = False
+            return "invalid_offset"
+        self.image.extend(data)
+        return "ok"
+
+    def finish(self) -> str:
+        if not self.receiving or len(self.image) != self.size:
+            self.receiving = False
+            return "invalid_state"
+        self.receiving = False
+        if zlib.crc32(self.image) & 0xFFFFFFFF != self.crc32:
+            return "crc_mismatch"
+        self.ready = True
+        return "ok"
+
+
+def make_handler(session: StandInSession, rtt_ms: float, link_kbps: float):
+    class StandInHandler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+        # Headers and body go out in separate writes; without this every
+        # response waits for a delayed ACK, which the device does not.
+        disable_nagle_algorithm = True
+
+        def log_message(self, format: str, *args) -> None:
+            pass
+
+        def read_body(self) -> bytes:
+            remaining = int(self.headers.get("Content-Length", "0"))
+            body = bytearray()
+            while remaining > 0:
+                segment = self.rfile.read(min(SEGMENT_SIZE, remaining))
+                if not segment:
+                    break
+                if link_kbps > 0:
+                    time.sleep(len(segment) * 8.0 / (link_kbps * 1000.0))
+                body.extend(segment)
+                remaining -= len(segment)
+            return bytes(body)
+
+        def reply(self, result: str) -> None:
+            body = json.dumps({"status": result}).encode("utf-8")
+            time.sleep(rtt_ms / 1000.0)
+            self.send_response(200 if result == "ok" else 400)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def do_GET(self) -> None:
+            self.reply("ok" if self.path == "/api/ota/status" else "not_found")
+
+        def do_POST(self) -> None:
+            body = self.read_body()
+            with session.lock:
+                if self.path == "/api/ota/upload":
+                    crc32 = self.headers.get("X-OTA-CRC32")
+                    result = "invalid_argument" if crc32 is None else session.begin(
+                        len(body), int(crc32, 16)
+                    )
+                    if result == "ok":
+                        result = session.write(0, body)
+                    if result == "ok":
+                        result = session.finish()
+                elif self.path == "/api/ota/begin":
+                    payload = json.loads(body)
+                    result = session.begin(payload["size"], payload["crc32"])
+                elif self.path == "/api/ota/chunk":
+                    payload = json.loads(body)
+                    result = session.write(payload["offset"], base64.b64decode(payload["data"]))
+                elif self.path == "/api/ota/finish":
+                    result = session.finish()
+                else:
+                    result = "not_found"
+            self.reply(result)
+
+    return StandInHandler
+
+
+def upload(target: TargetConnection, mode: str, image: bytes, crc32: int,
+           chunk_size: int) -> tuple[int, int]:
+    """Uploads the image without applying it. Returns requests and body bytes sent."""
+    if mode == "raw":
+        target.upload("/api/ota/upload", image, crc32, "bench")
+        return 1, len(image)
+
+    sent = 0
+    begin = {"size": len(image), "crc32": crc32, "version": "bench"}
+    target.request("POST", "/api/ota/begin", begin)
+    sent += len(json.dumps(begin, separators=(",", ":")))
+    requests = 1
+    for offset in range(0, len(image), chunk_size):
+        payload = {
+            "offset": offset,
+            "data": base64.b64encode(image[offset : offset + chunk_size]).decode("ascii"),
+        }
+        target.request("POST", "/api/ota/chunk", payload)
+        sent += len(json.dumps(payload, separators=(",", ":")))
+        requests += 1
+    target.request("POST", "/api/ota/finish", {})
+    return requests + 1, sent + 2
+
+
+def main() -> int:
+    args = parse_args()
+    firmware_path = pathlib.Path(args.file).expanduser().resolve()
+
+    if not firmware_path.is_file():
+        print(f"Error: firmware file not found: {firmware_path}", file=sys.stderr)
+        return 1
+    if args.chunk_size <= 0 or args.runs <= 0:
+        print("Error: --chunk-size and --runs must be > 0", file=sys.stderr)
+        return 1
+    image = firmware_path.read_bytes()
+    if not image:
+        print("Error: firmware file is empty", file=sys.stderr)
+        return 1
+    crc32 = zlib.crc32(image) & 0xFFFFFFFF
+
+    server = None
+    if args.host:
+        base_url = normalize_base_url(args.host)
+    else:
+        server = http.server.ThreadingHTTPServer(
+            ("127.0.0.1", 0),
+            make_handler(StandInSession(), args.rtt_ms, args.link_kbps),
+        )
+        threading.Thread(target=server.serve_forever, daemon=True).start()
+        base_url = f"http://127.0.0.1:{server.server_address[1]}"
+
+    results = []
+    try:
+        for mode in MODES:
+            times_s = []
+            for _ in range(args.runs):
+                target = TargetConnection(base_url, args.timeout)
+                started = time.monotonic()
+                try:
+                    requests, sent = upload(target, mode, image, crc32, args.chunk_size)
+                finally:
+                    target.close()
+                times_s.append(time.monotonic() - started)
+            best = min(times_s)
+            results.append({
+                "mode": mode,
+                "requests": requests,
+                "body_bytes": sent,
+                "best_s": round(best, 3),
+                "median_s": round(sorted(times_s)[len(times_s) // 2], 3),
+                "kib_per_s": round(len(image) / 1024.0 / best, 1),
+            })
+    except (OSError, ValueError, HttpStatusError) as exc:
+        print(f"Error: benchmark failed: {exc}", file=sys.stderr)
+        return 1
+    finally:
+        if server is not None:
+            server.shutdown()
+
+    if args.json:
+        print(json.dumps({
+            "target": args.host or "stand-in",
+            "image_bytes": len(image),
+            "results": results,
+        }, indent=2))
+        return 0
+
+    target_label = args.host or (
+        f"local stand-in (rtt {args.rtt_ms} ms, link {args.link_kbps} kbit/s)"
+    )
+    print(f"image: {firmware_path.name}, {len(image)} bytes; target: {target_label}")
+    print(f"{'mode':<8} {'requests':>9} {'body bytes':>11} {'best s':>8} "
+          f"{'median s':>9} {'KiB/s':>8}")
+    for row in results:
+        print(
+            f"{row['mode']:<8} {row['requests']:>9} {row['body_bytes']:>11} "
+            f"{row['best_s']:>8} {row['median_s']:>9} {row['kib_per_s']:>8}"
+        )
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+
+from __future__ import annotations
+
+import argparse
+import gzip
+import http.client
+import json
+import re
+import sys
+import threading
+import time
+import urllib.parse
+
+NET_DIAG_PATH = "/api/diag/net"
+NET_DIAG_RESET_PATH = "/api/diag/net/reset"
+ASSET_REFERENCE = re.compile(r'(?:src|href)="([^"#:]+)"')
+REQUEST_HEADERS = {"Accept-Encoding": "gzip"}
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Measure web UI page-load time on Blower Pico and the lwIP heap and "
+            "pbuf pool high-water marks it causes"
+        )
+    )
+    parser.add_argument(
+        "--host",
+        required=True,
+        help="Target host or URL (example: 192.168.0.31 or http://192.168.0.31)",
+    )
+    parser.add_argument(
+        "--loads",
+        type=int,
+        default=10,
+        help="Page loads to time (default: 10)",
+    )
+    parser.add_argument(
+        "--parallel",
+        type=int,
+        default=4,
+        help="Connections per page load, like a browser (default: 4)",
+    )
+    parser.add_argument(
+        "--cached",
+        action="store_true",
+        help=(
+            "Load like a browser with a warm cache: revalidate / with If-None-Match "
+            "and skip assets marked immutable"
+        ),
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=10.0,
+        help="HTTP timeout in seconds (default: 10)",
+    )
+    parser.add_argument(
+        "--json",
+        action="store_true",
+        help="Print results as JSON instead of a summary",
+    )
+    return parser.parse_args()
+
+
+def parse_target(host: str) -> tuple[str, int]:
+    value = host.strip()
+    if not value.startswith("http://"):
+        value = f"http://{value}"
+    parsed = urllib.parse.urlsplit(value)
+    return parsed.hostname or "", parsed.port or 80
+
+
+def fetch(target: tuple[str, int], method: str, path: str, timeout: float,
+          headers: dict | None = None) -> http.client.HTTPResponse:
+    connection = http.client.HTTPConnection(*target, timeout=timeout)
+    try:
+        connection.request(method, path, headers={**REQUEST_HEADERS, **(headers or {})})
+        response = connection.getresponse()
+        response.body = response.read()
+    finally:
+        connection.close()
+    if response.status >= 400:
+        raise RuntimeError(f"{method} {path}: HTTP {response.status}")
+    return response
+
+
+def decoded_body(response: http.client.HTTPResponse) -> bytes:
+    if response.getheader("Content-Encoding", "") == "gzip":
+        return gzip.decompress(response.body)
+    return response.body
+
+
+def load_page(target: tuple[str, int], assets: list[str], parallel: int,
+              timeout: float, index_etag: str | None) -> tuple[float, int]:
+    """Loads / and then its assets over up to `parallel` connections. Returns
+    the load time and the bytes received on the wire."""
+    pending = list(assets)
+    lock = threading.Lock()
+    received = [0]
+    failures: list[Exception] = []
+
+    def worker() -> None:
+        connection = http.client.HTTPConnection(*target, timeout=timeout)
+        try:
+            while True:
+                with lock:
+                    if not pending:
+                        return
+                    path = pending.pop(0)
+                connection.request("GET", path, headers=REQUEST_HEADERS)
+                response = connection.getresponse()
+                body = response.read()
+                if response.status >= 400:
+                    raise RuntimeError(f"GET {path}: HTTP {response.status}")
+                with lock:
+                    received[0] += len(body)
+        except (OSError, http.client.HTTPException, RuntimeError) as exc:
+            failures.append(exc)
+        finally:
+            connection.close()
+
+    started = time.monotonic()
+    revalidate = {"If-None-Match": index_etag} if index_etag else None
+    received[0] += len(fetch(target, "GET", "/", timeout, revalidate).body)
+    threads = [threading.Thread(target=worker) for _ in range(max(1, parallel))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed_ms = 1000.0 * (time.monotonic() - started)
+
+    if failures:
+        raise RuntimeError(str(failures[0]))
+    return elapsed_ms, received[0]
+
+
+def main() -> int:
+    args = parse_args()
+    target = parse_target(args.host)
+
+    if args.loads <= 0:
+        print("Error: --loads must be > 0", file=sys.stderr)
+        return 1
+
+    try:
+        index_response = fetch(target, "GET", "/", args.timeout)
+        index = decoded_body(index_response).decode("utf-8", errors="replace")
+        assets = sorted({f"/{ref.lstrip('./')}" for ref in ASSET_REFERENCE.findall(index)})
+        index_etag = None
+        if args.cached:
+            index_etag = index_response.getheader("ETag")
+            assets = [
+                path for path in assets
+                if "immutable" not in fetch(target, "HEAD", path, args.timeout)
+                .getheader("Cache-Control", "")
+            ]
+        fetch(target, "POST", NET_DIAG_RESET_PATH, args.timeout)
+
+        times_ms = []
+        page_bytes = 0
+        for _ in range(args.loads):
+            elapsed_ms, page_bytes = load_page(target, assets, args.parallel, args.timeout,
+                                               index_etag)
+            times_ms.append(elapsed_ms)
+
+        net = json.loads(decoded_body(fetch(target, "GET", NET_DIAG_PATH, args.timeout)))
+    except (OSError, ValueError, RuntimeError, http.client.HTTPException) as exc:
+        print(f"Error: benchmark failed: {exc}", file=sys.stderr)
+        return 1
+
+    ordered = sorted(times_ms)
+    result = {
+        "assets": assets,
+        "page_bytes": page_bytes,
+        "loads": args.loads,
+        "parallel": args.parallel,
+        "cached": args.cached,
+        "median_ms": round(ordered[len(ordered) // 2], 1),
+        "p95_ms": round(ordered[min(len(ordered) - 1, round(0.95 * (len(ordered) - 1)))], 1),
+        "max_ms": round(ordered[-1], 1),
+        "net": net,
+    }
+
+    if args.json:
+        print(json.dumps(result, indent=2))
+        return 0
+
+    print(f"page: / + {', '.join(assets) or 'nothing else'} ({page_bytes} bytes on the wire)")
+    print(
+        f"load time over {args.loads} loads, {args.parallel} connections: "
+        f"median {result['median_ms']} ms, p95 {result['p95_ms']} ms, "
+        f"max {result['max_ms']} ms"
+    )
+    print(f"asset zero-copy: {net.get('asset_zero_copy')}")
+    for pool in ("heap", "pbuf_ref", "tcp_seg"):
+        stats = net.get(pool, {})
+        print(
+            f"{pool:<9} max {stats.get('max')}/{stats.get('avail')} "
+            f"errors {stats.get('errors')}"
+        )
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
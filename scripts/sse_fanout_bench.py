@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+
+from __future__ import annotations
+
+import argparse
+import http.client
+import json
+import socket
+import sys
+import threading
+import time
+import urllib.parse
+
+EVENTS_PATH = "/events"
+NET_DIAG_PATH = "/api/diag/net"
+NET_DIAG_RESET_PATH = "/api/diag/net/reset"
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Measure what each additional /events subscriber costs the Blower Pico "
+            "SSE hub: frames are rendered once and fanned out to every client, and "
+            "the hub's own timing is read from /api/diag/net"
+        )
+    )
+    parser.add_argument(
+        "--host",
+        required=True,
+        help="Target host or URL (example: 192.168.0.31 or http://192.168.0.31)",
+    )
+    parser.add_argument(
+        "--clients",
+        default="1,2,3,4",
+        help="Comma-separated subscriber counts to test (default: 1,2,3,4)",
+    )
+    parser.add_argument(
+        "--duration",
+        type=float,
+        default=10.0,
+        help="Seconds to measure at each subscriber count (default: 10)",
+    )
+    parser.add_argument(
+        "--slow-client",
+        action="store_true",
+        help="Add a subscriber that never reads, to check it gets dropped",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=5.0,
+        help="Timeout in seconds for connections and requests (default: 5)",
+    )
+    parser.add_argument(
+        "--json",
+        action="store_true",
+        help="Print results as JSON instead of a table",
+    )
+    return parser.parse_args()
+
+
+def parse_target(host: str) -> tuple[str, int]:
+    value = host.strip()
+    if not value.startswith("http://"):
+        value = f"http://{value}"
+    parsed = urllib.parse.urlsplit(value)
+    return parsed.hostname or "", parsed.port or 80
+
+
+def open_events(target: tuple[str, int], timeout: float,
+                receive_buffer: int = 0) -> socket.socket:
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    if receive_buffer > 0:
+        # Set before connecting so the advertised window stays small.
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, receive_buffer)
+    sock.settimeout(timeout)
+    sock.connect(target)
+    sock.sendall(
+        f"GET {EVENTS_PATH} HTTP/1.1\r\nHost: {target[0]}\r\n\r\n".encode("ascii")
+    )
+    return sock
+
+
+class Subscriber:
+    """Reads /events and counts frames until closed."""
+
+    def __init__(self, target: tuple[str, int], timeout: float) -> None:
+        self.sock = open_events(target, timeout)
+        self.reader = self.sock.makefile("rb")
+        status_line = self.reader.readline().decode("latin-1")
+        if " 200 " not in status_line:
+            self.sock.close()
+            raise RuntimeError(f"{EVENTS_PATH}: {status_line.strip() or 'no response'}")
+        self.frames = 0
+        self.lock = threading.Lock()
+        self.thread = threading.Thread(target=self.run, daemon=True)
+        self.thread.start()
+
+    def run(self) -> None:
+        try:
+            for raw in self.reader:
+                if raw.startswith(b"data:"):
+                    with self.lock:
+                        self.frames += 1
+        except (OSError, ValueError):
+            pass
+
+    def take_frames(self) -> int:
+        with self.lock:
+            frames, self.frames = self.frames, 0
+        return frames
+
+    def close(self) -> None:
+        try:
+            self.sock.shutdown(socket.SHUT_RDWR)
+        except OSError:
+            pass
+        self.sock.close()
+
+
+def request_json(target: tuple[str, int], method: str, path: str, timeout: float) -> dict:
+    connection = http.client.HTTPConnection(*target, timeout=timeout)
+    try:
+        connection.request(method, path)
+        response = connection.getresponse()
+        body = response.read()
+        if response.status >= 400:
+            raise RuntimeError(f"{method} {path}: HTTP {response.status}")
+        return json.loads(body)
+    finally:
+        connection.close()
+
+
+def measure(target: tuple[str, int], count: int, slow: bool, duration: float,
+            timeout: float) -> dict:
+    subscribers = []
+    slow_sock = None
+    try:
+        for _ in range(count):
+            subscribers.append(Subscriber(target, timeout))
+        if slow:
+            slow_sock = open_events(target, timeout, receive_buffer=1024)
+        # Let every subscriber get its first frame before counting.
+        time.sleep(1.5)
+        request_json(target, "POST", NET_DIAG_RESET_PATH, timeout)
+        for subscriber in subscribers:
+            subscriber.take_frames()
+        time.sleep(duration)
+        received = [subscriber.take_frames() for subscriber in subscribers]
+        sse = request_json(target, "GET", NET_DIAG_PATH, timeout).get("sse")
+        if sse is None:
+            raise RuntimeError(f"{NET_DIAG_PATH} has no sse stats")
+    finally:
+        for subscriber in subscribers:
+            subscriber.close()
+        if slow_sock is not None:
+            slow_sock.close()
+
+    return {
+        "clients": count,
+        "slow_client": slow,
+        "frames": sse["frames"],
+        "received_min": min(received),
+        "received_max": max(received),
+        "render_us_avg": sse["render_us_avg"],
+        "fanout_us_avg": sse["fanout_us_avg"],
+        "fanout_us_max": sse["fanout_us_max"],
+        "per_client_us": sse["per_client_us"],
+        "dropped_slow": sse["dropped_slow"],
+        "dropped_closed": sse["dropped_closed"],
+        "deferred": sse["deferred"],
+        "rejected": sse["rejected"],
+    }
+
+
+def marginal_cost_us(rows: list[dict]) -> float | None:
+    """Least-squares slope of fan-out time per frame against subscriber count."""
+    if len(rows) < 2:
+        return None
+    xs = [row["clients"] for row in rows]
+    ys = [row["fanout_us_avg"] for row in rows]
+    mean_x = sum(xs) / len(xs)
+    mean_y = sum(ys) / len(ys)
+    spread = sum((x - mean_x) ** 2 for x in xs)
+    if spread == 0:
+        return None
+    return sum((x - mean_x) * (y - mean_y) for x, y in zip(xs, ys)) / spread
+
+
+def main() -> int:
+    args = parse_args()
+    target = parse_target(args.host)
+
+    try:
+        counts = [int(value) for value in args.clients.split(",")]
+    except ValueError:
+        counts = []
+    if not counts or any(count <= 0 for count in counts):
+        print("Error: --clients must be a list of positive counts", file=sys.stderr)
+        return 1
+    if args.duration <= 0:
+        print("Error: --duration must be > 0", file=sys.stderr)
+        return 1
+
+    rows = []
+    try:
+        for count in counts:
+            rows.append(measure(target, count, False, args.duration, args.timeout))
+        if args.slow_client:
+            rows.append(measure(target, max(1, counts[-1] - 1), True, args.duration,
+                                args.timeout))
+    except (OSError, ValueError, KeyError, RuntimeError, http.client.HTTPException) as exc:
+        print(f"Error: benchmark failed: {exc}", file=sys.stderr)
+        return 1
+
+    slope = marginal_cost_us([row for row in rows if not row["slow_client"]])
+    if args.json:
+        print(json.dumps({"results": rows, "marginal_client_us": slope}, indent=2))
+        return 0
+
+    print(f"{'clients':<9} {'frames':>7} {'recv':>9} {'render us':>10} "
+          f"{'fanout us':>10} {'max us':>8} {'us/client':>10} {'slow':>5} {'closed':>7} "
+          f"{'defer':>6}")
+    for row in rows:
+        label = f"{row['clients']}+slow" if row["slow_client"] else str(row["clients"])
+        received = f"{row['received_min']}-{row['received_max']}"
+        print(
+            f"{label:<9} {row['frames']:>7} {received:>9} {row['render_us_avg']:>10} "
+            f"{row['fanout_us_avg']:>10} {row['fanout_us_max']:>8} "
+            f"{row['per_client_us']:>10} {row['dropped_slow']:>5} {row['dropped_closed']:>7} "
+            f"{row['deferred']:>6}"
+        )
+    if slope is not None:
+        print(f"each additional subscriber adds ~{slope:.0f} us of fan-out per frame")
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,299 @@
+#!/usr/bin/env python3
+
+from __future__ import annotations
+
+import argparse
+import csv
+import math
+import pathlib
+import random
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+REPO_ROOT = pathlib.Path(__file__).resolve().parent.parent
+APP_CONFIG_PATH = REPO_ROOT / "include" / "app" / "app_config.h"
+DETECTOR_SOURCE = REPO_ROOT / "src" / "services" / "steady_state_detector.c"
+DEFAULT_POINTS = (10.0, 20.0, 30.0, 40.0, 50.0, 60.0, 70.0, 80.0)
+SAMPLE_PERIOD_MS = 20
+MAX_SEGMENT_S = 180.0
+
+# Mirrors the STABILIZING branch of blower_test_service_update(): the fixed
+# settle timer runs while the pressure stays inside the tolerance band and the
+# detector may end the wait earlier.
+DRIVER_SOURCE = r"""
+#include "services/steady_state_detector.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static steady_state_config_t g_config;
+static steady_state_detector_t g_detector;
+static float g_target;
+static float g_tolerance;
+static unsigned g_settle_ms;
+static unsigned g_start_ms;
+static unsigned g_stable_since_ms;
+static long g_detector_end_ms = -1;
+static long g_timer_end_ms = -1;
+static int g_active;
+
+static void finish_point(void) {
+  if (g_active) {
+    printf("P %.2f %ld %ld\n", g_target, g_detector_end_ms, g_timer_end_ms);
+  }
+  g_active = 0;
+}
+
+int main(int argc, char **argv) {
+  char line[256];
+
+  if (argc != 7) {
+    return 2;
+  }
+  g_config.window_ms = (uint32_t)strtoul(argv[1], NULL, 10);
+  g_config.min_samples = (uint16_t)strtoul(argv[2], NULL, 10);
+  g_config.max_flow_drift_ratio = strtof(argv[4], NULL);
+  g_config.slope_t_quantile = strtof(argv[5], NULL);
+  g_config.max_variance_ratio = strtof(argv[6], NULL);
+
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    unsigned t_ms = 0u;
+    float pressure = 0.0f;
+    float flow = 0.0f;
+
+    if (line[0] == 'S') {
+      finish_point();
+      if (sscanf(line + 1, "%f %f %u", &g_target, &g_tolerance, &g_settle_ms) != 3) {
+        return 3;
+      }
+      g_settle_ms *= 1000u;
+      g_config.max_pressure_drift_pa = g_tolerance * strtof(argv[3], NULL);
+      steady_state_reset(&g_detector, &g_config);
+      g_stable_since_ms = 0u;
+      g_start_ms = 0u;
+      g_detector_end_ms = -1;
+      g_timer_end_ms = -1;
+      g_active = 1;
+      continue;
+    }
+    if (!g_active || sscanf(line, "%u %f %f", &t_ms, &pressure, &flow) != 3) {
+      continue;
+    }
+    if (g_start_ms == 0u) {
+      g_start_ms = t_ms == 0u ? 1u : t_ms;
+    }
+
+    const int steady = steady_state_add_sample(&g_detector, t_ms, pressure, flow);
+    if (fabsf(pressure - g_target) > g_tolerance) {
+      g_stable_since_ms = 0u;
+      continue;
+    }
+    if (g_stable_since_ms == 0u) {
+      g_stable_since_ms = t_ms == 0u ? 1u : t_ms;
+    }
+    if (g_timer_end_ms < 0 && (t_ms - g_stable_since_ms) >= g_settle_ms) {
+      g_timer_end_ms = (long)(t_ms - g_start_ms);
+    }
+    if (g_detector_end_ms < 0 && steady &&
+        fabsf(g_detector.status.pressure_mean_pa - g_target) <= g_tolerance) {
+      g_detector_end_ms = (long)(t_ms - g_start_ms);
+    }
+  }
+  finish_point();
+  return 0;
+}
+"""
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Run the firmware steady-state detector on simulated or recorded "
+            "test points and report stabilization time saved against the "
+            "fixed settle timer"
+        )
+    )
+    parser.add_argument(
+        "--replay",
+        help="CSV with t_ms,target_pa,pressure_pa,flow_m3h columns; a change "
+        "of target_pa starts a new point",
+    )
+    parser.add_argument("--runs", type=int, default=20, help="Simulated full tests (default: 20)")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed (default: 1)")
+    parser.add_argument(
+        "--points",
+        default=",".join(f"{point:g}" for point in DEFAULT_POINTS),
+        help="Comma-separated target pressures in Pa",
+    )
+    parser.add_argument("--tolerance", type=float, default=2.0, help="target_tolerance_pa (default: 2)")
+    parser.add_argument("--settle-s", type=int, default=8, help="settle_time_s cap (default: 8)")
+    parser.add_argument("--sensor-noise", type=float, default=0.25, help="Pressure sensor noise in Pa")
+    parser.add_argument("--wind", type=float, default=0.6, help="Wind gust amplitude in Pa")
+    parser.add_argument("--cc", default="cc", help="Host C compiler (default: cc)")
+    return parser.parse_args()
+
+
+def read_app_config() -> dict[str, str]:
+    text = APP_CONFIG_PATH.read_text(encoding="utf-8")
+    return dict(re.findall(r"#define\s+(APP_TEST_STEADY_\w+)\s+([0-9.]+)[uf]?", text))
+
+
+def build_driver(compiler: str, work_dir: pathlib.Path) -> pathlib.Path:
+    driver_path = work_dir / "steady_state_driver.c"
+    binary_path = work_dir / "steady_state_driver"
+    driver_path.write_text(DRIVER_SOURCE, encoding="utf-8")
+    subprocess.run(
+        [
+            compiler,
+            "-std=c11",
+            "-O2",
+            "-I",
+            str(REPO_ROOT / "include"),
+            str(driver_path),
+            str(DETECTOR_SOURCE),
+            "-lm",
+            "-o",
+            str(binary_path),
+        ],
+        check=True,
+    )
+    return binary_path
+
+
+def simulate_point(rng: random.Random, start_pa: float, target_pa: float,
+                   sensor_noise: float, wind_pa: float) -> list[tuple[int, float, float]]:
+    # Under-damped first-order-ish approach as seen with the PWM loop, plus a
+    # slowly varying wind term and white sensor noise.
+    tau_s = rng.uniform(1.5, 5.0)
+    ring_hz = rng.uniform(0.05, 0.2)
+    leakage_c = rng.uniform(60.0, 160.0)
+    leakage_n = rng.uniform(0.55, 0.75)
+    gust = 0.0
+    gust_alpha = math.exp(-SAMPLE_PERIOD_MS / 2000.0)
+    samples = []
+
+    for index in range(int(MAX_SEGMENT_S * 1000 / SAMPLE_PERIOD_MS)):
+        t_s = index * SAMPLE_PERIOD_MS / 1000.0
+        gust = gust_alpha * gust + math.sqrt(1.0 - gust_alpha**2) * rng.gauss(0.0, wind_pa)
+        envelope = target_pa + (start_pa - target_pa) * math.exp(-t_s / tau_s) * math.cos(
+            2.0 * math.pi * ring_hz * t_s)
+        pressure = envelope + gust + rng.gauss(0.0, sensor_noise)
+        flow = leakage_c * max(envelope, 0.1) ** leakage_n * (1.0 + rng.gauss(0.0, 0.005))
+        samples.append((index * SAMPLE_PERIOD_MS, pressure, flow))
+    return samples
+
+
+def read_replay(path: str) -> list[tuple[float, list[tuple[int, float, float]]]]:
+    segments: list[tuple[float, list[tuple[int, float, float]]]] = []
+    with open(path, newline="", encoding="utf-8") as handle:
+        for row in csv.DictReader(handle):
+            target = float(row["target_pa"])
+            if not segments or segments[-1][0] != target:
+                segments.append((target, []))
+            segments[-1][1].append(
+                (int(row["t_ms"]), float(row["pressure_pa"]), float(row["flow_m3h"]))
+            )
+    return segments
+
+
+def run_driver(binary: pathlib.Path, config: dict[str, str], tolerance: float,
+               settle_s: int, segments) -> list[tuple[float, int, int]]:
+    lines = []
+    for target, samples in segments:
+        lines.append(f"S {target} {tolerance} {settle_s}")
+        lines.extend(f"{t_ms} {pressure:.4f} {flow:.4f}" for t_ms, pressure, flow in samples)
+    result = subprocess.run(
+        [
+            str(binary),
+            config["APP_TEST_STEADY_WINDOW_MS"],
+            config["APP_TEST_STEADY_MIN_SAMPLES"],
+            config["APP_TEST_STEADY_PRESSURE_DRIFT_RATIO"],
+            config["APP_TEST_STEADY_FLOW_DRIFT_RATIO"],
+            config["APP_TEST_STEADY_SLOPE_T_QUANTILE"],
+            config["APP_TEST_STEADY_MAX_VARIANCE_RATIO"],
+        ],
+        input="\n".join(lines) + "\n",
+        capture_output=True,
+        text=True,
+        check=True,
+    )
+    points = []
+    for line in result.stdout.splitlines():
+        _, target, detector_ms, timer_ms = line.split()
+        points.append((float(target), int(detector_ms), int(timer_ms)))
+    return points
+
+
+def summarize(label: str, points: list[tuple[float, int, int]], settle_s: int) -> None:
+    fixed_total = 0
+    adaptive_total = 0
+    for target, detector_ms, timer_ms in points:
+        fixed_ms = timer_ms if timer_ms >= 0 else int(MAX_SEGMENT_S * 1000)
+        adaptive_ms = min(fixed_ms, detector_ms) if detector_ms >= 0 else fixed_ms
+        fixed_total += fixed_ms
+        adaptive_total += adaptive_ms
+        print(
+            f"{label} target={target:5.1f}Pa fixed={fixed_ms / 1000.0:6.2f}s "
+            f"detector={'-' if detector_ms < 0 else f'{detector_ms / 1000.0:.2f}s':>7} "
+            f"saved={(fixed_ms - adaptive_ms) / 1000.0:5.2f}s"
+        )
+    print(
+        f"{label} total fixed={fixed_total / 1000.0:.1f}s adaptive={adaptive_total / 1000.0:.1f}s "
+        f"saved={(fixed_total - adaptive_total) / 1000.0:.1f}s (settle cap {settle_s}s)"
+    )
+
+
+def main() -> int:
+    args = parse_args()
+    config = read_app_config()
+    if shutil.which(args.cc) is None:
+        print(f"Compiler not found: {args.cc}", file=sys.stderr)
+        return 1
+
+    with tempfile.TemporaryDirectory() as work_dir:
+        binary = build_driver(args.cc, pathlib.Path(work_dir))
+
+        if args.replay:
+            points = run_driver(binary, config, args.tolerance, args.settle_s,
+                                read_replay(args.replay))
+            summarize("replay", points, args.settle_s)
+            return 0
+
+        rng = random.Random(args.seed)
+        targets = [float(value) for value in args.points.split(",") if value.strip()]
+        saved_per_test = []
+        for run in range(args.runs):
+            segments = []
+            start_pa = 0.0
+            # Both directions, as in BLOWER_TEST_MODE_BOTH.
+            for target in targets + targets:
+                segments.append((target, simulate_point(rng, start_pa, target,
+                                                        args.sensor_noise, args.wind)))
+                start_pa = target
+            points = run_driver(binary, config, args.tolerance, args.settle_s, segments)
+            fixed = sum(timer for _, _, timer in points if timer >= 0)
+            adaptive = sum(
+                min(timer, detector) if detector >= 0 else timer
+                for _, detector, timer in points
+                if timer >= 0
+            )
+            saved_per_test.append((fixed - adaptive) / 1000.0)
+            if run == 0:
+                summarize("sim", points, args.settle_s)
+
+        saved_per_test.sort()
+        print(
+            f"sim runs={len(saved_per_test)} saved_per_test "
+            f"min={saved_per_test[0]:.1f}s "
+            f"median={saved_per_test[len(saved_per_test) // 2]:.1f}s "
+            f"max={saved_per_test[-1]:.1f}s"
+        )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,349 @@
+#!/usr/bin/env python3
+
+from __future__ import annotations
+
+import argparse
+import base64
+import hashlib
+import http.client
+import json
+import os
+import socket
+import struct
+import sys
+import threading
+import time
+import urllib.parse
+
+PWM_PATH = "/api/pwm"
+EVENTS_PATH = "/events"
+SOCKET_PATH = "/ws"
+WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+BINARY_PROTOCOL = "blower.v1.bin"
+MODES = ("post-close", "post-keep-alive", "websocket", "websocket-bin")
+STATUS_FRAME_VERSION = 1
+STATUS_FRAME_FLOATS = (
+    "frequency", "phase_error_us", "dp1_pressure", "dp1_temperature",
+    "dp2_pressure", "dp2_temperature", "fan_wind_speed_ms", "fan_flow_m3h",
+    "target_pressure_pa", "cal_fan", "cal_env", "test_ach", "test_ach_ci_low",
+    "test_ach_ci_high",
+)
+STATUS_FRAME_HEADER = struct.Struct(f"<BBBBBBBBBBII{len(STATUS_FRAME_FLOATS)}f")
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(
+        description=(
+            "Measure command-to-actuation latency on Blower Pico for PWM commands "
+            "sent as POST requests (new connection each, or one kept alive) and "
+            "over the WebSocket with JSON or binary status frames. The fan PWM is "
+            "driven between the given values and left at 0."
+        )
+    )
+    parser.add_argument(
+        "--host",
+        required=True,
+        help="Target host or URL (example: 192.168.0.31 or http://192.168.0.31)",
+    )
+    parser.add_argument(
+        "--commands",
+        type=int,
+        default=40,
+        help="Commands per mode (default: 40)",
+    )
+    parser.add_argument(
+        "--pwm",
+        default="0,10",
+        help="Two PWM values to alternate between, in percent (default: 0,10)",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=5.0,
+        help="Timeout in seconds for a response or telemetry update (default: 5)",
+    )
+    parser.add_argument(
+        "--json",
+        action="store_true",
+        help="Print results as JSON instead of a table",
+    )
+    return parser.parse_args()
+
+
+def parse_target(host: str) -> tuple[str, int]:
+    value = host.strip()
+    if not value.startswith("http://"):
+        value = f"http://{value}"
+    parsed = urllib.parse.urlsplit(value)
+    return parsed.hostname or "", parsed.port or 80
+
+
+def decode_status_frame(frame: bytes) -> dict:
+    """Packed status frame (subprotocol blower.v1.bin) as a status message."""
+    if len(frame) < STATUS_FRAME_HEADER.size or frame[0] != STATUS_FRAME_VERSION:
+        raise ValueError("unknown status frame")
+    fields = STATUS_FRAME_HEADER.unpack_from(frame)
+    data = dict(zip(STATUS_FRAME_FLOATS, fields[12:]))
+    data.update(pwm=fields[2], sample_sequence=fields[11])
+    return {"type": "status", "seq": fields[10], "data": data}
+
+
+class WebSocketClient:
+    """Just enough RFC 6455 for the bench: text and status frames, no extensions."""
+
+    def __init__(self, target: tuple[str, int], timeout: float,
+                 protocol: str | None = None) -> None:
+        self.sock = socket.create_connection(target, timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.reader = self.sock.makefile("rb")
+        key = base64.b64encode(os.urandom(16)).decode("ascii")
+        self.sock.sendall(
+            (
+                f"GET {SOCKET_PATH} HTTP/1.1\r\n"
+                f"Host: {target[0]}\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                f"Sec-WebSocket-Key: {key}\r\n"
+                "Sec-WebSocket-Version: 13\r\n"
+                + (f"Sec-WebSocket-Protocol: {protocol}\r\n" if protocol else "")
+                + "\r\n"
+            ).encode("ascii")
+        )
+        self.status_bytes: list[int] = []
+        status_line = self.reader.readline().decode("latin-1")
+        headers = {}
+        while True:
+            line = self.reader.readline().decode("latin-1").strip()
+            if not line:
+                break
+            name, _, value = line.partition(":")
+            headers[name.strip().lower()] = value.strip()
+        expected = base64.b64encode(
+            hashlib.sha1((key + WEBSOCKET_GUID).encode("ascii")).digest()
+        ).decode("ascii")
+        if " 101 " not in status_line or headers.get("sec-websocket-accept") != expected:
+            raise RuntimeError(f"WebSocket handshake failed: {status_line.strip()}")
+        if headers.get("sec-websocket-protocol") != protocol:
+            raise RuntimeError(f"WebSocket subprotocol {protocol} not accepted")
+
+    def send_text(self, text: str) -> None:
+        payload = text.encode("utf-8")
+        mask = os.urandom(4)
+        if len(payload) < 126:
+            header = struct.pack("!BB", 0x81, 0x80 | len(payload))
+        else:
+            header = struct.pack("!BBH", 0x81, 0x80 | 126, len(payload))
+        masked = bytes(byte ^ mask[index & 3] for index, byte in enumerate(payload))
+        self.sock.sendall(header + mask + masked)
+
+    def receive(self) -> dict:
+        """Returns the next message, decoded; answers pings on the way."""
+        message = b""
+        binary = False
+        while True:
+            first, second = self.reader.read(2)
+            length = second & 0x7F
+            if length == 126:
+                (length,) = struct.unpack("!H", self.reader.read(2))
+            elif length == 127:
+                (length,) = struct.unpack("!Q", self.reader.read(8))
+            payload = self.reader.read(length)
+            opcode = first & 0x0F
+            if opcode == 0x8:
+                raise RuntimeError("WebSocket closed by the target")
+            if opcode == 0x9:
+                self.sock.sendall(struct.pack("!BB", 0x8A, 0x80 | len(payload)) +
+                                  b"\0\0\0\0" + payload)
+                continue
+            if opcode in (0x0, 0x1, 0x2):
+                if opcode != 0x0:
+                    binary = opcode == 0x2
+                message += payload
+                if first & 0x80:
+                    decoded = decode_status_frame(message) if binary else json.loads(message)
+                    if decoded.get("type") == "status":
+                        self.status_bytes.append(len(message))
+                    return decoded
+
+    def close(self) -> None:
+        try:
+            self.sock.sendall(struct.pack("!BB", 0x88, 0x82) + b"\0\0\0\0" +
+                              struct.pack("!H", 1000))
+        except OSError:
+            pass
+        self.sock.close()
+
+
+class TelemetryWatcher:
+    """Follows /events and records when each PWM value shows up."""
+
+    def __init__(self, target: tuple[str, int], timeout: float) -> None:
+        self.sock = socket.create_connection(target, timeout=timeout)
+        self.sock.sendall(
+            f"GET {EVENTS_PATH} HTTP/1.1\r\nHost: {target[0]}\r\n\r\n".encode("ascii")
+        )
+        self.reader = self.sock.makefile("rb")
+        self.condition = threading.Condition()
+        self.seen: list[tuple[float, int]] = []
+        self.thread = threading.Thread(target=self.run, daemon=True)
+        self.thread.start()
+
+    def run(self) -> None:
+        try:
+            for raw in self.reader:
+                line = raw.decode("utf-8", errors="replace").strip()
+                if not line.startswith("data:"):
+                    continue
+                pwm = json.loads(line[5:]).get("pwm")
+                with self.condition:
+                    self.seen.append((time.monotonic(), pwm))
+                    self.condition.notify_all()
+        except (OSError, ValueError):
+            pass
+
+    def wait_for(self, pwm: int, since: float, timeout: float) -> float:
+        deadline = time.monotonic() + timeout
+        with self.condition:
+            while True:
+                for seen_at, value in self.seen:
+                    if seen_at >= since and value == pwm:
+                        return seen_at
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    raise RuntimeError(f"PWM {pwm} not seen on {EVENTS_PATH}")
+                self.condition.wait(remaining)
+
+    def close(self) -> None:
+        self.sock.close()
+
+
+def post_pwm(connection: http.client.HTTPConnection, value: int) -> None:
+    body = json.dumps({"value": value}).encode("utf-8")
+    connection.request("POST", PWM_PATH, body=body,
+                       headers={"Content-Type": "application/json"})
+    response = connection.getresponse()
+    response.read()
+    if response.status >= 400:
+        raise RuntimeError(f"POST {PWM_PATH}: HTTP {response.status}")
+
+
+def run_post(target: tuple[str, int], keep_alive: bool, values: list[int], count: int,
+             timeout: float) -> tuple[list[float], list[float]]:
+    acked_ms = []
+    visible_ms = []
+    watcher = TelemetryWatcher(target, timeout)
+    connection = http.client.HTTPConnection(*target, timeout=timeout)
+    try:
+        for index in range(count):
+            value = values[index % 2]
+            if not keep_alive:
+                connection.close()
+                connection = http.client.HTTPConnection(*target, timeout=timeout)
+            started = time.monotonic()
+            post_pwm(connection, value)
+            acked_ms.append(1000.0 * (time.monotonic() - started))
+            visible_ms.append(1000.0 * (watcher.wait_for(value, started, timeout) - started))
+    finally:
+        connection.close()
+        watcher.close()
+    return acked_ms, visible_ms
+
+
+def run_websocket(target: tuple[str, int], values: list[int], count: int,
+                  timeout: float, protocol: str | None) -> tuple[list[float], list[float], int]:
+    acked_ms = []
+    visible_ms = []
+    client = WebSocketClient(target, timeout, protocol)
+    try:
+        for index in range(count):
+            value = values[index % 2]
+            seq = index + 1
+            acked = None
+            visible = None
+            started = time.monotonic()
+            client.send_text(json.dumps({"seq": seq, "cmd": "pwm", "value": value}))
+            while acked is None or visible is None:
+                message = client.receive()
+                if message.get("type") == "ack" and message.get("ack") == seq:
+                    if message.get("status") != "ok":
+                        raise RuntimeError(f"command {seq} refused: {message}")
+                    acked = time.monotonic()
+                elif message.get("type") == "status" and message["data"].get("pwm") == value:
+                    visible = time.monotonic()
+            acked_ms.append(1000.0 * (acked - started))
+            visible_ms.append(1000.0 * (visible - started))
+    finally:
+        client.close()
+    status_bytes = round(sum(client.status_bytes) / max(1, len(client.status_bytes)))
+    return acked_ms, visible_ms, status_bytes
+
+
+def summarize(samples: list[float]) -> dict:
+    ordered = sorted(samples)
+    return {
+        "median_ms": round(ordered[len(ordered) // 2], 1),
+        "p95_ms": round(ordered[min(len(ordered) - 1, round(0.95 * (len(ordered) - 1)))], 1),
+        "max_ms": round(ordered[-1], 1),
+    }
+
+
+def main() -> int:
+    args = parse_args()
+    target = parse_target(args.host)
+
+    try:
+        values = [int(value) for value in args.pwm.split(",")]
+    except ValueError:
+        values = []
+    if len(values) != 2 or values[0] == values[1] or not all(0 <= v <= 100 for v in values):
+        print("Error: --pwm needs two different values in 0..100", file=sys.stderr)
+        return 1
+    if args.commands <= 0:
+        print("Error: --commands must be > 0", file=sys.stderr)
+        return 1
+
+    results = {}
+    try:
+        for mode in MODES:
+            status_bytes = None
+            if mode.startswith("websocket"):
+                acked, visible, status_bytes = run_websocket(
+                    target, values, args.commands, args.timeout,
+                    BINARY_PROTOCOL if mode == "websocket-bin" else None,
+                )
+            else:
+                acked, visible = run_post(target, mode == "post-keep-alive", values,
+                                          args.commands, args.timeout)
+            results[mode] = {"ack": summarize(acked), "visible": summarize(visible),
+                             "status_bytes": status_bytes}
+    except (OSError, ValueError, RuntimeError, http.client.HTTPException) as exc:
+        print(f"Error: benchmark failed: {exc}", file=sys.stderr)
+        return 1
+    finally:
+        try:
+            connection = http.client.HTTPConnection(*target, timeout=args.timeout)
+            post_pwm(connection, 0)
+            connection.close()
+        except (OSError, RuntimeError, http.client.HTTPException):
+            print("Warning: could not set PWM back to 0", file=sys.stderr)
+
+    if args.json:
+        print(json.dumps({"commands": args.commands, "results": results}, indent=2))
+        return 0
+
+    print(f"{args.commands} PWM commands per mode; ack = response or ack received, "
+          "visible = new value seen in telemetry, status = bytes per status message")
+    print(f"{'mode':<16} {'ack med':>8} {'ack p95':>8} {'vis med':>8} {'vis p95':>8} "
+          f"{'status':>7}")
+    for mode, row in results.items():
+        status_bytes = "-" if row["status_bytes"] is None else row["status_bytes"]
+        print(
+            f"{mode:<16} {row['ack']['median_ms']:>8} {row['ack']['p95_ms']:>8} "
+            f"{row['visible']['median_ms']:>8} {row['visible']['p95_ms']:>8} "
+            f"{status_bytes:>7}"
+        )
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
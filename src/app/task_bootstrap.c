@@ -41,6 +41,15 @@ static const app_task_definition_t k_default_tasks[] = {
         .parameters = NULL,
     },
 #endif
+#if APP_ENABLE_BLOWER_TEST_TASK
+    {
+        .entry_point = blower_test_task_entry,
+        .task_name = "BlowerTestTask",
+        .stack_depth_words = APP_BLOWER_TEST_TASK_STACK_WORDS,
+        .priority = APP_BLOWER_TEST_TASK_PRIORITY,
+        .parameters = NULL,
+    },
+#endif
 };
 
 BaseType_t app_create_default_tasks(void) {
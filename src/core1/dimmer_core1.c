@@ -1,6 +1,9 @@
 #include "core1_dimmer.h"
 
-#include "app_config.h"
+#include "app/app_config.h"
+#include "drivers/zero_cross/zero_cross_capture.h"
+#include "services/dimmer_trace.h"
+#include "services/mains_pll.h"
 #include "shared_state.h"
 
 #include "hardware/gpio.h"
@@ -10,21 +13,42 @@
 #include "hardware/structs/sio.h"
 #include "pico/stdlib.h"
 
-// Use a dedicated timer instance and alarm on Core1 to avoid contention with Core0 time services.
-// RP2350 has two timer instances (timer0_hw and timer1_hw).
+// Use a dedicated timer instance and alarms on Core1 to avoid contention with Core0 time services.
+// RP2350 has two timer instances (timer0_hw and timer1_hw). Zero-cross edges are
+// timestamped on the same instance so PLL predictions map straight to alarm targets.
 #define DIMMER_TIMER timer1_hw
-#define DIMMER_ALARM_NUM 0u
-
-static volatile uint32_t s_last_zc_us = 0;
+#define DIMMER_ALARM_COUNT 2u
+#define DIMMER_GATE_PULSE_US 100u
+#define DIMMER_GATE_END_MARGIN_US 200u
+#define DIMMER_GATE_LATE_LIMIT_US 500u
+#define DIMMER_MIN_ALARM_LEAD_US 2u
+#define DIMMER_DEFAULT_HALF_CYCLE_US 10000.0f
+
+// After init everything below runs from RAM: Core0 erases/programs flash with
+// XIP disabled and Core1 is deliberately not a flash lockout victim, so the
+// gate keeps firing through OTA and storage writes.
+typedef struct {
+  uint32_t target_us;
+  uint32_t zero_cross_us;
+  uint32_t half_cycle_sequence;
+} dimmer_alarm_schedule_t;
+
+static mains_pll_t s_mains_pll;
+static dimmer_alarm_schedule_t s_alarm_schedule[DIMMER_ALARM_COUNT];
 
 static inline uint32_t dimmer_time_us_32(void) { return DIMMER_TIMER->timerawl; }
 
+// Actuation records shared with Core0 use the time_us_32() (timer0) timebase.
+static inline uint32_t dimmer_to_system_us(uint32_t dimmer_us) {
+  return timer0_hw->timerawl - (dimmer_time_us_32() - dimmer_us);
+}
+
 static inline void dimmer_gate_on(void) {
-  sio_hw->gpio_set = 1u << DIMMER_GATE_GPIO;
+  sio_hw->gpio_set = 1u << APP_DIMMER_GATE_PIN;
 }
 
 static inline void dimmer_gate_off(void) {
-  sio_hw->gpio_clr = 1u << DIMMER_GATE_GPIO;
+  sio_hw->gpio_clr = 1u << APP_DIMMER_GATE_PIN;
 }
 
 static void __time_critical_func(dimmer_busy_wait_us)(uint32_t us) {
@@ -40,97 +64,189 @@ static inline void __time_critical_func(dimmer_fire_gate_pulse)(void) {
   dimmer_gate_off();
 }
 
-static void __time_critical_func(dimmer_alarm_irq_handler)(void) {
-  // Clear IRQ (write-1-to-clear)
-  DIMMER_TIMER->intr = 1u << DIMMER_ALARM_NUM;
+static void __time_critical_func(dimmer_fire_if_on_time)(
+    const dimmer_alarm_schedule_t *schedule) {
+  const uint32_t fire_us = dimmer_time_us_32();
+  const int32_t latency_us = (int32_t)(fire_us - schedule->target_us);
+
+  // A pulse this late would land in the next half-cycle; dropping it is
+  // safer than latching the triac near full conduction.
+  if (latency_us > (int32_t)DIMMER_GATE_LATE_LIMIT_US) {
+    shared_dimmer_note_missed_alarm();
+    dimmer_trace_note_missed();
+    return;
+  }
 
-  // Fire gate pulse (keep this ISR minimal and deterministic)
+  dimmer_trace_note_fire(schedule->target_us, fire_us);
   dimmer_fire_gate_pulse();
+  shared_dimmer_note_gate_pulse(latency_us > 0 ? (uint32_t)latency_us : 0u);
+  shared_dimmer_note_fire(schedule->half_cycle_sequence,
+                          dimmer_to_system_us(schedule->zero_cross_us),
+                          dimmer_to_system_us(fire_us));
+}
+
+static void __time_critical_func(dimmer_alarm_irq_handler)(void) {
+  uint alarm_num = 0u;
+
+  for (alarm_num = 0u; alarm_num < DIMMER_ALARM_COUNT; ++alarm_num) {
+    if ((DIMMER_TIMER->ints & (1u << alarm_num)) == 0u) {
+      continue;
+    }
+    // Clear IRQ (write-1-to-clear)
+    DIMMER_TIMER->intr = 1u << alarm_num;
+    dimmer_fire_if_on_time(&s_alarm_schedule[alarm_num]);
+  }
 }
 
-static void __time_critical_func(dimmer_zc_irq_handler)(void) {
-  const uint32_t event_mask = GPIO_IRQ_EDGE_RISE;
-  if ((gpio_get_irq_event_mask(DIMMER_ZC_GPIO) & event_mask) == 0u) {
+static void __time_critical_func(dimmer_arm_gate)(uint alarm_num,
+                                                  uint32_t half_cycle_sequence,
+                                                  uint32_t zero_cross_us,
+                                                  uint32_t fire_at_us) {
+  dimmer_alarm_schedule_t *schedule = &s_alarm_schedule[alarm_num];
+  const int32_t lead_us = (int32_t)(fire_at_us - dimmer_time_us_32());
+
+  if ((DIMMER_TIMER->armed & (1u << alarm_num)) != 0u) {
+    shared_dimmer_note_missed_alarm();
+    dimmer_trace_note_missed();
+  }
+
+  schedule->target_us = fire_at_us;
+  schedule->zero_cross_us = zero_cross_us;
+  schedule->half_cycle_sequence = half_cycle_sequence;
+
+  if (lead_us < (int32_t)DIMMER_MIN_ALARM_LEAD_US) {
+    DIMMER_TIMER->armed = 1u << alarm_num;
+    dimmer_fire_if_on_time(schedule);
     return;
   }
-  gpio_acknowledge_irq(DIMMER_ZC_GPIO, event_mask);
 
-  const uint32_t now = dimmer_time_us_32();
-  if ((uint32_t)(now - s_last_zc_us) < DIMMER_ZC_DEBOUNCE_US) {
+  DIMMER_TIMER->intr = 1u << alarm_num; // clear pending
+  DIMMER_TIMER->alarm[alarm_num] = fire_at_us;
+}
+
+static void __time_critical_func(dimmer_publish_line_status)(void) {
+  const float half_cycle_us = mains_pll_half_cycle_us(&s_mains_pll);
+
+  shared_dimmer_set_line_status(
+      s_mains_pll.locked,
+      half_cycle_us > 0.0f ? (uint32_t)(500000000.0f / half_cycle_us) : 0u,
+      (uint32_t)s_mains_pll.phase_error_ms2);
+}
+
+static void __time_critical_func(dimmer_zero_cross_process_edge)(uint32_t edge_us) {
+  uint32_t zero_cross_us = 0u;
+  uint32_t first_half_cycle_sequence = 0u;
+  uint8_t percent = 0u;
+  float half_cycle_us = 0.0f;
+  uint half_cycles = 1u;
+  uint half_cycle_index = 0u;
+
+  if (mains_pll_process_edge(&s_mains_pll, edge_us, &zero_cross_us) ==
+      MAINS_PLL_EDGE_REJECTED) {
     return;
   }
-  s_last_zc_us = now;
+  shared_dimmer_note_zero_cross();
+  dimmer_publish_line_status();
+
+  half_cycle_us = mains_pll_half_cycle_us(&s_mains_pll);
+  if (half_cycle_us <= 0.0f) {
+    half_cycle_us = DIMMER_DEFAULT_HALF_CYCLE_US;
+  } else if (s_mains_pll.locked) {
+    half_cycles = s_mains_pll.half_cycles_per_edge;
+  }
+
+  // Commit the pending command at ZC only; Core0 may submit at any time.
+  percent = shared_dimmer_commit_half_cycles(dimmer_to_system_us(zero_cross_us),
+                                             half_cycles, &first_half_cycle_sequence);
 
-  const uint8_t percent = shared_get_dimmer_power_percent();
   if (percent == 0u) {
     dimmer_gate_off();
-    DIMMER_TIMER->inte &= ~(1u << DIMMER_ALARM_NUM);
     return;
   }
 
-  // Full conduction: trigger immediately on ZC to minimize latency/jitter.
+  // Full conduction: hold the gate so the triac re-latches right at ZC.
   if (percent >= 100u) {
-    DIMMER_TIMER->inte &= ~(1u << DIMMER_ALARM_NUM);
-    dimmer_fire_gate_pulse();
+    dimmer_gate_on();
     return;
   }
+  dimmer_gate_off();
 
-  const uint32_t max_delay_us =
-      (DIMMER_MAINS_HALF_CYCLE_US > (DIMMER_GATE_PULSE_US + 1u))
-          ? (DIMMER_MAINS_HALF_CYCLE_US - DIMMER_GATE_PULSE_US - 1u)
-          : 0u;
-
-  uint32_t delay_us = 0;
-  delay_us = (DIMMER_MAINS_HALF_CYCLE_US * (100u - (uint32_t)percent)) / 100u;
-  if (delay_us > max_delay_us) {
-    delay_us = max_delay_us;
+  for (half_cycle_index = 0u;
+       half_cycle_index < half_cycles && half_cycle_index < DIMMER_ALARM_COUNT;
+       ++half_cycle_index) {
+    const float max_delay_us =
+        half_cycle_us - (float)(DIMMER_GATE_PULSE_US + DIMMER_GATE_END_MARGIN_US);
+    float delay_us = half_cycle_us * (float)(100u - (uint32_t)percent) / 100.0f;
+
+    if (delay_us > max_delay_us) {
+      delay_us = max_delay_us;
+    }
+    if (delay_us < 0.0f) {
+      delay_us = 0.0f;
+    }
+
+    const uint32_t half_cycle_start_us =
+        zero_cross_us + (uint32_t)(half_cycle_us * (float)half_cycle_index);
+
+    // Program alarms relative to the predicted ZC, not the IRQ entry time.
+    dimmer_arm_gate(half_cycle_index, first_half_cycle_sequence + half_cycle_index,
+                    half_cycle_start_us, half_cycle_start_us + (uint32_t)delay_us);
   }
+}
+
+static void __time_critical_func(dimmer_zero_cross_edge_handler)(uint32_t edge_us,
+                                                                 void *context) {
+  const uint32_t trace_cycles =
+      dimmer_trace_zero_cross_begin(edge_us, dimmer_time_us_32());
+  (void)context;
 
-  // Program alarm relative to the captured ZC timestamp.
-  DIMMER_TIMER->intr = 1u << DIMMER_ALARM_NUM; // clear pending
-  DIMMER_TIMER->alarm[DIMMER_ALARM_NUM] = now + delay_us;
-  DIMMER_TIMER->inte |= 1u << DIMMER_ALARM_NUM;
+  dimmer_zero_cross_process_edge(edge_us);
+  dimmer_trace_zero_cross_end(trace_cycles);
 }
 
 static void dimmer_core1_init(void) {
-  // Dedicated alarm for Core1
-  timer_hardware_alarm_claim(DIMMER_TIMER, DIMMER_ALARM_NUM);
+  zero_cross_capture_config_t zero_cross_config;
+  uint alarm_num = 0u;
 
-  // GPIO setup
-  gpio_init(DIMMER_ZC_GPIO);
-  gpio_set_dir(DIMMER_ZC_GPIO, GPIO_IN);
-  // Hardware-dependent: adjust pull-up/down to match the ZC detector output stage.
-  gpio_pull_down(DIMMER_ZC_GPIO);
+  mains_pll_reset(&s_mains_pll);
+  dimmer_trace_init();
 
-  gpio_init(DIMMER_GATE_GPIO);
-  gpio_set_dir(DIMMER_GATE_GPIO, GPIO_OUT);
+  gpio_init(APP_DIMMER_GATE_PIN);
+  gpio_set_dir(APP_DIMMER_GATE_PIN, GPIO_OUT);
   dimmer_gate_off();
 
-  // Install and enable ZC IRQ on Core1 only.
-  // Use the SDK shared-handler mechanism so Core0 can also use IO_IRQ_BANK0 later without conflicts.
-  gpio_add_raw_irq_handler_with_order_priority_masked(1u << DIMMER_ZC_GPIO,
-                                                     dimmer_zc_irq_handler, 0);
-  irq_set_priority(IO_IRQ_BANK0, 0);
-  irq_set_enabled(IO_IRQ_BANK0, true);
-  gpio_set_irq_enabled(DIMMER_ZC_GPIO, GPIO_IRQ_EDGE_RISE, true);
-
-  // Install and enable the timer alarm IRQ on Core1 only
-  const uint alarm_irq =
-      timer_hardware_alarm_get_irq_num(DIMMER_TIMER, DIMMER_ALARM_NUM);
-  irq_set_exclusive_handler(alarm_irq, dimmer_alarm_irq_handler);
-  irq_set_priority(alarm_irq, 0);
-  irq_set_enabled(alarm_irq, true);
-
-  // Start disarmed; will arm on first valid ZC edge
-  DIMMER_TIMER->inte &= ~(1u << DIMMER_ALARM_NUM);
-}
+  // Install and enable the timer alarm IRQs on Core1 only
+  for (alarm_num = 0u; alarm_num < DIMMER_ALARM_COUNT; ++alarm_num) {
+    const uint alarm_irq = timer_hardware_alarm_get_irq_num(DIMMER_TIMER, alarm_num);
 
-void core1_entry(void) {
-  // Core1 is dedicated to the dimmer: no FreeRTOS, no WiFi, no logging in ISR paths.
-  dimmer_core1_init();
+    timer_hardware_alarm_claim(DIMMER_TIMER, alarm_num);
+    irq_set_exclusive_handler(alarm_irq, dimmer_alarm_irq_handler);
+    irq_set_priority(alarm_irq, 0);
+    DIMMER_TIMER->inte |= 1u << alarm_num;
+    irq_set_enabled(alarm_irq, true);
+  }
 
+  // The capture IRQ lands on the core that initializes it, i.e. Core1.
+  zero_cross_config = (zero_cross_capture_config_t){
+      .gpio = APP_DIMMER_ZERO_CROSS_PIN,
+      .pull_up = true,
+      .glitch_filter_us = APP_ZERO_CROSS_GLITCH_FILTER_US,
+      .timestamp_timer = DIMMER_TIMER,
+      .handler = dimmer_zero_cross_edge_handler,
+      .handler_context = NULL,
+  };
+  zero_cross_capture_init(&zero_cross_config);
+}
+
+static void __time_critical_func(dimmer_core1_idle)(void) {
   for (;;) {
-    // Sleep until the next interrupt (ZC GPIO IRQ or timer alarm IRQ).
+    // Sleep until the next interrupt (zero-cross capture or timer alarm IRQ).
     __wfi();
   }
 }
+
+void core1_entry(void) {
+  // Core1 is dedicated to the dimmer: no FreeRTOS, no WiFi, no logging in ISR paths.
+  dimmer_core1_init();
+  dimmer_core1_idle();
+}
@@ -0,0 +1,204 @@
+#include "drivers/zero_cross/zero_cross_capture.h"
+
+#include "app/app_config.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "zero_cross_capture.pio.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define ZERO_CROSS_CAPTURE_RING_ENTRIES 16u
+#define ZERO_CROSS_CAPTURE_RING_BYTES_LOG2 6u
+#define ZERO_CROSS_CAPTURE_PIO_IRQ_INDEX 0u
+// Cycles between the SM seeing the edge and the push that triggers DMA:
+// 2 input synchronizer + mov + in + push, plus the filter loop itself.
+#define ZERO_CROSS_CAPTURE_FIXED_CYCLES 5u
+#define ZERO_CROSS_CAPTURE_FILTER_LOOP_CYCLES 2u
+
+typedef struct {
+  bool running;
+  PIO pio;
+  uint state_machine;
+  uint program_offset;
+  uint drain_channel;
+  uint stamp_channel;
+  uint32_t edge_latency_us;
+  uint32_t read_index;
+  uint32_t captured_edges;
+  uint32_t last_edge_us;
+  zero_cross_capture_handler_t handler;
+  void *handler_context;
+} zero_cross_capture_context_t;
+
+static uint32_t g_zero_cross_ring[ZERO_CROSS_CAPTURE_RING_ENTRIES]
+    __attribute__((aligned(1u << ZERO_CROSS_CAPTURE_RING_BYTES_LOG2)));
+static uint32_t g_zero_cross_drain_sink;
+static zero_cross_capture_context_t g_zero_cross_capture;
+
+static uint32_t __not_in_flash_func(zero_cross_capture_write_index)(void) {
+  const uintptr_t write_address =
+      (uintptr_t)dma_hw->ch[g_zero_cross_capture.stamp_channel].write_addr;
+
+  return (uint32_t)((write_address - (uintptr_t)&g_zero_cross_ring[0]) /
+                    sizeof(g_zero_cross_ring[0])) %
+         ZERO_CROSS_CAPTURE_RING_ENTRIES;
+}
+
+static void __not_in_flash_func(zero_cross_capture_irq_handler)(void) {
+  zero_cross_capture_context_t *context = &g_zero_cross_capture;
+  uint32_t write_index = 0u;
+
+  if (!pio_interrupt_get(context->pio, context->state_machine)) {
+    return;
+  }
+  pio_interrupt_clear(context->pio, context->state_machine);
+
+  write_index = zero_cross_capture_write_index();
+  while (context->read_index != write_index) {
+    const uint32_t edge_us =
+        g_zero_cross_ring[context->read_index] - context->edge_latency_us;
+
+    context->read_index =
+        (context->read_index + 1u) % ZERO_CROSS_CAPTURE_RING_ENTRIES;
+    context->captured_edges++;
+    context->last_edge_us = edge_us;
+    if (context->handler != NULL) {
+      context->handler(edge_us, context->handler_context);
+    }
+  }
+}
+
+static void zero_cross_capture_configure_dma(zero_cross_capture_context_t *context,
+                                             timer_hw_t *timestamp_timer) {
+  dma_channel_config drain_config = dma_channel_get_default_config(context->drain_channel);
+  dma_channel_config stamp_config = dma_channel_get_default_config(context->stamp_channel);
+
+  // The drain channel empties the RX FIFO the instant the SM pushes and
+  // chains to the stamp channel, which copies the raw timer into the ring.
+  // The stamp channel chains back so the pair re-arms without CPU help.
+  channel_config_set_transfer_data_size(&drain_config, DMA_SIZE_32);
+  channel_config_set_read_increment(&drain_config, false);
+  channel_config_set_write_increment(&drain_config, false);
+  channel_config_set_dreq(&drain_config,
+                          pio_get_dreq(context->pio, context->state_machine, false));
+  channel_config_set_chain_to(&drain_config, context->stamp_channel);
+  channel_config_set_high_priority(&drain_config, true);
+
+  channel_config_set_transfer_data_size(&stamp_config, DMA_SIZE_32);
+  channel_config_set_read_increment(&stamp_config, false);
+  channel_config_set_write_increment(&stamp_config, true);
+  channel_config_set_ring(&stamp_config, true, ZERO_CROSS_CAPTURE_RING_BYTES_LOG2);
+  channel_config_set_dreq(&stamp_config, DREQ_FORCE);
+  channel_config_set_chain_to(&stamp_config, context->drain_channel);
+  channel_config_set_high_priority(&stamp_config, true);
+
+  dma_channel_configure(context->stamp_channel, &stamp_config, g_zero_cross_ring,
+                        &timestamp_timer->timerawl, 1u, false);
+  dma_channel_configure(context->drain_channel, &drain_config,
+                        &g_zero_cross_drain_sink,
+                        &context->pio->rxf[context->state_machine], 1u, true);
+}
+
+bool zero_cross_capture_init(const zero_cross_capture_config_t *config) {
+  zero_cross_capture_context_t *context = &g_zero_cross_capture;
+  pio_sm_config sm_config;
+  uint32_t filter_loops = 0u;
+  int drain_channel = -1;
+  int stamp_channel = -1;
+
+  if (config == NULL || context->running) {
+    return false;
+  }
+
+  *context = (zero_cross_capture_context_t){
+      .handler = config->handler,
+      .handler_context = config->handler_context,
+  };
+
+  if (!pio_claim_free_sm_and_add_program(&zero_cross_capture_program, &context->pio,
+                                         &context->state_machine,
+                                         &context->program_offset)) {
+    return false;
+  }
+
+  drain_channel = dma_claim_unused_channel(false);
+  stamp_channel = dma_claim_unused_channel(false);
+  if (drain_channel < 0 || stamp_channel < 0) {
+    if (drain_channel >= 0) {
+      dma_channel_unclaim((uint)drain_channel);
+    }
+    if (stamp_channel >= 0) {
+      dma_channel_unclaim((uint)stamp_channel);
+    }
+    pio_remove_program_and_unclaim_sm(&zero_cross_capture_program, context->pio,
+                                      context->state_machine,
+                                      context->program_offset);
+    return false;
+  }
+  context->drain_channel = (uint)drain_channel;
+  context->stamp_channel = (uint)stamp_channel;
+
+  filter_loops = (config->glitch_filter_us * APP_ZERO_CROSS_PIO_CLOCK_HZ / 1000000u) /
+                 ZERO_CROSS_CAPTURE_FILTER_LOOP_CYCLES;
+  context->edge_latency_us =
+      ((filter_loops + 1u) * ZERO_CROSS_CAPTURE_FILTER_LOOP_CYCLES +
+       ZERO_CROSS_CAPTURE_FIXED_CYCLES) *
+      1000000u / APP_ZERO_CROSS_PIO_CLOCK_HZ;
+
+  pio_gpio_init(context->pio, config->gpio);
+  gpio_set_dir(config->gpio, GPIO_IN);
+  if (config->pull_up) {
+    gpio_pull_up(config->gpio);
+  } else {
+    gpio_disable_pulls(config->gpio);
+  }
+  pio_sm_set_consecutive_pindirs(context->pio, context->state_machine, config->gpio,
+                                 1u, false);
+
+  sm_config = zero_cross_capture_program_get_default_config(context->program_offset);
+  sm_config_set_in_pins(&sm_config, config->gpio);
+  sm_config_set_jmp_pin(&sm_config, config->gpio);
+  sm_config_set_in_shift(&sm_config, false, false, 32u);
+  sm_config_set_clkdiv(&sm_config,
+                       (float)clock_get_hz(clk_sys) / (float)APP_ZERO_CROSS_PIO_CLOCK_HZ);
+  pio_sm_init(context->pio, context->state_machine, context->program_offset, &sm_config);
+
+  zero_cross_capture_configure_dma(
+      context, config->timestamp_timer != NULL ? config->timestamp_timer : timer_hw);
+
+  pio_interrupt_clear(context->pio, context->state_machine);
+  pio_set_irqn_source_enabled(context->pio, ZERO_CROSS_CAPTURE_PIO_IRQ_INDEX,
+                              (enum pio_interrupt_source)(pis_interrupt0 +
+                                                          context->state_machine),
+                              true);
+  irq_add_shared_handler(pio_get_irq_num(context->pio, ZERO_CROSS_CAPTURE_PIO_IRQ_INDEX),
+                         zero_cross_capture_irq_handler,
+                         PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY);
+  irq_set_enabled(pio_get_irq_num(context->pio, ZERO_CROSS_CAPTURE_PIO_IRQ_INDEX), true);
+
+  pio_sm_put_blocking(context->pio, context->state_machine, filter_loops);
+  pio_sm_set_enabled(context->pio, context->state_machine, true);
+  context->running = true;
+  return true;
+}
+
+void zero_cross_capture_get_stats(zero_cross_capture_stats_t *out_stats) {
+  uint32_t interrupt_state = 0u;
+
+  if (out_stats == NULL) {
+    return;
+  }
+
+  interrupt_state = save_and_disable_interrupts();
+  *out_stats = (zero_cross_capture_stats_t){
+      .running = g_zero_cross_capture.running,
+      .captured_edges = g_zero_cross_capture.captured_edges,
+      .last_edge_us = g_zero_cross_capture.last_edge_us,
+  };
+  restore_interrupts(interrupt_state);
+}
@@ -1,10 +1,17 @@
 #include "FreeRTOS.h"
+#include "app/app_config.h"
 #include "app/task_bootstrap.h"
 #include "pico/stdlib.h"
 #include "platform/runtime_faults.h"
+#include "shared_state.h"
 #include "task.h"
 #include <stdio.h>
 
+#if APP_DIMMER_ON_CORE1
+#include "core1_dimmer.h"
+#include "pico/multicore.h"
+#endif
+
 int main(void) {
   stdio_init_all();
 
@@ -18,6 +25,12 @@ int main(void) {
   runtime_install_fault_handlers();
   printf("Runtime handlers installed.\n");
 
+  shared_state_init();
+#if APP_DIMMER_ON_CORE1
+  multicore_launch_core1(core1_entry);
+  printf("Dimmer timing running on core1.\n");
+#endif
+
   if (app_create_default_tasks() != pdPASS) {
     runtime_panic("Task creation failed");
   }
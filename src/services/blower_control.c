@@ -34,6 +34,8 @@ typedef struct {
   uint32_t startup_boost_start_tick_ms;
   bool line_sync;
   float line_frequency_hz;
+  bool line_pll_locked;
+  float line_phase_error_us;
 } blower_control_state_t;
 
 static blower_control_state_t g_state;
@@ -189,6 +191,8 @@ static void blower_control_initialize_defaults(blower_control_state_t *state) {
       .startup_boost_start_tick_ms = 0u,
       .line_sync = false,
       .line_frequency_hz = 0.0f,
+      .line_pll_locked = false,
+      .line_phase_error_us = 0.0f,
   };
 }
 
@@ -457,12 +461,16 @@ uint8_t blower_control_step(float envelope_pressure_pa, bool measurement_valid,
   return g_state.output_pwm_percent;
 }
 
-void blower_control_update_line_feedback(bool line_sync, float line_frequency_hz) {
+void blower_control_update_line_feedback(bool line_sync, float line_frequency_hz,
+                                         bool line_pll_locked,
+                                         float line_phase_error_us) {
   uint32_t irq_state = save_and_disable_interrupts();
   blower_control_ensure_initialized_locked();
 
   g_state.line_sync = line_sync;
   g_state.line_frequency_hz = line_frequency_hz >= 0.0f ? line_frequency_hz : 0.0f;
+  g_state.line_pll_locked = line_pll_locked;
+  g_state.line_phase_error_us = line_phase_error_us >= 0.0f ? line_phase_error_us : 0.0f;
 
   restore_interrupts(irq_state);
 }
@@ -490,6 +498,8 @@ void blower_control_get_snapshot(blower_control_snapshot_t *out_snapshot) {
       .pd_max_step_percent = g_state.pd_max_step_percent,
       .line_sync = g_state.line_sync,
       .line_frequency_hz = g_state.line_frequency_hz,
+      .line_pll_locked = g_state.line_pll_locked,
+      .line_phase_error_us = g_state.line_phase_error_us,
   };
 
   restore_interrupts(irq_state);
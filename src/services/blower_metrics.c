@@ -3,6 +3,7 @@
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include "task.h"
+#include <math.h>
 #include <string.h>
 
 #define CALIBRATION_DURATION_MS 10000u
@@ -263,6 +264,31 @@ bool blower_metrics_service_capture_zero_offsets(void) {
   return captured;
 }
 
+bool blower_metrics_service_shift_envelope_zero(float residual_pa) {
+  blower_metrics_snapshot_t *snapshot = &g_service_context.snapshot;
+
+  if (g_service_context.mutex == NULL || !g_service_context.is_initialized ||
+      isnan(residual_pa)) {
+    return false;
+  }
+
+  if (xSemaphoreTake(g_service_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return false;
+  }
+
+  g_service_context.envelope_pressure_offset_pa += residual_pa;
+  snapshot->envelope_pressure_pa -= residual_pa;
+  snapshot->calibration_envelope_offset = g_service_context.envelope_pressure_offset_pa;
+  snapshot->estimated_air_leakage_units = g_service_context.models.air_leakage_model(
+      snapshot->fan_speed_units, snapshot->envelope_pressure_pa,
+      g_service_context.models.air_leakage_model_context);
+  snapshot->update_sequence += 1u;
+  snapshot->last_update_tick = (uint32_t)xTaskGetTickCount();
+
+  xSemaphoreGive(g_service_context.mutex);
+  return true;
+}
+
 void blower_metrics_service_begin_calibration(void) {
   if (g_service_context.mutex == NULL || !g_service_context.is_initialized) {
     return;
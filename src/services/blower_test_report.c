@@ -0,0 +1,466 @@
+#include "services/blower_test_report.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BLOWER_TEST_REPORT_MAGIC 0x5242u
+#define BLOWER_TEST_REPORT_FLAG_HAS_PRESSURIZATION 0x01u
+#define BLOWER_TEST_REPORT_FLAG_HAS_DEPRESSURIZATION 0x02u
+#define BLOWER_TEST_REPORT_SECTION_FLAG_CONFIDENCE_STOP 0x01u
+
+typedef struct {
+  uint8_t *data;
+  uint32_t capacity;
+  uint32_t offset;
+  bool ok;
+} blower_test_report_writer_t;
+
+static void blower_test_report_put_u8(blower_test_report_writer_t *writer, uint8_t value) {
+  if (writer->offset >= writer->capacity) {
+    writer->ok = false;
+    return;
+  }
+  writer->data[writer->offset++] = value;
+}
+
+static void blower_test_report_put_u16(blower_test_report_writer_t *writer,
+                                       uint16_t value) {
+  blower_test_report_put_u8(writer, (uint8_t)(value & 0xffu));
+  blower_test_report_put_u8(writer, (uint8_t)(value >> 8));
+}
+
+static void blower_test_report_put_u32(blower_test_report_writer_t *writer,
+                                       uint32_t value) {
+  blower_test_report_put_u16(writer, (uint16_t)(value & 0xffffu));
+  blower_test_report_put_u16(writer, (uint16_t)(value >> 16));
+}
+
+static void blower_test_report_put_f32(blower_test_report_writer_t *writer, float value) {
+  uint32_t bits = 0u;
+
+  memcpy(&bits, &value, sizeof(bits));
+  blower_test_report_put_u32(writer, bits);
+}
+
+static uint16_t blower_test_report_quantize_u16(float value, float scale) {
+  const float scaled = value * scale;
+
+  if (!isfinite(scaled) || scaled <= 0.0f) {
+    return 0u;
+  }
+  return scaled >= 65535.0f ? 0xffffu : (uint16_t)lrintf(scaled);
+}
+
+static int16_t blower_test_report_quantize_i16(float value, float scale) {
+  const float scaled = value * scale;
+
+  if (!isfinite(scaled)) {
+    return 0;
+  }
+  if (scaled >= 32767.0f) {
+    return INT16_MAX;
+  }
+  if (scaled <= -32768.0f) {
+    return INT16_MIN;
+  }
+  return (int16_t)lrintf(scaled);
+}
+
+static uint16_t blower_test_report_get_u16(const uint8_t *data) {
+  return (uint16_t)(data[0] | ((uint16_t)data[1] << 8));
+}
+
+static uint32_t blower_test_report_get_u32(const uint8_t *data) {
+  return (uint32_t)blower_test_report_get_u16(data) |
+         ((uint32_t)blower_test_report_get_u16(data + 2) << 16);
+}
+
+static float blower_test_report_get_f32(const uint8_t *data) {
+  const uint32_t bits = blower_test_report_get_u32(data);
+  float value = 0.0f;
+
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static void blower_test_report_put_summary(blower_test_report_writer_t *writer,
+                                           const blower_test_curve_summary_t *summary) {
+  blower_test_report_put_f32(writer, summary->cl_m3h_pan);
+  blower_test_report_put_f32(writer, summary->exponent_n);
+  blower_test_report_put_f32(writer, summary->correlation_r);
+  blower_test_report_put_f32(writer, summary->q_ref_m3h);
+  blower_test_report_put_f32(writer, summary->ach_ref_h1);
+  blower_test_report_put_f32(writer, summary->w_ref_m3h_m2);
+  blower_test_report_put_f32(writer, summary->q_ref_envelope_m3h_m2);
+  blower_test_report_put_f32(writer, summary->eqla10_cm2);
+  blower_test_report_put_f32(writer, summary->eqla10_cm2_per_m2_envelope);
+  blower_test_report_put_f32(writer, summary->lbl_ela4_cm2);
+  blower_test_report_put_f32(writer, summary->lbl_ela4_cm2_per_m2_envelope);
+  blower_test_report_put_f32(writer, summary->uncertainty_pct);
+  blower_test_report_put_f32(writer, summary->cl_ci_low_m3h_pan);
+  blower_test_report_put_f32(writer, summary->cl_ci_high_m3h_pan);
+  blower_test_report_put_f32(writer, summary->exponent_n_ci_low);
+  blower_test_report_put_f32(writer, summary->exponent_n_ci_high);
+  blower_test_report_put_f32(writer, summary->q_ref_ci_low_m3h);
+  blower_test_report_put_f32(writer, summary->q_ref_ci_high_m3h);
+  blower_test_report_put_u8(writer, summary->downweighted_points);
+  blower_test_report_put_u8(writer, summary->valid ? 1u : 0u);
+}
+
+static void blower_test_report_read_summary(const uint8_t *data,
+                                            blower_test_curve_summary_t *out_summary) {
+  *out_summary = (blower_test_curve_summary_t){
+      .cl_m3h_pan = blower_test_report_get_f32(data + 0),
+      .exponent_n = blower_test_report_get_f32(data + 4),
+      .correlation_r = blower_test_report_get_f32(data + 8),
+      .q_ref_m3h = blower_test_report_get_f32(data + 12),
+      .ach_ref_h1 = blower_test_report_get_f32(data + 16),
+      .w_ref_m3h_m2 = blower_test_report_get_f32(data + 20),
+      .q_ref_envelope_m3h_m2 = blower_test_report_get_f32(data + 24),
+      .eqla10_cm2 = blower_test_report_get_f32(data + 28),
+      .eqla10_cm2_per_m2_envelope = blower_test_report_get_f32(data + 32),
+      .lbl_ela4_cm2 = blower_test_report_get_f32(data + 36),
+      .lbl_ela4_cm2_per_m2_envelope = blower_test_report_get_f32(data + 40),
+      .uncertainty_pct = blower_test_report_get_f32(data + 44),
+      .cl_ci_low_m3h_pan = blower_test_report_get_f32(data + 48),
+      .cl_ci_high_m3h_pan = blower_test_report_get_f32(data + 52),
+      .exponent_n_ci_low = blower_test_report_get_f32(data + 56),
+      .exponent_n_ci_high = blower_test_report_get_f32(data + 60),
+      .q_ref_ci_low_m3h = blower_test_report_get_f32(data + 64),
+      .q_ref_ci_high_m3h = blower_test_report_get_f32(data + 68),
+      .downweighted_points = data[72],
+      .valid = data[73] != 0u,
+  };
+}
+
+static void blower_test_report_put_point(blower_test_report_writer_t *writer,
+                                         const blower_test_point_result_t *point) {
+  blower_test_report_put_u16(writer,
+                             blower_test_report_quantize_u16(point->target_pressure_pa, 10.0f));
+  blower_test_report_put_u16(writer,
+                             blower_test_report_quantize_u16(point->avg_pressure_pa, 100.0f));
+  blower_test_report_put_f32(writer, point->avg_fan_flow_m3h);
+  blower_test_report_put_u16(writer, (uint16_t)blower_test_report_quantize_i16(
+                                         point->avg_fan_temperature_c, 100.0f));
+  blower_test_report_put_u16(writer, (uint16_t)blower_test_report_quantize_i16(
+                                         point->avg_envelope_temperature_c, 100.0f));
+  blower_test_report_put_u16(writer,
+                             blower_test_report_quantize_u16(point->avg_pwm_percent, 100.0f));
+  blower_test_report_put_u16(writer,
+                             blower_test_report_quantize_u16(point->settle_time_s, 10.0f));
+  blower_test_report_put_u16(
+      writer, blower_test_report_quantize_u16(point->pressure_std_error_pa, 1000.0f));
+  blower_test_report_put_f32(writer, point->flow_std_error_m3h);
+  blower_test_report_put_u16(writer,
+                             blower_test_report_quantize_u16(point->log_flow_ci_pct, 100.0f));
+  blower_test_report_put_u16(writer, point->sample_count);
+  blower_test_report_put_u16(writer, point->raw_sample_count);
+  blower_test_report_put_u8(writer, point->valid ? 1u : 0u);
+}
+
+static void blower_test_report_read_point(const uint8_t *data,
+                                          blower_test_point_result_t *out_point) {
+  *out_point = (blower_test_point_result_t){
+      .target_pressure_pa = (float)blower_test_report_get_u16(data + 0) / 10.0f,
+      .avg_pressure_pa = (float)blower_test_report_get_u16(data + 2) / 100.0f,
+      .avg_fan_flow_m3h = blower_test_report_get_f32(data + 4),
+      .avg_fan_temperature_c =
+          (float)(int16_t)blower_test_report_get_u16(data + 8) / 100.0f,
+      .avg_envelope_temperature_c =
+          (float)(int16_t)blower_test_report_get_u16(data + 10) / 100.0f,
+      .avg_pwm_percent = (float)blower_test_report_get_u16(data + 12) / 100.0f,
+      .settle_time_s = (float)blower_test_report_get_u16(data + 14) / 10.0f,
+      .pressure_std_error_pa = (float)blower_test_report_get_u16(data + 16) / 1000.0f,
+      .flow_std_error_m3h = blower_test_report_get_f32(data + 18),
+      .log_flow_ci_pct = (float)blower_test_report_get_u16(data + 22) / 100.0f,
+      .sample_count = blower_test_report_get_u16(data + 24),
+      .raw_sample_count = blower_test_report_get_u16(data + 26),
+      .valid = data[28] != 0u,
+  };
+}
+
+static bool blower_test_report_section_present(const blower_test_direction_report_t *section) {
+  return section->direction != BLOWER_TEST_DIRECTION_NONE || section->point_count > 0u;
+}
+
+static void blower_test_report_put_section(blower_test_report_writer_t *writer,
+                                           blower_test_direction_t direction,
+                                           const blower_test_direction_report_t *section) {
+  const uint8_t point_count = section->point_count <= BLOWER_TEST_MAX_PRESSURE_POINTS
+                                  ? section->point_count
+                                  : BLOWER_TEST_MAX_PRESSURE_POINTS;
+  uint8_t index = 0u;
+
+  blower_test_report_put_u8(writer, (uint8_t)direction);
+  blower_test_report_put_u8(writer, point_count);
+  blower_test_report_put_u8(
+      writer, section->confidence_stop ? BLOWER_TEST_REPORT_SECTION_FLAG_CONFIDENCE_STOP
+                                       : 0u);
+  blower_test_report_put_summary(writer, &section->summary);
+  for (index = 0u; index < point_count; ++index) {
+    blower_test_report_put_point(writer, &section->points[index]);
+  }
+}
+
+uint32_t blower_test_report_encode(const blower_test_report_t *report, uint8_t *out_data,
+                                   uint32_t capacity) {
+  blower_test_report_writer_t writer = {
+      .data = out_data,
+      .capacity = capacity,
+      .ok = true,
+  };
+  bool has_press_section = false;
+  bool has_depress_section = false;
+  uint32_t source_distance = 0u;
+
+  if (report == NULL || out_data == NULL) {
+    return 0u;
+  }
+  if (report->source_report_id != 0u) {
+    source_distance = report->report_id - report->source_report_id;
+    if (source_distance == 0u || source_distance > UINT16_MAX) {
+      return 0u;
+    }
+  }
+
+  has_press_section = blower_test_report_section_present(&report->pressurization);
+  has_depress_section = blower_test_report_section_present(&report->depressurization);
+
+  blower_test_report_put_u16(&writer, BLOWER_TEST_REPORT_MAGIC);
+  blower_test_report_put_u8(&writer, BLOWER_TEST_REPORT_FORMAT_VERSION);
+  blower_test_report_put_u8(
+      &writer,
+      (uint8_t)((report->has_pressurization ? BLOWER_TEST_REPORT_FLAG_HAS_PRESSURIZATION
+                                            : 0u) |
+                (report->has_depressurization
+                     ? BLOWER_TEST_REPORT_FLAG_HAS_DEPRESSURIZATION
+                     : 0u)));
+  blower_test_report_put_u32(&writer, report->report_id);
+  blower_test_report_put_u32(&writer, report->completed_tick_ms);
+  blower_test_report_put_u8(&writer, report->reference_pressure_pa);
+  blower_test_report_put_u8(&writer, (uint8_t)((has_press_section ? 0x01u : 0u) |
+                                               (has_depress_section ? 0x02u : 0u)));
+  blower_test_report_put_u16(&writer, (uint16_t)source_distance);
+  blower_test_report_put_summary(&writer, &report->mean_summary);
+  if (has_press_section) {
+    blower_test_report_put_section(&writer, BLOWER_TEST_DIRECTION_PRESSURIZATION,
+                                   &report->pressurization);
+  }
+  if (has_depress_section) {
+    blower_test_report_put_section(&writer, BLOWER_TEST_DIRECTION_DEPRESSURIZATION,
+                                   &report->depressurization);
+  }
+
+  return writer.ok ? writer.offset : 0u;
+}
+
+// Finds the section of a direction; sections are stored pressurization first.
+static bool blower_test_report_find_section(const blower_test_report_view_t *view,
+                                            blower_test_direction_t direction,
+                                            uint32_t *out_offset, uint8_t *out_point_count) {
+  const uint8_t section_mask = view->data[13];
+  uint32_t offset = BLOWER_TEST_REPORT_HEADER_BYTES + BLOWER_TEST_REPORT_SUMMARY_BYTES;
+  uint8_t bit = 0u;
+
+  for (bit = 0u; bit < 2u; ++bit) {
+    uint8_t point_count = 0u;
+
+    if ((section_mask & (1u << bit)) == 0u) {
+      continue;
+    }
+    if (offset + BLOWER_TEST_REPORT_SECTION_HEADER_BYTES + BLOWER_TEST_REPORT_SUMMARY_BYTES >
+        view->length) {
+      return false;
+    }
+
+    point_count = view->data[offset + 1u];
+    if (point_count > BLOWER_TEST_MAX_PRESSURE_POINTS ||
+        offset + BLOWER_TEST_REPORT_SECTION_HEADER_BYTES +
+                BLOWER_TEST_REPORT_SUMMARY_BYTES +
+                (uint32_t)point_count * BLOWER_TEST_REPORT_POINT_BYTES >
+            view->length) {
+      return false;
+    }
+    if (view->data[offset] == (uint8_t)direction) {
+      *out_offset = offset;
+      *out_point_count = point_count;
+      return true;
+    }
+    offset += BLOWER_TEST_REPORT_SECTION_HEADER_BYTES + BLOWER_TEST_REPORT_SUMMARY_BYTES +
+              (uint32_t)point_count * BLOWER_TEST_REPORT_POINT_BYTES;
+  }
+  return false;
+}
+
+bool blower_test_report_view_init(blower_test_report_view_t *view, const void *data,
+                                  uint32_t length) {
+  const uint8_t *bytes = (const uint8_t *)data;
+
+  if (view == NULL || data == NULL ||
+      length < BLOWER_TEST_REPORT_HEADER_BYTES + BLOWER_TEST_REPORT_SUMMARY_BYTES ||
+      length > BLOWER_TEST_REPORT_MAX_ENCODED_BYTES ||
+      blower_test_report_get_u16(bytes) != BLOWER_TEST_REPORT_MAGIC ||
+      bytes[2] != BLOWER_TEST_REPORT_FORMAT_VERSION) {
+    return false;
+  }
+
+  *view = (blower_test_report_view_t){
+      .data = bytes,
+      .length = length,
+  };
+  return true;
+}
+
+bool blower_test_report_get_header(const blower_test_report_view_t *view,
+                                   blower_test_report_header_t *out_header) {
+  uint32_t report_id = 0u;
+  uint16_t source_distance = 0u;
+
+  if (view == NULL || view->data == NULL || out_header == NULL) {
+    return false;
+  }
+
+  report_id = blower_test_report_get_u32(view->data + 4);
+  source_distance = blower_test_report_get_u16(view->data + 14);
+  *out_header = (blower_test_report_header_t){
+      .report_id = report_id,
+      .source_report_id = source_distance != 0u ? report_id - source_distance : 0u,
+      .completed_tick_ms = blower_test_report_get_u32(view->data + 8),
+      .reference_pressure_pa = view->data[12],
+      .has_pressurization =
+          (view->data[3] & BLOWER_TEST_REPORT_FLAG_HAS_PRESSURIZATION) != 0u,
+      .has_depressurization =
+          (view->data[3] & BLOWER_TEST_REPORT_FLAG_HAS_DEPRESSURIZATION) != 0u,
+  };
+  return true;
+}
+
+bool blower_test_report_get_summary(const blower_test_report_view_t *view,
+                                    blower_test_direction_t direction,
+                                    blower_test_curve_summary_t *out_summary) {
+  uint32_t offset = 0u;
+  uint8_t point_count = 0u;
+
+  if (view == NULL || view->data == NULL || out_summary == NULL) {
+    return false;
+  }
+
+  if (direction == BLOWER_TEST_DIRECTION_NONE) {
+    blower_test_report_read_summary(view->data + BLOWER_TEST_REPORT_HEADER_BYTES,
+                                    out_summary);
+    return true;
+  }
+  if (!blower_test_report_find_section(view, direction, &offset, &point_count)) {
+    return false;
+  }
+  blower_test_report_read_summary(
+      view->data + offset + BLOWER_TEST_REPORT_SECTION_HEADER_BYTES, out_summary);
+  return true;
+}
+
+bool blower_test_report_get_direction(const blower_test_report_view_t *view,
+                                      blower_test_direction_t direction,
+                                      blower_test_report_direction_info_t *out_info) {
+  uint32_t offset = 0u;
+  uint8_t point_count = 0u;
+
+  if (view == NULL || view->data == NULL || out_info == NULL ||
+      !blower_test_report_find_section(view, direction, &offset, &point_count)) {
+    return false;
+  }
+
+  *out_info = (blower_test_report_direction_info_t){
+      .direction = direction,
+      .point_count = point_count,
+      .confidence_stop = (view->data[offset + 2u] &
+                          BLOWER_TEST_REPORT_SECTION_FLAG_CONFIDENCE_STOP) != 0u,
+  };
+  return true;
+}
+
+bool blower_test_report_points_begin(const blower_test_report_view_t *view,
+                                     blower_test_direction_t direction,
+                                     blower_test_report_point_iter_t *out_iter) {
+  uint32_t offset = 0u;
+  uint8_t point_count = 0u;
+
+  if (out_iter == NULL) {
+    return false;
+  }
+  *out_iter = (blower_test_report_point_iter_t){0};
+  if (view == NULL || view->data == NULL ||
+      !blower_test_report_find_section(view, direction, &offset, &point_count)) {
+    return false;
+  }
+
+  *out_iter = (blower_test_report_point_iter_t){
+      .data = view->data,
+      .end = view->length,
+      .offset = offset + BLOWER_TEST_REPORT_SECTION_HEADER_BYTES +
+                BLOWER_TEST_REPORT_SUMMARY_BYTES,
+      .remaining = point_count,
+  };
+  return true;
+}
+
+bool blower_test_report_points_next(blower_test_report_point_iter_t *iter,
+                                    blower_test_point_result_t *out_point) {
+  if (iter == NULL || out_point == NULL || iter->remaining == 0u ||
+      iter->offset + BLOWER_TEST_REPORT_POINT_BYTES > iter->end) {
+    return false;
+  }
+
+  blower_test_report_read_point(iter->data + iter->offset, out_point);
+  iter->offset += BLOWER_TEST_REPORT_POINT_BYTES;
+  iter->remaining = (uint8_t)(iter->remaining - 1u);
+  return true;
+}
+
+static void blower_test_report_decode_section(const blower_test_report_view_t *view,
+                                              blower_test_direction_t direction,
+                                              blower_test_direction_report_t *out_section) {
+  blower_test_report_direction_info_t info = {0};
+  blower_test_report_point_iter_t iter = {0};
+
+  *out_section = (blower_test_direction_report_t){0};
+  if (!blower_test_report_get_direction(view, direction, &info)) {
+    return;
+  }
+
+  out_section->direction = direction;
+  out_section->confidence_stop = info.confidence_stop;
+  (void)blower_test_report_get_summary(view, direction, &out_section->summary);
+  (void)blower_test_report_points_begin(view, direction, &iter);
+  while (out_section->point_count < BLOWER_TEST_MAX_PRESSURE_POINTS &&
+         blower_test_report_points_next(&iter,
+                                        &out_section->points[out_section->point_count])) {
+    out_section->point_count += 1u;
+  }
+}
+
+bool blower_test_report_decode(const blower_test_report_view_t *view,
+                               blower_test_report_t *out_report) {
+  blower_test_report_header_t header = {0};
+
+  if (out_report == NULL || !blower_test_report_get_header(view, &header)) {
+    return false;
+  }
+
+  *out_report = (blower_test_report_t){
+      .report_id = header.report_id,
+      .source_report_id = header.source_report_id,
+      .completed_tick_ms = header.completed_tick_ms,
+      .reference_pressure_pa = header.reference_pressure_pa,
+      .has_pressurization = header.has_pressurization,
+      .has_depressurization = header.has_depressurization,
+  };
+  (void)blower_test_report_get_summary(view, BLOWER_TEST_DIRECTION_NONE,
+                                       &out_report->mean_summary);
+  blower_test_report_decode_section(view, BLOWER_TEST_DIRECTION_PRESSURIZATION,
+                                    &out_report->pressurization);
+  blower_test_report_decode_section(view, BLOWER_TEST_DIRECTION_DEPRESSURIZATION,
+                                    &out_report->depressurization);
+  return true;
+}
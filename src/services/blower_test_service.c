@@ -2,19 +2,26 @@
 
 #include "FreeRTOS.h"
 #include "app/app_config.h"
-#include "hardware/flash.h"
-#include "hardware/regs/addressmap.h"
-#include "hardware/sync.h"
 #include "semphr.h"
+#include "services/blower_control.h"
+#include "services/blower_metrics.h"
+#include "services/flash_journal.h"
+#include "services/leakage_regression.h"
+#include "services/steady_state_detector.h"
+#include "services/test_sample_store.h"
 #include "task.h"
 #include <math.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
-#define BLOWER_TEST_STORAGE_MAGIC 0x42544452u /* BTDR */
-#define BLOWER_TEST_STORAGE_VERSION 1u
-#define BLOWER_TEST_STORAGE_FILL_BYTE 0xffu
+#define BLOWER_TEST_STORAGE_VERSION 8u
+#define BLOWER_TEST_RECORD_CONFIG 1u
+#define BLOWER_TEST_RECORD_REPORT 2u
+// Raw samples of a measured test, keyed (slot << 8) | chunk.
+#define BLOWER_TEST_RECORD_RAW 3u
+// Sample store image bytes per raw record; a record must fit in one sector.
+#define BLOWER_TEST_RAW_CHUNK_BYTES 3840u
 
 #define BLOWER_TEST_FULL_APERTURE_DIAMETER_CM 31.0f
 #define BLOWER_TEST_SEA_LEVEL_AIR_DENSITY 1.225f
@@ -30,40 +37,106 @@
 #define BLOWER_TEST_MIN_MEASURE_TIME_S 2u
 #define BLOWER_TEST_MAX_MEASURE_TIME_S 300u
 #define BLOWER_TEST_DEFAULT_MIN_POINTS 5u
+#define BLOWER_TEST_MAX_TARGET_CI_PCT 50.0f
+#define BLOWER_TEST_MAX_TARGET_ACH_H1 50.0f
+// Maps pressure uncertainty onto log(Q) before the point's exponent is known.
+#define BLOWER_TEST_NOMINAL_FLOW_EXPONENT 0.65f
 
 typedef struct {
-  uint32_t magic;
-  uint16_t version;
-  uint16_t payload_size;
-  uint32_t sequence;
-  blower_test_config_t config;
-  uint8_t history_count;
-  uint8_t history_head;
-  uint16_t reserved0;
-  blower_test_report_t history[BLOWER_TEST_HISTORY_CAPACITY];
-  uint32_t crc32;
-} blower_test_persistent_blob_t;
+  uint32_t start_tick_ms;
+  float pressure_sum_pa;
+  float flow_sum_m3h;
+  uint16_t samples;
+  uint16_t count;
+  float pressure_mean_pa;
+  float pressure_m2;
+  float flow_mean_m3h;
+  float flow_m2;
+} blower_test_block_stats_t;
+
+typedef struct {
+  blower_test_queue_state_t state;
+  uint8_t run_count;
+  uint8_t current_run;
+  blower_test_config_t configs[BLOWER_TEST_QUEUE_MAX_RUNS];
+  blower_test_queue_run_t runs[BLOWER_TEST_QUEUE_MAX_RUNS];
+  // Restored when the queue ends; runs swap in their own config.
+  blower_test_config_t operator_config;
+  bool baseline_sampling;
+  uint32_t baseline_start_tick_ms;
+  float baseline_sum_pa;
+  uint16_t baseline_samples;
+} blower_test_queue_t;
+
+// Leads every raw record. A slot holds one test: chunk_count records, keyed
+// by chunk, each with the next BLOWER_TEST_RAW_CHUNK_BYTES of the image.
+typedef struct {
+  uint32_t report_id;
+  uint32_t image_size;
+  uint16_t block_bytes;
+  uint8_t chunk;
+  uint8_t chunk_count;
+} blower_test_raw_chunk_header_t;
+
+_Static_assert((APP_TEST_RAW_STORE_BYTES + BLOWER_TEST_RAW_CHUNK_BYTES) /
+                       BLOWER_TEST_RAW_CHUNK_BYTES <=
+                   255u,
+               "APP_TEST_RAW_STORE_BYTES needs more raw chunks than a key holds");
 
 typedef struct {
   SemaphoreHandle_t mutex;
+  // Serializes flash_journal calls. Taken inside mutex, or alone by the report
+  // append, never the other way round.
+  SemaphoreHandle_t journal_mutex;
   bool initialized;
   bool persistence_available;
 
   blower_test_config_t config;
   blower_test_runtime_status_t runtime;
 
+  // Working form of the running test; scratch space while idle.
   blower_test_report_t active_report;
-  blower_test_report_t latest_report;
   bool has_latest_report;
+  uint32_t latest_report_id;
+  float latest_ach_ref_h1;
   uint32_t next_report_id;
-
-  blower_test_report_t history[BLOWER_TEST_HISTORY_CAPACITY];
-  uint8_t history_count;
-  uint8_t history_head;
+  // Encoded running test, or the latest report once it completes. Readers
+  // use it without the mutex; the sequence is odd while it is rewritten.
+  uint8_t report_slot[BLOWER_TEST_REPORT_MAX_ENCODED_BYTES];
+  uint32_t report_slot_length;
+  uint32_t report_slot_id;
+  bool report_slot_active;
+  volatile uint32_t report_slot_sequence;
+  // Copy of the slot waiting to be appended to the journal. The append runs
+  // without the mutex: a page program can wait for a dimmer window and a
+  // compaction erases a sector, which must not stall the status routes.
+  uint8_t persist_buffer[BLOWER_TEST_REPORT_MAX_ENCODED_BYTES];
+  uint32_t persist_length;
+  uint32_t persist_id;
+  bool persist_ready;
+  bool persist_busy;
+  // Requested while an append was running, or while an older report waits
+  // for its retry; the slot is copied afterwards.
+  bool persist_pending;
+  // When the last failed append was tried; runtime.persist_failed is set.
+  uint32_t persist_retry_tick_ms;
+  // Bumped per applied config change (mutex); the newest one appended so far
+  // (journal_mutex).
+  uint32_t config_sequence;
+  uint32_t config_stored_sequence;
+  // Measured report whose raw samples are being appended to the journal, one
+  // chunk per flush; 0 when none. Cleared when the next test resets the store.
+  uint32_t raw_persist_report_id;
+  uint32_t raw_persist_size;
+  uint8_t raw_persist_chunk;
+  uint8_t raw_persist_slot;
+  uint8_t raw_chunk[sizeof(blower_test_raw_chunk_header_t) + BLOWER_TEST_RAW_CHUNK_BYTES];
 
   uint32_t state_enter_tick_ms;
   uint32_t stable_since_tick_ms;
   uint32_t measure_start_tick_ms;
+  uint32_t point_settle_ms;
+  steady_state_detector_t steady_detector;
 
   float acc_pressure_pa;
   float acc_fan_flow_m3h;
@@ -71,18 +144,21 @@ typedef struct {
   float acc_envelope_temp_c;
   float acc_pwm_percent;
   uint16_t acc_samples;
+  blower_test_block_stats_t blocks;
+  test_sample_t raw_window;
+  uint32_t raw_window_start_tick_ms;
+  uint16_t raw_window_samples;
+  // Measured report whose raw samples test_sample_store holds.
+  uint32_t raw_report_id;
 
   blower_test_direction_t direction_sequence[2];
   uint8_t direction_count;
   uint8_t direction_slot;
+
+  blower_test_queue_t queue;
 } blower_test_context_t;
 
 static blower_test_context_t g_context;
-static uint8_t g_storage_image_buffer[APP_PERSISTENT_STORAGE_SIZE_BYTES];
-
-_Static_assert(
-    sizeof(blower_test_persistent_blob_t) <= APP_PERSISTENT_STORAGE_SIZE_BYTES,
-    "Persistent blob is larger than APP_PERSISTENT_STORAGE_SIZE_BYTES");
 
 static float blower_test_absf(float value) {
   return value >= 0.0f ? value : -value;
@@ -98,133 +174,6 @@ static float blower_test_clampf(float value, float min_value, float max_value) {
   return value;
 }
 
-static uint32_t blower_test_crc32_update(uint32_t crc, const uint8_t *data,
-                                         size_t data_len) {
-  uint32_t value = crc;
-  size_t index = 0u;
-
-  if (data == NULL) {
-    return value;
-  }
-
-  for (index = 0u; index < data_len; ++index) {
-    uint32_t bit = 0u;
-    value ^= data[index];
-    for (bit = 0u; bit < 8u; ++bit) {
-      const uint32_t mask = (uint32_t)-(int32_t)(value & 1u);
-      value = (value >> 1u) ^ (0xedb88320u & mask);
-    }
-  }
-
-  return value;
-}
-
-static uint32_t blower_test_crc32_for_blob(
-    const blower_test_persistent_blob_t *blob) {
-  const size_t payload_size =
-      offsetof(blower_test_persistent_blob_t, crc32);
-  return blower_test_crc32_update(0xffffffffu, (const uint8_t *)blob,
-                                  payload_size) ^
-         0xffffffffu;
-}
-
-static bool blower_test_storage_layout_is_valid(void) {
-  const uint32_t storage_end =
-      APP_PERSISTENT_STORAGE_OFFSET_BYTES + APP_PERSISTENT_STORAGE_SIZE_BYTES;
-
-  if (APP_PERSISTENT_STORAGE_SIZE_BYTES == 0u) {
-    return false;
-  }
-  if ((APP_PERSISTENT_STORAGE_OFFSET_BYTES % FLASH_SECTOR_SIZE) != 0u) {
-    return false;
-  }
-  if ((APP_PERSISTENT_STORAGE_SIZE_BYTES % FLASH_SECTOR_SIZE) != 0u) {
-    return false;
-  }
-  if ((APP_PERSISTENT_STORAGE_SIZE_BYTES % FLASH_PAGE_SIZE) != 0u) {
-    return false;
-  }
-  if (APP_PERSISTENT_STORAGE_OFFSET_BYTES >= PICO_FLASH_SIZE_BYTES ||
-      storage_end > PICO_FLASH_SIZE_BYTES) {
-    return false;
-  }
-
-  return true;
-}
-
-static bool blower_test_storage_verify(const uint8_t *expected_data,
-                                       size_t verify_len) {
-  const volatile uint8_t *flash_bytes =
-      (const volatile uint8_t *)(XIP_BASE + APP_PERSISTENT_STORAGE_OFFSET_BYTES);
-  size_t index = 0u;
-
-  if (expected_data == NULL) {
-    return false;
-  }
-
-  for (index = 0u; index < verify_len; ++index) {
-    if (flash_bytes[index] != expected_data[index]) {
-      return false;
-    }
-  }
-
-  return true;
-}
-
-static bool blower_test_storage_program(const blower_test_persistent_blob_t *blob) {
-  uint32_t offset = 0u;
-  uint32_t irq_state = 0u;
-
-  if (blob == NULL || !blower_test_storage_layout_is_valid()) {
-    return false;
-  }
-
-  memset(g_storage_image_buffer, BLOWER_TEST_STORAGE_FILL_BYTE,
-         sizeof(g_storage_image_buffer));
-  memcpy(g_storage_image_buffer, blob, sizeof(*blob));
-
-  irq_state = save_and_disable_interrupts();
-  flash_range_erase(APP_PERSISTENT_STORAGE_OFFSET_BYTES,
-                    APP_PERSISTENT_STORAGE_SIZE_BYTES);
-
-  for (offset = 0u; offset < APP_PERSISTENT_STORAGE_SIZE_BYTES;
-       offset += FLASH_PAGE_SIZE) {
-    flash_range_program(APP_PERSISTENT_STORAGE_OFFSET_BYTES + offset,
-                        g_storage_image_buffer + offset, FLASH_PAGE_SIZE);
-  }
-  restore_interrupts(irq_state);
-
-  return blower_test_storage_verify(g_storage_image_buffer,
-                                    APP_PERSISTENT_STORAGE_SIZE_BYTES);
-}
-
-static bool blower_test_storage_load(blower_test_persistent_blob_t *out_blob) {
-  const volatile uint8_t *flash_ptr = NULL;
-  blower_test_persistent_blob_t loaded_blob = {0};
-  uint32_t expected_crc = 0u;
-
-  if (out_blob == NULL || !blower_test_storage_layout_is_valid()) {
-    return false;
-  }
-
-  flash_ptr = (const volatile uint8_t *)(XIP_BASE + APP_PERSISTENT_STORAGE_OFFSET_BYTES);
-  memcpy(&loaded_blob, (const void *)flash_ptr, sizeof(loaded_blob));
-
-  if (loaded_blob.magic != BLOWER_TEST_STORAGE_MAGIC ||
-      loaded_blob.version != BLOWER_TEST_STORAGE_VERSION ||
-      loaded_blob.payload_size != sizeof(loaded_blob)) {
-    return false;
-  }
-
-  expected_crc = blower_test_crc32_for_blob(&loaded_blob);
-  if (expected_crc != loaded_blob.crc32) {
-    return false;
-  }
-
-  *out_blob = loaded_blob;
-  return true;
-}
-
 static float blower_test_air_density_kg_m3(float altitude_m, float temperature_c) {
   const float clamped_altitude = blower_test_clampf(altitude_m, 0.0f, 6000.0f);
   const float pressure_pa =
@@ -292,7 +241,11 @@ static void blower_test_fill_default_config(blower_test_config_t *config) {
   config->fan_curve_n = APP_FAN_FLOW_EXPONENT_N;
   config->target_tolerance_pa = 2.0f;
   config->settle_time_s = 8u;
+  config->measure_min_time_s = 4u;
   config->measure_time_s = 10u;
+  config->measure_target_ci_pct = 1.0f;
+  config->target_ach_ref_h1 = 0.0f;
+  config->confidence_stop_enabled = false;
   config->reference_pressure_pa = 50u;
   config->min_points_required = BLOWER_TEST_DEFAULT_MIN_POINTS;
   config->enforce_iso_9972_rules = true;
@@ -347,7 +300,9 @@ static bool blower_test_validate_and_normalize_config(blower_test_config_t *conf
   if (!isfinite(config->fan_curve_n) || config->fan_curve_n <= 0.0f) {
     return false;
   }
-  if (!isfinite(config->target_tolerance_pa)) {
+  if (!isfinite(config->target_tolerance_pa) ||
+      !isfinite(config->measure_target_ci_pct) ||
+      !isfinite(config->target_ach_ref_h1)) {
     return false;
   }
 
@@ -360,6 +315,13 @@ static bool blower_test_validate_and_normalize_config(blower_test_config_t *conf
   config->measure_time_s = (uint16_t)blower_test_clampf(
       (float)config->measure_time_s, (float)BLOWER_TEST_MIN_MEASURE_TIME_S,
       (float)BLOWER_TEST_MAX_MEASURE_TIME_S);
+  config->measure_min_time_s = (uint16_t)blower_test_clampf(
+      (float)config->measure_min_time_s, (float)BLOWER_TEST_MIN_MEASURE_TIME_S,
+      (float)config->measure_time_s);
+  config->measure_target_ci_pct = blower_test_clampf(
+      config->measure_target_ci_pct, 0.0f, BLOWER_TEST_MAX_TARGET_CI_PCT);
+  config->target_ach_ref_h1 =
+      blower_test_clampf(config->target_ach_ref_h1, 0.0f, BLOWER_TEST_MAX_TARGET_ACH_H1);
   config->fan_aperture_cm =
       blower_test_clampf(config->fan_aperture_cm, 5.0f, 60.0f);
   config->altitude_m = blower_test_clampf(config->altitude_m, 0.0f, 6000.0f);
@@ -404,6 +366,17 @@ static void blower_test_set_state_locked(blower_test_state_t state,
   g_context.runtime.state_elapsed_ms = 0u;
 }
 
+static void blower_test_clear_provisional_locked(void) {
+  g_context.runtime.provisional_valid = false;
+  g_context.runtime.provisional_point_count = 0u;
+  g_context.runtime.provisional_exponent_n = 0.0f;
+  g_context.runtime.provisional_q_ref_m3h = 0.0f;
+  g_context.runtime.provisional_ach_ref_h1 = 0.0f;
+  g_context.runtime.provisional_ach_ci_low_h1 = 0.0f;
+  g_context.runtime.provisional_ach_ci_high_h1 = 0.0f;
+  g_context.runtime.provisional_verdict = BLOWER_TEST_VERDICT_NONE;
+}
+
 static blower_test_direction_report_t *blower_test_active_direction_report_locked(void) {
   if (g_context.runtime.current_direction ==
       BLOWER_TEST_DIRECTION_PRESSURIZATION) {
@@ -418,7 +391,165 @@ static blower_test_direction_report_t *blower_test_active_direction_report_locke
   return NULL;
 }
 
+static void blower_test_reset_steady_detector_locked(void) {
+  const steady_state_config_t steady_config = {
+      .window_ms = APP_TEST_STEADY_WINDOW_MS,
+      .min_samples = APP_TEST_STEADY_MIN_SAMPLES,
+      .max_pressure_drift_pa =
+          g_context.config.target_tolerance_pa * APP_TEST_STEADY_PRESSURE_DRIFT_RATIO,
+      .max_flow_drift_ratio = APP_TEST_STEADY_FLOW_DRIFT_RATIO,
+      .slope_t_quantile = APP_TEST_STEADY_SLOPE_T_QUANTILE,
+      .max_variance_ratio = APP_TEST_STEADY_MAX_VARIANCE_RATIO,
+  };
+
+  steady_state_reset(&g_context.steady_detector, &steady_config);
+}
+
+static void blower_test_block_reset(blower_test_block_stats_t *blocks,
+                                    uint32_t now_tick_ms) {
+  *blocks = (blower_test_block_stats_t){
+      .start_tick_ms = now_tick_ms,
+  };
+}
+
+static void blower_test_block_add(blower_test_block_stats_t *blocks,
+                                  uint32_t now_tick_ms, float pressure_pa,
+                                  float flow_m3h) {
+  float block_pressure_pa = 0.0f;
+  float block_flow_m3h = 0.0f;
+  float delta = 0.0f;
+
+  blocks->pressure_sum_pa += pressure_pa;
+  blocks->flow_sum_m3h += flow_m3h;
+  blocks->samples += 1u;
+
+  if ((now_tick_ms - blocks->start_tick_ms) < APP_TEST_MEASURE_BLOCK_MS) {
+    return;
+  }
+
+  // Welford update over block means.
+  block_pressure_pa = blocks->pressure_sum_pa / (float)blocks->samples;
+  block_flow_m3h = blocks->flow_sum_m3h / (float)blocks->samples;
+  blocks->count += 1u;
+  delta = block_pressure_pa - blocks->pressure_mean_pa;
+  blocks->pressure_mean_pa += delta / (float)blocks->count;
+  blocks->pressure_m2 += delta * (block_pressure_pa - blocks->pressure_mean_pa);
+  delta = block_flow_m3h - blocks->flow_mean_m3h;
+  blocks->flow_mean_m3h += delta / (float)blocks->count;
+  blocks->flow_m2 += delta * (block_flow_m3h - blocks->flow_mean_m3h);
+
+  blocks->start_tick_ms = now_tick_ms;
+  blocks->pressure_sum_pa = 0.0f;
+  blocks->flow_sum_m3h = 0.0f;
+  blocks->samples = 0u;
+}
+
+// Standard errors of the point means and the 95 % half-width on log(Q), with
+// pressure noise carried onto log(Q) through the nominal exponent.
+static bool blower_test_block_errors(const blower_test_block_stats_t *blocks,
+                                     float *out_pressure_se_pa,
+                                     float *out_flow_se_m3h,
+                                     float *out_log_flow_ci_pct) {
+  const float count_f = (float)blocks->count;
+  float pressure_rel = 0.0f;
+  float flow_rel = 0.0f;
+
+  *out_pressure_se_pa = 0.0f;
+  *out_flow_se_m3h = 0.0f;
+  *out_log_flow_ci_pct = 0.0f;
+  if (blocks->count < 2u || blocks->pressure_mean_pa <= 0.0f ||
+      blocks->flow_mean_m3h <= 0.0f) {
+    return false;
+  }
+
+  *out_pressure_se_pa = sqrtf(blocks->pressure_m2 / ((count_f - 1.0f) * count_f));
+  *out_flow_se_m3h = sqrtf(blocks->flow_m2 / ((count_f - 1.0f) * count_f));
+  pressure_rel = BLOWER_TEST_NOMINAL_FLOW_EXPONENT * *out_pressure_se_pa /
+                 blocks->pressure_mean_pa;
+  flow_rel = *out_flow_se_m3h / blocks->flow_mean_m3h;
+  *out_log_flow_ci_pct = 100.0f * leakage_regression_t_quantile_975(blocks->count - 1u) *
+                         sqrtf(pressure_rel * pressure_rel + flow_rel * flow_rel);
+  return true;
+}
+
+static uint8_t blower_test_raw_series_id(blower_test_direction_t direction,
+                                         uint8_t point_index) {
+  return (uint8_t)((direction == BLOWER_TEST_DIRECTION_DEPRESSURIZATION
+                        ? BLOWER_TEST_MAX_PRESSURE_POINTS
+                        : 0u) +
+                   point_index);
+}
+
+static void blower_test_raw_window_reset_locked(uint32_t now_tick_ms) {
+  g_context.raw_window = (test_sample_t){0};
+  g_context.raw_window_start_tick_ms = now_tick_ms;
+  g_context.raw_window_samples = 0u;
+}
+
+// Stores the mean of the window so far; also called when a point ends so its
+// last, shorter window is kept.
+static void blower_test_raw_window_flush_locked(uint32_t now_tick_ms) {
+  const test_sample_t *window = &g_context.raw_window;
+  const float count_f = (float)g_context.raw_window_samples;
+
+  if (g_context.raw_window_samples == 0u) {
+    return;
+  }
+
+  (void)test_sample_store_append(&(test_sample_t){
+      .t_ms = now_tick_ms,
+      .envelope_pressure_pa = window->envelope_pressure_pa / count_f,
+      .fan_pressure_pa = window->fan_pressure_pa / count_f,
+      .envelope_temperature_c = window->envelope_temperature_c / count_f,
+      .fan_temperature_c = window->fan_temperature_c / count_f,
+      .pwm_percent = window->pwm_percent / count_f,
+  });
+  blower_test_raw_window_reset_locked(now_tick_ms);
+}
+
+// Raw samples are stored as APP_TEST_RAW_SAMPLE_PERIOD_MS means.
+static void blower_test_raw_window_add_locked(
+    const blower_metrics_snapshot_t *metrics_snapshot, float pwm_percent,
+    uint32_t now_tick_ms) {
+  test_sample_t *window = &g_context.raw_window;
+
+  window->envelope_pressure_pa += metrics_snapshot->envelope_pressure_pa;
+  window->fan_pressure_pa += metrics_snapshot->fan_pressure_pa;
+  window->envelope_temperature_c += metrics_snapshot->envelope_temperature_c;
+  window->fan_temperature_c += metrics_snapshot->fan_temperature_c;
+  window->pwm_percent += pwm_percent;
+  g_context.raw_window_samples += 1u;
+
+  if ((now_tick_ms - g_context.raw_window_start_tick_ms) >=
+      APP_TEST_RAW_SAMPLE_PERIOD_MS) {
+    blower_test_raw_window_flush_locked(now_tick_ms);
+  }
+}
+
+static bool blower_test_measurement_done_locked(uint32_t now_tick_ms) {
+  const uint32_t elapsed_ms = now_tick_ms - g_context.measure_start_tick_ms;
+  float pressure_se_pa = 0.0f;
+  float flow_se_m3h = 0.0f;
+  float log_flow_ci_pct = 0.0f;
+  bool has_errors = false;
+
+  has_errors = blower_test_block_errors(&g_context.blocks, &pressure_se_pa,
+                                        &flow_se_m3h, &log_flow_ci_pct);
+  g_context.runtime.active_log_flow_ci_pct = log_flow_ci_pct;
+
+  if (elapsed_ms >= (uint32_t)g_context.config.measure_time_s * 1000u) {
+    return true;
+  }
+  if (g_context.config.measure_target_ci_pct <= 0.0f || !has_errors ||
+      g_context.blocks.count < APP_TEST_MEASURE_MIN_BLOCKS ||
+      elapsed_ms < (uint32_t)g_context.config.measure_min_time_s * 1000u) {
+    return false;
+  }
+  return log_flow_ci_pct <= g_context.config.measure_target_ci_pct;
+}
+
 static void blower_test_prepare_measurement_locked(uint32_t now_tick_ms) {
+  g_context.point_settle_ms = now_tick_ms - g_context.state_enter_tick_ms;
   g_context.acc_pressure_pa = 0.0f;
   g_context.acc_fan_flow_m3h = 0.0f;
   g_context.acc_fan_temp_c = 0.0f;
@@ -427,6 +558,11 @@ static void blower_test_prepare_measurement_locked(uint32_t now_tick_ms) {
   g_context.acc_samples = 0u;
   g_context.measure_start_tick_ms = now_tick_ms;
   g_context.runtime.active_sample_count = 0u;
+  g_context.runtime.active_log_flow_ci_pct = 0.0f;
+  blower_test_block_reset(&g_context.blocks, now_tick_ms);
+  blower_test_raw_window_reset_locked(now_tick_ms);
+  (void)test_sample_store_begin_series(blower_test_raw_series_id(
+      g_context.runtime.current_direction, g_context.runtime.current_point_index));
   blower_test_set_state_locked(BLOWER_TEST_STATE_MEASURING, now_tick_ms);
 }
 
@@ -436,52 +572,78 @@ static void blower_test_abort_control_locked(void) {
   blower_control_set_manual_pwm_percent(0u);
 }
 
+static bool blower_test_queue_busy_locked(void) {
+  return g_context.queue.state == BLOWER_TEST_QUEUE_STATE_RUNNING ||
+         g_context.queue.state == BLOWER_TEST_QUEUE_STATE_WAITING_OPERATOR;
+}
+
+static void blower_test_queue_end_locked(blower_test_queue_state_t state) {
+  if (!blower_test_queue_busy_locked()) {
+    return;
+  }
+  g_context.queue.state = state;
+  g_context.queue.baseline_sampling = false;
+  g_context.config = g_context.queue.operator_config;
+}
+
+static void blower_test_fail_locked(uint32_t now_tick_ms) {
+  g_context.runtime.active = false;
+  blower_test_set_state_locked(BLOWER_TEST_STATE_ERROR, now_tick_ms);
+  blower_test_abort_control_locked();
+  blower_test_queue_end_locked(BLOWER_TEST_QUEUE_STATE_ABORTED);
+}
+
+static float blower_test_point_log_flow_sigma(const blower_test_point_result_t *point) {
+  const float pressure_rel = BLOWER_TEST_NOMINAL_FLOW_EXPONENT *
+                             point->pressure_std_error_pa / point->avg_pressure_pa;
+  const float flow_rel = point->flow_std_error_m3h / point->avg_fan_flow_m3h;
+
+  return sqrtf(pressure_rel * pressure_rel + flow_rel * flow_rel);
+}
+
 static bool blower_test_compute_summary_from_direction(
     const blower_test_config_t *config,
     const blower_test_direction_report_t *direction_report,
     blower_test_curve_summary_t *out_summary) {
-  float sum_x = 0.0f;
-  float sum_y = 0.0f;
-  float sum_x2 = 0.0f;
-  float sum_y2 = 0.0f;
-  float sum_xy = 0.0f;
-  float sum_rel_err2 = 0.0f;
+  leakage_regression_point_t fit_points[BLOWER_TEST_MAX_PRESSURE_POINTS];
+  const leakage_regression_options_t fit_options = {
+      .use_weights = APP_TEST_FIT_WEIGHTED != 0,
+      .robust = APP_TEST_FIT_ROBUST != 0,
+      .huber_k = APP_TEST_FIT_HUBER_K,
+  };
+  leakage_regression_result_t fit = {0};
   uint8_t valid_count = 0u;
   uint8_t index = 0u;
   float slope_n = 0.0f;
-  float intercept = 0.0f;
-  float denominator = 0.0f;
-  float correlation_denominator = 0.0f;
-  float correlation_r = 0.0f;
   float cl = 0.0f;
   float q_ref = 0.0f;
+  float q_ref_ci_low = 0.0f;
+  float q_ref_ci_high = 0.0f;
   float q10_m3h = 0.0f;
   float q4_m3h = 0.0f;
-  const float rho =
-      blower_test_air_density_kg_m3(config->altitude_m, 20.0f);
+  float rho = 0.0f;
   blower_test_curve_summary_t summary = {0};
 
   if (config == NULL || direction_report == NULL || out_summary == NULL) {
     return false;
   }
+  rho = blower_test_air_density_kg_m3(config->altitude_m, 20.0f);
 
-  for (index = 0u; index < direction_report->point_count; ++index) {
+  for (index = 0u; index < direction_report->point_count &&
+                   index < BLOWER_TEST_MAX_PRESSURE_POINTS;
+       ++index) {
     const blower_test_point_result_t *point = &direction_report->points[index];
     if (!point->valid || point->avg_pressure_pa <= 0.0f ||
         point->avg_fan_flow_m3h <= 0.0f) {
       continue;
     }
 
-    {
-      const float x = logf(point->avg_pressure_pa);
-      const float y = logf(point->avg_fan_flow_m3h);
-      sum_x += x;
-      sum_y += y;
-      sum_x2 += x * x;
-      sum_y2 += y * y;
-      sum_xy += x * y;
-      valid_count += 1u;
-    }
+    fit_points[valid_count] = (leakage_regression_point_t){
+        .pressure_pa = point->avg_pressure_pa,
+        .flow_m3h = point->avg_fan_flow_m3h,
+        .log_flow_sigma = blower_test_point_log_flow_sigma(point),
+    };
+    valid_count += 1u;
   }
 
   if (valid_count < 2u ||
@@ -490,47 +652,30 @@ static bool blower_test_compute_summary_from_direction(
     return false;
   }
 
-  denominator = (float)valid_count * sum_x2 - (sum_x * sum_x);
-  if (fabsf(denominator) < 1e-6f) {
+  if (!leakage_regression_fit(fit_points, valid_count, &fit_options, &fit) ||
+      !leakage_regression_predict(&fit, (float)config->reference_pressure_pa, &q_ref,
+                                  &q_ref_ci_low, &q_ref_ci_high)) {
     return false;
   }
 
-  slope_n = ((float)valid_count * sum_xy - (sum_x * sum_y)) / denominator;
-  intercept = (sum_y - slope_n * sum_x) / (float)valid_count;
-  cl = expf(intercept);
-
-  correlation_denominator =
-      ((float)valid_count * sum_x2 - (sum_x * sum_x)) *
-      ((float)valid_count * sum_y2 - (sum_y * sum_y));
-  if (correlation_denominator > 1e-9f) {
-    correlation_r =
-        ((float)valid_count * sum_xy - (sum_x * sum_y)) /
-        sqrtf(correlation_denominator);
-  }
-
-  for (index = 0u; index < direction_report->point_count; ++index) {
-    const blower_test_point_result_t *point = &direction_report->points[index];
-    if (!point->valid || point->avg_pressure_pa <= 0.0f ||
-        point->avg_fan_flow_m3h <= 0.0f) {
-      continue;
-    }
-
-    {
-      const float q_pred = cl * powf(point->avg_pressure_pa, slope_n);
-      if (q_pred > 0.0f) {
-        const float rel_err = (point->avg_fan_flow_m3h - q_pred) / q_pred;
-        sum_rel_err2 += rel_err * rel_err;
-      }
-    }
+  slope_n = fit.exponent_n;
+  cl = expf(fit.ln_c);
+  if (fit.has_confidence) {
+    summary.cl_ci_low_m3h_pan = expf(fit.ln_c - fit.t_quantile * fit.se_ln_c);
+    summary.cl_ci_high_m3h_pan = expf(fit.ln_c + fit.t_quantile * fit.se_ln_c);
+    summary.exponent_n_ci_low = slope_n - fit.t_quantile * fit.se_n;
+    summary.exponent_n_ci_high = slope_n + fit.t_quantile * fit.se_n;
+    summary.q_ref_ci_low_m3h = q_ref_ci_low;
+    summary.q_ref_ci_high_m3h = q_ref_ci_high;
   }
+  summary.downweighted_points = fit.downweighted_count;
 
-  q_ref = cl * powf((float)config->reference_pressure_pa, slope_n);
   q10_m3h = cl * powf(10.0f, slope_n);
   q4_m3h = cl * powf(4.0f, slope_n);
 
   summary.cl_m3h_pan = cl;
   summary.exponent_n = slope_n;
-  summary.correlation_r = correlation_r;
+  summary.correlation_r = fit.correlation_r;
   summary.q_ref_m3h = q_ref;
   summary.ach_ref_h1 =
       config->building_volume_m3 > 0.0f ? q_ref / config->building_volume_m3 : 0.0f;
@@ -557,8 +702,10 @@ static bool blower_test_compute_summary_from_direction(
           ? summary.lbl_ela4_cm2 / config->envelope_area_m2
           : 0.0f;
 
-  summary.uncertainty_pct =
-      sqrtf(sum_rel_err2 / (float)valid_count) * 100.0f;
+  // Regression part: q_ref 95 % half-width (ISO 9972 Annex C).
+  summary.uncertainty_pct = fit.has_confidence && q_ref > 0.0f
+                                ? (q_ref_ci_high - q_ref_ci_low) * 0.5f / q_ref * 100.0f
+                                : 0.0f;
   summary.uncertainty_pct = sqrtf(summary.uncertainty_pct * summary.uncertainty_pct +
                                   config->dimensions_uncertainty_pct *
                                       config->dimensions_uncertainty_pct);
@@ -603,6 +750,20 @@ static void blower_test_compute_mean_summary_locked(void) {
         (press->lbl_ela4_cm2_per_m2_envelope +
          depress->lbl_ela4_cm2_per_m2_envelope) *
         0.5f;
+    mean.cl_ci_low_m3h_pan =
+        (press->cl_ci_low_m3h_pan + depress->cl_ci_low_m3h_pan) * 0.5f;
+    mean.cl_ci_high_m3h_pan =
+        (press->cl_ci_high_m3h_pan + depress->cl_ci_high_m3h_pan) * 0.5f;
+    mean.exponent_n_ci_low =
+        (press->exponent_n_ci_low + depress->exponent_n_ci_low) * 0.5f;
+    mean.exponent_n_ci_high =
+        (press->exponent_n_ci_high + depress->exponent_n_ci_high) * 0.5f;
+    mean.q_ref_ci_low_m3h =
+        (press->q_ref_ci_low_m3h + depress->q_ref_ci_low_m3h) * 0.5f;
+    mean.q_ref_ci_high_m3h =
+        (press->q_ref_ci_high_m3h + depress->q_ref_ci_high_m3h) * 0.5f;
+    mean.downweighted_points =
+        (uint8_t)(press->downweighted_points + depress->downweighted_points);
     mean.uncertainty_pct =
         (press->uncertainty_pct + depress->uncertainty_pct) * 0.5f;
     if (mean.q_ref_m3h > 0.0f) {
@@ -620,81 +781,268 @@ static void blower_test_compute_mean_summary_locked(void) {
   g_context.active_report.mean_summary = mean;
 }
 
-static void blower_test_history_push_locked(const blower_test_report_t *report) {
-  if (report == NULL) {
+// Runs without the mutex. Two changes may race to the journal; the one
+// applied last carries the higher sequence, and an older one reaching the
+// journal after it is skipped rather than written over it.
+static bool blower_test_persist_config(const blower_test_config_t *config,
+                                       uint32_t sequence) {
+  bool stored = true;
+
+  (void)xSemaphoreTake(g_context.journal_mutex, portMAX_DELAY);
+  if (sequence > g_context.config_stored_sequence) {
+    stored = flash_journal_append(BLOWER_TEST_RECORD_CONFIG, 0u, false, config,
+                                  sizeof(*config));
+    if (stored) {
+      g_context.config_stored_sequence = sequence;
+    }
+  }
+  xSemaphoreGive(g_context.journal_mutex);
+  return stored;
+}
+
+static void blower_test_publish_slot_locked(bool active) {
+  g_context.report_slot_sequence += 1u;
+  g_context.report_slot_length = blower_test_report_encode(
+      &g_context.active_report, g_context.report_slot, sizeof(g_context.report_slot));
+  g_context.report_slot_id = g_context.active_report.report_id;
+  g_context.report_slot_active = active;
+  g_context.report_slot_sequence += 1u;
+}
+
+static void blower_test_set_latest_locked(uint32_t report_id,
+                                          const blower_test_curve_summary_t *mean) {
+  g_context.has_latest_report = true;
+  g_context.latest_report_id = report_id;
+  g_context.latest_ach_ref_h1 = mean->valid ? mean->ach_ref_h1 : 0.0f;
+  g_context.runtime.report_ready = true;
+  g_context.runtime.latest_report_id = report_id;
+  g_context.runtime.latest_ach_ref_h1 = g_context.latest_ach_ref_h1;
+}
+
+static void blower_test_copy_slot_for_persist_locked(void) {
+  memcpy(g_context.persist_buffer, g_context.report_slot, g_context.report_slot_length);
+  g_context.persist_length = g_context.report_slot_length;
+  g_context.persist_id = g_context.report_slot_id;
+  g_context.persist_ready = true;
+  g_context.persist_pending = false;
+}
+
+// Marks the slot, as it is now, for blower_test_persist_flush(). A record
+// with an existing report_id supersedes the older one.
+static void blower_test_request_persist_locked(void) {
+  if (!g_context.persistence_available || g_context.report_slot_length == 0u) {
+    return;
+  }
+  if (g_context.persist_busy ||
+      (g_context.persist_ready && g_context.persist_id != g_context.report_slot_id)) {
+    g_context.persist_pending = true;
     return;
   }
+  blower_test_copy_slot_for_persist_locked();
+}
+
+static uint8_t blower_test_raw_chunk_count(uint32_t image_size) {
+  return (uint8_t)((image_size + BLOWER_TEST_RAW_CHUNK_BYTES - 1u) /
+                   BLOWER_TEST_RAW_CHUNK_BYTES);
+}
+
+static uint32_t blower_test_raw_key(uint8_t slot, uint8_t chunk) {
+  return ((uint32_t)slot << 8u) | chunk;
+}
 
-  g_context.history[g_context.history_head] = *report;
-  g_context.history_head = (uint8_t)((g_context.history_head + 1u) %
-                                     BLOWER_TEST_HISTORY_CAPACITY);
-  if (g_context.history_count < BLOWER_TEST_HISTORY_CAPACITY) {
-    g_context.history_count += 1u;
+// Queues the raw samples of the test that just completed; the store keeps
+// them until the next test starts.
+static void blower_test_request_raw_persist_locked(void) {
+  if (!g_context.persistence_available ||
+      g_context.raw_report_id != g_context.active_report.report_id) {
+    return;
   }
+  g_context.raw_persist_report_id = g_context.raw_report_id;
+  g_context.raw_persist_size = (uint32_t)test_sample_store_image_size();
+  g_context.raw_persist_chunk = 0u;
 }
 
-static bool blower_test_persist_locked(void) {
-  blower_test_persistent_blob_t blob = {0};
+// Copies the next chunk of the store image behind its header; returns the
+// record length.
+static uint32_t blower_test_copy_raw_chunk_locked(void) {
+  const blower_test_raw_chunk_header_t header = {
+      .report_id = g_context.raw_persist_report_id,
+      .image_size = g_context.raw_persist_size,
+      .block_bytes = (uint16_t)sizeof(test_sample_block_t),
+      .chunk = g_context.raw_persist_chunk,
+      .chunk_count = blower_test_raw_chunk_count(g_context.raw_persist_size),
+  };
+  const size_t length = test_sample_store_image_read(
+      (size_t)g_context.raw_persist_chunk * BLOWER_TEST_RAW_CHUNK_BYTES,
+      g_context.raw_chunk + sizeof(header), BLOWER_TEST_RAW_CHUNK_BYTES);
 
-  if (!g_context.persistence_available) {
-    return false;
+  memcpy(g_context.raw_chunk, &header, sizeof(header));
+  return (uint32_t)(sizeof(header) + length);
+}
+
+// Header of one raw record. journal_mutex held.
+static bool blower_test_find_raw_chunk(uint8_t slot, uint8_t chunk,
+                                       flash_journal_entry_t *out_entry,
+                                       blower_test_raw_chunk_header_t *out_header) {
+  return flash_journal_find(BLOWER_TEST_RECORD_RAW, blower_test_raw_key(slot, chunk),
+                            out_entry) &&
+         out_entry->length >= sizeof(*out_header) &&
+         flash_journal_read(out_entry, 0u, out_header, sizeof(*out_header));
+}
+
+// An unused slot, else the one holding the oldest test. journal_mutex held.
+static uint8_t blower_test_pick_raw_slot(void) {
+  flash_journal_entry_t entry = {0};
+  blower_test_raw_chunk_header_t header = {0};
+  uint32_t oldest_report_id = UINT32_MAX;
+  uint8_t pick = 0u;
+  uint8_t slot = 0u;
+
+  for (slot = 0u; slot < APP_TEST_RAW_JOURNAL_SLOTS; ++slot) {
+    if (!blower_test_find_raw_chunk(slot, 0u, &entry, &header)) {
+      return slot;
+    }
+    if (header.report_id < oldest_report_id) {
+      oldest_report_id = header.report_id;
+      pick = slot;
+    }
+  }
+  return pick;
+}
+
+static void blower_test_note_persist_result_locked(bool stored, uint32_t now_ms) {
+  g_context.runtime.persist_failed = !stored;
+  if (!stored) {
+    g_context.runtime.persist_failures += 1u;
+    g_context.persist_retry_tick_ms = now_ms;
+  }
+}
+
+// Appends the requested report with the mutex released. Called by the
+// public entry points after they give the mutex back. A failed append (an
+// erase refused while the fan runs, a worn sector) stays ready and is tried
+// again by a later call once APP_TEST_PERSIST_RETRY_MS has passed, or at once
+// when a newer report is waiting; that newer report then takes the buffer
+// even if the retry failed.
+static void blower_test_persist_flush(void) {
+  const uint32_t now_ms =
+      (uint32_t)xTaskGetTickCount() * (uint32_t)portTICK_PERIOD_MS;
+  bool stored = false;
+
+  if (g_context.mutex == NULL ||
+      xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return;
   }
 
-  blob.magic = BLOWER_TEST_STORAGE_MAGIC;
-  blob.version = BLOWER_TEST_STORAGE_VERSION;
-  blob.payload_size = sizeof(blob);
-  blob.sequence = g_context.next_report_id;
-  blob.config = g_context.config;
-  blob.history_count = g_context.history_count;
-  blob.history_head = g_context.history_head;
-  memcpy(blob.history, g_context.history, sizeof(blob.history));
-  blob.crc32 = blower_test_crc32_for_blob(&blob);
-  return blower_test_storage_program(&blob);
+  // Only one caller appends at a time; it also picks up what was requested
+  // meanwhile.
+  while (g_context.persist_ready && !g_context.persist_busy) {
+    if (g_context.runtime.persist_failed && !g_context.persist_pending &&
+        (now_ms - g_context.persist_retry_tick_ms) < APP_TEST_PERSIST_RETRY_MS) {
+      break;
+    }
+    g_context.persist_ready = false;
+    g_context.persist_busy = true;
+    xSemaphoreGive(g_context.mutex);
+
+    (void)xSemaphoreTake(g_context.journal_mutex, portMAX_DELAY);
+    stored = flash_journal_append(BLOWER_TEST_RECORD_REPORT, g_context.persist_id, true,
+                                  g_context.persist_buffer, g_context.persist_length);
+    xSemaphoreGive(g_context.journal_mutex);
+
+    (void)xSemaphoreTake(g_context.mutex, portMAX_DELAY);
+    g_context.persist_busy = false;
+    blower_test_note_persist_result_locked(stored, now_ms);
+    // A running test has replaced the slot since the request; nothing to copy.
+    if (g_context.persist_pending && !g_context.report_slot_active) {
+      blower_test_copy_slot_for_persist_locked();
+    } else {
+      g_context.persist_pending = false;
+      g_context.persist_ready = !stored;
+    }
+  }
+
+  // Then the raw samples behind the report, one chunk per call so a test's
+  // worth of appends is spread over the updates that follow it.
+  if (!g_context.persist_ready && !g_context.persist_busy &&
+      g_context.raw_persist_report_id != 0u &&
+      (!g_context.runtime.persist_failed ||
+       (now_ms - g_context.persist_retry_tick_ms) >= APP_TEST_PERSIST_RETRY_MS)) {
+    const uint32_t report_id = g_context.raw_persist_report_id;
+    const uint8_t chunk = g_context.raw_persist_chunk;
+    const uint32_t length = blower_test_copy_raw_chunk_locked();
+    uint8_t slot = g_context.raw_persist_slot;
+
+    g_context.persist_busy = true;
+    xSemaphoreGive(g_context.mutex);
+
+    (void)xSemaphoreTake(g_context.journal_mutex, portMAX_DELAY);
+    if (chunk == 0u) {
+      slot = blower_test_pick_raw_slot();
+    }
+    stored = flash_journal_append(BLOWER_TEST_RECORD_RAW, blower_test_raw_key(slot, chunk),
+                                  true, g_context.raw_chunk, length);
+    xSemaphoreGive(g_context.journal_mutex);
+
+    (void)xSemaphoreTake(g_context.mutex, portMAX_DELAY);
+    g_context.persist_busy = false;
+    blower_test_note_persist_result_locked(stored, now_ms);
+    // A test that completed meanwhile restarted the sequence.
+    if (stored && g_context.raw_persist_report_id == report_id &&
+        g_context.raw_persist_chunk == chunk) {
+      g_context.raw_persist_slot = slot;
+      g_context.raw_persist_chunk += 1u;
+      if (g_context.raw_persist_chunk >=
+          blower_test_raw_chunk_count(g_context.raw_persist_size)) {
+        g_context.raw_persist_report_id = 0u;
+      }
+    }
+  }
+
+  xSemaphoreGive(g_context.mutex);
+}
+
+static bool blower_test_journal_view_locked(const flash_journal_entry_t *entry,
+                                            blower_test_report_view_t *out_view) {
+  return blower_test_report_view_init(out_view, flash_journal_payload(entry),
+                                      entry->length);
 }
 
 static void blower_test_load_from_storage_or_defaults_locked(void) {
-  blower_test_persistent_blob_t blob = {0};
   blower_test_config_t default_config = {0};
-  bool loaded = false;
+  blower_test_config_t stored_config = {0};
+  flash_journal_entry_t entry = {0};
+  blower_test_report_view_t view = {0};
+  blower_test_report_header_t header = {0};
+  blower_test_curve_summary_t mean = {0};
 
   blower_test_fill_default_config(&default_config);
   g_context.config = default_config;
-  g_context.history_count = 0u;
-  g_context.history_head = 0u;
   g_context.has_latest_report = false;
+  g_context.latest_report_id = 0u;
+  g_context.latest_ach_ref_h1 = 0.0f;
   g_context.next_report_id = 1u;
 
   if (!g_context.persistence_available) {
     return;
   }
 
-  loaded = blower_test_storage_load(&blob);
-  if (!loaded) {
-    (void)blower_test_persist_locked();
-    return;
-  }
-
-  if (blower_test_validate_and_normalize_config(&blob.config)) {
-    g_context.config = blob.config;
+  if (flash_journal_find(BLOWER_TEST_RECORD_CONFIG, 0u, &entry) &&
+      entry.length == sizeof(stored_config) &&
+      flash_journal_read(&entry, 0u, &stored_config, sizeof(stored_config)) &&
+      blower_test_validate_and_normalize_config(&stored_config)) {
+    g_context.config = stored_config;
   }
 
-  g_context.history_count = blob.history_count <= BLOWER_TEST_HISTORY_CAPACITY
-                                ? blob.history_count
-                                : BLOWER_TEST_HISTORY_CAPACITY;
-  g_context.history_head = blob.history_head % BLOWER_TEST_HISTORY_CAPACITY;
-  memcpy(g_context.history, blob.history, sizeof(g_context.history));
-
-  if (g_context.history_count > 0u) {
-    const uint8_t last_index =
-        (uint8_t)((g_context.history_head + BLOWER_TEST_HISTORY_CAPACITY - 1u) %
-                  BLOWER_TEST_HISTORY_CAPACITY);
-    g_context.latest_report = g_context.history[last_index];
+  // Reports are appended in id order, so the newest entry has the highest id.
+  if (flash_journal_list(BLOWER_TEST_RECORD_REPORT, 0u, &entry, 1u, NULL) == 1u &&
+      blower_test_journal_view_locked(&entry, &view) &&
+      blower_test_report_get_header(&view, &header) &&
+      blower_test_report_get_summary(&view, BLOWER_TEST_DIRECTION_NONE, &mean)) {
     g_context.has_latest_report = true;
-    g_context.next_report_id = g_context.latest_report.report_id + 1u;
-  }
-
-  if (blob.sequence >= g_context.next_report_id) {
-    g_context.next_report_id = blob.sequence + 1u;
+    g_context.latest_report_id = header.report_id;
+    g_context.latest_ach_ref_h1 = mean.valid ? mean.ach_ref_h1 : 0.0f;
+    g_context.next_report_id = header.report_id + 1u;
   }
 }
 
@@ -711,14 +1059,13 @@ static void blower_test_reset_runtime_locked(void) {
       .current_measured_flow_m3h = 0.0f,
       .state_elapsed_ms = 0u,
       .active_sample_count = 0u,
+      .active_log_flow_ci_pct = 0.0f,
+      .settle_time_saved_ms = 0u,
+      .provisional_valid = false,
+      .provisional_verdict = BLOWER_TEST_VERDICT_NONE,
       .report_ready = g_context.has_latest_report,
-      .latest_report_id = g_context.has_latest_report
-                              ? g_context.latest_report.report_id
-                              : 0u,
-      .latest_ach_ref_h1 =
-          g_context.has_latest_report && g_context.latest_report.mean_summary.valid
-              ? g_context.latest_report.mean_summary.ach_ref_h1
-              : 0.0f,
+      .latest_report_id = g_context.latest_report_id,
+      .latest_ach_ref_h1 = g_context.latest_ach_ref_h1,
   };
   g_context.acc_pressure_pa = 0.0f;
   g_context.acc_fan_flow_m3h = 0.0f;
@@ -741,6 +1088,10 @@ void blower_test_service_init(void) {
   }
 
   memset(&g_context, 0, sizeof(g_context));
+  g_context.journal_mutex = xSemaphoreCreateMutex();
+  if (g_context.journal_mutex == NULL) {
+    return;
+  }
   g_context.mutex = xSemaphoreCreateMutex();
   if (g_context.mutex == NULL) {
     return;
@@ -750,7 +1101,7 @@ void blower_test_service_init(void) {
     return;
   }
 
-  g_context.persistence_available = blower_test_storage_layout_is_valid();
+  g_context.persistence_available = flash_journal_mount(BLOWER_TEST_STORAGE_VERSION);
   blower_test_load_from_storage_or_defaults_locked();
   blower_test_reset_runtime_locked();
   g_context.initialized = true;
@@ -771,58 +1122,57 @@ void blower_test_service_get_config(blower_test_config_t *out_config) {
   xSemaphoreGive(g_context.mutex);
 }
 
-bool blower_test_service_set_config(const blower_test_config_t *config) {
-  blower_test_config_t normalized = {0};
-  bool persisted_ok = true;
+// Applies a normalized config under the mutex, then appends it without it,
+// so a slow append does not stall the status routes.
+static blower_test_set_config_result_t blower_test_apply_config(
+    const blower_test_config_t *config) {
+  uint32_t sequence = 0u;
 
-  if (config == NULL || g_context.mutex == NULL) {
-    return false;
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return BLOWER_TEST_SET_CONFIG_BUSY;
   }
 
-  normalized = *config;
-  if (!blower_test_validate_and_normalize_config(&normalized)) {
-    return false;
+  if (g_context.runtime.active || blower_test_queue_busy_locked()) {
+    xSemaphoreGive(g_context.mutex);
+    return BLOWER_TEST_SET_CONFIG_BUSY;
   }
 
-  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
-    return false;
+  g_context.config = *config;
+  sequence = ++g_context.config_sequence;
+  xSemaphoreGive(g_context.mutex);
+
+  if (g_context.persistence_available &&
+      !blower_test_persist_config(config, sequence)) {
+    return BLOWER_TEST_SET_CONFIG_STORAGE_UNAVAILABLE;
   }
+  return BLOWER_TEST_SET_CONFIG_OK;
+}
 
-  if (g_context.runtime.active) {
-    xSemaphoreGive(g_context.mutex);
-    return false;
+blower_test_set_config_result_t blower_test_service_set_config(
+    const blower_test_config_t *config) {
+  blower_test_config_t normalized = {0};
+
+  if (config == NULL || g_context.mutex == NULL) {
+    return BLOWER_TEST_SET_CONFIG_INVALID;
   }
 
-  g_context.config = normalized;
-  if (g_context.persistence_available) {
-    persisted_ok = blower_test_persist_locked();
+  normalized = *config;
+  if (!blower_test_validate_and_normalize_config(&normalized)) {
+    return BLOWER_TEST_SET_CONFIG_INVALID;
   }
 
-  xSemaphoreGive(g_context.mutex);
-  return persisted_ok;
+  return blower_test_apply_config(&normalized);
 }
 
-void blower_test_service_reset_config_to_defaults(void) {
+blower_test_set_config_result_t blower_test_service_reset_config_to_defaults(void) {
   blower_test_config_t defaults = {0};
 
   if (g_context.mutex == NULL) {
-    return;
+    return BLOWER_TEST_SET_CONFIG_BUSY;
   }
 
   blower_test_fill_default_config(&defaults);
-
-  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
-    return;
-  }
-
-  if (!g_context.runtime.active) {
-    g_context.config = defaults;
-    if (g_context.persistence_available) {
-      (void)blower_test_persist_locked();
-    }
-  }
-
-  xSemaphoreGive(g_context.mutex);
+  return blower_test_apply_config(&defaults);
 }
 
 static void blower_test_setup_mode_sequence_locked(blower_test_mode_t mode) {
@@ -844,37 +1194,24 @@ static void blower_test_setup_mode_sequence_locked(blower_test_mode_t mode) {
   }
 }
 
-bool blower_test_service_start(blower_test_mode_t mode) {
-  bool can_start = false;
+static bool blower_test_config_startable(const blower_test_config_t *config) {
+  return config->pressure_points_count > 0u &&
+         (!config->enforce_iso_9972_rules ||
+          config->pressure_points_count >= config->min_points_required);
+}
 
-  if (g_context.mutex == NULL) {
-    return false;
-  }
+static void blower_test_begin_run_locked(blower_test_mode_t mode) {
+  memset(&g_context.active_report, 0, sizeof(g_context.active_report));
+  g_context.active_report.report_id = g_context.next_report_id++;
+  g_context.raw_report_id = g_context.active_report.report_id;
+  // Raw samples of the previous test not yet in the journal are lost here.
+  g_context.raw_persist_report_id = 0u;
+  test_sample_store_reset();
+  g_context.active_report.reference_pressure_pa = g_context.config.reference_pressure_pa;
+  g_context.active_report.completed_tick_ms = 0u;
+  blower_test_publish_slot_locked(true);
 
-  if (mode != BLOWER_TEST_MODE_PRESSURIZATION &&
-      mode != BLOWER_TEST_MODE_DEPRESSURIZATION &&
-      mode != BLOWER_TEST_MODE_BOTH) {
-    return false;
-  }
-
-  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
-    return false;
-  }
-
-  if (g_context.runtime.active || g_context.config.pressure_points_count == 0u ||
-      (g_context.config.enforce_iso_9972_rules &&
-       g_context.config.pressure_points_count <
-           g_context.config.min_points_required)) {
-    xSemaphoreGive(g_context.mutex);
-    return false;
-  }
-
-  memset(&g_context.active_report, 0, sizeof(g_context.active_report));
-  g_context.active_report.report_id = g_context.next_report_id++;
-  g_context.active_report.reference_pressure_pa = g_context.config.reference_pressure_pa;
-  g_context.active_report.completed_tick_ms = 0u;
-
-  blower_test_setup_mode_sequence_locked(mode);
+  blower_test_setup_mode_sequence_locked(mode);
 
   g_context.runtime.active = true;
   g_context.runtime.requested_mode = mode;
@@ -886,13 +1223,11 @@ bool blower_test_service_start(blower_test_mode_t mode) {
   g_context.runtime.current_measured_pressure_pa = 0.0f;
   g_context.runtime.current_measured_flow_m3h = 0.0f;
   g_context.runtime.active_sample_count = 0u;
+  g_context.runtime.settle_time_saved_ms = 0u;
+  blower_test_clear_provisional_locked();
   g_context.runtime.report_ready = g_context.has_latest_report;
-  g_context.runtime.latest_report_id =
-      g_context.has_latest_report ? g_context.latest_report.report_id : 0u;
-  g_context.runtime.latest_ach_ref_h1 =
-      g_context.has_latest_report && g_context.latest_report.mean_summary.valid
-          ? g_context.latest_report.mean_summary.ach_ref_h1
-          : 0.0f;
+  g_context.runtime.latest_report_id = g_context.latest_report_id;
+  g_context.runtime.latest_ach_ref_h1 = g_context.latest_ach_ref_h1;
 
   g_context.stable_since_tick_ms = 0u;
   g_context.measure_start_tick_ms = 0u;
@@ -901,10 +1236,32 @@ bool blower_test_service_start(blower_test_mode_t mode) {
 
   blower_control_set_mode(BLOWER_CONTROL_MODE_AUTO_TEST);
   blower_control_set_relay_enabled(true);
+}
+
+bool blower_test_service_start(blower_test_mode_t mode) {
+  if (g_context.mutex == NULL) {
+    return false;
+  }
+
+  if (mode != BLOWER_TEST_MODE_PRESSURIZATION &&
+      mode != BLOWER_TEST_MODE_DEPRESSURIZATION &&
+      mode != BLOWER_TEST_MODE_BOTH) {
+    return false;
+  }
 
-  can_start = true;
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return false;
+  }
+
+  if (g_context.runtime.active || blower_test_queue_busy_locked() ||
+      !blower_test_config_startable(&g_context.config)) {
+    xSemaphoreGive(g_context.mutex);
+    return false;
+  }
+
+  blower_test_begin_run_locked(mode);
   xSemaphoreGive(g_context.mutex);
-  return can_start;
+  return true;
 }
 
 void blower_test_service_stop(void) {
@@ -924,10 +1281,282 @@ void blower_test_service_stop(void) {
     blower_test_set_state_locked(BLOWER_TEST_STATE_ABORTED, now_tick_ms);
     blower_test_abort_control_locked();
   }
+  blower_test_queue_end_locked(BLOWER_TEST_QUEUE_STATE_ABORTED);
 
   xSemaphoreGive(g_context.mutex);
 }
 
+// Cuts fan power but leaves the relay closed, so the rotor is still turning
+// when the next run starts.
+static void blower_test_queue_begin_rezero_locked(uint32_t now_tick_ms) {
+  g_context.queue.baseline_sampling = false;
+  g_context.queue.baseline_sum_pa = 0.0f;
+  g_context.queue.baseline_samples = 0u;
+  g_context.runtime.active = true;
+  g_context.runtime.current_direction = BLOWER_TEST_DIRECTION_NONE;
+  g_context.runtime.current_target_pressure_pa = 0.0f;
+  blower_test_clear_provisional_locked();
+  blower_test_set_state_locked(BLOWER_TEST_STATE_REZEROING, now_tick_ms);
+
+  blower_control_set_mode(BLOWER_CONTROL_MODE_MANUAL_PERCENT);
+  blower_control_set_manual_pwm_percent(0u);
+  blower_control_set_relay_enabled(true);
+}
+
+static void blower_test_queue_rezero_step_locked(
+    const blower_metrics_snapshot_t *metrics_snapshot, uint32_t now_tick_ms) {
+  blower_test_queue_t *queue = &g_context.queue;
+  blower_test_queue_run_t *run = &queue->runs[queue->current_run];
+
+  if (!queue->baseline_sampling) {
+    if (metrics_snapshot->fan_sample_valid &&
+        blower_test_absf(metrics_snapshot->fan_pressure_pa) <=
+            APP_TEST_QUEUE_ZERO_FAN_MAX_PA) {
+      queue->baseline_sampling = true;
+      queue->baseline_start_tick_ms = now_tick_ms;
+    } else if ((now_tick_ms - g_context.state_enter_tick_ms) >=
+               APP_TEST_QUEUE_SPINDOWN_TIMEOUT_MS) {
+      blower_test_begin_run_locked(run->mode);
+    }
+    return;
+  }
+
+  if (metrics_snapshot->envelope_sample_valid) {
+    queue->baseline_sum_pa += metrics_snapshot->envelope_pressure_pa;
+    queue->baseline_samples += 1u;
+  }
+  if ((now_tick_ms - queue->baseline_start_tick_ms) < APP_TEST_QUEUE_BASELINE_MS) {
+    return;
+  }
+
+  if (queue->baseline_samples >= APP_TEST_QUEUE_BASELINE_MIN_SAMPLES) {
+    const float residual_pa = queue->baseline_sum_pa / (float)queue->baseline_samples;
+    if (blower_metrics_service_shift_envelope_zero(residual_pa)) {
+      run->rezeroed = true;
+      run->baseline_shift_pa = residual_pa;
+    }
+  }
+  queue->baseline_sampling = false;
+  blower_test_begin_run_locked(run->mode);
+}
+
+// Returns true when the next queued run takes over: power is already cut and
+// the relay stays closed while it re-zeroes.
+static bool blower_test_queue_run_finished_locked(uint32_t now_tick_ms) {
+  blower_test_queue_t *queue = &g_context.queue;
+  blower_test_queue_run_t *run = NULL;
+  const blower_test_curve_summary_t *mean = &g_context.active_report.mean_summary;
+  uint8_t next_run = 0u;
+
+  if (queue->state != BLOWER_TEST_QUEUE_STATE_RUNNING) {
+    return false;
+  }
+
+  run = &queue->runs[queue->current_run];
+  run->finished = true;
+  run->report_id = g_context.active_report.report_id;
+  run->valid = mean->valid;
+  run->ach_ref_h1 = mean->ach_ref_h1;
+  run->q_ref_m3h = mean->q_ref_m3h;
+  run->exponent_n = mean->exponent_n;
+
+  next_run = queue->current_run + 1u;
+  if (next_run >= queue->run_count) {
+    blower_test_queue_end_locked(BLOWER_TEST_QUEUE_STATE_COMPLETED);
+    return false;
+  }
+
+  queue->current_run = next_run;
+  g_context.config = queue->configs[next_run];
+  if (blower_test_absf(queue->runs[next_run].fan_aperture_cm - run->fan_aperture_cm) >
+      0.05f) {
+    queue->state = BLOWER_TEST_QUEUE_STATE_WAITING_OPERATOR;
+    return false;
+  }
+
+  blower_test_queue_begin_rezero_locked(now_tick_ms);
+  return true;
+}
+
+bool blower_test_service_queue_add(const blower_test_config_t *config,
+                                   blower_test_mode_t mode) {
+  blower_test_config_t normalized = {0};
+  blower_test_queue_t *queue = &g_context.queue;
+  bool added = false;
+
+  if (config == NULL || g_context.mutex == NULL) {
+    return false;
+  }
+
+  if (mode != BLOWER_TEST_MODE_PRESSURIZATION &&
+      mode != BLOWER_TEST_MODE_DEPRESSURIZATION &&
+      mode != BLOWER_TEST_MODE_BOTH) {
+    return false;
+  }
+
+  normalized = *config;
+  if (!blower_test_validate_and_normalize_config(&normalized) ||
+      !blower_test_config_startable(&normalized)) {
+    return false;
+  }
+
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return false;
+  }
+
+  if (queue->state == BLOWER_TEST_QUEUE_STATE_COMPLETED ||
+      queue->state == BLOWER_TEST_QUEUE_STATE_ABORTED) {
+    queue->state = BLOWER_TEST_QUEUE_STATE_IDLE;
+    queue->run_count = 0u;
+    queue->current_run = 0u;
+  }
+
+  if (queue->run_count < BLOWER_TEST_QUEUE_MAX_RUNS) {
+    queue->configs[queue->run_count] = normalized;
+    queue->runs[queue->run_count] = (blower_test_queue_run_t){
+        .mode = mode,
+        .fan_aperture_cm = normalized.fan_aperture_cm,
+    };
+    queue->run_count += 1u;
+    added = true;
+  }
+
+  xSemaphoreGive(g_context.mutex);
+  return added;
+}
+
+bool blower_test_service_queue_clear(void) {
+  bool cleared = false;
+
+  if (g_context.mutex == NULL) {
+    return false;
+  }
+
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return false;
+  }
+
+  if (!blower_test_queue_busy_locked()) {
+    g_context.queue.state = BLOWER_TEST_QUEUE_STATE_IDLE;
+    g_context.queue.run_count = 0u;
+    g_context.queue.current_run = 0u;
+    cleared = true;
+  }
+
+  xSemaphoreGive(g_context.mutex);
+  return cleared;
+}
+
+bool blower_test_service_queue_start(void) {
+  const uint32_t now_tick_ms =
+      (uint32_t)xTaskGetTickCount() * (uint32_t)portTICK_PERIOD_MS;
+  blower_test_queue_t *queue = &g_context.queue;
+  bool started = false;
+  uint8_t index = 0u;
+
+  if (g_context.mutex == NULL) {
+    return false;
+  }
+
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return false;
+  }
+
+  if (queue->state == BLOWER_TEST_QUEUE_STATE_WAITING_OPERATOR) {
+    // The fan was stopped for the ring swap; re-zero before the run as usual.
+    queue->state = BLOWER_TEST_QUEUE_STATE_RUNNING;
+    blower_test_queue_begin_rezero_locked(now_tick_ms);
+    started = true;
+  } else if (queue->state != BLOWER_TEST_QUEUE_STATE_RUNNING &&
+             !g_context.runtime.active && queue->run_count > 0u) {
+    for (index = 0u; index < queue->run_count; ++index) {
+      queue->runs[index] = (blower_test_queue_run_t){
+          .mode = queue->runs[index].mode,
+          .fan_aperture_cm = queue->runs[index].fan_aperture_cm,
+      };
+    }
+    queue->state = BLOWER_TEST_QUEUE_STATE_RUNNING;
+    queue->current_run = 0u;
+    queue->operator_config = g_context.config;
+    g_context.config = queue->configs[0];
+    blower_test_begin_run_locked(queue->runs[0].mode);
+    started = true;
+  }
+
+  xSemaphoreGive(g_context.mutex);
+  return started;
+}
+
+static void blower_test_queue_aggregate(const blower_test_queue_status_t *status,
+                                        blower_test_queue_aggregate_t *out_aggregate) {
+  float ach_m2 = 0.0f;
+  float q_ref_m2 = 0.0f;
+  float n_m2 = 0.0f;
+  float count_f = 0.0f;
+  uint8_t index = 0u;
+
+  *out_aggregate = (blower_test_queue_aggregate_t){0};
+  for (index = 0u; index < status->run_count; ++index) {
+    const blower_test_queue_run_t *run = &status->runs[index];
+    float delta = 0.0f;
+
+    if (!run->finished || !run->valid) {
+      continue;
+    }
+
+    // Welford's update keeps the spread accurate for nearly equal runs.
+    out_aggregate->valid_runs += 1u;
+    count_f = (float)out_aggregate->valid_runs;
+    delta = run->ach_ref_h1 - out_aggregate->ach_mean_h1;
+    out_aggregate->ach_mean_h1 += delta / count_f;
+    ach_m2 += delta * (run->ach_ref_h1 - out_aggregate->ach_mean_h1);
+    delta = run->q_ref_m3h - out_aggregate->q_ref_mean_m3h;
+    out_aggregate->q_ref_mean_m3h += delta / count_f;
+    q_ref_m2 += delta * (run->q_ref_m3h - out_aggregate->q_ref_mean_m3h);
+    delta = run->exponent_n - out_aggregate->n_mean;
+    out_aggregate->n_mean += delta / count_f;
+    n_m2 += delta * (run->exponent_n - out_aggregate->n_mean);
+
+    if (out_aggregate->valid_runs == 1u || run->ach_ref_h1 < out_aggregate->ach_min_h1) {
+      out_aggregate->ach_min_h1 = run->ach_ref_h1;
+    }
+    if (out_aggregate->valid_runs == 1u || run->ach_ref_h1 > out_aggregate->ach_max_h1) {
+      out_aggregate->ach_max_h1 = run->ach_ref_h1;
+    }
+  }
+
+  if (out_aggregate->valid_runs < 2u) {
+    return;
+  }
+
+  count_f = (float)(out_aggregate->valid_runs - 1u);
+  out_aggregate->ach_stddev_h1 = sqrtf(ach_m2 / count_f);
+  out_aggregate->q_ref_stddev_m3h = sqrtf(q_ref_m2 / count_f);
+  out_aggregate->n_stddev = sqrtf(n_m2 / count_f);
+  if (out_aggregate->ach_mean_h1 > 0.0f) {
+    out_aggregate->ach_cov_pct =
+        100.0f * out_aggregate->ach_stddev_h1 / out_aggregate->ach_mean_h1;
+  }
+}
+
+void blower_test_service_get_queue(blower_test_queue_status_t *out_status) {
+  if (out_status == NULL || g_context.mutex == NULL) {
+    return;
+  }
+
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return;
+  }
+
+  out_status->state = g_context.queue.state;
+  out_status->run_count = g_context.queue.run_count;
+  out_status->current_run = g_context.queue.current_run;
+  memcpy(out_status->runs, g_context.queue.runs, sizeof(out_status->runs));
+  xSemaphoreGive(g_context.mutex);
+
+  blower_test_queue_aggregate(out_status, &out_status->aggregate);
+}
+
 static void blower_test_finalize_direction_locked(
     blower_test_direction_report_t *direction_report) {
   if (direction_report == NULL) {
@@ -946,19 +1575,76 @@ static void blower_test_finalize_direction_locked(
   }
 }
 
+// Refits the direction's completed points (at most
+// BLOWER_TEST_MAX_PRESSURE_POINTS, so bounded) with the same regression as the
+// final summary, minus the ISO minimum-point rule.
+static void blower_test_update_provisional_locked(
+    const blower_test_direction_report_t *direction_report) {
+  blower_test_config_t provisional_config = g_context.config;
+  blower_test_curve_summary_t summary = {0};
+  const float volume_m3 = g_context.config.building_volume_m3;
+  const float target_ach = g_context.config.target_ach_ref_h1;
+  uint8_t valid_points = 0u;
+  uint8_t index = 0u;
+
+  for (index = 0u; index < direction_report->point_count &&
+                   index < BLOWER_TEST_MAX_PRESSURE_POINTS;
+       ++index) {
+    if (direction_report->points[index].valid) {
+      valid_points += 1u;
+    }
+  }
+
+  blower_test_clear_provisional_locked();
+  g_context.runtime.provisional_point_count = valid_points;
+  provisional_config.enforce_iso_9972_rules = false;
+  if (!blower_test_compute_summary_from_direction(&provisional_config,
+                                                  direction_report, &summary)) {
+    return;
+  }
+
+  g_context.runtime.provisional_valid = true;
+  g_context.runtime.provisional_exponent_n = summary.exponent_n;
+  g_context.runtime.provisional_q_ref_m3h = summary.q_ref_m3h;
+  g_context.runtime.provisional_ach_ref_h1 = summary.ach_ref_h1;
+  g_context.runtime.provisional_ach_ci_low_h1 =
+      summary.q_ref_ci_low_m3h / volume_m3;
+  g_context.runtime.provisional_ach_ci_high_h1 =
+      summary.q_ref_ci_high_m3h / volume_m3;
+
+  // Without an interval (two points) there is no verdict yet.
+  if (target_ach <= 0.0f || summary.q_ref_ci_high_m3h <= 0.0f) {
+    return;
+  }
+  if (g_context.runtime.provisional_ach_ci_high_h1 <= target_ach) {
+    g_context.runtime.provisional_verdict = BLOWER_TEST_VERDICT_PASS;
+  } else if (g_context.runtime.provisional_ach_ci_low_h1 > target_ach) {
+    g_context.runtime.provisional_verdict = BLOWER_TEST_VERDICT_FAIL;
+  }
+}
+
+// Opt-in confidence stop; see blower_test_config_t.confidence_stop_enabled.
+static bool blower_test_confidence_stop_locked(void) {
+  return g_context.config.confidence_stop_enabled &&
+         g_context.runtime.provisional_verdict != BLOWER_TEST_VERDICT_NONE &&
+         g_context.runtime.provisional_point_count >=
+             g_context.config.min_points_required;
+}
+
 static void blower_test_advance_to_next_target_locked(uint32_t now_tick_ms) {
   blower_test_direction_report_t *direction_report =
       blower_test_active_direction_report_locked();
 
   if (direction_report == NULL) {
-    g_context.runtime.active = false;
-    blower_test_set_state_locked(BLOWER_TEST_STATE_ERROR, now_tick_ms);
-    blower_test_abort_control_locked();
+    blower_test_fail_locked(now_tick_ms);
     return;
   }
 
+  blower_test_update_provisional_locked(direction_report);
+
   if (g_context.runtime.current_point_index + 1u <
-      g_context.config.pressure_points_count) {
+          g_context.config.pressure_points_count &&
+      !blower_test_confidence_stop_locked()) {
     g_context.runtime.current_point_index += 1u;
     g_context.runtime.current_target_pressure_pa =
         g_context.config
@@ -968,6 +1654,8 @@ static void blower_test_advance_to_next_target_locked(uint32_t now_tick_ms) {
     return;
   }
 
+  direction_report->confidence_stop = g_context.runtime.current_point_index + 1u <
+                                      g_context.config.pressure_points_count;
   blower_test_finalize_direction_locked(direction_report);
 
   if (g_context.direction_slot + 1u < g_context.direction_count) {
@@ -980,33 +1668,31 @@ static void blower_test_advance_to_next_target_locked(uint32_t now_tick_ms) {
     g_context.stable_since_tick_ms = 0u;
     g_context.measure_start_tick_ms = 0u;
     g_context.acc_samples = 0u;
+    blower_test_clear_provisional_locked();
     blower_test_set_state_locked(BLOWER_TEST_STATE_PREPARING, now_tick_ms);
     return;
   }
 
   blower_test_compute_mean_summary_locked();
   g_context.active_report.completed_tick_ms = now_tick_ms;
-  g_context.latest_report = g_context.active_report;
-  g_context.has_latest_report = true;
-  blower_test_history_push_locked(&g_context.latest_report);
-  if (g_context.persistence_available) {
-    (void)blower_test_persist_locked();
-  }
-
   g_context.runtime.active = false;
-  g_context.runtime.report_ready = true;
-  g_context.runtime.latest_report_id = g_context.latest_report.report_id;
-  g_context.runtime.latest_ach_ref_h1 =
-      g_context.latest_report.mean_summary.valid
-          ? g_context.latest_report.mean_summary.ach_ref_h1
-          : 0.0f;
   blower_test_set_state_locked(BLOWER_TEST_STATE_COMPLETED, now_tick_ms);
-  blower_test_abort_control_locked();
+  // Fan power is cut before anything else; a following queued run keeps only
+  // the relay closed.
+  if (!blower_test_queue_run_finished_locked(now_tick_ms)) {
+    blower_test_abort_control_locked();
+  }
+
+  blower_test_publish_slot_locked(false);
+  blower_test_set_latest_locked(g_context.active_report.report_id,
+                                &g_context.active_report.mean_summary);
+  blower_test_request_persist_locked();
+  blower_test_request_raw_persist_locked();
 }
 
-void blower_test_service_update(const blower_metrics_snapshot_t *metrics_snapshot,
-                                const blower_control_snapshot_t *control_snapshot,
-                                uint32_t now_tick_ms) {
+static void blower_test_update(const blower_metrics_snapshot_t *metrics_snapshot,
+                               const blower_control_snapshot_t *control_snapshot,
+                               uint32_t now_tick_ms) {
   float envelope_pressure_pa = 0.0f;
   float fan_flow_m3h = 0.0f;
   bool envelope_valid = false;
@@ -1039,6 +1725,12 @@ void blower_test_service_update(const blower_metrics_snapshot_t *metrics_snapsho
   g_context.runtime.current_measured_flow_m3h = fan_flow_m3h;
   g_context.runtime.state_elapsed_ms = now_tick_ms - g_context.state_enter_tick_ms;
 
+  if (g_context.runtime.state == BLOWER_TEST_STATE_REZEROING) {
+    blower_test_queue_rezero_step_locked(metrics_snapshot, now_tick_ms);
+    xSemaphoreGive(g_context.mutex);
+    return;
+  }
+
   if (g_context.runtime.state == BLOWER_TEST_STATE_PREPARING) {
     const float target =
         g_context.config
@@ -1046,26 +1738,43 @@ void blower_test_service_update(const blower_metrics_snapshot_t *metrics_snapsho
     blower_control_set_target_pressure_pa(target);
     g_context.runtime.current_target_pressure_pa = target;
     g_context.stable_since_tick_ms = 0u;
+    blower_test_reset_steady_detector_locked();
     blower_test_set_state_locked(BLOWER_TEST_STATE_STABILIZING, now_tick_ms);
     xSemaphoreGive(g_context.mutex);
     return;
   }
 
   if (g_context.runtime.state == BLOWER_TEST_STATE_STABILIZING) {
+    const float target = g_context.runtime.current_target_pressure_pa;
+    const float tolerance = g_context.config.target_tolerance_pa;
+    const uint32_t settle_ms = (uint32_t)g_context.config.settle_time_s * 1000u;
+    bool steady = false;
+
     if (!envelope_valid) {
       g_context.stable_since_tick_ms = 0u;
+      blower_test_reset_steady_detector_locked();
       xSemaphoreGive(g_context.mutex);
       return;
     }
 
-    if (fabsf(envelope_pressure_pa - g_context.runtime.current_target_pressure_pa) <=
-        g_context.config.target_tolerance_pa) {
+    if (fan_valid) {
+      steady = steady_state_add_sample(&g_context.steady_detector, now_tick_ms,
+                                       envelope_pressure_pa, fan_flow_m3h);
+    }
+
+    if (fabsf(envelope_pressure_pa - target) <= tolerance) {
       if (g_context.stable_since_tick_ms == 0u) {
         g_context.stable_since_tick_ms = now_tick_ms;
       }
 
-      if ((now_tick_ms - g_context.stable_since_tick_ms) >=
-          ((uint32_t)g_context.config.settle_time_s * 1000u)) {
+      if ((now_tick_ms - g_context.stable_since_tick_ms) >= settle_ms) {
+        blower_test_prepare_measurement_locked(now_tick_ms);
+      } else if (steady &&
+                 fabsf(g_context.steady_detector.status.pressure_mean_pa - target) <=
+                     tolerance) {
+        // The fixed timer would have waited at least until stable_since + settle.
+        g_context.runtime.settle_time_saved_ms +=
+            g_context.stable_since_tick_ms + settle_ms - now_tick_ms;
         blower_test_prepare_measurement_locked(now_tick_ms);
       }
     } else {
@@ -1089,13 +1798,16 @@ void blower_test_service_update(const blower_metrics_snapshot_t *metrics_snapsho
     g_context.acc_pwm_percent += pwm_percent;
     g_context.acc_samples += 1u;
     g_context.runtime.active_sample_count = g_context.acc_samples;
+    blower_test_block_add(&g_context.blocks, now_tick_ms, envelope_pressure_pa,
+                          fan_flow_m3h);
+    blower_test_raw_window_add_locked(metrics_snapshot, pwm_percent, now_tick_ms);
   }
 
-  if ((now_tick_ms - g_context.measure_start_tick_ms) <
-      ((uint32_t)g_context.config.measure_time_s * 1000u)) {
+  if (!blower_test_measurement_done_locked(now_tick_ms)) {
     xSemaphoreGive(g_context.mutex);
     return;
   }
+  blower_test_raw_window_flush_locked(now_tick_ms);
 
   {
     blower_test_direction_report_t *direction_report =
@@ -1104,9 +1816,7 @@ void blower_test_service_update(const blower_metrics_snapshot_t *metrics_snapsho
 
     if (direction_report == NULL ||
         g_context.runtime.current_point_index >= BLOWER_TEST_MAX_PRESSURE_POINTS) {
-      g_context.runtime.active = false;
-      blower_test_set_state_locked(BLOWER_TEST_STATE_ERROR, now_tick_ms);
-      blower_test_abort_control_locked();
+      blower_test_fail_locked(now_tick_ms);
       xSemaphoreGive(g_context.mutex);
       return;
     }
@@ -1121,7 +1831,13 @@ void blower_test_service_update(const blower_metrics_snapshot_t *metrics_snapsho
 
     point = &direction_report->points[g_context.runtime.current_point_index];
     point->target_pressure_pa = g_context.runtime.current_target_pressure_pa;
+    point->settle_time_s = (float)g_context.point_settle_ms * 0.001f;
+    (void)blower_test_block_errors(&g_context.blocks, &point->pressure_std_error_pa,
+                                   &point->flow_std_error_m3h,
+                                   &point->log_flow_ci_pct);
     point->sample_count = g_context.acc_samples;
+    point->raw_sample_count = test_sample_store_series_count(blower_test_raw_series_id(
+        g_context.runtime.current_direction, g_context.runtime.current_point_index));
     point->valid = g_context.acc_samples > 0u;
 
     if (point->valid) {
@@ -1142,9 +1858,19 @@ void blower_test_service_update(const blower_metrics_snapshot_t *metrics_snapsho
   }
 
   blower_test_advance_to_next_target_locked(now_tick_ms);
+  if (g_context.runtime.active) {
+    blower_test_publish_slot_locked(true);
+  }
   xSemaphoreGive(g_context.mutex);
 }
 
+void blower_test_service_update(const blower_metrics_snapshot_t *metrics_snapshot,
+                                const blower_control_snapshot_t *control_snapshot,
+                                uint32_t now_tick_ms) {
+  blower_test_update(metrics_snapshot, control_snapshot, now_tick_ms);
+  blower_test_persist_flush();
+}
+
 void blower_test_service_get_runtime(blower_test_runtime_status_t *out_runtime) {
   if (out_runtime == NULL || g_context.mutex == NULL) {
     return;
@@ -1158,31 +1884,60 @@ void blower_test_service_get_runtime(blower_test_runtime_status_t *out_runtime)
   xSemaphoreGive(g_context.mutex);
 }
 
-bool blower_test_service_get_latest_report(blower_test_report_t *out_report) {
-  bool has_report = false;
+static bool blower_test_open_slot_locked(blower_test_report_handle_t *out_handle) {
+  if (!blower_test_report_view_init(&out_handle->view, g_context.report_slot,
+                                    g_context.report_slot_length)) {
+    return false;
+  }
+  out_handle->is_active = g_context.report_slot_active;
+  out_handle->in_slot = true;
+  out_handle->generation = g_context.report_slot_sequence;
+  return true;
+}
+
+static bool blower_test_open_report_locked(uint32_t report_id,
+                                           blower_test_report_handle_t *out_handle) {
+  flash_journal_entry_t entry = {0};
+  bool opened = false;
 
-  if (out_report == NULL || g_context.mutex == NULL) {
+  *out_handle = (blower_test_report_handle_t){0};
+  if (g_context.report_slot_id == report_id && !g_context.report_slot_active &&
+      blower_test_open_slot_locked(out_handle)) {
+    return true;
+  }
+  if (!g_context.persistence_available) {
     return false;
   }
 
-  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+  (void)xSemaphoreTake(g_context.journal_mutex, portMAX_DELAY);
+  opened = flash_journal_find(BLOWER_TEST_RECORD_REPORT, report_id, &entry) &&
+           blower_test_journal_view_locked(&entry, &out_handle->view);
+  out_handle->generation = flash_journal_generation();
+  xSemaphoreGive(g_context.journal_mutex);
+  return opened;
+}
+
+bool blower_test_service_open_latest_report(blower_test_report_handle_t *out_handle) {
+  bool opened = false;
+
+  if (out_handle == NULL || g_context.mutex == NULL) {
     return false;
   }
 
-  has_report = g_context.has_latest_report;
-  if (has_report) {
-    *out_report = g_context.latest_report;
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return false;
   }
 
+  opened = g_context.has_latest_report &&
+           blower_test_open_report_locked(g_context.latest_report_id, out_handle);
   xSemaphoreGive(g_context.mutex);
-  return has_report;
+  return opened;
 }
 
-bool blower_test_service_get_report_snapshot(blower_test_report_t *out_report,
-                                             bool *out_is_active) {
-  bool has_report = false;
+bool blower_test_service_open_current_report(blower_test_report_handle_t *out_handle) {
+  bool opened = false;
 
-  if (out_report == NULL || g_context.mutex == NULL) {
+  if (out_handle == NULL || g_context.mutex == NULL) {
     return false;
   }
 
@@ -1190,22 +1945,329 @@ bool blower_test_service_get_report_snapshot(blower_test_report_t *out_report,
     return false;
   }
 
+  *out_handle = (blower_test_report_handle_t){0};
   if (g_context.runtime.active) {
-    *out_report = g_context.active_report;
-    has_report = true;
-    if (out_is_active != NULL) {
-      *out_is_active = true;
-    }
+    opened = blower_test_open_slot_locked(out_handle);
   } else if (g_context.has_latest_report) {
-    *out_report = g_context.latest_report;
-    has_report = true;
-    if (out_is_active != NULL) {
-      *out_is_active = false;
+    opened = blower_test_open_report_locked(g_context.latest_report_id, out_handle);
+  }
+
+  xSemaphoreGive(g_context.mutex);
+  return opened;
+}
+
+bool blower_test_service_open_report(uint32_t report_id,
+                                     blower_test_report_handle_t *out_handle) {
+  bool opened = false;
+
+  if (out_handle == NULL || g_context.mutex == NULL) {
+    return false;
+  }
+
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return false;
+  }
+
+  opened = blower_test_open_report_locked(report_id, out_handle);
+  xSemaphoreGive(g_context.mutex);
+  return opened;
+}
+
+bool blower_test_service_report_is_current(const blower_test_report_handle_t *handle) {
+  if (handle == NULL) {
+    return false;
+  }
+  return handle->in_slot ? g_context.report_slot_sequence == handle->generation
+                         : flash_journal_generation() == handle->generation;
+}
+
+uint32_t blower_test_service_list_reports(uint32_t offset,
+                                          blower_test_report_info_t *out_infos,
+                                          uint32_t max_infos, uint32_t *out_total) {
+  flash_journal_entry_t entries[8];
+  uint32_t written = 0u;
+  uint32_t total = 0u;
+
+  if (out_total != NULL) {
+    *out_total = 0u;
+  }
+  if (out_infos == NULL || g_context.mutex == NULL) {
+    return 0u;
+  }
+
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return 0u;
+  }
+
+  (void)xSemaphoreTake(g_context.journal_mutex, portMAX_DELAY);
+  (void)flash_journal_list(BLOWER_TEST_RECORD_REPORT, 0u, NULL, 0u, &total);
+  while (written < max_infos) {
+    const uint32_t batch = max_infos - written < 8u ? max_infos - written : 8u;
+    const uint32_t count = flash_journal_list(BLOWER_TEST_RECORD_REPORT, offset + written,
+                                              entries, batch, &total);
+    uint32_t index = 0u;
+
+    for (index = 0u; index < count; ++index) {
+      blower_test_report_info_t *info = &out_infos[written + index];
+      blower_test_report_view_t view = {0};
+      blower_test_report_header_t header = {.report_id = entries[index].key};
+      blower_test_curve_summary_t mean = {0};
+
+      if (blower_test_journal_view_locked(&entries[index], &view)) {
+        (void)blower_test_report_get_header(&view, &header);
+        (void)blower_test_report_get_summary(&view, BLOWER_TEST_DIRECTION_NONE, &mean);
+      }
+      *info = (blower_test_report_info_t){
+          .report_id = header.report_id,
+          .source_report_id = header.source_report_id,
+          .completed_tick_ms = header.completed_tick_ms,
+          .has_pressurization = header.has_pressurization,
+          .has_depressurization = header.has_depressurization,
+          .valid = mean.valid,
+          .ach_ref_h1 = mean.ach_ref_h1,
+          .exponent_n = mean.exponent_n,
+          .q_ref_m3h = mean.q_ref_m3h,
+          .uncertainty_pct = mean.uncertainty_pct,
+      };
+    }
+    written += count;
+    if (count < batch) {
+      break;
+    }
+  }
+  xSemaphoreGive(g_context.journal_mutex);
+
+  xSemaphoreGive(g_context.mutex);
+  if (out_total != NULL) {
+    *out_total = total;
+  }
+  return written;
+}
+
+void blower_test_service_get_storage_stats(flash_journal_stats_t *out_stats) {
+  if (out_stats == NULL || g_context.mutex == NULL) {
+    return;
+  }
+
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return;
+  }
+
+  (void)xSemaphoreTake(g_context.journal_mutex, portMAX_DELAY);
+  flash_journal_get_stats(out_stats);
+  xSemaphoreGive(g_context.journal_mutex);
+  xSemaphoreGive(g_context.mutex);
+}
+
+static void blower_test_reanalyze_point_locked(const blower_test_config_t *config,
+                                              uint8_t series_id,
+                                              blower_test_point_result_t *point) {
+  test_sample_cursor_t cursor = {0};
+  test_sample_t sample = {0};
+  blower_test_block_stats_t blocks = {0};
+  float sum_pressure_pa = 0.0f;
+  float sum_flow_m3h = 0.0f;
+  float sum_fan_temp_c = 0.0f;
+  float sum_envelope_temp_c = 0.0f;
+  float sum_pwm_percent = 0.0f;
+  uint16_t count = 0u;
+
+  test_sample_store_cursor_init(&cursor, series_id);
+  while (test_sample_store_cursor_next(&cursor, &sample)) {
+    const float pressure_pa = blower_test_absf(sample.envelope_pressure_pa);
+    const float flow_m3h = blower_test_compute_fan_flow_m3h(
+        config, sample.fan_pressure_pa, sample.envelope_temperature_c);
+
+    if (count == 0u) {
+      blower_test_block_reset(&blocks, sample.t_ms);
+    }
+    blower_test_block_add(&blocks, sample.t_ms, pressure_pa, flow_m3h);
+    sum_pressure_pa += pressure_pa;
+    sum_flow_m3h += flow_m3h;
+    sum_fan_temp_c += sample.fan_temperature_c;
+    sum_envelope_temp_c += sample.envelope_temperature_c;
+    sum_pwm_percent += sample.pwm_percent;
+    count += 1u;
+  }
+
+  if (count == 0u) {
+    return;
+  }
+
+  point->avg_pressure_pa = sum_pressure_pa / (float)count;
+  point->avg_fan_flow_m3h = sum_flow_m3h / (float)count;
+  point->avg_fan_temperature_c = sum_fan_temp_c / (float)count;
+  point->avg_envelope_temperature_c = sum_envelope_temp_c / (float)count;
+  point->avg_pwm_percent = sum_pwm_percent / (float)count;
+  point->raw_sample_count = count;
+  point->valid = true;
+  (void)blower_test_block_errors(&blocks, &point->pressure_std_error_pa,
+                                 &point->flow_std_error_m3h,
+                                 &point->log_flow_ci_pct);
+}
+
+static void blower_test_reanalyze_direction_locked(
+    const blower_test_config_t *config,
+    blower_test_direction_report_t *direction_report) {
+  uint8_t index = 0u;
+
+  for (index = 0u; index < direction_report->point_count &&
+                   index < BLOWER_TEST_MAX_PRESSURE_POINTS;
+       ++index) {
+    blower_test_reanalyze_point_locked(
+        config, blower_test_raw_series_id(direction_report->direction, index),
+        &direction_report->points[index]);
+  }
+  direction_report->summary = (blower_test_curve_summary_t){0};
+  (void)blower_test_compute_summary_from_direction(config, direction_report,
+                                                   &direction_report->summary);
+}
+
+// Replaces the sample store with the raw samples the journal holds for a
+// measured report.
+static blower_test_reanalyze_result_t blower_test_load_raw_locked(uint32_t report_id) {
+  flash_journal_entry_t entry = {0};
+  blower_test_raw_chunk_header_t first = {0};
+  blower_test_raw_chunk_header_t header = {0};
+  uint8_t slot = 0u;
+  uint8_t chunk = 0u;
+  bool found = false;
+  bool loaded = false;
+
+  // The store still holds a test whose samples are not all in the journal.
+  if (g_context.raw_persist_report_id != 0u) {
+    return g_context.runtime.persist_failed ? BLOWER_TEST_REANALYZE_RAW_UNAVAILABLE
+                                            : BLOWER_TEST_REANALYZE_BUSY;
+  }
+  if (!g_context.persistence_available) {
+    return BLOWER_TEST_REANALYZE_RAW_UNAVAILABLE;
+  }
+
+  (void)xSemaphoreTake(g_context.journal_mutex, portMAX_DELAY);
+  for (slot = 0u; slot < APP_TEST_RAW_JOURNAL_SLOTS; ++slot) {
+    if (blower_test_find_raw_chunk(slot, 0u, &entry, &first) &&
+        first.report_id == report_id &&
+        first.block_bytes == sizeof(test_sample_block_t) &&
+        first.chunk_count == blower_test_raw_chunk_count(first.image_size)) {
+      found = true;
+      break;
     }
   }
 
+  loaded = found;
+  for (chunk = 0u; loaded && chunk < first.chunk_count; ++chunk) {
+    const uint32_t offset = (uint32_t)chunk * BLOWER_TEST_RAW_CHUNK_BYTES;
+    const uint32_t length = first.image_size - offset < BLOWER_TEST_RAW_CHUNK_BYTES
+                                ? first.image_size - offset
+                                : BLOWER_TEST_RAW_CHUNK_BYTES;
+
+    // A chunk left over from an older test in the slot fails the id check.
+    loaded = blower_test_find_raw_chunk(slot, chunk, &entry, &header) &&
+             header.report_id == report_id && header.chunk == chunk &&
+             entry.length == sizeof(header) + length &&
+             test_sample_store_image_write(
+                 offset, flash_journal_payload(&entry) + sizeof(header), length);
+  }
+  loaded = loaded && test_sample_store_image_finish(first.image_size);
+  xSemaphoreGive(g_context.journal_mutex);
+
+  if (!loaded) {
+    // A partly written image is of no use either.
+    if (found) {
+      test_sample_store_reset();
+      g_context.raw_report_id = 0u;
+    }
+    return BLOWER_TEST_REANALYZE_RAW_UNAVAILABLE;
+  }
+
+  g_context.raw_report_id = report_id;
+  return BLOWER_TEST_REANALYZE_OK;
+}
+
+// Decodes the measured report behind report_id into active_report, loading
+// its raw samples from the journal unless the store already holds them.
+static blower_test_reanalyze_result_t blower_test_load_reanalysis_source_locked(
+    uint32_t report_id) {
+  blower_test_report_handle_t handle = {0};
+  blower_test_report_header_t header = {0};
+  blower_test_reanalyze_result_t result = BLOWER_TEST_REANALYZE_OK;
+  uint32_t source_id = report_id;
+
+  if (source_id == 0u && g_context.has_latest_report) {
+    source_id = g_context.latest_report_id;
+  }
+  if (source_id == 0u || !blower_test_open_report_locked(source_id, &handle) ||
+      !blower_test_report_get_header(&handle.view, &header)) {
+    return BLOWER_TEST_REANALYZE_NOT_FOUND;
+  }
+
+  if (header.source_report_id != 0u) {
+    source_id = header.source_report_id;
+    // The measured report may have been evicted since.
+    if (!blower_test_open_report_locked(source_id, &handle)) {
+      return BLOWER_TEST_REANALYZE_RAW_UNAVAILABLE;
+    }
+  }
+  if (source_id != g_context.raw_report_id) {
+    result = blower_test_load_raw_locked(source_id);
+    if (result != BLOWER_TEST_REANALYZE_OK) {
+      return result;
+    }
+  }
+  if (!blower_test_report_decode(&handle.view, &g_context.active_report)) {
+    return BLOWER_TEST_REANALYZE_RAW_UNAVAILABLE;
+  }
+  return BLOWER_TEST_REANALYZE_OK;
+}
+
+blower_test_reanalyze_result_t blower_test_service_reanalyze(
+    uint32_t report_id, const blower_test_config_t *config, uint32_t *out_report_id) {
+  blower_test_config_t normalized = {0};
+  blower_test_report_t *report = &g_context.active_report;
+  blower_test_reanalyze_result_t result = BLOWER_TEST_REANALYZE_OK;
+
+  if (config == NULL || out_report_id == NULL || g_context.mutex == NULL) {
+    return BLOWER_TEST_REANALYZE_INVALID_CONFIG;
+  }
+
+  normalized = *config;
+  if (!blower_test_validate_and_normalize_config(&normalized)) {
+    return BLOWER_TEST_REANALYZE_INVALID_CONFIG;
+  }
+
+  if (xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return BLOWER_TEST_REANALYZE_BUSY;
+  }
+
+  // active_report is idle scratch space while no test runs.
+  result = g_context.runtime.active ? BLOWER_TEST_REANALYZE_BUSY
+                                    : blower_test_load_reanalysis_source_locked(report_id);
+  if (result != BLOWER_TEST_REANALYZE_OK) {
+    xSemaphoreGive(g_context.mutex);
+    return result;
+  }
+
+  report->source_report_id = report->report_id;
+  report->report_id = g_context.next_report_id++;
+  report->reference_pressure_pa = normalized.reference_pressure_pa;
+  if (report->pressurization.direction != BLOWER_TEST_DIRECTION_NONE) {
+    blower_test_reanalyze_direction_locked(&normalized, &report->pressurization);
+    report->has_pressurization = report->pressurization.summary.valid;
+  }
+  if (report->depressurization.direction != BLOWER_TEST_DIRECTION_NONE) {
+    blower_test_reanalyze_direction_locked(&normalized, &report->depressurization);
+    report->has_depressurization = report->depressurization.summary.valid;
+  }
+  blower_test_compute_mean_summary_locked();
+
+  blower_test_publish_slot_locked(false);
+  blower_test_set_latest_locked(report->report_id, &report->mean_summary);
+  blower_test_request_persist_locked();
+  *out_report_id = report->report_id;
+
   xSemaphoreGive(g_context.mutex);
-  return has_report;
+  blower_test_persist_flush();
+  return BLOWER_TEST_REANALYZE_OK;
 }
 
 const char *blower_test_mode_name(blower_test_mode_t mode) {
@@ -1231,6 +2293,8 @@ const char *blower_test_state_name(blower_test_state_t state) {
     return "stabilizing";
   case BLOWER_TEST_STATE_MEASURING:
     return "measuring";
+  case BLOWER_TEST_STATE_REZEROING:
+    return "rezeroing";
   case BLOWER_TEST_STATE_COMPLETED:
     return "completed";
   case BLOWER_TEST_STATE_ABORTED:
@@ -1242,6 +2306,34 @@ const char *blower_test_state_name(blower_test_state_t state) {
   }
 }
 
+const char *blower_test_verdict_name(blower_test_verdict_t verdict) {
+  switch (verdict) {
+  case BLOWER_TEST_VERDICT_PASS:
+    return "pass";
+  case BLOWER_TEST_VERDICT_FAIL:
+    return "fail";
+  default:
+    return "none";
+  }
+}
+
+const char *blower_test_queue_state_name(blower_test_queue_state_t state) {
+  switch (state) {
+  case BLOWER_TEST_QUEUE_STATE_IDLE:
+    return "idle";
+  case BLOWER_TEST_QUEUE_STATE_RUNNING:
+    return "running";
+  case BLOWER_TEST_QUEUE_STATE_WAITING_OPERATOR:
+    return "waiting_operator";
+  case BLOWER_TEST_QUEUE_STATE_COMPLETED:
+    return "completed";
+  case BLOWER_TEST_QUEUE_STATE_ABORTED:
+    return "aborted";
+  default:
+    return "unknown";
+  }
+}
+
 const char *blower_test_direction_name(blower_test_direction_t direction) {
   switch (direction) {
   case BLOWER_TEST_DIRECTION_PRESSURIZATION:
@@ -1,20 +1,90 @@
 #include "services/dimmer_control.h"
 
 #include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "shared_state.h"
+#include <stddef.h>
 
-static volatile uint8_t g_dimmer_power_percent;
+// The pending/committed command slots live in shared_state so the same
+// double buffer serves the core0 dimmer task and the core1 executive.
+typedef struct {
+  uint32_t submitted_sequence;
+  uint32_t submitted_us;
+  uint32_t accounted_sequence;
+  uint32_t latency_last_us;
+  uint32_t latency_max_us;
+} dimmer_control_latency_t;
 
-void dimmer_control_set_power_percent(uint8_t power_percent) {
-  uint32_t irq_state = save_and_disable_interrupts();
+static dimmer_control_latency_t g_latency;
 
-  g_dimmer_power_percent = power_percent <= 100u ? power_percent : 100u;
+static void dimmer_control_account_latency(const shared_dimmer_actuation_t *actuation) {
+  uint32_t irq_state = 0u;
+  int32_t latency_us = 0;
 
+  if (actuation->command_sequence != g_latency.submitted_sequence ||
+      g_latency.accounted_sequence == g_latency.submitted_sequence) {
+    return;
+  }
+
+  latency_us = (int32_t)(actuation->commit_us - g_latency.submitted_us);
+  if (latency_us < 0) {
+    latency_us = 0;
+  }
+
+  irq_state = save_and_disable_interrupts();
+  g_latency.accounted_sequence = g_latency.submitted_sequence;
+  g_latency.latency_last_us = (uint32_t)latency_us;
+  if ((uint32_t)latency_us > g_latency.latency_max_us) {
+    g_latency.latency_max_us = (uint32_t)latency_us;
+  }
   restore_interrupts(irq_state);
 }
 
+uint32_t dimmer_control_set_power_percent(uint8_t power_percent) {
+  shared_dimmer_actuation_t actuation;
+  uint32_t sequence = 0u;
+  uint32_t irq_state = 0u;
+
+  shared_dimmer_get_actuation(&actuation);
+  dimmer_control_account_latency(&actuation);
+
+  irq_state = save_and_disable_interrupts();
+  g_latency.submitted_us = time_us_32();
+  sequence = shared_dimmer_submit_command(power_percent <= 100u ? power_percent : 100u);
+  g_latency.submitted_sequence = sequence;
+  restore_interrupts(irq_state);
+
+  return sequence;
+}
+
 uint8_t dimmer_control_get_power_percent(void) {
-  uint32_t irq_state = save_and_disable_interrupts();
-  uint8_t power_percent = g_dimmer_power_percent;
+  return shared_get_dimmer_power_percent();
+}
+
+void dimmer_control_get_actuation(dimmer_control_actuation_t *out_actuation) {
+  shared_dimmer_actuation_t actuation;
+  uint32_t irq_state = 0u;
+
+  if (out_actuation == NULL) {
+    return;
+  }
+
+  shared_dimmer_get_actuation(&actuation);
+  dimmer_control_account_latency(&actuation);
+
+  irq_state = save_and_disable_interrupts();
+  *out_actuation = (dimmer_control_actuation_t){
+      .submitted_sequence = g_latency.submitted_sequence,
+      .command_sequence = actuation.command_sequence,
+      .power_percent = actuation.power_percent,
+      .half_cycle_sequence = actuation.half_cycle_sequence,
+      .commit_us = actuation.commit_us,
+      .fire_us = actuation.fire_us,
+      .fire_delay_us = actuation.fire_delay_us,
+      .command_latency_last_us = g_latency.latency_last_us,
+      .command_latency_max_us = g_latency.latency_max_us,
+      .asymmetric_cycle_count = actuation.asymmetric_cycle_count,
+      .last_asymmetry_us = actuation.last_asymmetry_us,
+  };
   restore_interrupts(irq_state);
-  return power_percent;
 }
@@ -0,0 +1,164 @@
+#include "services/dimmer_trace.h"
+
+#include "app/app_config.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/m33.h"
+#include "hardware/sync.h"
+#include "pico/platform.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+typedef struct {
+  atomic_uint count;
+  atomic_uint max;
+  atomic_uint total;
+  atomic_uint bins[DIMMER_TRACE_BIN_COUNT];
+} dimmer_trace_bins_t;
+
+// Written by two ISRs of the gate-timing core: the zero-cross handler and the
+// gate alarm, which preempts it and can land between a load and a store. So
+// updates are atomic read-modify-writes (LDREX/STREX on the M33), still
+// relaxed since readers only need each counter on its own.
+static dimmer_trace_bins_t g_edge_latency_us;
+static dimmer_trace_bins_t g_zero_cross_isr_cycles;
+static dimmer_trace_bins_t g_fire_error_us;
+static atomic_uint g_early_pulse_count;
+static atomic_uint g_late_pulse_count;
+static atomic_uint g_missed_pulse_count;
+static atomic_uint g_reset_requested;
+static atomic_uint g_reset_applied;
+
+static __force_inline void dimmer_trace_increment(atomic_uint *counter) {
+  atomic_fetch_add_explicit(counter, 1u, memory_order_relaxed);
+}
+
+static __force_inline uint32_t dimmer_trace_cycles(void) {
+  return m33_hw->dwt_cyccnt;
+}
+
+static void __time_critical_func(dimmer_trace_record)(dimmer_trace_bins_t *bins,
+                                                      uint32_t value, uint32_t shift) {
+  const uint32_t scaled = value >> shift;
+  uint32_t bin = scaled == 0u ? 0u : 32u - (uint32_t)__builtin_clz(scaled);
+
+  if (bin >= DIMMER_TRACE_BIN_COUNT) {
+    bin = DIMMER_TRACE_BIN_COUNT - 1u;
+  }
+
+  uint32_t max = atomic_load_explicit(&bins->max, memory_order_relaxed);
+
+  dimmer_trace_increment(&bins->count);
+  dimmer_trace_increment(&bins->bins[bin]);
+  atomic_fetch_add_explicit(&bins->total, value, memory_order_relaxed);
+  while (value > max &&
+         !atomic_compare_exchange_weak_explicit(&bins->max, &max, value,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+  }
+}
+
+static void __time_critical_func(dimmer_trace_clear_bins)(dimmer_trace_bins_t *bins) {
+  uint32_t index = 0u;
+
+  atomic_store_explicit(&bins->count, 0u, memory_order_relaxed);
+  atomic_store_explicit(&bins->max, 0u, memory_order_relaxed);
+  atomic_store_explicit(&bins->total, 0u, memory_order_relaxed);
+  for (index = 0u; index < DIMMER_TRACE_BIN_COUNT; ++index) {
+    atomic_store_explicit(&bins->bins[index], 0u, memory_order_relaxed);
+  }
+}
+
+// Runs in the zero-cross handler. The gate alarm is held off while clearing so
+// it cannot leave a histogram half cleared (count reset, bin kept).
+static void __time_critical_func(dimmer_trace_apply_reset)(void) {
+  const uint32_t requested =
+      atomic_load_explicit(&g_reset_requested, memory_order_acquire);
+  uint32_t saved_interrupts = 0u;
+
+  if (requested == atomic_load_explicit(&g_reset_applied, memory_order_relaxed)) {
+    return;
+  }
+
+  saved_interrupts = save_and_disable_interrupts();
+  dimmer_trace_clear_bins(&g_edge_latency_us);
+  dimmer_trace_clear_bins(&g_zero_cross_isr_cycles);
+  dimmer_trace_clear_bins(&g_fire_error_us);
+  atomic_store_explicit(&g_early_pulse_count, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_late_pulse_count, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_missed_pulse_count, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_reset_applied, requested, memory_order_release);
+  restore_interrupts(saved_interrupts);
+}
+
+static void dimmer_trace_copy_bins(const dimmer_trace_bins_t *bins,
+                                   dimmer_trace_histogram_t *out_histogram) {
+  uint32_t index = 0u;
+
+  out_histogram->count = atomic_load_explicit(&bins->count, memory_order_relaxed);
+  out_histogram->max = atomic_load_explicit(&bins->max, memory_order_relaxed);
+  out_histogram->total = atomic_load_explicit(&bins->total, memory_order_relaxed);
+  for (index = 0u; index < DIMMER_TRACE_BIN_COUNT; ++index) {
+    out_histogram->bins[index] =
+        atomic_load_explicit(&bins->bins[index], memory_order_relaxed);
+  }
+}
+
+void dimmer_trace_init(void) {
+  // DWT is per-core, so this must run on the core whose ISRs are traced.
+  m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+  m33_hw->dwt_cyccnt = 0u;
+  m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+}
+
+uint32_t __time_critical_func(dimmer_trace_zero_cross_begin)(uint32_t edge_us,
+                                                            uint32_t now_us) {
+  const uint32_t start_cycles = dimmer_trace_cycles();
+
+  dimmer_trace_apply_reset();
+  dimmer_trace_record(&g_edge_latency_us, now_us - edge_us, 0u);
+  return start_cycles;
+}
+
+void __time_critical_func(dimmer_trace_zero_cross_end)(uint32_t start_cycles) {
+  dimmer_trace_record(&g_zero_cross_isr_cycles, dimmer_trace_cycles() - start_cycles,
+                      DIMMER_TRACE_CYCLE_BIN_SHIFT);
+}
+
+void __time_critical_func(dimmer_trace_note_fire)(uint32_t target_us, uint32_t fire_us) {
+  const int32_t error_us = (int32_t)(fire_us - target_us);
+
+  if (error_us < 0) {
+    dimmer_trace_increment(&g_early_pulse_count);
+  } else if (error_us > (int32_t)APP_DIMMER_TRACE_LATE_US) {
+    dimmer_trace_increment(&g_late_pulse_count);
+  }
+  dimmer_trace_record(&g_fire_error_us, error_us > 0 ? (uint32_t)error_us : 0u, 0u);
+}
+
+void __time_critical_func(dimmer_trace_note_missed)(void) {
+  dimmer_trace_increment(&g_missed_pulse_count);
+}
+
+void dimmer_trace_request_reset(void) {
+  atomic_fetch_add_explicit(&g_reset_requested, 1u, memory_order_release);
+}
+
+void dimmer_trace_get_snapshot(dimmer_trace_snapshot_t *out_snapshot) {
+  if (out_snapshot == NULL) {
+    return;
+  }
+
+  *out_snapshot = (dimmer_trace_snapshot_t){
+      .reset_count = atomic_load_explicit(&g_reset_applied, memory_order_acquire),
+      .cpu_hz = clock_get_hz(clk_sys),
+      .early_pulse_count =
+          atomic_load_explicit(&g_early_pulse_count, memory_order_relaxed),
+      .late_pulse_count =
+          atomic_load_explicit(&g_late_pulse_count, memory_order_relaxed),
+      .missed_pulse_count =
+          atomic_load_explicit(&g_missed_pulse_count, memory_order_relaxed),
+  };
+  dimmer_trace_copy_bins(&g_edge_latency_us, &out_snapshot->edge_latency_us);
+  dimmer_trace_copy_bins(&g_zero_cross_isr_cycles, &out_snapshot->zero_cross_isr_cycles);
+  dimmer_trace_copy_bins(&g_fire_error_us, &out_snapshot->fire_error_us);
+}
@@ -0,0 +1,703 @@
+#include "services/flash_journal.h"
+
+#include "app/app_config.h"
+#include "hardware/flash.h"
+#include "hardware/regs/addressmap.h"
+#include "services/flash_writer.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FLASH_JOURNAL_SECTOR_MAGIC 0x534a5442u /* BTJS */
+// A compacted sector keeps its header with the magic programmed to zero, so its
+// erase count survives until the sector is erased for reuse.
+#define FLASH_JOURNAL_RETIRED_MAGIC 0x00000000u
+#define FLASH_JOURNAL_RECORD_MAGIC 0x524au
+#define FLASH_JOURNAL_ERASED_MAGIC 0xffffu
+#define FLASH_JOURNAL_FLAG_EVICTABLE 0x01u
+#define FLASH_JOURNAL_RESERVE_SECTORS 1u
+#define FLASH_JOURNAL_SECTOR_COUNT \
+  (APP_PERSISTENT_STORAGE_SIZE_BYTES / FLASH_SECTOR_SIZE)
+#define FLASH_JOURNAL_NO_SECTOR 0xffffu
+#define FLASH_JOURNAL_NOT_FOUND UINT32_MAX
+
+typedef struct {
+  uint32_t magic;
+  uint16_t format_version;
+  uint16_t reserved0;
+  uint32_t sequence;
+  uint32_t erase_count;
+  uint32_t crc32;
+} flash_journal_sector_header_t;
+
+typedef struct {
+  uint16_t magic;
+  uint8_t type;
+  uint8_t flags;
+  uint32_t key;
+  uint32_t length;
+  uint32_t crc32;
+} flash_journal_record_header_t;
+
+typedef struct {
+  uint32_t sequence;
+  uint32_t erase_count;
+  bool used;
+  bool erased;
+} flash_journal_sector_t;
+
+typedef struct {
+  uint8_t type;
+  uint8_t flags;
+  uint32_t key;
+  // Absolute flash offset of the record header.
+  uint32_t record_offset;
+  uint32_t length;
+} flash_journal_index_entry_t;
+
+_Static_assert(FLASH_JOURNAL_SECTOR_COUNT <= FLASH_JOURNAL_MAX_SECTORS,
+               "APP_PERSISTENT_STORAGE_SIZE_BYTES exceeds FLASH_JOURNAL_MAX_SECTORS");
+_Static_assert(FLASH_JOURNAL_SECTOR_COUNT >= 2u + FLASH_JOURNAL_RESERVE_SECTORS,
+               "Flash journal needs at least three sectors");
+
+static flash_journal_sector_t g_sectors[FLASH_JOURNAL_MAX_SECTORS];
+static flash_journal_index_entry_t g_index[APP_JOURNAL_MAX_RECORDS];
+static uint32_t g_index_count;
+static uint8_t g_page_buffer[FLASH_PAGE_SIZE];
+static uint16_t g_format_version;
+static uint16_t g_head_sector = FLASH_JOURNAL_NO_SECTOR;
+static uint32_t g_head_offset;
+static uint32_t g_next_sequence;
+static uint32_t g_live_bytes;
+static uint32_t g_compactions;
+static uint32_t g_evicted_records;
+static volatile uint32_t g_erase_generation;
+static bool g_mounted;
+
+static uint32_t flash_journal_crc32_update(uint32_t crc, const uint8_t *data,
+                                           size_t data_len) {
+  uint32_t value = crc;
+  size_t index = 0u;
+
+  for (index = 0u; index < data_len; ++index) {
+    uint32_t bit = 0u;
+    value ^= data[index];
+    for (bit = 0u; bit < 8u; ++bit) {
+      const uint32_t mask = (uint32_t)-(int32_t)(value & 1u);
+      value = (value >> 1u) ^ (0xedb88320u & mask);
+    }
+  }
+
+  return value;
+}
+
+static uint32_t flash_journal_sector_header_crc(
+    const flash_journal_sector_header_t *header) {
+  return flash_journal_crc32_update(0xffffffffu, (const uint8_t *)header,
+                                    offsetof(flash_journal_sector_header_t, crc32)) ^
+         0xffffffffu;
+}
+
+static uint32_t flash_journal_record_crc(const flash_journal_record_header_t *header,
+                                         const uint8_t *payload) {
+  const uint32_t crc = flash_journal_crc32_update(
+      0xffffffffu, (const uint8_t *)header,
+      offsetof(flash_journal_record_header_t, crc32));
+  return flash_journal_crc32_update(crc, payload, header->length) ^ 0xffffffffu;
+}
+
+static const uint8_t *flash_journal_xip(uint32_t flash_offset) {
+  return (const uint8_t *)(XIP_BASE + flash_offset);
+}
+
+static uint32_t flash_journal_sector_base(uint16_t sector) {
+  return APP_PERSISTENT_STORAGE_OFFSET_BYTES + (uint32_t)sector * FLASH_SECTOR_SIZE;
+}
+
+static uint32_t flash_journal_record_size(uint32_t length) {
+  return (uint32_t)((sizeof(flash_journal_record_header_t) + length + 3u) & ~3u);
+}
+
+static uint32_t flash_journal_sector_payload(void) {
+  return FLASH_SECTOR_SIZE - (uint32_t)sizeof(flash_journal_sector_header_t);
+}
+
+static bool flash_journal_layout_is_valid(void) {
+  const uint32_t storage_end =
+      APP_PERSISTENT_STORAGE_OFFSET_BYTES + APP_PERSISTENT_STORAGE_SIZE_BYTES;
+
+  if ((APP_PERSISTENT_STORAGE_OFFSET_BYTES % FLASH_SECTOR_SIZE) != 0u ||
+      (APP_PERSISTENT_STORAGE_SIZE_BYTES % FLASH_SECTOR_SIZE) != 0u) {
+    return false;
+  }
+  if (APP_PERSISTENT_STORAGE_OFFSET_BYTES >= PICO_FLASH_SIZE_BYTES ||
+      storage_end > PICO_FLASH_SIZE_BYTES) {
+    return false;
+  }
+
+  return true;
+}
+
+static bool flash_journal_is_blank(uint32_t flash_offset, uint32_t length) {
+  const uint8_t *flash_bytes = flash_journal_xip(flash_offset);
+  uint32_t index = 0u;
+
+  for (index = 0u; index < length; ++index) {
+    if (flash_bytes[index] != 0xffu) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool flash_journal_erase_sector(uint16_t sector) {
+  const uint32_t base = flash_journal_sector_base(sector);
+
+  // Bumped before the erase starts so no XIP view outlives it.
+  g_erase_generation += 1u;
+  if (!flash_writer_erase_sector(base)) {
+    // Refused while the dimmer runs, or failed: the sector was not erased,
+    // so it gains no wear and stays free for a later attempt.
+    return false;
+  }
+
+  g_sectors[sector].erase_count += 1u;
+  g_sectors[sector].used = false;
+  g_sectors[sector].erased = flash_journal_is_blank(base, FLASH_SECTOR_SIZE);
+  return g_sectors[sector].erased;
+}
+
+static void flash_journal_overlay(uint32_t page_base, uint32_t dest_offset,
+                                  const uint8_t *source, uint32_t length) {
+  const uint32_t page_end = page_base + FLASH_PAGE_SIZE;
+  const uint32_t begin = dest_offset > page_base ? dest_offset : page_base;
+  const uint32_t end =
+      (dest_offset + length) < page_end ? (dest_offset + length) : page_end;
+
+  if (begin < end) {
+    memcpy(g_page_buffer + (begin - page_base), source + (begin - dest_offset),
+           end - begin);
+  }
+}
+
+// Programs header + payload one page at a time. Bytes already in the page are
+// read back and reprogrammed unchanged, so records can share pages.
+static bool flash_journal_program(uint32_t flash_offset, const uint8_t *header,
+                                  uint32_t header_length, const uint8_t *payload,
+                                  uint32_t payload_length) {
+  const uint32_t end = flash_offset + header_length + payload_length;
+  uint32_t page_base = flash_offset & ~(uint32_t)(FLASH_PAGE_SIZE - 1u);
+
+  for (; page_base < end; page_base += FLASH_PAGE_SIZE) {
+    memcpy(g_page_buffer, flash_journal_xip(page_base), FLASH_PAGE_SIZE);
+    flash_journal_overlay(page_base, flash_offset, header, header_length);
+    if (payload_length > 0u) {
+      flash_journal_overlay(page_base, flash_offset + header_length, payload,
+                            payload_length);
+    }
+
+    if (!flash_writer_program_page(page_base, g_page_buffer)) {
+      return false;
+    }
+  }
+
+  return memcmp(flash_journal_xip(flash_offset), header, header_length) == 0 &&
+         (payload_length == 0u ||
+          memcmp(flash_journal_xip(flash_offset + header_length), payload,
+                 payload_length) == 0);
+}
+
+static uint32_t flash_journal_index_find(uint8_t type, uint32_t key) {
+  uint32_t index = 0u;
+
+  for (index = 0u; index < g_index_count; ++index) {
+    if (g_index[index].type == type && g_index[index].key == key) {
+      return index;
+    }
+  }
+  return FLASH_JOURNAL_NOT_FOUND;
+}
+
+static uint32_t flash_journal_index_find_offset(uint32_t record_offset) {
+  uint32_t index = 0u;
+
+  for (index = 0u; index < g_index_count; ++index) {
+    if (g_index[index].record_offset == record_offset) {
+      return index;
+    }
+  }
+  return FLASH_JOURNAL_NOT_FOUND;
+}
+
+static void flash_journal_index_remove(uint32_t index) {
+  g_live_bytes -= flash_journal_record_size(g_index[index].length);
+  memmove(&g_index[index], &g_index[index + 1u],
+          (g_index_count - index - 1u) * sizeof(g_index[0]));
+  g_index_count -= 1u;
+}
+
+static bool flash_journal_index_evict_oldest(void) {
+  uint32_t index = 0u;
+
+  for (index = 0u; index < g_index_count; ++index) {
+    if ((g_index[index].flags & FLASH_JOURNAL_FLAG_EVICTABLE) != 0u) {
+      flash_journal_index_remove(index);
+      g_evicted_records += 1u;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Newest record per (type, key) wins; insertion order is append order.
+static bool flash_journal_index_upsert(const flash_journal_record_header_t *header,
+                                       uint32_t record_offset) {
+  const uint32_t existing = flash_journal_index_find(header->type, header->key);
+
+  if (existing != FLASH_JOURNAL_NOT_FOUND) {
+    flash_journal_index_remove(existing);
+  } else if (g_index_count >= APP_JOURNAL_MAX_RECORDS &&
+             !flash_journal_index_evict_oldest()) {
+    return false;
+  }
+
+  g_index[g_index_count] = (flash_journal_index_entry_t){
+      .type = header->type,
+      .flags = header->flags,
+      .key = header->key,
+      .record_offset = record_offset,
+      .length = header->length,
+  };
+  g_index_count += 1u;
+  g_live_bytes += flash_journal_record_size(header->length);
+  return true;
+}
+
+static uint16_t flash_journal_free_sectors(void) {
+  uint16_t sector = 0u;
+  uint16_t count = 0u;
+
+  for (sector = 0u; sector < FLASH_JOURNAL_SECTOR_COUNT; ++sector) {
+    if (!g_sectors[sector].used) {
+      count += 1u;
+    }
+  }
+  return count;
+}
+
+static uint32_t flash_journal_live_bytes_in_sector(uint16_t sector) {
+  const uint32_t base = flash_journal_sector_base(sector);
+  uint32_t index = 0u;
+  uint32_t bytes = 0u;
+
+  for (index = 0u; index < g_index_count; ++index) {
+    if (g_index[index].record_offset >= base &&
+        g_index[index].record_offset < (base + FLASH_SECTOR_SIZE)) {
+      bytes += flash_journal_record_size(g_index[index].length);
+    }
+  }
+  return bytes;
+}
+
+static bool flash_journal_compact_oldest(void);
+
+static bool flash_journal_open_sector(bool allow_compaction) {
+  flash_journal_sector_header_t header = {0};
+  uint16_t sector = 0u;
+  uint16_t pick = FLASH_JOURNAL_NO_SECTOR;
+  uint16_t attempts = 0u;
+
+  if (allow_compaction) {
+    while (flash_journal_free_sectors() <= FLASH_JOURNAL_RESERVE_SECTORS &&
+           attempts < FLASH_JOURNAL_SECTOR_COUNT) {
+      if (!flash_journal_compact_oldest()) {
+        break;
+      }
+      attempts += 1u;
+    }
+    if (flash_journal_free_sectors() <= FLASH_JOURNAL_RESERVE_SECTORS) {
+      return false;
+    }
+  }
+
+  // Wear leveling: the free sector with the fewest erases goes next.
+  for (sector = 0u; sector < FLASH_JOURNAL_SECTOR_COUNT; ++sector) {
+    if (!g_sectors[sector].used &&
+        (pick == FLASH_JOURNAL_NO_SECTOR ||
+         g_sectors[sector].erase_count < g_sectors[pick].erase_count)) {
+      pick = sector;
+    }
+  }
+  if (pick == FLASH_JOURNAL_NO_SECTOR) {
+    return false;
+  }
+  if (!g_sectors[pick].erased && !flash_journal_erase_sector(pick)) {
+    return false;
+  }
+
+  header = (flash_journal_sector_header_t){
+      .magic = FLASH_JOURNAL_SECTOR_MAGIC,
+      .format_version = g_format_version,
+      .sequence = g_next_sequence,
+      .erase_count = g_sectors[pick].erase_count,
+  };
+  header.crc32 = flash_journal_sector_header_crc(&header);
+  g_sectors[pick].used = true;
+  g_sectors[pick].erased = false;
+  g_sectors[pick].sequence = g_next_sequence++;
+  g_head_sector = pick;
+  g_head_offset = FLASH_SECTOR_SIZE;
+  if (!flash_journal_program(flash_journal_sector_base(pick), (const uint8_t *)&header,
+                             sizeof(header), NULL, 0u)) {
+    return false;
+  }
+
+  g_head_offset = sizeof(header);
+  return true;
+}
+
+static uint32_t flash_journal_write_record(const flash_journal_record_header_t *header,
+                                           const uint8_t *payload,
+                                           bool allow_compaction) {
+  const uint32_t size = flash_journal_record_size(header->length);
+  uint32_t record_offset = 0u;
+
+  if (g_head_sector == FLASH_JOURNAL_NO_SECTOR ||
+      (g_head_offset + size) > FLASH_SECTOR_SIZE) {
+    if (!flash_journal_open_sector(allow_compaction)) {
+      return FLASH_JOURNAL_NOT_FOUND;
+    }
+  }
+
+  record_offset = flash_journal_sector_base(g_head_sector) + g_head_offset;
+  if (!flash_journal_program(record_offset, (const uint8_t *)header, sizeof(*header),
+                             payload, header->length)) {
+    // The tail of this sector may hold a partial record; seal it.
+    g_head_offset = FLASH_SECTOR_SIZE;
+    return FLASH_JOURNAL_NOT_FOUND;
+  }
+
+  g_head_offset += size;
+  return record_offset;
+}
+
+static uint16_t flash_journal_oldest_sector(void) {
+  uint16_t sector = 0u;
+  uint16_t oldest = FLASH_JOURNAL_NO_SECTOR;
+
+  for (sector = 0u; sector < FLASH_JOURNAL_SECTOR_COUNT; ++sector) {
+    if (g_sectors[sector].used && sector != g_head_sector &&
+        (oldest == FLASH_JOURNAL_NO_SECTOR ||
+         g_sectors[sector].sequence < g_sectors[oldest].sequence)) {
+      oldest = sector;
+    }
+  }
+  return oldest;
+}
+
+// Frees a compacted sector without erasing it; flash_journal_open_sector()
+// erases it when it is picked, right before the header with the new count.
+static bool flash_journal_retire_sector(uint16_t sector) {
+  const uint32_t retired_magic = FLASH_JOURNAL_RETIRED_MAGIC;
+
+  g_sectors[sector].used = false;
+  g_sectors[sector].erased = false;
+  return flash_journal_program(flash_journal_sector_base(sector),
+                               (const uint8_t *)&retired_magic, sizeof(retired_magic),
+                               NULL, 0u);
+}
+
+// True when the oldest sector's live records cannot all be kept: they do not
+// fit in the head's free space plus the free sectors (the reserve included,
+// it exists for this), or the journal holds more live data than fits outside
+// the reserve and a fresh head sector, so moving them would free nothing.
+static bool flash_journal_must_evict(uint16_t oldest) {
+  const uint32_t free_space =
+      (FLASH_SECTOR_SIZE - g_head_offset) +
+      (uint32_t)flash_journal_free_sectors() * flash_journal_sector_payload();
+  const uint32_t keep_capacity =
+      (FLASH_JOURNAL_SECTOR_COUNT - FLASH_JOURNAL_RESERVE_SECTORS - 1u) *
+      flash_journal_sector_payload();
+
+  return g_head_sector == FLASH_JOURNAL_NO_SECTOR ||
+         g_index_count >= APP_JOURNAL_MAX_RECORDS ||
+         flash_journal_live_bytes_in_sector(oldest) > free_space ||
+         g_live_bytes > keep_capacity;
+}
+
+// Moves the live records of the oldest sector to the head, then retires it.
+// When flash_journal_must_evict() says they cannot all be kept, evictable
+// records (the oldest reports) are dropped instead.
+static bool flash_journal_compact_oldest(void) {
+  const uint16_t oldest = flash_journal_oldest_sector();
+  uint32_t base = 0u;
+  uint32_t offset = sizeof(flash_journal_sector_header_t);
+  bool evict = false;
+
+  if (oldest == FLASH_JOURNAL_NO_SECTOR) {
+    return false;
+  }
+
+  base = flash_journal_sector_base(oldest);
+  evict = flash_journal_must_evict(oldest);
+  while ((offset + sizeof(flash_journal_record_header_t)) <= FLASH_SECTOR_SIZE) {
+    flash_journal_record_header_t header = {0};
+    uint32_t index = 0u;
+
+    memcpy(&header, flash_journal_xip(base + offset), sizeof(header));
+    if (header.magic != FLASH_JOURNAL_RECORD_MAGIC ||
+        header.length > (FLASH_SECTOR_SIZE - offset - sizeof(header))) {
+      break;
+    }
+
+    index = flash_journal_index_find_offset(base + offset);
+    if (index != FLASH_JOURNAL_NOT_FOUND) {
+      if (evict && (header.flags & FLASH_JOURNAL_FLAG_EVICTABLE) != 0u) {
+        flash_journal_index_remove(index);
+        g_evicted_records += 1u;
+      } else {
+        const uint32_t moved_offset = flash_journal_write_record(
+            &header, flash_journal_xip(base + offset + sizeof(header)), false);
+        if (moved_offset == FLASH_JOURNAL_NOT_FOUND) {
+          return false;
+        }
+        g_index[index].record_offset = moved_offset;
+      }
+    }
+    offset += flash_journal_record_size(header.length);
+  }
+
+  g_compactions += 1u;
+  return flash_journal_retire_sector(oldest);
+}
+
+// Replays one sector into the index; returns where the next record would go.
+static uint32_t flash_journal_replay_sector(uint16_t sector) {
+  const uint32_t base = flash_journal_sector_base(sector);
+  uint32_t offset = sizeof(flash_journal_sector_header_t);
+
+  while ((offset + sizeof(flash_journal_record_header_t)) <= FLASH_SECTOR_SIZE) {
+    flash_journal_record_header_t header = {0};
+
+    memcpy(&header, flash_journal_xip(base + offset), sizeof(header));
+    if (header.magic == FLASH_JOURNAL_ERASED_MAGIC) {
+      return offset;
+    }
+    if (header.magic != FLASH_JOURNAL_RECORD_MAGIC ||
+        header.length > (FLASH_SECTOR_SIZE - offset - sizeof(header)) ||
+        flash_journal_record_crc(&header,
+                                 flash_journal_xip(base + offset + sizeof(header))) !=
+            header.crc32) {
+      // Torn or corrupt write: nothing after it in this sector is trusted.
+      return FLASH_SECTOR_SIZE;
+    }
+
+    (void)flash_journal_index_upsert(&header, base + offset);
+    offset += flash_journal_record_size(header.length);
+  }
+
+  return FLASH_SECTOR_SIZE;
+}
+
+bool flash_journal_mount(uint16_t format_version) {
+  uint32_t max_erase_count = 0u;
+  uint32_t replay_sequence = 0u;
+  uint16_t sector = 0u;
+  bool has_replayed = false;
+
+  g_mounted = false;
+  g_format_version = format_version;
+  g_index_count = 0u;
+  g_live_bytes = 0u;
+  g_head_sector = FLASH_JOURNAL_NO_SECTOR;
+  g_head_offset = 0u;
+  g_next_sequence = 1u;
+  g_compactions = 0u;
+  g_evicted_records = 0u;
+  memset(g_sectors, 0, sizeof(g_sectors));
+
+  if (!flash_journal_layout_is_valid()) {
+    return false;
+  }
+
+  for (sector = 0u; sector < FLASH_JOURNAL_SECTOR_COUNT; ++sector) {
+    flash_journal_sector_header_t header = {0};
+    const uint32_t base = flash_journal_sector_base(sector);
+    bool header_valid = false;
+    bool retired = false;
+
+    memcpy(&header, flash_journal_xip(base), sizeof(header));
+    // The CRC was taken while the sector was live.
+    retired = header.magic == FLASH_JOURNAL_RETIRED_MAGIC;
+    if (retired) {
+      header.magic = FLASH_JOURNAL_SECTOR_MAGIC;
+    }
+    header_valid = header.magic == FLASH_JOURNAL_SECTOR_MAGIC &&
+                   header.crc32 == flash_journal_sector_header_crc(&header);
+    if (header_valid) {
+      g_sectors[sector].erase_count = header.erase_count;
+      if (header.erase_count > max_erase_count) {
+        max_erase_count = header.erase_count;
+      }
+    }
+    if (header_valid && !retired && header.format_version == format_version) {
+      g_sectors[sector].used = true;
+      g_sectors[sector].sequence = header.sequence;
+      if (header.sequence >= g_next_sequence) {
+        g_next_sequence = header.sequence + 1u;
+      }
+    } else {
+      g_sectors[sector].erased = flash_journal_is_blank(base, FLASH_SECTOR_SIZE);
+    }
+  }
+
+  // Sectors with a damaged header get the worst known wear.
+  for (sector = 0u; sector < FLASH_JOURNAL_SECTOR_COUNT; ++sector) {
+    if (!g_sectors[sector].used && !g_sectors[sector].erased &&
+        g_sectors[sector].erase_count == 0u) {
+      g_sectors[sector].erase_count = max_erase_count;
+    }
+  }
+
+  // Replay in write order so newer records supersede older ones.
+  for (;;) {
+    uint16_t next = FLASH_JOURNAL_NO_SECTOR;
+
+    for (sector = 0u; sector < FLASH_JOURNAL_SECTOR_COUNT; ++sector) {
+      if (g_sectors[sector].used &&
+          (!has_replayed || g_sectors[sector].sequence > replay_sequence) &&
+          (next == FLASH_JOURNAL_NO_SECTOR ||
+           g_sectors[sector].sequence < g_sectors[next].sequence)) {
+        next = sector;
+      }
+    }
+    if (next == FLASH_JOURNAL_NO_SECTOR) {
+      break;
+    }
+
+    g_head_sector = next;
+    g_head_offset = flash_journal_replay_sector(next);
+    replay_sequence = g_sectors[next].sequence;
+    has_replayed = true;
+  }
+
+  g_mounted = true;
+  return true;
+}
+
+bool flash_journal_append(uint8_t type, uint32_t key, bool evictable,
+                          const void *data, uint32_t length) {
+  flash_journal_record_header_t header = {0};
+  uint32_t record_offset = 0u;
+
+  if (!g_mounted || (data == NULL && length > 0u) ||
+      flash_journal_record_size(length) > flash_journal_sector_payload()) {
+    return false;
+  }
+
+  header = (flash_journal_record_header_t){
+      .magic = FLASH_JOURNAL_RECORD_MAGIC,
+      .type = type,
+      .flags = evictable ? FLASH_JOURNAL_FLAG_EVICTABLE : 0u,
+      .key = key,
+      .length = length,
+  };
+  header.crc32 = flash_journal_record_crc(&header, (const uint8_t *)data);
+
+  record_offset = flash_journal_write_record(&header, (const uint8_t *)data, true);
+  if (record_offset == FLASH_JOURNAL_NOT_FOUND) {
+    return false;
+  }
+  return flash_journal_index_upsert(&header, record_offset);
+}
+
+static void flash_journal_fill_entry(uint32_t index, flash_journal_entry_t *out_entry) {
+  *out_entry = (flash_journal_entry_t){
+      .type = g_index[index].type,
+      .key = g_index[index].key,
+      .payload_offset =
+          g_index[index].record_offset + (uint32_t)sizeof(flash_journal_record_header_t),
+      .length = g_index[index].length,
+  };
+}
+
+bool flash_journal_find(uint8_t type, uint32_t key, flash_journal_entry_t *out_entry) {
+  const uint32_t index = flash_journal_index_find(type, key);
+
+  if (out_entry == NULL || index == FLASH_JOURNAL_NOT_FOUND) {
+    return false;
+  }
+
+  flash_journal_fill_entry(index, out_entry);
+  return true;
+}
+
+uint32_t flash_journal_list(uint8_t type, uint32_t skip, flash_journal_entry_t *out_entries,
+                            uint32_t max_entries, uint32_t *out_total) {
+  uint32_t index = g_index_count;
+  uint32_t matched = 0u;
+  uint32_t written = 0u;
+
+  while (index > 0u) {
+    index -= 1u;
+    if (g_index[index].type != type) {
+      continue;
+    }
+    if (matched >= skip && written < max_entries && out_entries != NULL) {
+      flash_journal_fill_entry(index, &out_entries[written]);
+      written += 1u;
+    }
+    matched += 1u;
+  }
+
+  if (out_total != NULL) {
+    *out_total = matched;
+  }
+  return written;
+}
+
+bool flash_journal_read(const flash_journal_entry_t *entry, uint32_t offset, void *out_data,
+                        uint32_t length) {
+  if (entry == NULL || out_data == NULL || offset > entry->length ||
+      length > (entry->length - offset)) {
+    return false;
+  }
+
+  memcpy(out_data, flash_journal_xip(entry->payload_offset + offset), length);
+  return true;
+}
+
+const uint8_t *flash_journal_payload(const flash_journal_entry_t *entry) {
+  return entry != NULL ? flash_journal_xip(entry->payload_offset) : NULL;
+}
+
+uint32_t flash_journal_generation(void) {
+  return g_erase_generation;
+}
+
+void flash_journal_get_stats(flash_journal_stats_t *out_stats) {
+  uint16_t sector = 0u;
+
+  if (out_stats == NULL) {
+    return;
+  }
+
+  *out_stats = (flash_journal_stats_t){
+      .sector_count = FLASH_JOURNAL_SECTOR_COUNT,
+      .free_sectors = flash_journal_free_sectors(),
+      .min_erase_count = UINT32_MAX,
+      .live_records = g_index_count,
+      .live_bytes = g_live_bytes,
+      .capacity_bytes = FLASH_JOURNAL_SECTOR_COUNT * flash_journal_sector_payload(),
+      .compactions = g_compactions,
+      .evicted_records = g_evicted_records,
+  };
+  for (sector = 0u; sector < FLASH_JOURNAL_SECTOR_COUNT; ++sector) {
+    if (g_sectors[sector].erase_count < out_stats->min_erase_count) {
+      out_stats->min_erase_count = g_sectors[sector].erase_count;
+    }
+    if (g_sectors[sector].erase_count > out_stats->max_erase_count) {
+      out_stats->max_erase_count = g_sectors[sector].erase_count;
+    }
+  }
+}
@@ -0,0 +1,217 @@
+#include "services/flash_writer.h"
+
+#include "FreeRTOS.h"
+#include "app/app_config.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "pico/flash.h"
+#include "shared_state.h"
+#include "task.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Shortest half-cycle the mains PLL accepts; used as the deadline after the
+// last gate pulse because the next zero-cross can come no sooner.
+#define FLASH_WRITER_MIN_HALF_CYCLE_US \
+  ((uint32_t)(500000.0f / APP_MAINS_MAX_FREQUENCY_HZ))
+
+typedef enum {
+  FLASH_WRITER_OP_ERASE = 0,
+  FLASH_WRITER_OP_PROGRAM,
+} flash_writer_op_kind_t;
+
+typedef struct {
+  flash_writer_op_kind_t kind;
+  uint32_t flash_offset;
+  const uint8_t *data;
+} flash_writer_op_t;
+
+static flash_writer_stats_t g_stats;
+static volatile uint32_t g_lockout_start_us;
+static volatile uint32_t g_lockout_end_us;
+static volatile bool g_lockout_seen;
+
+// Runs with XIP disabled and core0 interrupts masked, so everything it
+// touches must be in SRAM.
+static void __not_in_flash_func(flash_writer_execute)(void *param) {
+  const flash_writer_op_t *op = (const flash_writer_op_t *)param;
+  const uint32_t start_us = time_us_32();
+
+  g_lockout_start_us = start_us;
+  g_lockout_end_us = start_us;
+  g_lockout_seen = true;
+  if (op->kind == FLASH_WRITER_OP_ERASE) {
+    flash_range_erase(op->flash_offset, FLASH_SECTOR_SIZE);
+  } else {
+    flash_range_program(op->flash_offset, op->data, FLASH_PAGE_SIZE);
+  }
+  g_lockout_end_us = time_us_32();
+}
+
+// Microseconds core0 may stay masked before the dimmer needs it again.
+static uint32_t flash_writer_dimmer_window_us(void) {
+#if APP_DIMMER_ON_CORE1
+  return UINT32_MAX;
+#else
+  shared_dimmer_actuation_t actuation;
+  uint32_t half_cycle_start_us = 0u;
+  uint32_t elapsed_us = 0u;
+
+  shared_dimmer_get_actuation(&actuation);
+  if ((time_us_32() - actuation.commit_us) >= APP_LINE_SYNC_TIMEOUT_US) {
+    return UINT32_MAX;
+  }
+
+  if (actuation.power_percent == 0u || actuation.power_percent >= 100u) {
+    half_cycle_start_us = actuation.commit_us;
+  } else if (actuation.fire_us != 0u &&
+             actuation.fire_half_cycle_sequence == actuation.half_cycle_sequence) {
+    half_cycle_start_us = actuation.fire_us - actuation.fire_delay_us;
+  } else {
+    return 0u;
+  }
+
+  elapsed_us = time_us_32() - half_cycle_start_us;
+  return elapsed_us < FLASH_WRITER_MIN_HALF_CYCLE_US
+             ? FLASH_WRITER_MIN_HALF_CYCLE_US - elapsed_us
+             : 0u;
+#endif
+}
+
+bool flash_writer_erase_allowed(void) {
+#if APP_DIMMER_ON_CORE1
+  return true;
+#else
+  shared_dimmer_actuation_t actuation;
+
+  shared_dimmer_get_actuation(&actuation);
+  if ((time_us_32() - actuation.commit_us) >= APP_LINE_SYNC_TIMEOUT_US) {
+    return true;
+  }
+  return actuation.power_percent == 0u && shared_get_dimmer_power_percent() == 0u;
+#endif
+}
+
+// Pages wait for a gap after the gate they fit in. Erases cannot fit a
+// half-cycle whatever the timing, so they wait until the dimmer is at 0%.
+static bool flash_writer_wait_for_window(const flash_writer_op_t *op) {
+  const TickType_t start_tick = xTaskGetTickCount();
+  bool waited = false;
+
+  for (;;) {
+    if (op->kind == FLASH_WRITER_OP_ERASE) {
+      if (flash_writer_erase_allowed()) {
+        break;
+      }
+    } else {
+      const uint32_t window_us = flash_writer_dimmer_window_us();
+      if (window_us >= APP_FLASH_WRITER_PAGE_WINDOW_US) {
+        break;
+      }
+    }
+    if ((xTaskGetTickCount() - start_tick) >=
+        pdMS_TO_TICKS(APP_FLASH_WRITER_WINDOW_TIMEOUT_MS)) {
+      return false;
+    }
+    waited = true;
+    vTaskDelay(1);
+  }
+
+  if (waited) {
+    const uint32_t irq_state = save_and_disable_interrupts();
+    g_stats.window_wait_count += 1u;
+    restore_interrupts(irq_state);
+  }
+  return true;
+}
+
+static bool flash_writer_run(flash_writer_op_t *op) {
+  shared_dimmer_health_t health_before;
+  shared_dimmer_health_t health_after;
+  const bool in_window = flash_writer_wait_for_window(op);
+  uint32_t lockout_us = 0u;
+  uint32_t irq_state = 0u;
+  int result = PICO_OK;
+
+  // An erase is never forced: with the dimmer running it would swallow gates.
+  if (!in_window && op->kind == FLASH_WRITER_OP_ERASE) {
+    irq_state = save_and_disable_interrupts();
+    g_stats.erase_refused_count += 1u;
+    restore_interrupts(irq_state);
+    return false;
+  }
+
+  shared_dimmer_get_health(&health_before);
+  result = flash_safe_execute(flash_writer_execute, op,
+                              APP_FLASH_WRITER_LOCKOUT_TIMEOUT_MS);
+  shared_dimmer_get_health(&health_after);
+  lockout_us = g_lockout_end_us - g_lockout_start_us;
+
+  irq_state = save_and_disable_interrupts();
+  if (result != PICO_OK) {
+    g_stats.failed_count += 1u;
+  } else if (op->kind == FLASH_WRITER_OP_ERASE) {
+    g_stats.erase_count += 1u;
+  } else {
+    g_stats.program_count += 1u;
+  }
+  if (!in_window) {
+    g_stats.forced_count += 1u;
+  }
+  if (result == PICO_OK) {
+    g_stats.lockout_last_us = lockout_us;
+    if (lockout_us > g_stats.lockout_max_us) {
+      g_stats.lockout_max_us = lockout_us;
+    }
+  }
+  g_stats.missed_alarm_count +=
+      health_after.missed_alarm_count - health_before.missed_alarm_count;
+  restore_interrupts(irq_state);
+
+  return result == PICO_OK;
+}
+
+bool flash_writer_erase_sector(uint32_t flash_offset) {
+  flash_writer_op_t op = {
+      .kind = FLASH_WRITER_OP_ERASE,
+      .flash_offset = flash_offset,
+  };
+
+  if ((flash_offset % FLASH_SECTOR_SIZE) != 0u) {
+    return false;
+  }
+  return flash_writer_run(&op);
+}
+
+bool flash_writer_program_page(uint32_t flash_offset, const uint8_t *page_data) {
+  flash_writer_op_t op = {
+      .kind = FLASH_WRITER_OP_PROGRAM,
+      .flash_offset = flash_offset,
+      .data = page_data,
+  };
+
+  if (page_data == NULL || (flash_offset % FLASH_PAGE_SIZE) != 0u) {
+    return false;
+  }
+  return flash_writer_run(&op);
+}
+
+bool __time_critical_func(flash_writer_lockout_covers)(uint32_t timestamp_us) {
+  const uint32_t start_us = g_lockout_start_us;
+  const uint32_t end_us = g_lockout_end_us;
+
+  return g_lockout_seen && (timestamp_us - start_us) <= (end_us - start_us);
+}
+
+void flash_writer_get_stats(flash_writer_stats_t *out_stats) {
+  uint32_t irq_state = 0u;
+
+  if (out_stats == NULL) {
+    return;
+  }
+
+  irq_state = save_and_disable_interrupts();
+  *out_stats = g_stats;
+  restore_interrupts(irq_state);
+}
@@ -0,0 +1,218 @@
+#include "services/http_request_parser.h"
+
+#include <string.h>
+#include <strings.h>
+
+static bool http_request_parser_is_space(char value) {
+  return value == ' ' || value == '\t';
+}
+
+static bool http_request_parser_request_line(http_request_parser_t *parser) {
+  const char *line = parser->line;
+  const char *end = line + parser->line_length;
+  const char *method_end = NULL;
+  const char *target = NULL;
+  const char *target_end = NULL;
+  const char *version = NULL;
+
+  if (parser->line_overflow) {
+    return false;
+  }
+
+  method_end = memchr(line, ' ', parser->line_length);
+  if (method_end == NULL || method_end == line) {
+    return false;
+  }
+  target = method_end + 1;
+  target_end = memchr(target, ' ', (size_t)(end - target));
+  if (target_end == NULL || target_end == target) {
+    return false;
+  }
+  version = target_end + 1;
+  if (end - version != 8 || strncmp(version, "HTTP/1.", 7u) != 0) {
+    return false;
+  }
+
+  return parser->callbacks->on_request_line == NULL ||
+         parser->callbacks->on_request_line(
+             parser->context, line, (size_t)(method_end - line), target,
+             (size_t)(target_end - target), version[7] == '1');
+}
+
+static bool http_request_parser_content_length(http_request_parser_t *parser,
+                                               const char *value, size_t length) {
+  size_t content_length = 0u;
+  size_t index = 0u;
+
+  if (length == 0u) {
+    return false;
+  }
+  for (index = 0u; index < length; ++index) {
+    if (value[index] < '0' || value[index] > '9' ||
+        content_length > (SIZE_MAX - 9u) / 10u) {
+      return false;
+    }
+    content_length = content_length * 10u + (size_t)(value[index] - '0');
+  }
+
+  // Repeats must agree, or two parsers could disagree on where the body ends.
+  if (parser->has_content_length && parser->content_length != content_length) {
+    return false;
+  }
+  parser->content_length = content_length;
+  parser->has_content_length = true;
+  return true;
+}
+
+static bool http_request_parser_header_line(http_request_parser_t *parser) {
+  const char *line = parser->line;
+  const char *colon = NULL;
+  const char *value = NULL;
+  const char *value_end = line + parser->line_length;
+  size_t name_length = 0u;
+
+  // Too long to be anything the server reads; drop it.
+  if (parser->line_overflow) {
+    return true;
+  }
+
+  colon = memchr(line, ':', parser->line_length);
+  if (colon == NULL || colon == line) {
+    return false;
+  }
+  name_length = (size_t)(colon - line);
+  value = colon + 1;
+  while (value < value_end && http_request_parser_is_space(*value)) {
+    value++;
+  }
+  while (value_end > value && http_request_parser_is_space(value_end[-1])) {
+    value_end--;
+  }
+
+  if (name_length == 14u && strncasecmp(line, "Content-Length", 14u) == 0 &&
+      !http_request_parser_content_length(parser, value, (size_t)(value_end - value))) {
+    return false;
+  }
+  if (name_length == 17u && strncasecmp(line, "Transfer-Encoding", 17u) == 0) {
+    parser->has_transfer_encoding = true;
+  }
+
+  return parser->callbacks->on_header == NULL ||
+         parser->callbacks->on_header(parser->context, line, name_length, value,
+                                      (size_t)(value_end - value));
+}
+
+static bool http_request_parser_end_headers(http_request_parser_t *parser) {
+  // A chunked body would otherwise be read as the next pipelined request.
+  if (parser->has_transfer_encoding) {
+    parser->error = parser->has_content_length ? HTTP_REQUEST_PARSER_ERROR_BAD_REQUEST
+                                               : HTTP_REQUEST_PARSER_ERROR_NOT_IMPLEMENTED;
+    return false;
+  }
+
+  if (parser->callbacks->on_headers_complete != NULL &&
+      !parser->callbacks->on_headers_complete(parser->context,
+                                              parser->content_length)) {
+    return false;
+  }
+
+  parser->body_remaining = parser->content_length;
+  parser->state = parser->content_length > 0u ? HTTP_REQUEST_PARSER_BODY
+                                              : HTTP_REQUEST_PARSER_DONE;
+  return true;
+}
+
+static bool http_request_parser_line(http_request_parser_t *parser) {
+  bool accepted = true;
+
+  if (parser->line_length > 0u && parser->line[parser->line_length - 1u] == '\r') {
+    parser->line_length--;
+  }
+
+  if (parser->state == HTTP_REQUEST_PARSER_REQUEST_LINE) {
+    // Stray line breaks between pipelined requests are allowed.
+    if (parser->line_length > 0u || parser->line_overflow) {
+      accepted = http_request_parser_request_line(parser);
+      parser->state = HTTP_REQUEST_PARSER_HEADERS;
+    }
+  } else if (parser->line_length == 0u && !parser->line_overflow) {
+    accepted = http_request_parser_end_headers(parser);
+  } else {
+    accepted = http_request_parser_header_line(parser);
+  }
+
+  parser->line_length = 0u;
+  parser->line_overflow = false;
+  return accepted;
+}
+
+void http_request_parser_init(http_request_parser_t *parser,
+                              const http_request_parser_callbacks_t *callbacks,
+                              void *context) {
+  parser->callbacks = callbacks;
+  parser->context = context;
+  parser->state = HTTP_REQUEST_PARSER_REQUEST_LINE;
+  parser->error = HTTP_REQUEST_PARSER_ERROR_NONE;
+  parser->line_length = 0u;
+  parser->line_overflow = false;
+  parser->header_bytes = 0u;
+  parser->content_length = 0u;
+  parser->has_content_length = false;
+  parser->has_transfer_encoding = false;
+  parser->body_remaining = 0u;
+}
+
+// Every failure that does not name its own reason is a malformed request.
+static void http_request_parser_fail(http_request_parser_t *parser) {
+  parser->state = HTTP_REQUEST_PARSER_ERROR;
+  if (parser->error == HTTP_REQUEST_PARSER_ERROR_NONE) {
+    parser->error = HTTP_REQUEST_PARSER_ERROR_BAD_REQUEST;
+  }
+}
+
+size_t http_request_parser_feed(http_request_parser_t *parser, const uint8_t *data,
+                                size_t length) {
+  size_t consumed = 0u;
+
+  while (consumed < length && parser->state != HTTP_REQUEST_PARSER_DONE &&
+         parser->state != HTTP_REQUEST_PARSER_ERROR) {
+    if (parser->state == HTTP_REQUEST_PARSER_BODY) {
+      size_t slice = length - consumed;
+
+      if (slice > parser->body_remaining) {
+        slice = parser->body_remaining;
+      }
+      if (parser->callbacks->on_body != NULL &&
+          !parser->callbacks->on_body(parser->context, data + consumed, slice)) {
+        http_request_parser_fail(parser);
+        break;
+      }
+      consumed += slice;
+      parser->body_remaining -= slice;
+      if (parser->body_remaining == 0u) {
+        parser->state = HTTP_REQUEST_PARSER_DONE;
+      }
+      continue;
+    }
+
+    if (++parser->header_bytes > HTTP_REQUEST_PARSER_MAX_HEADER_BYTES) {
+      http_request_parser_fail(parser);
+      break;
+    }
+    if (data[consumed] == '\n') {
+      consumed++;
+      if (!http_request_parser_line(parser)) {
+        http_request_parser_fail(parser);
+      }
+      continue;
+    }
+    if (parser->line_length < sizeof(parser->line)) {
+      parser->line[parser->line_length++] = (char)data[consumed];
+    } else {
+      parser->line_overflow = true;
+    }
+    consumed++;
+  }
+
+  return consumed;
+}
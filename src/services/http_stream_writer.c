@@ -0,0 +1,299 @@
+#include "services/http_stream_writer.h"
+
+#include "services/websocket.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+_Static_assert(HTTP_STREAM_WRITER_CAPACITY <= 0xFFFFu,
+               "chunk size must fit the four-digit chunk header");
+// A frame of up to 0xFFFF bytes has a 4-byte header, which goes in the space
+// kept for the chunk header.
+_Static_assert(HTTP_STREAM_CHUNK_HEADER_BYTES >= 4u,
+               "WebSocket frame header must fit in front of the data");
+
+static char *http_stream_data(http_stream_writer_t *stream) {
+  return stream->buffer + HTTP_STREAM_CHUNK_HEADER_BYTES;
+}
+
+static bool http_stream_send(http_stream_writer_t *stream, const void *data,
+                             size_t length) {
+  if (netconn_write(stream->connection, data, length, NETCONN_COPY) != ERR_OK) {
+    stream->failed = true;
+  }
+  return !stream->failed;
+}
+
+static bool http_stream_send_websocket_frame(http_stream_writer_t *stream,
+                                             size_t length, bool fin) {
+  uint8_t header[WEBSOCKET_MAX_FRAME_HEADER_BYTES];
+  const size_t header_length =
+      websocket_frame_header(header, fin, stream->websocket_opcode, length);
+  char *frame = http_stream_data(stream) - header_length;
+
+  memcpy(frame, header, header_length);
+  stream->websocket_opcode = WEBSOCKET_OPCODE_CONTINUATION;
+  return http_stream_send(stream, frame, header_length + length);
+}
+
+static bool http_stream_copy_to_memory(http_stream_writer_t *stream, size_t length) {
+  const size_t offset = stream->total_bytes - length;
+
+  if (length > stream->memory_capacity - offset) {
+    stream->failed = true;
+    return false;
+  }
+  memcpy(stream->memory + offset, http_stream_data(stream), length);
+  return true;
+}
+
+bool http_stream_begin_response(http_stream_writer_t *stream,
+                                struct netconn *connection, const char *status_line,
+                                const char *content_type, bool head_only,
+                                bool keep_alive) {
+  char header[192];
+  const int header_length = snprintf(
+      header, sizeof(header),
+      "HTTP/1.1 %s\r\n"
+      "Content-Type: %s\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "Connection: %s\r\n"
+      "\r\n",
+      status_line, content_type, keep_alive ? "keep-alive" : "close");
+
+  http_stream_begin_raw(stream, connection);
+  stream->chunked = true;
+  stream->discard = head_only;
+  if (header_length <= 0 || (size_t)header_length >= sizeof(header)) {
+    stream->failed = true;
+    return false;
+  }
+
+  return http_stream_send(stream, header, (size_t)header_length);
+}
+
+void http_stream_begin_raw(http_stream_writer_t *stream, struct netconn *connection) {
+  stream->connection = connection;
+  stream->chunked = false;
+  stream->websocket = false;
+  stream->websocket_opcode = 0u;
+  stream->memory = NULL;
+  stream->memory_capacity = 0u;
+  stream->discard = false;
+  stream->failed = connection == NULL;
+  stream->length = 0u;
+  stream->total_bytes = 0u;
+}
+
+void http_stream_begin_websocket(http_stream_writer_t *stream,
+                                 struct netconn *connection, uint8_t opcode) {
+  http_stream_begin_raw(stream, connection);
+  stream->websocket = true;
+  stream->websocket_opcode = opcode;
+}
+
+void http_stream_begin_memory(http_stream_writer_t *stream, char *out,
+                              size_t capacity) {
+  http_stream_begin_raw(stream, NULL);
+  stream->memory = out;
+  stream->memory_capacity = capacity;
+  stream->failed = out == NULL;
+}
+
+bool http_stream_flush(http_stream_writer_t *stream) {
+  static const char k_hex_digits[] = "0123456789abcdef";
+  const size_t length = stream->length;
+
+  if (stream->failed) {
+    return false;
+  }
+  if (length == 0u) {
+    return true;
+  }
+
+  stream->length = 0u;
+  stream->total_bytes += (uint32_t)length;
+  if (stream->discard) {
+    return true;
+  }
+  if (stream->memory != NULL) {
+    return http_stream_copy_to_memory(stream, length);
+  }
+  if (stream->websocket) {
+    return http_stream_send_websocket_frame(stream, length, false);
+  }
+  if (!stream->chunked) {
+    return http_stream_send(stream, http_stream_data(stream), length);
+  }
+
+  stream->buffer[0] = k_hex_digits[(length >> 12) & 0xFu];
+  stream->buffer[1] = k_hex_digits[(length >> 8) & 0xFu];
+  stream->buffer[2] = k_hex_digits[(length >> 4) & 0xFu];
+  stream->buffer[3] = k_hex_digits[length & 0xFu];
+  stream->buffer[4] = '\r';
+  stream->buffer[5] = '\n';
+  http_stream_data(stream)[length] = '\r';
+  http_stream_data(stream)[length + 1u] = '\n';
+  return http_stream_send(stream, stream->buffer,
+                          HTTP_STREAM_CHUNK_HEADER_BYTES + length + 2u);
+}
+
+bool http_stream_write(http_stream_writer_t *stream, const char *data, size_t length) {
+  while (!stream->failed && length > 0u) {
+    size_t room = HTTP_STREAM_WRITER_CAPACITY - stream->length;
+
+    if (room == 0u) {
+      if (!http_stream_flush(stream)) {
+        return false;
+      }
+      room = HTTP_STREAM_WRITER_CAPACITY;
+    }
+    if (room > length) {
+      room = length;
+    }
+    memcpy(http_stream_data(stream) + stream->length, data, room);
+    stream->length += room;
+    data += room;
+    length -= room;
+  }
+
+  return !stream->failed;
+}
+
+bool http_stream_puts(http_stream_writer_t *stream, const char *text) {
+  return http_stream_write(stream, text, strlen(text));
+}
+
+bool http_stream_printf(http_stream_writer_t *stream, const char *format, ...) {
+  va_list args;
+  int written = 0;
+
+  if (stream->failed) {
+    return false;
+  }
+
+  // vsnprintf() needs one byte past the data for its terminator; the two
+  // bytes reserved for the chunk trailer cover it.
+  va_start(args, format);
+  written = vsnprintf(http_stream_data(stream) + stream->length,
+                      HTTP_STREAM_WRITER_CAPACITY - stream->length + 1u, format, args);
+  va_end(args);
+  if (written < 0) {
+    stream->failed = true;
+    return false;
+  }
+  if ((size_t)written <= HTTP_STREAM_WRITER_CAPACITY - stream->length) {
+    stream->length += (size_t)written;
+    return true;
+  }
+
+  // Did not fit behind what is buffered: flush and format again.
+  if ((size_t)written > HTTP_STREAM_WRITER_CAPACITY || !http_stream_flush(stream)) {
+    stream->failed = true;
+    return false;
+  }
+  va_start(args, format);
+  written = vsnprintf(http_stream_data(stream), HTTP_STREAM_WRITER_CAPACITY + 1u,
+                      format, args);
+  va_end(args);
+  stream->length = (size_t)written;
+  return true;
+}
+
+bool http_stream_json_string(http_stream_writer_t *stream, const char *text) {
+  const char *run_start = text;
+  const char *cursor = text;
+
+  if (!http_stream_write(stream, "\"", 1u)) {
+    return false;
+  }
+
+  for (; *cursor != '\0'; ++cursor) {
+    const unsigned char ch = (unsigned char)*cursor;
+    const char *replacement = NULL;
+    char escaped[7];
+
+    switch (ch) {
+    case '\\':
+      replacement = "\\\\";
+      break;
+    case '"':
+      replacement = "\\\"";
+      break;
+    case '\n':
+      replacement = "\\n";
+      break;
+    case '\r':
+      replacement = "\\r";
+      break;
+    case '\t':
+      replacement = "\\t";
+      break;
+    default:
+      if (ch < 0x20u) {
+        (void)snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+        replacement = escaped;
+      }
+      break;
+    }
+
+    if (replacement != NULL) {
+      if (!http_stream_write(stream, run_start, (size_t)(cursor - run_start)) ||
+          !http_stream_puts(stream, replacement)) {
+        return false;
+      }
+      run_start = cursor + 1;
+    }
+  }
+
+  return http_stream_write(stream, run_start, (size_t)(cursor - run_start)) &&
+         http_stream_write(stream, "\"", 1u);
+}
+
+bool http_stream_csv_field(http_stream_writer_t *stream, const char *text) {
+  const char *run_start = text;
+  const char *cursor = text;
+
+  if (strpbrk(text, ",\"\r\n") == NULL) {
+    return http_stream_puts(stream, text);
+  }
+
+  if (!http_stream_write(stream, "\"", 1u)) {
+    return false;
+  }
+  for (; *cursor != '\0'; ++cursor) {
+    if (*cursor == '"') {
+      // Doubled quote: write the run including this quote, then one more.
+      if (!http_stream_write(stream, run_start, (size_t)(cursor - run_start) + 1u) ||
+          !http_stream_write(stream, "\"", 1u)) {
+        return false;
+      }
+      run_start = cursor + 1;
+    }
+  }
+
+  return http_stream_write(stream, run_start, (size_t)(cursor - run_start)) &&
+         http_stream_write(stream, "\"", 1u);
+}
+
+bool http_stream_end(http_stream_writer_t *stream) {
+  static const char k_last_chunk[] = "0\r\n\r\n";
+
+  if (stream->websocket) {
+    const size_t length = stream->length;
+
+    if (stream->failed) {
+      return false;
+    }
+    stream->length = 0u;
+    stream->total_bytes += (uint32_t)length;
+    return http_stream_send_websocket_frame(stream, length, true);
+  }
+  if (!http_stream_flush(stream)) {
+    return false;
+  }
+  if (stream->chunked && !stream->discard) {
+    return http_stream_send(stream, k_last_chunk, sizeof(k_last_chunk) - 1u);
+  }
+  return true;
+}
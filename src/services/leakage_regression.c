@@ -0,0 +1,293 @@
+#include "services/leakage_regression.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LEAKAGE_REGRESSION_MAD_TO_SIGMA 1.4826f
+#define LEAKAGE_REGRESSION_WEIGHT_TOLERANCE 1e-3f
+#define LEAKAGE_REGRESSION_MIN_SXX 1e-6f
+
+// Neumaier-compensated running sum; keeps log-domain sums exact enough in
+// single precision when one point dominates the magnitude.
+typedef struct {
+  float sum;
+  float compensation;
+} leakage_regression_sum_t;
+
+typedef struct {
+  float x[LEAKAGE_REGRESSION_MAX_POINTS];
+  float y[LEAKAGE_REGRESSION_MAX_POINTS];
+  float base_weight[LEAKAGE_REGRESSION_MAX_POINTS];
+  float robust_weight[LEAKAGE_REGRESSION_MAX_POINTS];
+  uint8_t count;
+} leakage_regression_data_t;
+
+static void leakage_regression_sum_add(leakage_regression_sum_t *accumulator,
+                                       float value) {
+  const float total = accumulator->sum + value;
+
+  if (fabsf(accumulator->sum) >= fabsf(value)) {
+    accumulator->compensation += (accumulator->sum - total) + value;
+  } else {
+    accumulator->compensation += (value - total) + accumulator->sum;
+  }
+  accumulator->sum = total;
+}
+
+static float leakage_regression_sum_value(const leakage_regression_sum_t *accumulator) {
+  return accumulator->sum + accumulator->compensation;
+}
+
+static float leakage_regression_median(float *values, uint8_t count) {
+  uint8_t outer = 0u;
+
+  for (outer = 1u; outer < count; ++outer) {
+    const float value = values[outer];
+    uint8_t inner = outer;
+    while (inner > 0u && values[inner - 1u] > value) {
+      values[inner] = values[inner - 1u];
+      --inner;
+    }
+    values[inner] = value;
+  }
+
+  if ((count % 2u) != 0u) {
+    return values[count / 2u];
+  }
+  return 0.5f * (values[count / 2u - 1u] + values[count / 2u]);
+}
+
+// Weighted least squares on centered data (two passes, compensated sums).
+static bool leakage_regression_solve(const leakage_regression_data_t *data,
+                                     leakage_regression_result_t *result) {
+  leakage_regression_sum_t weight_sum = {0};
+  leakage_regression_sum_t sum_x = {0};
+  leakage_regression_sum_t sum_y = {0};
+  leakage_regression_sum_t sxx = {0};
+  leakage_regression_sum_t sxy = {0};
+  leakage_regression_sum_t syy = {0};
+  leakage_regression_sum_t residual_ss = {0};
+  float mean_x = 0.0f;
+  float mean_y = 0.0f;
+  float w_total = 0.0f;
+  float sxx_value = 0.0f;
+  float syy_value = 0.0f;
+  uint8_t index = 0u;
+
+  for (index = 0u; index < data->count; ++index) {
+    const float weight = data->base_weight[index] * data->robust_weight[index];
+    leakage_regression_sum_add(&weight_sum, weight);
+    leakage_regression_sum_add(&sum_x, weight * data->x[index]);
+    leakage_regression_sum_add(&sum_y, weight * data->y[index]);
+  }
+
+  w_total = leakage_regression_sum_value(&weight_sum);
+  if (w_total <= 0.0f) {
+    return false;
+  }
+  mean_x = leakage_regression_sum_value(&sum_x) / w_total;
+  mean_y = leakage_regression_sum_value(&sum_y) / w_total;
+
+  for (index = 0u; index < data->count; ++index) {
+    const float weight = data->base_weight[index] * data->robust_weight[index];
+    const float dx = data->x[index] - mean_x;
+    const float dy = data->y[index] - mean_y;
+    leakage_regression_sum_add(&sxx, weight * dx * dx);
+    leakage_regression_sum_add(&sxy, weight * dx * dy);
+    leakage_regression_sum_add(&syy, weight * dy * dy);
+  }
+
+  sxx_value = leakage_regression_sum_value(&sxx);
+  syy_value = leakage_regression_sum_value(&syy);
+  if (sxx_value < LEAKAGE_REGRESSION_MIN_SXX) {
+    return false;
+  }
+
+  result->exponent_n = leakage_regression_sum_value(&sxy) / sxx_value;
+  result->ln_c = mean_y - result->exponent_n * mean_x;
+  result->correlation_r = syy_value > 0.0f
+                              ? leakage_regression_sum_value(&sxy) /
+                                    sqrtf(sxx_value * syy_value)
+                              : 1.0f;
+  result->mean_log_pressure = mean_x;
+  result->weight_sum = w_total;
+  result->sxx = sxx_value;
+
+  for (index = 0u; index < data->count; ++index) {
+    const float weight = data->base_weight[index] * data->robust_weight[index];
+    const float residual =
+        data->y[index] - (result->ln_c + result->exponent_n * data->x[index]);
+    leakage_regression_sum_add(&residual_ss, weight * residual * residual);
+  }
+
+  result->residual_scale = 0.0f;
+  if (data->count > 2u) {
+    const float variance =
+        leakage_regression_sum_value(&residual_ss) / (float)(data->count - 2u);
+    result->residual_scale = variance > 0.0f ? sqrtf(variance) : 0.0f;
+  }
+  return true;
+}
+
+// Huber weights from standardized residuals; returns true once they settle.
+static bool leakage_regression_update_robust_weights(
+    leakage_regression_data_t *data, const leakage_regression_result_t *result,
+    float huber_k) {
+  float scaled[LEAKAGE_REGRESSION_MAX_POINTS];
+  float sorted[LEAKAGE_REGRESSION_MAX_POINTS];
+  float scale = 0.0f;
+  float max_change = 0.0f;
+  uint8_t index = 0u;
+
+  for (index = 0u; index < data->count; ++index) {
+    const float residual =
+        data->y[index] - (result->ln_c + result->exponent_n * data->x[index]);
+    scaled[index] = fabsf(residual) * sqrtf(data->base_weight[index]);
+    sorted[index] = scaled[index];
+  }
+
+  scale = LEAKAGE_REGRESSION_MAD_TO_SIGMA * leakage_regression_median(sorted, data->count);
+  if (scale <= 0.0f) {
+    return true;
+  }
+
+  for (index = 0u; index < data->count; ++index) {
+    const float limit = huber_k * scale;
+    const float weight = scaled[index] <= limit ? 1.0f : limit / scaled[index];
+    const float change = fabsf(weight - data->robust_weight[index]);
+    if (change > max_change) {
+      max_change = change;
+    }
+    data->robust_weight[index] = weight;
+  }
+
+  return max_change < LEAKAGE_REGRESSION_WEIGHT_TOLERANCE;
+}
+
+float leakage_regression_t_quantile_975(uint32_t degrees_of_freedom) {
+  static const float k_t_table[] = {
+      12.706f, 4.303f, 3.182f, 2.776f, 2.571f, 2.447f, 2.365f, 2.306f,
+      2.262f,  2.228f, 2.201f, 2.179f, 2.160f, 2.145f, 2.131f, 2.120f,
+      2.110f,  2.101f, 2.093f, 2.086f, 2.080f, 2.074f, 2.069f, 2.064f,
+      2.060f,  2.056f, 2.052f, 2.048f, 2.045f, 2.042f,
+  };
+
+  if (degrees_of_freedom == 0u) {
+    return INFINITY;
+  }
+  if (degrees_of_freedom <= sizeof(k_t_table) / sizeof(k_t_table[0])) {
+    return k_t_table[degrees_of_freedom - 1u];
+  }
+  return 1.96f + 2.4f / (float)degrees_of_freedom;
+}
+
+bool leakage_regression_fit(const leakage_regression_point_t *points, uint8_t count,
+                            const leakage_regression_options_t *options,
+                            leakage_regression_result_t *out_result) {
+  leakage_regression_data_t data = {0};
+  leakage_regression_result_t result = {0};
+  bool weighted = false;
+  float weight_total = 0.0f;
+  uint8_t index = 0u;
+  uint8_t iteration = 0u;
+
+  if (points == NULL || options == NULL || out_result == NULL) {
+    return false;
+  }
+
+  *out_result = (leakage_regression_result_t){0};
+  weighted = options->use_weights;
+  for (index = 0u; index < count && data.count < LEAKAGE_REGRESSION_MAX_POINTS;
+       ++index) {
+    const leakage_regression_point_t *point = &points[index];
+    if (!(point->pressure_pa > 0.0f) || !(point->flow_m3h > 0.0f) ||
+        !isfinite(point->pressure_pa) || !isfinite(point->flow_m3h)) {
+      continue;
+    }
+
+    data.x[data.count] = logf(point->pressure_pa);
+    data.y[data.count] = logf(point->flow_m3h);
+    if (!(point->log_flow_sigma > 0.0f) || !isfinite(point->log_flow_sigma)) {
+      weighted = false;
+    } else {
+      data.base_weight[data.count] =
+          1.0f / (point->log_flow_sigma * point->log_flow_sigma);
+    }
+    data.robust_weight[data.count] = 1.0f;
+    data.count += 1u;
+  }
+
+  if (data.count < 2u) {
+    return false;
+  }
+
+  for (index = 0u; index < data.count; ++index) {
+    if (!weighted) {
+      data.base_weight[index] = 1.0f;
+    }
+    weight_total += data.base_weight[index];
+  }
+  for (index = 0u; index < data.count; ++index) {
+    data.base_weight[index] *= (float)data.count / weight_total;
+  }
+
+  for (iteration = 0u; iteration < LEAKAGE_REGRESSION_MAX_ITERATIONS; ++iteration) {
+    if (!leakage_regression_solve(&data, &result)) {
+      return false;
+    }
+    result.iterations = (uint8_t)(iteration + 1u);
+    if (!options->robust || data.count < 4u ||
+        leakage_regression_update_robust_weights(&data, &result, options->huber_k)) {
+      break;
+    }
+  }
+
+  result.point_count = data.count;
+  for (index = 0u; index < data.count; ++index) {
+    if (data.robust_weight[index] < 1.0f) {
+      result.downweighted_count += 1u;
+    }
+  }
+
+  // ISO 9972 Annex C: s_n = s / sqrt(Sxx), s_lnC = s * sqrt(1/N + mean_x^2 / Sxx).
+  result.has_confidence = data.count > 2u;
+  result.t_quantile = leakage_regression_t_quantile_975(data.count - 2u);
+  if (result.has_confidence) {
+    result.se_n = result.residual_scale / sqrtf(result.sxx);
+    result.se_ln_c = result.residual_scale *
+                     sqrtf(1.0f / result.weight_sum +
+                           result.mean_log_pressure * result.mean_log_pressure /
+                               result.sxx);
+  }
+  result.valid = true;
+
+  *out_result = result;
+  return true;
+}
+
+bool leakage_regression_predict(const leakage_regression_result_t *result,
+                                float pressure_pa, float *out_flow_m3h,
+                                float *out_ci_low_m3h, float *out_ci_high_m3h) {
+  float x = 0.0f;
+  float y = 0.0f;
+  float half_width = 0.0f;
+
+  if (result == NULL || !result->valid || !(pressure_pa > 0.0f) ||
+      out_flow_m3h == NULL || out_ci_low_m3h == NULL || out_ci_high_m3h == NULL) {
+    return false;
+  }
+
+  x = logf(pressure_pa);
+  y = result->ln_c + result->exponent_n * x;
+  if (result->has_confidence) {
+    const float dx = x - result->mean_log_pressure;
+    half_width = result->t_quantile * result->residual_scale *
+                 sqrtf(1.0f / result->weight_sum + dx * dx / result->sxx);
+  }
+
+  *out_flow_m3h = expf(y);
+  *out_ci_low_m3h = expf(y - half_width);
+  *out_ci_high_m3h = expf(y + half_width);
+  return true;
+}
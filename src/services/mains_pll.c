@@ -0,0 +1,193 @@
+#include "services/mains_pll.h"
+
+#include "app/app_config.h"
+#include "pico/platform.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAINS_PLL_MIN_EDGE_PERIOD_US (1000000.0f / (2.0f * APP_MAINS_MAX_FREQUENCY_HZ))
+#define MAINS_PLL_MAX_EDGE_PERIOD_US (1000000.0f / APP_MAINS_MIN_FREQUENCY_HZ)
+#define MAINS_PLL_DOUBLE_EDGE_MIN_RATE_HZ \
+  ((APP_MAINS_MAX_FREQUENCY_HZ + 2.0f * APP_MAINS_MIN_FREQUENCY_HZ) * 0.5f)
+#define MAINS_PLL_ERROR_AVERAGE_ALPHA 0.0625f
+#define MAINS_PLL_MAX_MISSED_EDGES 4
+
+static float __time_critical_func(mains_pll_clamp_period)(float period_us) {
+  if (period_us < MAINS_PLL_MIN_EDGE_PERIOD_US) {
+    return MAINS_PLL_MIN_EDGE_PERIOD_US;
+  }
+  if (period_us > MAINS_PLL_MAX_EDGE_PERIOD_US) {
+    return MAINS_PLL_MAX_EDGE_PERIOD_US;
+  }
+  return period_us;
+}
+
+static uint8_t __time_critical_func(mains_pll_classify_half_cycles)(
+    float edge_period_us) {
+  // One edge per half-cycle puts the edge rate at 80-140 Hz; detectors that
+  // only fire on one polarity land at 40-70 Hz.
+  return (1000000.0f / edge_period_us) >= MAINS_PLL_DOUBLE_EDGE_MIN_RATE_HZ ? 1u : 2u;
+}
+
+static void __time_critical_func(mains_pll_restart_acquisition)(mains_pll_t *pll,
+                                                                uint32_t edge_us) {
+  if (pll->locked) {
+    pll->unlock_events++;
+  }
+  pll->locked = false;
+  pll->lock_streak = 0u;
+  pll->unlock_streak = 0u;
+  pll->reject_streak = 0u;
+  pll->edge_period_us = 0.0f;
+  pll->phase_error_us = 0.0f;
+  pll->last_edge_us = edge_us;
+  pll->has_edge = true;
+}
+
+static void __time_critical_func(mains_pll_update_lock)(mains_pll_t *pll,
+                                                        float phase_error_us) {
+  const float magnitude_us = fabsf(phase_error_us);
+
+  if (magnitude_us <= APP_MAINS_PLL_LOCK_THRESHOLD_US) {
+    pll->unlock_streak = 0u;
+    if (!pll->locked && ++pll->lock_streak >= APP_MAINS_PLL_LOCK_EDGES) {
+      pll->locked = true;
+      pll->lock_events++;
+    }
+    return;
+  }
+
+  pll->lock_streak = 0u;
+  if (pll->locked && ++pll->unlock_streak >= APP_MAINS_PLL_UNLOCK_EDGES) {
+    pll->locked = false;
+    pll->unlock_streak = 0u;
+    pll->unlock_events++;
+  }
+}
+
+void mains_pll_reset(mains_pll_t *pll) {
+  if (pll == NULL) {
+    return;
+  }
+
+  *pll = (mains_pll_t){
+      .half_cycles_per_edge = 1u,
+  };
+}
+
+mains_pll_edge_result_t __time_critical_func(mains_pll_process_edge)(
+    mains_pll_t *pll, uint32_t edge_us, uint32_t *out_zero_cross_us) {
+  float phase_error_us = 0.0f;
+  float window_us = 0.0f;
+  float filtered_edge_us = 0.0f;
+
+  if (pll == NULL || out_zero_cross_us == NULL) {
+    return MAINS_PLL_EDGE_REJECTED;
+  }
+
+  if (!pll->has_edge) {
+    mains_pll_restart_acquisition(pll, edge_us);
+    *out_zero_cross_us = edge_us;
+    return MAINS_PLL_EDGE_ACQUIRING;
+  }
+
+  if (pll->edge_period_us <= 0.0f) {
+    const float interval_us = (float)(uint32_t)(edge_us - pll->last_edge_us);
+
+    if (interval_us < MAINS_PLL_MIN_EDGE_PERIOD_US) {
+      pll->rejected_edges++;
+      return MAINS_PLL_EDGE_REJECTED;
+    }
+
+    pll->last_edge_us = edge_us;
+    *out_zero_cross_us = edge_us;
+    if (interval_us > MAINS_PLL_MAX_EDGE_PERIOD_US) {
+      return MAINS_PLL_EDGE_ACQUIRING;
+    }
+
+    pll->edge_period_us = interval_us;
+    pll->half_cycles_per_edge = mains_pll_classify_half_cycles(interval_us);
+    pll->predicted_edge_us = edge_us + (uint32_t)interval_us;
+    pll->accepted_edges++;
+    return MAINS_PLL_EDGE_ACQUIRING;
+  }
+
+  phase_error_us = (float)(int32_t)(edge_us - pll->predicted_edge_us);
+  window_us = pll->edge_period_us * APP_MAINS_PLL_CAPTURE_WINDOW_RATIO;
+
+  if (phase_error_us > window_us) {
+    // A late edge that lines up with a later slot means the detector dropped
+    // edges; slip the prediction forward instead of dragging the loop.
+    const int32_t missed =
+        (int32_t)((phase_error_us + window_us) / pll->edge_period_us);
+
+    if (missed >= 1 && missed <= MAINS_PLL_MAX_MISSED_EDGES &&
+        fabsf(phase_error_us - (float)missed * pll->edge_period_us) <= window_us) {
+      pll->predicted_edge_us += (uint32_t)((float)missed * pll->edge_period_us);
+      pll->missed_edges += (uint32_t)missed;
+      phase_error_us -= (float)missed * pll->edge_period_us;
+    }
+  }
+
+  if (fabsf(phase_error_us) > window_us) {
+    pll->rejected_edges++;
+    if (++pll->reject_streak >= APP_MAINS_PLL_REACQUIRE_REJECTS) {
+      mains_pll_restart_acquisition(pll, edge_us);
+    }
+    return MAINS_PLL_EDGE_REJECTED;
+  }
+
+  pll->reject_streak = 0u;
+  pll->accepted_edges++;
+  pll->last_edge_us = edge_us;
+  pll->phase_error_us = phase_error_us;
+  pll->phase_error_ms2 +=
+      MAINS_PLL_ERROR_AVERAGE_ALPHA * (phase_error_us * phase_error_us - pll->phase_error_ms2);
+  mains_pll_update_lock(pll, phase_error_us);
+
+  filtered_edge_us = APP_MAINS_PLL_PHASE_GAIN * phase_error_us;
+  pll->edge_period_us = mains_pll_clamp_period(
+      pll->edge_period_us + APP_MAINS_PLL_FREQUENCY_GAIN * phase_error_us);
+  pll->half_cycles_per_edge = mains_pll_classify_half_cycles(pll->edge_period_us);
+
+  *out_zero_cross_us = pll->predicted_edge_us + (uint32_t)(int32_t)filtered_edge_us;
+  pll->predicted_edge_us = *out_zero_cross_us + (uint32_t)pll->edge_period_us;
+  return MAINS_PLL_EDGE_TRACKED;
+}
+
+float __time_critical_func(mains_pll_half_cycle_us)(const mains_pll_t *pll) {
+  if (pll == NULL || pll->edge_period_us <= 0.0f || pll->half_cycles_per_edge == 0u) {
+    return 0.0f;
+  }
+
+  return pll->edge_period_us / (float)pll->half_cycles_per_edge;
+}
+
+void mains_pll_get_status(const mains_pll_t *pll, mains_pll_status_t *out_status) {
+  const float half_cycle_us = mains_pll_half_cycle_us(pll);
+
+  if (out_status == NULL) {
+    return;
+  }
+
+  if (pll == NULL) {
+    *out_status = (mains_pll_status_t){0};
+    return;
+  }
+
+  *out_status = (mains_pll_status_t){
+      .tracking = pll->edge_period_us > 0.0f,
+      .locked = pll->locked,
+      .half_cycles_per_edge = pll->half_cycles_per_edge,
+      .mains_frequency_hz = half_cycle_us > 0.0f ? 500000.0f / half_cycle_us : 0.0f,
+      .half_cycle_us = half_cycle_us,
+      .phase_error_us = pll->phase_error_us,
+      .phase_error_rms_us = sqrtf(pll->phase_error_ms2),
+      .accepted_edges = pll->accepted_edges,
+      .rejected_edges = pll->rejected_edges,
+      .missed_edges = pll->missed_edges,
+      .lock_events = pll->lock_events,
+      .unlock_events = pll->unlock_events,
+  };
+}
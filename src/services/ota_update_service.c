@@ -8,6 +8,7 @@
 #include "hardware/watchdog.h"
 #include "pico/stdlib.h"
 #include "semphr.h"
+#include "services/flash_writer.h"
 #include "task.h"
 #include <ctype.h>
 #include <stdbool.h>
@@ -172,18 +173,14 @@ static bool ota_flash_verify_programmed(uint32_t flash_offset_bytes,
 }
 
 static bool ota_flash_erase_sector(uint32_t flash_offset_bytes) {
-  const uint32_t irq_state = save_and_disable_interrupts();
-  flash_range_erase(flash_offset_bytes, FLASH_SECTOR_SIZE);
-  restore_interrupts(irq_state);
-  return ota_flash_verify_erased(flash_offset_bytes, FLASH_SECTOR_SIZE);
+  return flash_writer_erase_sector(flash_offset_bytes) &&
+         ota_flash_verify_erased(flash_offset_bytes, FLASH_SECTOR_SIZE);
 }
 
 static bool ota_flash_program_page(uint32_t flash_offset_bytes,
                                    const uint8_t *page_data) {
-  const uint32_t irq_state = save_and_disable_interrupts();
-  flash_range_program(flash_offset_bytes, page_data, FLASH_PAGE_SIZE);
-  restore_interrupts(irq_state);
-  return ota_flash_verify_programmed(flash_offset_bytes, page_data,
+  return flash_writer_program_page(flash_offset_bytes, page_data) &&
+         ota_flash_verify_programmed(flash_offset_bytes, page_data,
                                      FLASH_PAGE_SIZE);
 }
 
@@ -198,7 +195,8 @@ static bool ota_stage_program_current_page_locked(void) {
 
   if ((page_offset % FLASH_SECTOR_SIZE) == 0u) {
     if (!ota_flash_erase_sector(staging_flash_offset)) {
-      ota_set_error_locked("flash_erase_failed");
+      ota_set_error_locked(flash_writer_erase_allowed() ? "flash_erase_failed"
+                                                        : "dimmer_active");
       return false;
     }
   }
@@ -549,6 +547,20 @@ finish:
   return result;
 }
 
+void ota_update_service_abort(const char *reason) {
+  ota_update_service_init();
+  if (g_context.mutex == NULL ||
+      xSemaphoreTake(g_context.mutex, portMAX_DELAY) != pdTRUE) {
+    return;
+  }
+
+  if (g_context.state == OTA_UPDATE_STATE_RECEIVING) {
+    ota_set_error_locked(reason);
+  }
+
+  xSemaphoreGive(g_context.mutex);
+}
+
 ota_update_result_t ota_update_service_request_apply_async(void) {
   ota_update_result_t result = OTA_UPDATE_RESULT_OK;
   TaskHandle_t task_handle = NULL;
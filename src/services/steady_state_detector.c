@@ -0,0 +1,228 @@
+#include "services/steady_state_detector.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Variance floors keep the ratio test meaningful on near-noiseless signals.
+#define STEADY_STATE_VARIANCE_FLOOR_FRACTION 0.05f
+#define STEADY_STATE_MIN_SPAN_FRACTION 0.75f
+
+typedef struct {
+  float mean;
+  float drift;
+  float early_variance;
+  float late_variance;
+} steady_state_channel_t;
+
+static uint16_t steady_state_index(const steady_state_detector_t *detector,
+                                   uint16_t offset) {
+  return (uint16_t)((detector->head + STEADY_STATE_MAX_SAMPLES - detector->count +
+                     offset) %
+                    STEADY_STATE_MAX_SAMPLES);
+}
+
+static float steady_state_value(const steady_state_sample_t *sample, bool flow) {
+  return flow ? sample->flow_m3h : sample->pressure_pa;
+}
+
+static float steady_state_variance(const steady_state_detector_t *detector,
+                                   uint16_t first, uint16_t count, bool flow) {
+  float mean = 0.0f;
+  float sum_sq = 0.0f;
+  uint16_t offset = 0u;
+
+  if (count < 2u) {
+    return 0.0f;
+  }
+
+  for (offset = 0u; offset < count; ++offset) {
+    mean += steady_state_value(
+        &detector->samples[steady_state_index(detector, (uint16_t)(first + offset))],
+        flow);
+  }
+  mean /= (float)count;
+
+  for (offset = 0u; offset < count; ++offset) {
+    const float delta =
+        steady_state_value(&detector->samples[steady_state_index(
+                               detector, (uint16_t)(first + offset))],
+                           flow) -
+        mean;
+    sum_sq += delta * delta;
+  }
+
+  return sum_sq / (float)(count - 1u);
+}
+
+// Least-squares slope against time; the drift is the upper confidence bound of
+// |slope| times the window span, so noise alone never reads as flat.
+static void steady_state_analyze_channel(const steady_state_detector_t *detector,
+                                         bool flow,
+                                         steady_state_channel_t *out_channel) {
+  const uint16_t count = detector->count;
+  const uint16_t half = (uint16_t)(count / 2u);
+  const uint32_t t0_ms = detector->samples[steady_state_index(detector, 0u)].t_ms;
+  float mean_t = 0.0f;
+  float mean_y = 0.0f;
+  float sxx = 0.0f;
+  float sxy = 0.0f;
+  float syy = 0.0f;
+  float slope = 0.0f;
+  float residual_variance = 0.0f;
+  float slope_error = 0.0f;
+  float span_s = 0.0f;
+  uint16_t offset = 0u;
+
+  for (offset = 0u; offset < count; ++offset) {
+    const steady_state_sample_t *sample =
+        &detector->samples[steady_state_index(detector, offset)];
+    mean_t += (float)(sample->t_ms - t0_ms) * 0.001f;
+    mean_y += steady_state_value(sample, flow);
+  }
+  mean_t /= (float)count;
+  mean_y /= (float)count;
+
+  for (offset = 0u; offset < count; ++offset) {
+    const steady_state_sample_t *sample =
+        &detector->samples[steady_state_index(detector, offset)];
+    const float dt = (float)(sample->t_ms - t0_ms) * 0.001f - mean_t;
+    const float dy = steady_state_value(sample, flow) - mean_y;
+    sxx += dt * dt;
+    sxy += dt * dy;
+    syy += dy * dy;
+  }
+
+  if (sxx > 0.0f) {
+    slope = sxy / sxx;
+    residual_variance = (syy - slope * sxy) / (float)(count - 2u);
+    if (residual_variance < 0.0f) {
+      residual_variance = 0.0f;
+    }
+    slope_error = sqrtf(residual_variance / sxx);
+  }
+
+  span_s = (float)detector->status.span_ms * 0.001f;
+  out_channel->mean = mean_y;
+  out_channel->drift =
+      (fabsf(slope) + detector->config.slope_t_quantile * slope_error) * span_s;
+  out_channel->early_variance = steady_state_variance(detector, 0u, half, flow);
+  out_channel->late_variance =
+      steady_state_variance(detector, half, (uint16_t)(count - half), flow);
+}
+
+// Late-half over early-half variance; a settling transient or a gust shows up
+// as a ratio far from one even when the mean slope happens to be small.
+static float steady_state_variance_ratio(const steady_state_channel_t *channel,
+                                         float tolerance) {
+  float floor = tolerance * STEADY_STATE_VARIANCE_FLOOR_FRACTION;
+
+  floor *= floor;
+  if (channel->early_variance + floor <= 0.0f) {
+    return 1.0f;
+  }
+  return (channel->late_variance + floor) / (channel->early_variance + floor);
+}
+
+static bool steady_state_ratio_ok(float ratio, float limit) {
+  return ratio <= limit && ratio * limit >= 1.0f;
+}
+
+void steady_state_reset(steady_state_detector_t *detector,
+                        const steady_state_config_t *config) {
+  if (detector == NULL || config == NULL) {
+    return;
+  }
+
+  detector->config = *config;
+  if (detector->config.min_samples < 4u) {
+    detector->config.min_samples = 4u;
+  }
+  if (detector->config.min_samples > STEADY_STATE_MAX_SAMPLES) {
+    detector->config.min_samples = STEADY_STATE_MAX_SAMPLES;
+  }
+  detector->head = 0u;
+  detector->count = 0u;
+  detector->status = (steady_state_status_t){0};
+}
+
+bool steady_state_add_sample(steady_state_detector_t *detector, uint32_t t_ms,
+                             float pressure_pa, float flow_m3h) {
+  steady_state_channel_t pressure;
+  steady_state_channel_t flow;
+  const uint32_t min_interval_ms =
+      detector != NULL ? detector->config.window_ms / (STEADY_STATE_MAX_SAMPLES - 1u)
+                       : 0u;
+  float flow_tolerance = 0.0f;
+
+  if (detector == NULL || !isfinite(pressure_pa) || !isfinite(flow_m3h)) {
+    return false;
+  }
+
+  // Decimate so a full window always fits in the ring.
+  if (detector->count > 0u &&
+      (t_ms - detector->samples[steady_state_index(
+                                    detector, (uint16_t)(detector->count - 1u))]
+                  .t_ms) < min_interval_ms) {
+    return detector->status.steady;
+  }
+
+  detector->samples[detector->head] = (steady_state_sample_t){
+      .t_ms = t_ms,
+      .pressure_pa = pressure_pa,
+      .flow_m3h = flow_m3h,
+  };
+  detector->head = (uint16_t)((detector->head + 1u) % STEADY_STATE_MAX_SAMPLES);
+  if (detector->count < STEADY_STATE_MAX_SAMPLES) {
+    detector->count += 1u;
+  }
+
+  while (detector->count > 1u &&
+         (t_ms - detector->samples[steady_state_index(detector, 0u)].t_ms) >
+             detector->config.window_ms) {
+    detector->count = (uint16_t)(detector->count - 1u);
+  }
+
+  detector->status.steady = false;
+  detector->status.sample_count = detector->count;
+  detector->status.span_ms =
+      t_ms - detector->samples[steady_state_index(detector, 0u)].t_ms;
+
+  if (detector->count < detector->config.min_samples ||
+      (float)detector->status.span_ms <
+          (float)detector->config.window_ms * STEADY_STATE_MIN_SPAN_FRACTION) {
+    return false;
+  }
+
+  steady_state_analyze_channel(detector, false, &pressure);
+  steady_state_analyze_channel(detector, true, &flow);
+  flow_tolerance = fabsf(flow.mean) * detector->config.max_flow_drift_ratio;
+
+  detector->status.pressure_mean_pa = pressure.mean;
+  detector->status.flow_mean_m3h = flow.mean;
+  detector->status.pressure_drift_pa = pressure.drift;
+  detector->status.flow_drift_ratio =
+      fabsf(flow.mean) > 0.0f ? flow.drift / fabsf(flow.mean) : 0.0f;
+  detector->status.pressure_variance_ratio = steady_state_variance_ratio(
+      &pressure, detector->config.max_pressure_drift_pa);
+  detector->status.flow_variance_ratio =
+      steady_state_variance_ratio(&flow, flow_tolerance);
+  detector->status.steady =
+      pressure.drift <= detector->config.max_pressure_drift_pa &&
+      flow.drift <= flow_tolerance &&
+      steady_state_ratio_ok(detector->status.pressure_variance_ratio,
+                            detector->config.max_variance_ratio) &&
+      steady_state_ratio_ok(detector->status.flow_variance_ratio,
+                            detector->config.max_variance_ratio);
+
+  return detector->status.steady;
+}
+
+void steady_state_get_status(const steady_state_detector_t *detector,
+                             steady_state_status_t *out_status) {
+  if (detector == NULL || out_status == NULL) {
+    return;
+  }
+
+  *out_status = detector->status;
+}
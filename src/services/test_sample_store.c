@@ -0,0 +1,326 @@
+#include "services/test_sample_store.h"
+
+#include "app/app_config.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TEST_SAMPLE_STORE_BLOCK_COUNT \
+  (APP_TEST_RAW_STORE_BYTES / sizeof(test_sample_block_t))
+#define TEST_SAMPLE_STORE_NO_SERIES 0xffu
+
+typedef struct {
+  uint16_t first_block;
+  uint16_t block_count;
+  uint16_t sample_count;
+  bool truncated;
+} test_sample_series_t;
+
+// Fixed-point scale per channel: ms, 0.01 Pa, 0.01 Pa, 0.01 C, 0.01 C, 0.01 %.
+static const float k_channel_scale[TEST_SAMPLE_CHANNEL_COUNT] = {
+    1.0f, 100.0f, 100.0f, 100.0f, 100.0f, 100.0f,
+};
+
+static test_sample_block_t g_blocks[TEST_SAMPLE_STORE_BLOCK_COUNT];
+static test_sample_series_t g_series[TEST_SAMPLE_STORE_MAX_SERIES];
+static int32_t g_last_value[TEST_SAMPLE_CHANNEL_COUNT];
+static uint16_t g_next_block;
+static uint8_t g_active_series = TEST_SAMPLE_STORE_NO_SERIES;
+
+static int32_t test_sample_store_quantize(float value, float scale) {
+  const float scaled = value * scale;
+
+  if (!isfinite(scaled)) {
+    return 0;
+  }
+  if (scaled >= 2147483520.0f) {
+    return INT32_MAX;
+  }
+  if (scaled <= -2147483520.0f) {
+    return INT32_MIN;
+  }
+  return (int32_t)lrintf(scaled);
+}
+
+static void test_sample_store_encode(const test_sample_t *sample,
+                                     int32_t out_value[TEST_SAMPLE_CHANNEL_COUNT]) {
+  out_value[TEST_SAMPLE_CHANNEL_TIME_MS] = (int32_t)sample->t_ms;
+  out_value[TEST_SAMPLE_CHANNEL_ENVELOPE_PRESSURE] = test_sample_store_quantize(
+      sample->envelope_pressure_pa,
+      k_channel_scale[TEST_SAMPLE_CHANNEL_ENVELOPE_PRESSURE]);
+  out_value[TEST_SAMPLE_CHANNEL_FAN_PRESSURE] = test_sample_store_quantize(
+      sample->fan_pressure_pa, k_channel_scale[TEST_SAMPLE_CHANNEL_FAN_PRESSURE]);
+  out_value[TEST_SAMPLE_CHANNEL_ENVELOPE_TEMPERATURE] = test_sample_store_quantize(
+      sample->envelope_temperature_c,
+      k_channel_scale[TEST_SAMPLE_CHANNEL_ENVELOPE_TEMPERATURE]);
+  out_value[TEST_SAMPLE_CHANNEL_FAN_TEMPERATURE] = test_sample_store_quantize(
+      sample->fan_temperature_c, k_channel_scale[TEST_SAMPLE_CHANNEL_FAN_TEMPERATURE]);
+  out_value[TEST_SAMPLE_CHANNEL_PWM] = test_sample_store_quantize(
+      sample->pwm_percent, k_channel_scale[TEST_SAMPLE_CHANNEL_PWM]);
+}
+
+static void test_sample_store_decode(const int32_t value[TEST_SAMPLE_CHANNEL_COUNT],
+                                     test_sample_t *out_sample) {
+  *out_sample = (test_sample_t){
+      .t_ms = (uint32_t)value[TEST_SAMPLE_CHANNEL_TIME_MS],
+      .envelope_pressure_pa =
+          (float)value[TEST_SAMPLE_CHANNEL_ENVELOPE_PRESSURE] /
+          k_channel_scale[TEST_SAMPLE_CHANNEL_ENVELOPE_PRESSURE],
+      .fan_pressure_pa = (float)value[TEST_SAMPLE_CHANNEL_FAN_PRESSURE] /
+                         k_channel_scale[TEST_SAMPLE_CHANNEL_FAN_PRESSURE],
+      .envelope_temperature_c =
+          (float)value[TEST_SAMPLE_CHANNEL_ENVELOPE_TEMPERATURE] /
+          k_channel_scale[TEST_SAMPLE_CHANNEL_ENVELOPE_TEMPERATURE],
+      .fan_temperature_c = (float)value[TEST_SAMPLE_CHANNEL_FAN_TEMPERATURE] /
+                           k_channel_scale[TEST_SAMPLE_CHANNEL_FAN_TEMPERATURE],
+      .pwm_percent = (float)value[TEST_SAMPLE_CHANNEL_PWM] /
+                     k_channel_scale[TEST_SAMPLE_CHANNEL_PWM],
+  };
+}
+
+static bool test_sample_store_deltas_fit(const int32_t value[TEST_SAMPLE_CHANNEL_COUNT],
+                                         int16_t out_delta[TEST_SAMPLE_CHANNEL_COUNT]) {
+  uint32_t channel = 0u;
+
+  for (channel = 0u; channel < TEST_SAMPLE_CHANNEL_COUNT; ++channel) {
+    const int64_t delta = (int64_t)value[channel] - (int64_t)g_last_value[channel];
+    if (delta < INT16_MIN || delta > INT16_MAX) {
+      return false;
+    }
+    out_delta[channel] = (int16_t)delta;
+  }
+  return true;
+}
+
+void test_sample_store_reset(void) {
+  uint32_t index = 0u;
+
+  g_next_block = 0u;
+  g_active_series = TEST_SAMPLE_STORE_NO_SERIES;
+  for (index = 0u; index < TEST_SAMPLE_STORE_MAX_SERIES; ++index) {
+    g_series[index] = (test_sample_series_t){0};
+  }
+}
+
+bool test_sample_store_begin_series(uint8_t series_id) {
+  if (series_id >= TEST_SAMPLE_STORE_MAX_SERIES) {
+    g_active_series = TEST_SAMPLE_STORE_NO_SERIES;
+    return false;
+  }
+
+  g_series[series_id] = (test_sample_series_t){
+      .first_block = g_next_block,
+  };
+  g_active_series = series_id;
+  return true;
+}
+
+bool test_sample_store_append(const test_sample_t *sample) {
+  test_sample_series_t *series = NULL;
+  test_sample_block_t *block = NULL;
+  int32_t value[TEST_SAMPLE_CHANNEL_COUNT];
+  int16_t delta[TEST_SAMPLE_CHANNEL_COUNT];
+  uint32_t channel = 0u;
+
+  if (sample == NULL || g_active_series == TEST_SAMPLE_STORE_NO_SERIES) {
+    return false;
+  }
+
+  series = &g_series[g_active_series];
+  if (series->truncated || series->sample_count == UINT16_MAX) {
+    return false;
+  }
+
+  test_sample_store_encode(sample, value);
+  if (series->block_count > 0u) {
+    block = &g_blocks[series->first_block + series->block_count - 1u];
+    if (block->count < TEST_SAMPLE_STORE_BLOCK_SAMPLES &&
+        test_sample_store_deltas_fit(value, delta)) {
+      for (channel = 0u; channel < TEST_SAMPLE_CHANNEL_COUNT; ++channel) {
+        block->delta[block->count - 1u][channel] = delta[channel];
+        g_last_value[channel] = value[channel];
+      }
+      block->count += 1u;
+      series->sample_count += 1u;
+      return true;
+    }
+  }
+
+  if (g_next_block >= TEST_SAMPLE_STORE_BLOCK_COUNT) {
+    series->truncated = true;
+    return false;
+  }
+
+  block = &g_blocks[g_next_block];
+  g_next_block += 1u;
+  series->block_count += 1u;
+  for (channel = 0u; channel < TEST_SAMPLE_CHANNEL_COUNT; ++channel) {
+    block->base[channel] = value[channel];
+    g_last_value[channel] = value[channel];
+  }
+  block->count = 1u;
+  series->sample_count += 1u;
+  return true;
+}
+
+uint16_t test_sample_store_series_count(uint8_t series_id) {
+  return series_id < TEST_SAMPLE_STORE_MAX_SERIES ? g_series[series_id].sample_count
+                                                  : 0u;
+}
+
+bool test_sample_store_series_truncated(uint8_t series_id) {
+  return series_id < TEST_SAMPLE_STORE_MAX_SERIES && g_series[series_id].truncated;
+}
+
+void test_sample_store_get_usage(size_t *out_used_bytes, size_t *out_capacity_bytes) {
+  if (out_used_bytes != NULL) {
+    *out_used_bytes = (size_t)g_next_block * sizeof(test_sample_block_t);
+  }
+  if (out_capacity_bytes != NULL) {
+    *out_capacity_bytes = sizeof(g_blocks);
+  }
+}
+
+// Where image offset lands: in the series table or in the block pool, with
+// the bytes left in that region.
+static uint8_t *test_sample_store_image_at(size_t offset, size_t *out_span) {
+  const size_t table_size = sizeof(g_series);
+
+  if (offset < table_size) {
+    *out_span = table_size - offset;
+    return (uint8_t *)g_series + offset;
+  }
+  offset -= table_size;
+  if (offset < sizeof(g_blocks)) {
+    *out_span = sizeof(g_blocks) - offset;
+    return (uint8_t *)g_blocks + offset;
+  }
+  *out_span = 0u;
+  return NULL;
+}
+
+size_t test_sample_store_image_size(void) {
+  return sizeof(g_series) + (size_t)g_next_block * sizeof(test_sample_block_t);
+}
+
+size_t test_sample_store_image_read(size_t offset, void *out_data, size_t length) {
+  const size_t size = test_sample_store_image_size();
+  uint8_t *out_bytes = (uint8_t *)out_data;
+  size_t copied = 0u;
+
+  if (out_data == NULL || offset >= size) {
+    return 0u;
+  }
+  if (length > size - offset) {
+    length = size - offset;
+  }
+
+  while (copied < length) {
+    size_t span = 0u;
+    const uint8_t *source = test_sample_store_image_at(offset + copied, &span);
+
+    if (span > length - copied) {
+      span = length - copied;
+    }
+    memcpy(out_bytes + copied, source, span);
+    copied += span;
+  }
+  return copied;
+}
+
+bool test_sample_store_image_write(size_t offset, const void *data, size_t length) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  size_t copied = 0u;
+
+  if (data == NULL || offset > sizeof(g_series) + sizeof(g_blocks) ||
+      length > sizeof(g_series) + sizeof(g_blocks) - offset) {
+    return false;
+  }
+
+  g_active_series = TEST_SAMPLE_STORE_NO_SERIES;
+  while (copied < length) {
+    size_t span = 0u;
+    uint8_t *dest = test_sample_store_image_at(offset + copied, &span);
+
+    if (span > length - copied) {
+      span = length - copied;
+    }
+    memcpy(dest, bytes + copied, span);
+    copied += span;
+  }
+  return true;
+}
+
+bool test_sample_store_image_finish(size_t size) {
+  const size_t table_size = sizeof(g_series);
+  size_t block_count = 0u;
+  uint32_t index = 0u;
+
+  if (size < table_size || ((size - table_size) % sizeof(test_sample_block_t)) != 0u ||
+      (size - table_size) / sizeof(test_sample_block_t) > TEST_SAMPLE_STORE_BLOCK_COUNT) {
+    test_sample_store_reset();
+    return false;
+  }
+
+  block_count = (size - table_size) / sizeof(test_sample_block_t);
+  for (index = 0u; index < TEST_SAMPLE_STORE_MAX_SERIES; ++index) {
+    const test_sample_series_t *series = &g_series[index];
+
+    if ((size_t)series->first_block + series->block_count > block_count) {
+      test_sample_store_reset();
+      return false;
+    }
+  }
+  for (index = 0u; index < block_count; ++index) {
+    if (g_blocks[index].count == 0u ||
+        g_blocks[index].count > TEST_SAMPLE_STORE_BLOCK_SAMPLES) {
+      test_sample_store_reset();
+      return false;
+    }
+  }
+
+  g_next_block = (uint16_t)block_count;
+  g_active_series = TEST_SAMPLE_STORE_NO_SERIES;
+  return true;
+}
+
+void test_sample_store_cursor_init(test_sample_cursor_t *cursor, uint8_t series_id) {
+  if (cursor == NULL) {
+    return;
+  }
+
+  *cursor = (test_sample_cursor_t){
+      .series_id = series_id,
+  };
+  if (series_id < TEST_SAMPLE_STORE_MAX_SERIES) {
+    cursor->block = g_series[series_id].first_block;
+    cursor->block_end =
+        (uint16_t)(g_series[series_id].first_block + g_series[series_id].block_count);
+  }
+}
+
+bool test_sample_store_cursor_next(test_sample_cursor_t *cursor, test_sample_t *out_sample) {
+  const test_sample_block_t *block = NULL;
+  uint32_t channel = 0u;
+
+  if (cursor == NULL || out_sample == NULL || cursor->block >= cursor->block_end) {
+    return false;
+  }
+
+  block = &g_blocks[cursor->block];
+  for (channel = 0u; channel < TEST_SAMPLE_CHANNEL_COUNT; ++channel) {
+    cursor->value[channel] = cursor->index == 0u
+                                 ? block->base[channel]
+                                 : cursor->value[channel] +
+                                       block->delta[cursor->index - 1u][channel];
+  }
+  test_sample_store_decode(cursor->value, out_sample);
+
+  cursor->index += 1u;
+  if (cursor->index >= block->count) {
+    cursor->block += 1u;
+    cursor->index = 0u;
+  }
+  return true;
+}
@@ -0,0 +1,354 @@
+#include "services/websocket.h"
+
+#include <string.h>
+
+#define WEBSOCKET_KEY_LENGTH 24u
+
+static const char k_websocket_guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+typedef struct {
+  uint32_t state[5];
+  uint64_t length;
+  size_t block_length;
+  uint8_t block[64];
+} websocket_sha1_t;
+
+static uint32_t websocket_rol(uint32_t value, unsigned bits) {
+  return (value << bits) | (value >> (32u - bits));
+}
+
+static void websocket_sha1_block(websocket_sha1_t *sha1) {
+  uint32_t w[80];
+  uint32_t a = sha1->state[0];
+  uint32_t b = sha1->state[1];
+  uint32_t c = sha1->state[2];
+  uint32_t d = sha1->state[3];
+  uint32_t e = sha1->state[4];
+  unsigned index = 0u;
+
+  for (index = 0u; index < 16u; ++index) {
+    w[index] = ((uint32_t)sha1->block[index * 4u] << 24) |
+               ((uint32_t)sha1->block[index * 4u + 1u] << 16) |
+               ((uint32_t)sha1->block[index * 4u + 2u] << 8) |
+               (uint32_t)sha1->block[index * 4u + 3u];
+  }
+  for (index = 16u; index < 80u; ++index) {
+    w[index] = websocket_rol(w[index - 3u] ^ w[index - 8u] ^ w[index - 14u] ^
+                                 w[index - 16u],
+                             1u);
+  }
+
+  for (index = 0u; index < 80u; ++index) {
+    uint32_t f = 0u;
+    uint32_t k = 0u;
+    uint32_t temp = 0u;
+
+    if (index < 20u) {
+      f = (b & c) | (~b & d);
+      k = 0x5A827999u;
+    } else if (index < 40u) {
+      f = b ^ c ^ d;
+      k = 0x6ED9EBA1u;
+    } else if (index < 60u) {
+      f = (b & c) | (b & d) | (c & d);
+      k = 0x8F1BBCDCu;
+    } else {
+      f = b ^ c ^ d;
+      k = 0xCA62C1D6u;
+    }
+    temp = websocket_rol(a, 5u) + f + e + k + w[index];
+    e = d;
+    d = c;
+    c = websocket_rol(b, 30u);
+    b = a;
+    a = temp;
+  }
+
+  sha1->state[0] += a;
+  sha1->state[1] += b;
+  sha1->state[2] += c;
+  sha1->state[3] += d;
+  sha1->state[4] += e;
+  sha1->block_length = 0u;
+}
+
+static void websocket_sha1_init(websocket_sha1_t *sha1) {
+  sha1->state[0] = 0x67452301u;
+  sha1->state[1] = 0xEFCDAB89u;
+  sha1->state[2] = 0x98BADCFEu;
+  sha1->state[3] = 0x10325476u;
+  sha1->state[4] = 0xC3D2E1F0u;
+  sha1->length = 0u;
+  sha1->block_length = 0u;
+}
+
+static void websocket_sha1_update(websocket_sha1_t *sha1, const void *data,
+                                  size_t length) {
+  const uint8_t *bytes = (const uint8_t *)data;
+
+  sha1->length += length;
+  while (length-- > 0u) {
+    sha1->block[sha1->block_length++] = *bytes++;
+    if (sha1->block_length == sizeof(sha1->block)) {
+      websocket_sha1_block(sha1);
+    }
+  }
+}
+
+static void websocket_sha1_final(websocket_sha1_t *sha1, uint8_t digest[20]) {
+  const uint64_t bit_length = sha1->length * 8u;
+  unsigned index = 0u;
+
+  sha1->block[sha1->block_length++] = 0x80u;
+  if (sha1->block_length > 56u) {
+    memset(sha1->block + sha1->block_length, 0, sizeof(sha1->block) - sha1->block_length);
+    websocket_sha1_block(sha1);
+  }
+  memset(sha1->block + sha1->block_length, 0, 56u - sha1->block_length);
+  for (index = 0u; index < 8u; ++index) {
+    sha1->block[56u + index] = (uint8_t)(bit_length >> (56u - index * 8u));
+  }
+  websocket_sha1_block(sha1);
+
+  for (index = 0u; index < 20u; ++index) {
+    digest[index] = (uint8_t)(sha1->state[index / 4u] >> (24u - (index % 4u) * 8u));
+  }
+}
+
+static bool websocket_is_base64(char value) {
+  return (value >= 'A' && value <= 'Z') || (value >= 'a' && value <= 'z') ||
+         (value >= '0' && value <= '9') || value == '+' || value == '/';
+}
+
+bool websocket_accept_key(const char *key, size_t key_length,
+                          char accept[WEBSOCKET_ACCEPT_KEY_LENGTH + 1u]) {
+  static const char k_alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  websocket_sha1_t sha1;
+  uint8_t digest[21];
+  size_t index = 0u;
+  char *out = accept;
+
+  // A 16-byte nonce is 22 base64 characters and "==".
+  if (key_length != WEBSOCKET_KEY_LENGTH || key[22] != '=' || key[23] != '=') {
+    return false;
+  }
+  for (index = 0u; index < 22u; ++index) {
+    if (!websocket_is_base64(key[index])) {
+      return false;
+    }
+  }
+
+  websocket_sha1_init(&sha1);
+  websocket_sha1_update(&sha1, key, key_length);
+  websocket_sha1_update(&sha1, k_websocket_guid, sizeof(k_websocket_guid) - 1u);
+  websocket_sha1_final(&sha1, digest);
+  digest[20] = 0u;
+
+  // 20 bytes: six full groups and one of two bytes.
+  for (index = 0u; index < 21u; index += 3u) {
+    const uint32_t group = ((uint32_t)digest[index] << 16) |
+                           ((uint32_t)digest[index + 1u] << 8) | digest[index + 2u];
+
+    *out++ = k_alphabet[(group >> 18) & 0x3Fu];
+    *out++ = k_alphabet[(group >> 12) & 0x3Fu];
+    *out++ = k_alphabet[(group >> 6) & 0x3Fu];
+    *out++ = index + 3u < 21u ? k_alphabet[group & 0x3Fu] : '=';
+  }
+  *out = '\0';
+  return true;
+}
+
+size_t websocket_frame_header(uint8_t *header, bool fin, uint8_t opcode,
+                              uint64_t payload_length) {
+  unsigned index = 0u;
+
+  header[0] = (uint8_t)((fin ? 0x80u : 0u) | (opcode & 0x0Fu));
+  if (payload_length < 126u) {
+    header[1] = (uint8_t)payload_length;
+    return 2u;
+  }
+  if (payload_length <= 0xFFFFu) {
+    header[1] = 126u;
+    header[2] = (uint8_t)(payload_length >> 8);
+    header[3] = (uint8_t)payload_length;
+    return 4u;
+  }
+
+  header[1] = 127u;
+  for (index = 0u; index < 8u; ++index) {
+    header[2u + index] = (uint8_t)(payload_length >> (56u - index * 8u));
+  }
+  return 10u;
+}
+
+static bool websocket_parser_fail(websocket_parser_t *parser, uint16_t close_code) {
+  parser->state = WEBSOCKET_PARSER_ERROR;
+  parser->close_code = close_code;
+  return false;
+}
+
+static bool websocket_parser_is_control(uint8_t opcode) { return (opcode & 0x8u) != 0u; }
+
+static void websocket_parser_frame_done(websocket_parser_t *parser) {
+  if (websocket_parser_is_control(parser->frame_opcode)) {
+    parser->opcode = parser->frame_opcode;
+    parser->payload = parser->control;
+    parser->payload_length = parser->control_length;
+    if (parser->opcode == WEBSOCKET_OPCODE_CLOSE && parser->control_length >= 2u) {
+      parser->close_code =
+          (uint16_t)(((uint16_t)parser->control[0] << 8) | parser->control[1]);
+    }
+    parser->state = WEBSOCKET_PARSER_MESSAGE;
+  } else if (parser->frame_fin) {
+    parser->opcode = parser->message_opcode;
+    parser->payload = parser->message;
+    parser->payload_length = parser->message_length;
+    parser->state = WEBSOCKET_PARSER_MESSAGE;
+  } else {
+    parser->state = WEBSOCKET_PARSER_HEADER;
+  }
+
+  parser->header_length = 0u;
+  parser->header_needed = 2u;
+}
+
+// Header is complete: check it against RFC 6455 and what a client may send.
+static bool websocket_parser_header_done(websocket_parser_t *parser) {
+  const uint8_t *header = parser->header;
+  const uint8_t opcode = header[0] & 0x0Fu;
+  const uint8_t length_code = header[1] & 0x7Fu;
+  uint64_t length = length_code;
+  size_t mask_at = 2u;
+  unsigned index = 0u;
+
+  if (length_code == 126u) {
+    length = ((uint64_t)header[2] << 8) | header[3];
+    mask_at = 4u;
+  } else if (length_code == 127u) {
+    length = 0u;
+    for (index = 0u; index < 8u; ++index) {
+      length = (length << 8) | header[2u + index];
+    }
+    mask_at = 10u;
+  }
+  memcpy(parser->mask, header + mask_at, sizeof(parser->mask));
+
+  parser->frame_fin = (header[0] & 0x80u) != 0u;
+  parser->frame_opcode = opcode;
+  parser->frame_remaining = length;
+  parser->frame_offset = 0u;
+
+  if (websocket_parser_is_control(opcode)) {
+    if ((opcode != WEBSOCKET_OPCODE_CLOSE && opcode != WEBSOCKET_OPCODE_PING &&
+         opcode != WEBSOCKET_OPCODE_PONG) ||
+        !parser->frame_fin || length > WEBSOCKET_MAX_CONTROL_BYTES) {
+      return websocket_parser_fail(parser, WEBSOCKET_CLOSE_PROTOCOL_ERROR);
+    }
+    parser->control_length = 0u;
+  } else if (opcode == WEBSOCKET_OPCODE_CONTINUATION) {
+    if (parser->message_opcode == 0u) {
+      return websocket_parser_fail(parser, WEBSOCKET_CLOSE_PROTOCOL_ERROR);
+    }
+  } else if (opcode == WEBSOCKET_OPCODE_TEXT || opcode == WEBSOCKET_OPCODE_BINARY) {
+    if (parser->message_opcode != 0u) {
+      return websocket_parser_fail(parser, WEBSOCKET_CLOSE_PROTOCOL_ERROR);
+    }
+    parser->message_opcode = opcode;
+    parser->message_length = 0u;
+  } else {
+    return websocket_parser_fail(parser, WEBSOCKET_CLOSE_PROTOCOL_ERROR);
+  }
+
+  if (!websocket_parser_is_control(opcode) &&
+      length > WEBSOCKET_MAX_MESSAGE_BYTES - parser->message_length) {
+    return websocket_parser_fail(parser, WEBSOCKET_CLOSE_TOO_BIG);
+  }
+
+  if (length == 0u) {
+    websocket_parser_frame_done(parser);
+  } else {
+    parser->state = WEBSOCKET_PARSER_PAYLOAD;
+  }
+  return true;
+}
+
+void websocket_parser_init(websocket_parser_t *parser) {
+  parser->state = WEBSOCKET_PARSER_HEADER;
+  parser->header_length = 0u;
+  parser->header_needed = 2u;
+  parser->message_opcode = 0u;
+  parser->message_length = 0u;
+  parser->control_length = 0u;
+  parser->opcode = 0u;
+  parser->payload = NULL;
+  parser->payload_length = 0u;
+  parser->close_code = 0u;
+}
+
+size_t websocket_parser_feed(websocket_parser_t *parser, const uint8_t *data,
+                             size_t length) {
+  size_t consumed = 0u;
+
+  while (consumed < length && (parser->state == WEBSOCKET_PARSER_HEADER ||
+                               parser->state == WEBSOCKET_PARSER_PAYLOAD)) {
+    if (parser->state == WEBSOCKET_PARSER_PAYLOAD) {
+      const bool control = websocket_parser_is_control(parser->frame_opcode);
+      uint8_t *target = control ? parser->control + parser->control_length
+                                : parser->message + parser->message_length;
+      size_t slice = length - consumed;
+      size_t index = 0u;
+
+      if (slice > parser->frame_remaining) {
+        slice = (size_t)parser->frame_remaining;
+      }
+      for (index = 0u; index < slice; ++index) {
+        target[index] = data[consumed + index] ^ parser->mask[parser->frame_offset++ & 3u];
+      }
+      if (control) {
+        parser->control_length += slice;
+      } else {
+        parser->message_length += slice;
+      }
+      consumed += slice;
+      parser->frame_remaining -= slice;
+      if (parser->frame_remaining == 0u) {
+        websocket_parser_frame_done(parser);
+      }
+      continue;
+    }
+
+    parser->header[parser->header_length++] = data[consumed++];
+    if (parser->header_length == 2u) {
+      const uint8_t length_code = parser->header[1] & 0x7Fu;
+
+      // Reserved bits need a negotiated extension; clients must mask.
+      if ((parser->header[0] & 0x70u) != 0u || (parser->header[1] & 0x80u) == 0u) {
+        websocket_parser_fail(parser, WEBSOCKET_CLOSE_PROTOCOL_ERROR);
+        break;
+      }
+      parser->header_needed =
+          2u + (length_code == 126u ? 2u : (length_code == 127u ? 8u : 0u)) + 4u;
+    }
+    if (parser->header_length == parser->header_needed &&
+        !websocket_parser_header_done(parser)) {
+      break;
+    }
+  }
+
+  return consumed;
+}
+
+void websocket_parser_next(websocket_parser_t *parser) {
+  if (parser->state != WEBSOCKET_PARSER_MESSAGE) {
+    return;
+  }
+  if (!websocket_parser_is_control(parser->opcode)) {
+    parser->message_opcode = 0u;
+    parser->message_length = 0u;
+  }
+  parser->opcode = 0u;
+  parser->payload = NULL;
+  parser->payload_length = 0u;
+  parser->state = WEBSOCKET_PARSER_HEADER;
+}
@@ -1,24 +1,251 @@
 #include "shared_state.h"
 
 #include <stdatomic.h>
+#include <stddef.h>
 
+#include "app/app_config.h"
+#include "hardware/sync.h"
 #include "pico/stdlib.h"
 
-static atomic_uchar g_dimmer_power_percent;
+#define SHARED_DIMMER_PERCENT_MASK 0xFFu
+#define SHARED_DIMMER_SEQUENCE_SHIFT 8u
+#define SHARED_DIMMER_SEQUENCE_MASK 0x00FFFFFFu
+
+// Pending command packed as (sequence << 8) | percent so the committing ISR
+// can never pair the percent of one submit with the sequence of another.
+static atomic_uint g_dimmer_command_pending;
+static atomic_uint g_dimmer_command_sequence;
+
+// Committed actuation record behind a sequence lock. Only the gate-timing
+// core writes it, with its local interrupts masked, so there is one writer.
+static atomic_uint g_actuation_generation;
+static shared_dimmer_actuation_t g_actuation;
+static uint32_t g_asymmetry_first_half_sequence;
+static uint32_t g_asymmetry_first_half_delay_us;
+
+// Health counters have a single writer (the core that owns gate timing), so
+// relaxed loads/stores are enough; readers only need eventually-fresh values.
+static atomic_uint g_zero_cross_count;
+static atomic_uint g_gate_pulse_count;
+static atomic_uint g_missed_alarm_count;
+static atomic_uint g_blanked_half_cycle_count;
+static atomic_uint g_fire_latency_last_us;
+static atomic_uint g_fire_latency_max_us;
+static atomic_uint g_fire_latency_total_us;
+static atomic_bool g_line_pll_locked;
+static atomic_uint g_line_frequency_mhz;
+static atomic_uint g_line_phase_error_ms_us2;
+
+static __force_inline void shared_counter_increment(atomic_uint *counter) {
+  atomic_store_explicit(counter,
+                        atomic_load_explicit(counter, memory_order_relaxed) + 1u,
+                        memory_order_relaxed);
+}
+
+static __force_inline void shared_actuation_write_begin(void) {
+  atomic_store_explicit(&g_actuation_generation,
+                        atomic_load_explicit(&g_actuation_generation,
+                                             memory_order_relaxed) +
+                            1u,
+                        memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+}
+
+static __force_inline void shared_actuation_write_end(void) {
+  atomic_store_explicit(&g_actuation_generation,
+                        atomic_load_explicit(&g_actuation_generation,
+                                             memory_order_relaxed) +
+                            1u,
+                        memory_order_release);
+}
 
 void __time_critical_func(shared_state_init)(void) {
-  atomic_store_explicit(&g_dimmer_power_percent, 0, memory_order_relaxed);
+  atomic_store_explicit(&g_dimmer_command_pending, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_dimmer_command_sequence, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_actuation_generation, 0u, memory_order_relaxed);
+  g_actuation = (shared_dimmer_actuation_t){0};
+  g_asymmetry_first_half_sequence = 0u;
+  g_asymmetry_first_half_delay_us = 0u;
+  atomic_store_explicit(&g_zero_cross_count, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_gate_pulse_count, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_missed_alarm_count, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_blanked_half_cycle_count, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_fire_latency_last_us, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_fire_latency_max_us, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_fire_latency_total_us, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_line_pll_locked, false, memory_order_relaxed);
+  atomic_store_explicit(&g_line_frequency_mhz, 0u, memory_order_relaxed);
+  atomic_store_explicit(&g_line_phase_error_ms_us2, 0u, memory_order_relaxed);
 }
 
 void __time_critical_func(shared_set_dimmer_power_percent)(uint8_t percent) {
+  (void)shared_dimmer_submit_command(percent);
+}
+
+uint8_t __time_critical_func(shared_get_dimmer_power_percent)(void) {
+  return (uint8_t)(atomic_load_explicit(&g_dimmer_command_pending,
+                                        memory_order_relaxed) &
+                   SHARED_DIMMER_PERCENT_MASK);
+}
+
+uint32_t shared_dimmer_submit_command(uint8_t percent) {
+  uint32_t sequence = 0u;
+
   if (percent > 100) {
     percent = 100;
   }
-  atomic_store_explicit(&g_dimmer_power_percent, (unsigned char)percent,
+
+  sequence = (atomic_fetch_add_explicit(&g_dimmer_command_sequence, 1u,
+                                        memory_order_relaxed) +
+              1u) &
+             SHARED_DIMMER_SEQUENCE_MASK;
+  atomic_store_explicit(&g_dimmer_command_pending,
+                        (sequence << SHARED_DIMMER_SEQUENCE_SHIFT) | percent,
+                        memory_order_release);
+  return sequence;
+}
+
+uint8_t __time_critical_func(shared_dimmer_commit_half_cycles)(
+    uint32_t zero_cross_us, uint32_t half_cycles,
+    uint32_t *out_first_half_cycle_sequence) {
+  const uint32_t pending =
+      atomic_load_explicit(&g_dimmer_command_pending, memory_order_acquire);
+  const uint8_t percent = (uint8_t)(pending & SHARED_DIMMER_PERCENT_MASK);
+  uint32_t first_half_cycle_sequence = 0u;
+  uint32_t irq_state = save_and_disable_interrupts();
+
+  shared_actuation_write_begin();
+  first_half_cycle_sequence = g_actuation.half_cycle_sequence + 1u;
+  g_actuation.command_sequence = pending >> SHARED_DIMMER_SEQUENCE_SHIFT;
+  g_actuation.power_percent = percent;
+  g_actuation.half_cycle_sequence += half_cycles;
+  g_actuation.commit_us = zero_cross_us;
+  g_actuation.fire_us = 0u;
+  g_actuation.fire_delay_us = 0u;
+  shared_actuation_write_end();
+
+  restore_interrupts(irq_state);
+
+  if (out_first_half_cycle_sequence != NULL) {
+    *out_first_half_cycle_sequence = first_half_cycle_sequence;
+  }
+  return percent;
+}
+
+void __time_critical_func(shared_dimmer_note_fire)(uint32_t half_cycle_sequence,
+                                                   uint32_t zero_cross_us,
+                                                   uint32_t fire_us) {
+  const uint32_t fire_delay_us = fire_us - zero_cross_us;
+  uint32_t irq_state = save_and_disable_interrupts();
+
+  shared_actuation_write_begin();
+  g_actuation.fire_us = fire_us;
+  g_actuation.fire_delay_us = fire_delay_us;
+  g_actuation.fire_half_cycle_sequence = half_cycle_sequence;
+
+  // Half-cycles pair up as (odd, even) sequence numbers; the two halves of a
+  // mains cycle should conduct for the same angle or the load sees DC.
+  if ((half_cycle_sequence & 1u) != 0u) {
+    g_asymmetry_first_half_sequence = half_cycle_sequence;
+    g_asymmetry_first_half_delay_us = fire_delay_us;
+  } else if (g_asymmetry_first_half_sequence + 1u == half_cycle_sequence) {
+    const int32_t asymmetry_us =
+        (int32_t)(fire_delay_us - g_asymmetry_first_half_delay_us);
+
+    g_actuation.last_asymmetry_us = asymmetry_us;
+    if (asymmetry_us > (int32_t)APP_DIMMER_ASYMMETRY_THRESHOLD_US ||
+        asymmetry_us < -(int32_t)APP_DIMMER_ASYMMETRY_THRESHOLD_US) {
+      g_actuation.asymmetric_cycle_count++;
+    }
+    g_asymmetry_first_half_sequence = 0u;
+  }
+  shared_actuation_write_end();
+
+  restore_interrupts(irq_state);
+}
+
+void shared_dimmer_get_actuation(shared_dimmer_actuation_t *out_actuation) {
+  if (out_actuation == NULL) {
+    return;
+  }
+
+  for (;;) {
+    const uint32_t generation =
+        atomic_load_explicit(&g_actuation_generation, memory_order_acquire);
+
+    if ((generation & 1u) == 0u) {
+      *out_actuation = g_actuation;
+      atomic_thread_fence(memory_order_acquire);
+      if (atomic_load_explicit(&g_actuation_generation, memory_order_relaxed) ==
+          generation) {
+        return;
+      }
+    }
+    tight_loop_contents();
+  }
+}
+
+void __time_critical_func(shared_dimmer_note_zero_cross)(void) {
+  shared_counter_increment(&g_zero_cross_count);
+}
+
+void __time_critical_func(shared_dimmer_note_gate_pulse)(uint32_t fire_latency_us) {
+  shared_counter_increment(&g_gate_pulse_count);
+  atomic_store_explicit(&g_fire_latency_last_us, fire_latency_us, memory_order_relaxed);
+  atomic_store_explicit(&g_fire_latency_total_us,
+                        atomic_load_explicit(&g_fire_latency_total_us,
+                                             memory_order_relaxed) +
+                            fire_latency_us,
+                        memory_order_relaxed);
+  if (fire_latency_us >
+      atomic_load_explicit(&g_fire_latency_max_us, memory_order_relaxed)) {
+    atomic_store_explicit(&g_fire_latency_max_us, fire_latency_us,
+                          memory_order_relaxed);
+  }
+}
+
+void __time_critical_func(shared_dimmer_note_missed_alarm)(void) {
+  shared_counter_increment(&g_missed_alarm_count);
+}
+
+void __time_critical_func(shared_dimmer_note_blanked_half_cycle)(void) {
+  shared_counter_increment(&g_blanked_half_cycle_count);
+}
+
+void __time_critical_func(shared_dimmer_set_line_status)(bool pll_locked,
+                                                         uint32_t frequency_mhz,
+                                                         uint32_t phase_error_ms_us2) {
+  atomic_store_explicit(&g_line_pll_locked, pll_locked, memory_order_relaxed);
+  atomic_store_explicit(&g_line_frequency_mhz, frequency_mhz, memory_order_relaxed);
+  atomic_store_explicit(&g_line_phase_error_ms_us2, phase_error_ms_us2,
                         memory_order_relaxed);
 }
 
-uint8_t __time_critical_func(shared_get_dimmer_power_percent)(void) {
-  return (uint8_t)atomic_load_explicit(&g_dimmer_power_percent,
-                                       memory_order_relaxed);
+void shared_dimmer_get_health(shared_dimmer_health_t *out_health) {
+  if (out_health == NULL) {
+    return;
+  }
+
+  *out_health = (shared_dimmer_health_t){
+      .zero_cross_count =
+          atomic_load_explicit(&g_zero_cross_count, memory_order_relaxed),
+      .gate_pulse_count =
+          atomic_load_explicit(&g_gate_pulse_count, memory_order_relaxed),
+      .missed_alarm_count =
+          atomic_load_explicit(&g_missed_alarm_count, memory_order_relaxed),
+      .blanked_half_cycle_count =
+          atomic_load_explicit(&g_blanked_half_cycle_count, memory_order_relaxed),
+      .fire_latency_last_us =
+          atomic_load_explicit(&g_fire_latency_last_us, memory_order_relaxed),
+      .fire_latency_max_us =
+          atomic_load_explicit(&g_fire_latency_max_us, memory_order_relaxed),
+      .fire_latency_total_us =
+          atomic_load_explicit(&g_fire_latency_total_us, memory_order_relaxed),
+      .line_pll_locked =
+          atomic_load_explicit(&g_line_pll_locked, memory_order_relaxed),
+      .line_frequency_mhz =
+          atomic_load_explicit(&g_line_frequency_mhz, memory_order_relaxed),
+      .line_phase_error_ms_us2 =
+          atomic_load_explicit(&g_line_phase_error_ms_us2, memory_order_relaxed),
+  };
 }
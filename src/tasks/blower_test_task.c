@@ -0,0 +1,41 @@
+#include "tasks/task_entries.h"
+
+#include "app/app_config.h"
+#include "FreeRTOS.h"
+#include "services/blower_control.h"
+#include "services/blower_metrics.h"
+#include "services/blower_test_service.h"
+#include "task.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+void blower_test_task_entry(void *params) {
+  TickType_t next_wake_tick = xTaskGetTickCount();
+  uint32_t last_update_sequence = 0u;
+  bool has_update_sequence = false;
+  (void)params;
+
+  blower_test_service_init();
+  printf("[TEST] engine ready\n");
+
+  while (1) {
+    blower_metrics_snapshot_t metrics_snapshot = {0};
+    blower_control_snapshot_t control_snapshot = {0};
+    const uint32_t now_ms =
+        (uint32_t)xTaskGetTickCount() * (uint32_t)portTICK_PERIOD_MS;
+
+    // Only new sensor samples advance the averages; the loop still runs at
+    // control cadence so stop/start requests are picked up promptly.
+    if (blower_metrics_service_get_snapshot(&metrics_snapshot) &&
+        (!has_update_sequence ||
+         metrics_snapshot.update_sequence != last_update_sequence)) {
+      last_update_sequence = metrics_snapshot.update_sequence;
+      has_update_sequence = true;
+      blower_control_get_snapshot(&control_snapshot);
+      blower_test_service_update(&metrics_snapshot, &control_snapshot, now_ms);
+    }
+
+    vTaskDelayUntil(&next_wake_tick, pdMS_TO_TICKS(APP_BLOWER_TEST_PERIOD_MS));
+  }
+}
@@ -2,6 +2,7 @@
 
 #include "app/app_config.h"
 #include "FreeRTOS.h"
+#include "drivers/zero_cross/zero_cross_capture.h"
 #include "hardware/gpio.h"
 #include "hardware/sync.h"
 #include "hardware/timer.h"
@@ -9,15 +10,37 @@
 #include "services/blower_control.h"
 #include "services/blower_metrics.h"
 #include "services/dimmer_control.h"
+#include "services/dimmer_trace.h"
+#include "services/flash_writer.h"
+#include "services/mains_pll.h"
+#include "shared_state.h"
 #include "task.h"
 #include <math.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #define DIMMER_GATE_PULSE_US 100u
-#define DIMMER_FREQUENCY_DOUBLE_EDGE_THRESHOLD_HZ 70.0f
+#define DIMMER_GATE_END_MARGIN_US 200u
+#define DIMMER_GATE_LATE_LIMIT_US 500u
+#define DIMMER_DEFAULT_HALF_CYCLE_US 10000.0f
+#define DIMMER_GATE_SCHEDULE_SLOTS 4u
+
+#if APP_DIMMER_ON_CORE1
+static uint32_t g_core1_zero_cross_count = 0u;
+static uint32_t g_core1_last_zero_cross_ms = 0u;
+#else
+typedef struct {
+  uint32_t target_us;
+  uint32_t zero_cross_us;
+  uint32_t half_cycle_sequence;
+} dimmer_gate_schedule_t;
 
 static volatile uint32_t g_last_zero_cross_us = 0u;
-static volatile uint32_t g_zero_cross_period_us = 0u;
+static mains_pll_t g_mains_pll;
+// Indexed by half-cycle sequence; an alarm always fires within its own
+// half-cycle, long before its slot comes round again.
+static dimmer_gate_schedule_t g_gate_schedule[DIMMER_GATE_SCHEDULE_SLOTS];
+#endif
 
 static bool dimmer_pick_control_pressure(
     const blower_metrics_snapshot_t *snapshot, float *out_pressure_pa) {
@@ -59,44 +82,163 @@ static bool dimmer_pick_control_pressure(
 #endif
 }
 
+#if APP_DIMMER_ON_CORE1
+static void dimmer_update_line_feedback(void) {
+  shared_dimmer_health_t health;
+  const uint32_t now_ms =
+      (uint32_t)xTaskGetTickCount() * (uint32_t)portTICK_PERIOD_MS;
+
+  shared_dimmer_get_health(&health);
+  // Core1 runs on its own timer instance, so sync is judged by whether its
+  // zero-cross counter keeps moving rather than by comparing timestamps.
+  if (health.zero_cross_count != g_core1_zero_cross_count) {
+    g_core1_zero_cross_count = health.zero_cross_count;
+    g_core1_last_zero_cross_ms = now_ms;
+  }
+
+  const bool line_sync_available =
+      g_core1_zero_cross_count != 0u &&
+      (now_ms - g_core1_last_zero_cross_ms) * 1000u <= APP_LINE_SYNC_TIMEOUT_US;
+
+  blower_control_update_line_feedback(
+      line_sync_available,
+      line_sync_available ? (float)health.line_frequency_mhz / 1000.0f : 0.0f,
+      line_sync_available && health.line_pll_locked,
+      line_sync_available ? sqrtf((float)health.line_phase_error_ms_us2) : 0.0f);
+}
+
+#else
 static int64_t dimmer_gate_pulse_alarm_callback(alarm_id_t alarm_id,
                                                 void *user_data) {
+  const dimmer_gate_schedule_t *schedule = (const dimmer_gate_schedule_t *)user_data;
+  const uint32_t fire_us = time_us_32();
+  const int32_t latency_us = (int32_t)(fire_us - schedule->target_us);
+  (void)alarm_id;
+
+  if (latency_us > (int32_t)DIMMER_GATE_LATE_LIMIT_US) {
+    shared_dimmer_note_missed_alarm();
+    dimmer_trace_note_missed();
+    return 0;
+  }
+
+  dimmer_trace_note_fire(schedule->target_us, fire_us);
   gpio_put(APP_DIMMER_GATE_PIN, 1);
   busy_wait_us(DIMMER_GATE_PULSE_US);
   gpio_put(APP_DIMMER_GATE_PIN, 0);
-  (void)alarm_id;
-  (void)user_data;
+  shared_dimmer_note_gate_pulse(latency_us > 0 ? (uint32_t)latency_us : 0u);
+  shared_dimmer_note_fire(schedule->half_cycle_sequence, schedule->zero_cross_us,
+                          fire_us);
   return 0;
 }
 
-static void dimmer_zero_crossing_callback(uint gpio, uint32_t events) {
-  const uint32_t now_us = time_us_32();
-  const uint8_t power_percent = dimmer_control_get_power_percent();
-  (void)events;
+static absolute_time_t dimmer_absolute_time_from_us32(uint32_t timestamp_us) {
+  const uint64_t now_us = time_us_64();
+  const int32_t offset_us = (int32_t)(timestamp_us - (uint32_t)now_us);
+
+  return from_us_since_boot((uint64_t)((int64_t)now_us + offset_us));
+}
 
-  if (gpio != APP_DIMMER_ZERO_CROSS_PIN) {
+static void dimmer_schedule_gate_pulse(uint32_t half_cycle_sequence,
+                                       uint32_t zero_cross_us, uint32_t fire_at_us) {
+  dimmer_gate_schedule_t *schedule =
+      &g_gate_schedule[half_cycle_sequence % DIMMER_GATE_SCHEDULE_SLOTS];
+
+  // Firing late into the next half-cycle would latch the triac near full
+  // conduction, so an alarm that can no longer be honoured is dropped.
+  if ((int32_t)(fire_at_us - time_us_32()) < -(int32_t)DIMMER_GATE_LATE_LIMIT_US) {
+    // An edge that arrived while a flash write held core0 was captured by
+    // PIO and is only processed now. Erases only run at 0%, so this is still
+    // a lost pulse; blanked just says what caused it.
+    if (flash_writer_lockout_covers(zero_cross_us)) {
+      shared_dimmer_note_blanked_half_cycle();
+    }
+    shared_dimmer_note_missed_alarm();
+    dimmer_trace_note_missed();
     return;
   }
 
-  if (g_last_zero_cross_us != 0u) {
-    g_zero_cross_period_us = now_us - g_last_zero_cross_us;
+  *schedule = (dimmer_gate_schedule_t){
+      .target_us = fire_at_us,
+      .zero_cross_us = zero_cross_us,
+      .half_cycle_sequence = half_cycle_sequence,
+  };
+  add_alarm_at(dimmer_absolute_time_from_us32(fire_at_us),
+               dimmer_gate_pulse_alarm_callback, schedule, true);
+}
+
+static uint32_t dimmer_phase_delay_us(uint8_t power_percent, float half_cycle_us) {
+  const float usable_us =
+      half_cycle_us - (float)(DIMMER_GATE_PULSE_US + DIMMER_GATE_END_MARGIN_US);
+  float delay_us = half_cycle_us * (float)(100u - power_percent) / 100.0f;
+
+  if (delay_us > usable_us) {
+    delay_us = usable_us;
   }
-  g_last_zero_cross_us = now_us;
+  return delay_us > 0.0f ? (uint32_t)delay_us : 0u;
+}
 
-  if (power_percent > 0u && power_percent < 100u) {
-    const uint32_t delay_us = (uint32_t)(100u - power_percent) * 100u;
-    add_alarm_in_us(delay_us, dimmer_gate_pulse_alarm_callback, NULL, false);
-  } else if (power_percent >= 100u) {
+static void dimmer_zero_cross_process_edge(uint32_t edge_us) {
+  uint32_t zero_cross_us = 0u;
+  uint32_t first_half_cycle_sequence = 0u;
+  float half_cycle_us = 0.0f;
+  uint8_t half_cycles = 1u;
+  uint8_t half_cycle_index = 0u;
+  uint8_t power_percent = 0u;
+
+  if (mains_pll_process_edge(&g_mains_pll, edge_us, &zero_cross_us) ==
+      MAINS_PLL_EDGE_REJECTED) {
+    return;
+  }
+  g_last_zero_cross_us = edge_us;
+  shared_dimmer_note_zero_cross();
+
+  half_cycle_us = mains_pll_half_cycle_us(&g_mains_pll);
+  if (half_cycle_us <= 0.0f) {
+    half_cycle_us = DIMMER_DEFAULT_HALF_CYCLE_US;
+  } else if (g_mains_pll.locked) {
+    // Single-polarity detectors only mark every other zero-cross; once the
+    // loop is locked the missing one is predicted so both halves conduct.
+    half_cycles = g_mains_pll.half_cycles_per_edge;
+  }
+
+  // The command is latched here and nowhere else, so every half-cycle in
+  // this group runs with one value even if the control loop submits mid-way.
+  power_percent = shared_dimmer_commit_half_cycles(zero_cross_us, half_cycles,
+                                                   &first_half_cycle_sequence);
+
+  if (power_percent >= 100u) {
     gpio_put(APP_DIMMER_GATE_PIN, 1);
-  } else {
-    gpio_put(APP_DIMMER_GATE_PIN, 0);
+    return;
+  }
+  gpio_put(APP_DIMMER_GATE_PIN, 0);
+  if (power_percent == 0u) {
+    return;
   }
+
+  for (half_cycle_index = 0u; half_cycle_index < half_cycles; ++half_cycle_index) {
+    const uint32_t half_cycle_start_us =
+        zero_cross_us + (uint32_t)(half_cycle_us * (float)half_cycle_index);
+
+    dimmer_schedule_gate_pulse(first_half_cycle_sequence + half_cycle_index,
+                               half_cycle_start_us,
+                               half_cycle_start_us +
+                                   dimmer_phase_delay_us(power_percent, half_cycle_us));
+  }
+}
+
+static void dimmer_zero_cross_edge_handler(uint32_t edge_us, void *context) {
+  const uint32_t trace_cycles = dimmer_trace_zero_cross_begin(edge_us, time_us_32());
+  (void)context;
+
+  dimmer_zero_cross_process_edge(edge_us);
+  dimmer_trace_zero_cross_end(trace_cycles);
 }
 
 static void dimmer_update_line_feedback(void) {
+  mains_pll_status_t pll_status = {0};
   uint32_t irq_state = save_and_disable_interrupts();
   const uint32_t last_zero_cross_us = g_last_zero_cross_us;
-  const uint32_t period_us = g_zero_cross_period_us;
+  mains_pll_get_status(&g_mains_pll, &pll_status);
   restore_interrupts(irq_state);
 
   const uint32_t now_us = time_us_32();
@@ -104,34 +246,45 @@ static void dimmer_update_line_feedback(void) {
       last_zero_cross_us != 0u &&
       (now_us - last_zero_cross_us) <= APP_LINE_SYNC_TIMEOUT_US;
 
-  float line_frequency_hz = 0.0f;
-  if (line_sync_available && period_us > 0u) {
-    line_frequency_hz = 1000000.0f / (float)period_us;
-    if (line_frequency_hz > DIMMER_FREQUENCY_DOUBLE_EDGE_THRESHOLD_HZ) {
-      line_frequency_hz *= 0.5f;
-    }
-  }
-
-  blower_control_update_line_feedback(line_sync_available, line_frequency_hz);
+  blower_control_update_line_feedback(
+      line_sync_available,
+      line_sync_available && pll_status.tracking ? pll_status.mains_frequency_hz : 0.0f,
+      line_sync_available && pll_status.locked,
+      line_sync_available ? pll_status.phase_error_rms_us : 0.0f);
 }
 
+#endif
+
 void dimmer_task_entry(void *params) {
   TickType_t next_wake_tick = xTaskGetTickCount();
+#if !APP_DIMMER_ON_CORE1
+  zero_cross_capture_config_t zero_cross_config;
+#endif
   (void)params;
 
   blower_control_initialize();
   dimmer_control_set_power_percent(0u);
 
-  gpio_init(APP_DIMMER_ZERO_CROSS_PIN);
-  gpio_set_dir(APP_DIMMER_ZERO_CROSS_PIN, GPIO_IN);
-  gpio_pull_up(APP_DIMMER_ZERO_CROSS_PIN);
+#if !APP_DIMMER_ON_CORE1
+  mains_pll_reset(&g_mains_pll);
+  dimmer_trace_init();
 
   gpio_init(APP_DIMMER_GATE_PIN);
   gpio_set_dir(APP_DIMMER_GATE_PIN, GPIO_OUT);
   gpio_put(APP_DIMMER_GATE_PIN, 0);
 
-  gpio_set_irq_enabled_with_callback(APP_DIMMER_ZERO_CROSS_PIN, GPIO_IRQ_EDGE_RISE,
-                                     true, &dimmer_zero_crossing_callback);
+  zero_cross_config = (zero_cross_capture_config_t){
+      .gpio = APP_DIMMER_ZERO_CROSS_PIN,
+      .pull_up = true,
+      .glitch_filter_us = APP_ZERO_CROSS_GLITCH_FILTER_US,
+      .timestamp_timer = NULL,
+      .handler = dimmer_zero_cross_edge_handler,
+      .handler_context = NULL,
+  };
+  if (!zero_cross_capture_init(&zero_cross_config)) {
+    printf("[DIMMER] zero-cross capture init failed\n");
+  }
+#endif
 
   while (1) {
     blower_metrics_snapshot_t metrics_snapshot = {0};
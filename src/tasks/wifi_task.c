@@ -6,14 +6,29 @@
 #include "lwip/api.h"
 #include "lwip/ip4_addr.h"
 #include "lwip/netif.h"
+#include "lwip/stats.h"
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
 #include "pico/cyw43_arch.h"
+#include "queue.h"
+#include "semphr.h"
 #include "services/blower_control.h"
 #include "services/blower_metrics.h"
+#include "services/blower_test_service.h"
+#include "services/dimmer_control.h"
+#include "services/dimmer_trace.h"
+#include "services/flash_writer.h"
+#include "services/http_request_parser.h"
+#include "services/http_stream_writer.h"
 #include "services/ota_update_service.h"
+#include "services/websocket.h"
+#include "shared_state.h"
 #include "task.h"
+#include "web/http_routes.h"
 #include "web/web_assets.h"
 #include <ctype.h>
 #include <math.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -34,19 +49,28 @@
 #define WIFI_RETRY_DELAY_MS 1000u
 #define HTTP_SERVER_PORT 80u
 
-#define HTTP_REQUEST_LINE_BUFFER_SIZE 256u
-#define HTTP_REQUEST_BUFFER_SIZE 6144u
 #define HTTP_MAX_BODY_SIZE 4096u
-#define HTTP_RESPONSE_PAYLOAD_BUFFER_SIZE 1024u
-#define HTTP_RESPONSE_CHUNK_SIZE 1024u
+#define HTTP_TEST_REPORT_LIST_DEFAULT_LIMIT 10u
+#define HTTP_TEST_REPORT_LIST_BATCH 16u
+#define HTTP_KEEPALIVE_POLL_MS 20u
 
 #define SSE_LOOP_INTERVAL_MS 250u
 #define SSE_FORCE_PUBLISH_INTERVAL_MS 1000u
+#define WS_RECEIVE_POLL_MS 20u
 #define STATUS_FLOAT_TOLERANCE 0.01f
+// Packed status frame sent to WebSocket clients that negotiate the binary
+// subprotocol. Little-endian; the layout is in docs/web_endpoint_mapping.md.
+#define WEB_STATUS_FRAME_VERSION 1u
+#define WEB_STATUS_FRAME_FLOAT_COUNT 14u
+#define WEB_STATUS_FRAME_FIXED_BYTES (18u + 4u * WEB_STATUS_FRAME_FLOAT_COUNT)
+#define WEB_STATUS_FRAME_MAX_BYTES                                             \
+  (WEB_STATUS_FRAME_FIXED_BYTES + 0xFFu + 1u + DEBUG_LOG_TAIL_CHARS)
 
 #define DEBUG_LOG_BUFFER_SIZE 1024u
 #define DEBUG_LOG_TAIL_CHARS 192u
 #define OTA_MAX_DECODED_CHUNK_BYTES 3072u
+// Base64 of a full decoded chunk plus room for the other JSON fields.
+#define OTA_MAX_CHUNK_BODY_SIZE (((OTA_MAX_DECODED_CHUNK_BYTES + 2u) / 3u) * 4u + 128u)
 
 typedef enum {
   HTTP_METHOD_UNKNOWN = 0,
@@ -55,19 +79,113 @@ typedef enum {
   HTTP_METHOD_POST,
 } http_method_t;
 
+// WebSocket subprotocol offered by the client (Sec-WebSocket-Protocol). A
+// client that offers none gets JSON status messages without the header.
+typedef enum {
+  WS_PROTOCOL_NONE = 0,
+  WS_PROTOCOL_JSON,
+  WS_PROTOCOL_BINARY,
+} ws_protocol_t;
+
+static const char *const k_ws_protocol_names[] = {
+    [WS_PROTOCOL_NONE] = NULL,
+    [WS_PROTOCOL_JSON] = "blower.v1.json",
+    [WS_PROTOCOL_BINARY] = "blower.v1.bin",
+};
+
+// Filled by the request parser callbacks. body holds the JSON body of every
+// route except the OTA chunk upload, which is decoded as it streams in.
 typedef struct {
   http_method_t method;
+  http_route_t route;
+  const web_route_t *route_entry;
+  bool keep_alive;
+  bool body_streamed;
   char path[96];
+  char query[64];
   char body[HTTP_MAX_BODY_SIZE + 1u];
   size_t body_length;
+  bool accepts_gzip;
+  char if_none_match[64];
+  bool websocket_upgrade;
+  uint8_t websocket_version;
+  char websocket_key[32];
+  ws_protocol_t websocket_protocol;
 } http_request_t;
 
+// One client connection. The parser reads straight from the received
+// netbufs; the unparsed rest of a netbuf (a pipelined request that arrived
+// with the previous one) stays pending for the next request.
+typedef struct {
+  struct netconn *netconn;
+  struct netbuf *pending;
+  u16_t pending_offset;
+  uint32_t served;
+  bool keep_alive;
+  http_request_parser_t parser;
+} http_connection_t;
+
+typedef struct {
+  int values[4];
+  size_t values_count;
+  bool found_padding;
+  uint8_t *output;
+  size_t capacity;
+  size_t length;
+} base64_stream_t;
+
+typedef enum {
+  HTTP_OTA_CHUNK_SCAN_JSON = 0,
+  HTTP_OTA_CHUNK_SCAN_STRING,
+  HTTP_OTA_CHUNK_SCAN_STRING_ESCAPE,
+  HTTP_OTA_CHUNK_SCAN_DATA,
+  HTTP_OTA_CHUNK_SCAN_DATA_ESCAPE,
+} http_ota_chunk_scan_t;
+
+// POST /api/ota/chunk body, {"offset":N,"data":"<base64>"}, decoded while it
+// arrives: the data string goes through the base64 decoder and the rest of
+// the JSON is kept in fields for the json_extract_* helpers.
+typedef struct {
+  http_ota_chunk_scan_t scan;
+  size_t string_start;
+  bool data_key;
+  bool data_value_next;
+  bool has_data;
+  bool failed;
+  size_t fields_length;
+  char fields[96];
+  base64_stream_t base64;
+  uint8_t decoded[OTA_MAX_DECODED_CHUNK_BYTES];
+} http_ota_chunk_t;
+
+// POST /api/ota/upload: the raw image is the body and goes to the OTA
+// service as it arrives; size, CRC-32 and version come from the headers.
+typedef struct {
+  bool has_crc32;
+  uint32_t crc32;
+  char version[OTA_UPDATE_VERSION_LABEL_MAX_LEN];
+  uint32_t offset;
+  bool begun;
+  ota_update_result_t result;
+} http_ota_upload_t;
+
+// One HTTP worker task. Everything sized by the request limits lives here,
+// statically allocated, so the worker stack only holds the route locals.
+typedef struct {
+  http_connection_t connection;
+  http_request_t request;
+  http_ota_chunk_t ota_chunk;
+  http_ota_upload_t ota_upload;
+} http_worker_t;
+
 typedef struct {
   uint8_t pwm;
   uint8_t led;
   uint8_t relay;
   uint8_t line_sync;
   float frequency_hz;
+  uint8_t pll_locked;
+  float phase_error_us;
   float dp1_pressure_pa;
   float dp1_temperature_c;
   bool dp1_ok;
@@ -84,24 +202,99 @@ typedef struct {
   uint8_t cal_pct;
   float cal_fan_offset;
   float cal_env_offset;
+  uint8_t test_state;
+  uint8_t test_point;
+  uint8_t test_points;
+  uint8_t test_verdict;
+  float test_ach_ref_h1;
+  float test_ach_ci_low_h1;
+  float test_ach_ci_high_h1;
 } web_status_snapshot_t;
 
+typedef enum {
+  SSE_SUBSCRIBER_FREE = 0,
+  SSE_SUBSCRIBER_RESERVED,
+  SSE_SUBSCRIBER_ACTIVE,
+  SSE_SUBSCRIBER_ABORTED,
+} sse_subscriber_state_t;
+
+// A frame still referenced by a subscriber's send queue is pending until the
+// peer has acknowledged the last byte of it (end_seq). frame_due is set until
+// the current frame has been queued: for a new subscriber, or after lwIP ran
+// out of pbufs or segments for it.
+typedef struct {
+  sse_subscriber_state_t state;
+  struct netconn *connection;
+  bool frame_due;
+  uint8_t pending_mask;
+  uint32_t end_seq[APP_SSE_BACKLOG_FRAMES];
+} sse_subscriber_t;
+
+_Static_assert(APP_SSE_BACKLOG_FRAMES >= 2u && APP_SSE_BACKLOG_FRAMES <= 8u,
+               "pending_mask holds one bit per backlog frame");
+
+typedef struct {
+  uint32_t frames;
+  uint32_t deliveries;
+  uint32_t render_us_total;
+  uint32_t render_us_max;
+  uint32_t fanout_us_total;
+  uint32_t fanout_us_max;
+  uint32_t dropped_slow;
+  uint32_t dropped_closed;
+  uint32_t deferred;
+  uint32_t rejected;
+} sse_hub_stats_t;
+
+// Every /events client is served by one task. Each frame is rendered once
+// into a ring slot and queued to all subscribers by reference
+// (NETCONN_NOCOPY), so a client costs a segment and a pbuf, not a task or a
+// copy. A slot is reused APP_SSE_BACKLOG_FRAMES frames later; a client that
+// has not acknowledged it by then is dropped.
+typedef struct {
+  SemaphoreHandle_t mutex;
+  sse_subscriber_t subscribers[APP_SSE_MAX_CLIENTS];
+  volatile uint8_t subscriber_count;
+  uint32_t frame_seq;
+  size_t frame_length[APP_SSE_BACKLOG_FRAMES];
+  char frames[APP_SSE_BACKLOG_FRAMES][APP_SSE_FRAME_BYTES];
+  web_status_snapshot_t last_status;
+  bool has_last_status;
+  uint32_t last_emit_ms;
+  sse_hub_stats_t stats;
+} sse_hub_t;
+
+// GET /ws after the upgrade: telemetry out and commands in, each message
+// numbered by the side that sends it.
 typedef struct {
   struct netconn *connection;
+  ws_protocol_t protocol;
+  websocket_parser_t parser;
   web_status_snapshot_t last_status;
   bool has_last_status;
+  bool status_due;
   uint32_t last_emit_ms;
-} sse_stream_context_t;
+  uint32_t last_poll_ms;
+  uint32_t tx_seq;
+} ws_session_t;
+
+// One WebSocket client at a time. Another one is refused with 503 rather than
+// taking the slot over, so two browsers do not keep evicting each other; the
+// UI falls back to /events, which serves several clients.
+typedef struct {
+  volatile bool active;
+} web_stream_slot_t;
 
-static volatile bool g_sse_active = false;
-static volatile bool g_sse_stop_requested = false;
+static sse_hub_t g_sse_hub;
+static web_stream_slot_t g_ws_slot = {0};
 #if APP_ENABLE_DEBUG_HTTP_ROUTES
 static volatile bool g_debug_logs_enabled = false;
 static volatile uint32_t g_debug_logs_generation = 0u;
 static char g_debug_log_buffer[DEBUG_LOG_BUFFER_SIZE];
 static size_t g_debug_log_length = 0u;
 #endif
-static uint8_t g_ota_decoded_chunk_buffer[OTA_MAX_DECODED_CHUNK_BYTES];
+static http_worker_t g_http_workers[APP_HTTP_WORKER_COUNT];
+static QueueHandle_t g_http_accept_queue = NULL;
 
 static float web_absf(float value) { return value >= 0.0f ? value : -value; }
 
@@ -250,105 +443,80 @@ static void debug_logs_copy_tail(char *out_buffer, size_t out_buffer_size) {
 }
 #endif
 
-static bool json_escape_string(const char *input, char *output,
-                               size_t output_size) {
-  size_t write_index = 0u;
-  size_t read_index = 0u;
-
-  if (input == NULL || output == NULL || output_size == 0u) {
-    return false;
-  }
-
-  while (input[read_index] != '\0') {
-    char ch = input[read_index++];
-    const char *replacement = NULL;
-    char escaped[7];
-    size_t replacement_length = 0u;
-
-    switch (ch) {
-    case '\\':
-      replacement = "\\\\";
-      break;
-    case '"':
-      replacement = "\\\"";
-      break;
-    case '\n':
-      replacement = "\\n";
-      break;
-    case '\r':
-      replacement = "\\r";
-      break;
-    case '\t':
-      replacement = "\\t";
-      break;
-    default:
-      if ((unsigned char)ch < 0x20u) {
-        const int written = snprintf(escaped, sizeof(escaped), "\\u%04x",
-                                     (unsigned char)ch);
-        if (written <= 0 || (size_t)written >= sizeof(escaped)) {
-          return false;
-        }
-        replacement = escaped;
-      }
-      break;
-    }
-
-    if (replacement != NULL) {
-      replacement_length = strlen(replacement);
-      if (write_index + replacement_length >= output_size) {
-        return false;
-      }
-      memcpy(output + write_index, replacement, replacement_length);
-      write_index += replacement_length;
-    } else {
-      if (write_index + 1u >= output_size) {
-        return false;
-      }
-      output[write_index++] = ch;
-    }
-  }
-
-  output[write_index] = '\0';
-  return true;
-}
-
-static void http_send_response(struct netconn *connection, const char *status_line,
-                               const char *content_type, const uint8_t *body,
-                               size_t body_length) {
-  char header[192];
-  size_t offset = 0u;
+// extra_headers is either empty or complete CRLF-terminated header lines.
+static size_t http_format_headers(const http_connection_t *connection, char *buffer,
+                                  size_t buffer_size, const char *status_line,
+                                  const char *content_type, size_t content_length,
+                                  const char *extra_headers) {
   const int header_length = snprintf(
-      header, sizeof(header),
+      buffer, buffer_size,
       "HTTP/1.1 %s\r\n"
       "Content-Type: %s\r\n"
       "Content-Length: %lu\r\n"
-      "Connection: close\r\n"
+      "%s"
+      "Connection: %s\r\n"
       "\r\n",
-      status_line, content_type, (unsigned long)body_length);
+      status_line, content_type, (unsigned long)content_length, extra_headers,
+      connection->keep_alive ? "keep-alive" : "close");
+
+  if (header_length <= 0 || (size_t)header_length >= buffer_size) {
+    return 0u;
+  }
+  return (size_t)header_length;
+}
+
+// Sends the header and the start of the body as one segment, then the rest in
+// MSS-sized writes. With NETCONN_NOCOPY lwIP references the body instead of
+// copying it into its heap, so the bytes must stay valid until the client has
+// acknowledged them; only flash-resident assets qualify.
+static void http_send_body(http_connection_t *connection, const char *status_line,
+                           const char *content_type, const char *extra_headers,
+                           const uint8_t *body, size_t body_length,
+                           uint8_t body_write_flags) {
+  char segment[TCP_MSS];
+  size_t offset = 0u;
+  size_t length = http_format_headers(connection, segment, sizeof(segment), status_line,
+                                      content_type, body_length, extra_headers);
 
-  if (header_length <= 0 || (size_t)header_length >= sizeof(header)) {
+  if (length == 0u) {
+    connection->keep_alive = false;
     return;
   }
 
-  if (netconn_write(connection, header, (size_t)header_length, NETCONN_COPY) !=
-      ERR_OK) {
+  if (body != NULL) {
+    offset = sizeof(segment) - length;
+    if (offset > body_length) {
+      offset = body_length;
+    }
+    memcpy(segment + length, body, offset);
+    length += offset;
+  }
+  if (netconn_write(connection->netconn, segment, length, NETCONN_COPY) != ERR_OK) {
+    connection->keep_alive = false;
     return;
   }
 
   while (body != NULL && offset < body_length) {
     const size_t remaining = body_length - offset;
-    const size_t chunk_size =
-        remaining > HTTP_RESPONSE_CHUNK_SIZE ? HTTP_RESPONSE_CHUNK_SIZE
-                                             : remaining;
-    if (netconn_write(connection, body + offset, chunk_size, NETCONN_COPY) !=
-        ERR_OK) {
+    const size_t chunk_size = remaining > TCP_MSS ? TCP_MSS : remaining;
+
+    if (netconn_write(connection->netconn, body + offset, chunk_size,
+                      body_write_flags) != ERR_OK) {
+      connection->keep_alive = false;
       return;
     }
     offset += chunk_size;
   }
 }
 
-static void http_send_text_response(struct netconn *connection,
+static void http_send_response(http_connection_t *connection, const char *status_line,
+                               const char *content_type, const uint8_t *body,
+                               size_t body_length) {
+  http_send_body(connection, status_line, content_type, "", body, body_length,
+                 NETCONN_COPY);
+}
+
+static void http_send_text_response(http_connection_t *connection,
                                     const char *status_line,
                                     const char *content_type,
                                     const char *body) {
@@ -356,220 +524,321 @@ static void http_send_text_response(struct netconn *connection,
                      (const uint8_t *)body, strlen(body));
 }
 
-static void http_send_headers_only(struct netconn *connection,
+static void http_send_headers_only(http_connection_t *connection,
                                    const char *status_line,
                                    const char *content_type,
-                                   size_t content_length) {
-  char header[192];
-  const int header_length = snprintf(
-      header, sizeof(header),
-      "HTTP/1.1 %s\r\n"
-      "Content-Type: %s\r\n"
-      "Content-Length: %lu\r\n"
-      "Connection: close\r\n"
-      "\r\n",
-      status_line, content_type, (unsigned long)content_length);
-
-  if (header_length <= 0 || (size_t)header_length >= sizeof(header)) {
-    return;
+                                   size_t content_length,
+                                   const char *extra_headers) {
+  char header[320];
+  const size_t header_length =
+      http_format_headers(connection, header, sizeof(header), status_line,
+                          content_type, content_length, extra_headers);
+
+  if (header_length == 0u ||
+      netconn_write(connection->netconn, header, header_length, NETCONN_COPY) !=
+          ERR_OK) {
+    connection->keep_alive = false;
   }
-
-  netconn_write(connection, header, (size_t)header_length, NETCONN_COPY);
 }
 
-static bool http_parse_request_path_and_method(const char *request_data,
-                                               size_t request_length,
-                                               http_method_t *out_method,
-                                               char *out_path,
-                                               size_t out_path_size) {
-  char request_line[HTTP_REQUEST_LINE_BUFFER_SIZE];
-  const char *method_prefix = NULL;
-  char *path_begin = NULL;
-  char *path_end = NULL;
-  char *absolute_path_start = NULL;
-  char *query_separator = NULL;
-  size_t copy_length = request_length;
-  size_t path_length = 0u;
+// 405 with the Allow header listing what the route accepts.
+static void http_send_method_not_allowed(http_connection_t *connection,
+                                         const http_request_t *request) {
+  static const struct {
+    uint8_t bit;
+    const char *name;
+  } k_methods[] = {
+      {WEB_ROUTE_METHOD_GET, "GET"},
+      {WEB_ROUTE_METHOD_HEAD, "HEAD"},
+      {WEB_ROUTE_METHOD_POST, "POST"},
+  };
+  static const char k_body[] = "Method Not Allowed";
+  const uint8_t methods =
+      request->route_entry != NULL ? request->route_entry->methods : 0u;
+  const char *separator = "";
+  char allow[48] = "Allow: ";
+  size_t index = 0u;
 
-  if (request_data == NULL || out_method == NULL || out_path == NULL ||
-      out_path_size == 0u || request_length < 5u) {
-    return false;
+  for (index = 0u; index < sizeof(k_methods) / sizeof(k_methods[0]); ++index) {
+    if ((methods & k_methods[index].bit) != 0u) {
+      strcat(allow, separator);
+      strcat(allow, k_methods[index].name);
+      separator = ", ";
+    }
   }
+  strcat(allow, "\r\n");
 
-  if (copy_length >= sizeof(request_line)) {
-    copy_length = sizeof(request_line) - 1u;
+  if (request->method == HTTP_METHOD_HEAD) {
+    http_send_headers_only(connection, "405 Method Not Allowed", "text/plain",
+                           sizeof(k_body) - 1u, allow);
+    return;
   }
+  http_send_body(connection, "405 Method Not Allowed", "text/plain", allow,
+                 (const uint8_t *)k_body, sizeof(k_body) - 1u, NETCONN_COPY);
+}
 
-  memcpy(request_line, request_data, copy_length);
-  request_line[copy_length] = '\0';
+// If-None-Match uses the weak comparison: W/"x" matches "x"; * matches any.
+static bool http_etag_matches(const char *header_value, const char *etag) {
+  const size_t etag_length = strlen(etag);
+  const char *cursor = header_value;
 
-  if (strncmp(request_line, "GET ", 4) == 0) {
-    *out_method = HTTP_METHOD_GET;
-    method_prefix = "GET ";
-  } else if (strncmp(request_line, "HEAD ", 5) == 0) {
-    *out_method = HTTP_METHOD_HEAD;
-    method_prefix = "HEAD ";
-  } else if (strncmp(request_line, "POST ", 5) == 0) {
-    *out_method = HTTP_METHOD_POST;
-    method_prefix = "POST ";
-  } else {
-    *out_method = HTTP_METHOD_UNKNOWN;
-    return false;
+  while (*cursor != '\0') {
+    while (*cursor == ',' || isspace((unsigned char)*cursor)) {
+      cursor++;
+    }
+    if (*cursor == '*') {
+      return true;
+    }
+    if (strncmp(cursor, "W/", 2u) == 0) {
+      cursor += 2;
+    }
+    if (strncmp(cursor, etag, etag_length) == 0) {
+      return true;
+    }
+    while (*cursor != '\0' && *cursor != ',') {
+      cursor++;
+    }
   }
 
-  path_begin = request_line + strlen(method_prefix);
-  path_end = strchr(path_begin, ' ');
-  if (path_end == NULL || path_end == path_begin) {
-    return false;
+  return false;
+}
+
+// Web assets are served gzip-encoded when the client accepts it, and answered
+// with 304 when the client already holds the same content.
+static void http_send_asset(http_connection_t *connection, const http_request_t *request,
+                            const web_asset_t *asset) {
+  const bool use_gzip = asset->gzip_body != NULL && request->accepts_gzip;
+  const char *etag = use_gzip ? asset->gzip_etag : asset->etag;
+  const uint8_t *body = use_gzip ? asset->gzip_body : asset->body;
+  const size_t body_length = use_gzip ? asset->gzip_length : asset->body_length;
+  char extra_headers[192];
+  const int written = snprintf(
+      extra_headers, sizeof(extra_headers), "ETag: %s\r\nCache-Control: %s\r\n%s%s",
+      etag, asset->cache_control, use_gzip ? "Content-Encoding: gzip\r\n" : "",
+      asset->gzip_body != NULL ? "Vary: Accept-Encoding\r\n" : "");
+
+  if (written <= 0 || (size_t)written >= sizeof(extra_headers)) {
+    connection->keep_alive = false;
+    return;
   }
 
-  path_length = (size_t)(path_end - path_begin);
-  if (path_length >= out_path_size) {
-    path_length = out_path_size - 1u;
+  if (http_etag_matches(request->if_none_match, etag)) {
+    http_send_headers_only(connection, "304 Not Modified", asset->content_type,
+                           body_length, extra_headers);
+  } else if (request->method == HTTP_METHOD_HEAD) {
+    http_send_headers_only(connection, "200 OK", asset->content_type, body_length,
+                           extra_headers);
+  } else {
+    http_send_body(connection, "200 OK", asset->content_type, extra_headers, body,
+                   body_length, APP_HTTP_ASSET_ZERO_COPY ? NETCONN_NOCOPY : NETCONN_COPY);
   }
+}
 
-  memcpy(out_path, path_begin, path_length);
-  out_path[path_length] = '\0';
+// Origin form (/path?query) or, from proxies, absolute form; the path is
+// truncated to fit, the query is split off.
+static bool http_parse_request_target(const char *target, size_t target_length,
+                                      http_request_t *request) {
+  const char *end = target + target_length;
+  const char *query = NULL;
+  size_t path_length = 0u;
+  size_t query_length = 0u;
 
-  if (strncmp(out_path, "http://", 7) == 0 ||
-      strncmp(out_path, "https://", 8) == 0) {
-    absolute_path_start = strstr(out_path, "://");
-    if (absolute_path_start != NULL) {
-      absolute_path_start += 3;
-      absolute_path_start = strchr(absolute_path_start, '/');
-      if (absolute_path_start != NULL) {
-        memmove(out_path, absolute_path_start, strlen(absolute_path_start) + 1u);
-      } else {
-        strcpy(out_path, "/");
-      }
+  if ((target_length > 7u && strncasecmp(target, "http://", 7u) == 0) ||
+      (target_length > 8u && strncasecmp(target, "https://", 8u) == 0)) {
+    const char *authority = (const char *)memchr(target, ':', target_length) + 3;
+
+    target = (const char *)memchr(authority, '/', (size_t)(end - authority));
+    if (target == NULL) {
+      target = end;
     }
   }
 
-  query_separator = strchr(out_path, '?');
-  if (query_separator != NULL) {
-    *query_separator = '\0';
+  query = (const char *)memchr(target, '?', (size_t)(end - target));
+  path_length = (size_t)((query != NULL ? query : end) - target);
+  if (path_length >= sizeof(request->path)) {
+    path_length = sizeof(request->path) - 1u;
+  }
+  memcpy(request->path, target, path_length);
+  request->path[path_length] = '\0';
+  if (request->path[0] == '\0') {
+    strcpy(request->path, "/");
   }
 
-  if (out_path[0] == '\0') {
-    strcpy(out_path, "/");
+  if (query != NULL) {
+    query_length = (size_t)(end - query) - 1u;
+    if (query_length >= sizeof(request->query)) {
+      query_length = sizeof(request->query) - 1u;
+    }
+    memcpy(request->query, query + 1, query_length);
+    request->query[query_length] = '\0';
   }
 
   return true;
 }
 
-static size_t http_extract_content_length(const char *buffer, size_t header_size) {
-  const char *cursor = buffer;
-  const char *end = buffer + header_size;
-
-  while (cursor < end) {
-    const char *line_end = strstr(cursor, "\r\n");
-    size_t line_length = 0u;
+static bool http_parse_hex_uint32(const char *value, size_t length,
+                                  uint32_t *out_value) {
+  uint32_t parsed = 0u;
+  size_t index = 0u;
 
-    if (line_end == NULL || line_end > end) {
-      break;
+  if (length > 2u && value[0] == '0' && (value[1] == 'x' || value[1] == 'X')) {
+    value += 2;
+    length -= 2u;
+  }
+  if (length == 0u || length > 8u) {
+    return false;
+  }
+  for (index = 0u; index < length; ++index) {
+    if (!isxdigit((unsigned char)value[index])) {
+      return false;
     }
+    parsed = (parsed << 4) |
+             (uint32_t)(isdigit((unsigned char)value[index])
+                            ? value[index] - '0'
+                            : (tolower((unsigned char)value[index]) - 'a') + 10);
+  }
 
-    line_length = (size_t)(line_end - cursor);
-    if (line_length == 0u) {
-      break;
-    }
+  *out_value = parsed;
+  return true;
+}
 
-    if (line_length > 15u && strncasecmp(cursor, "Content-Length:", 15u) == 0) {
-      const char *value_start = cursor + 15u;
-      while (value_start < line_end && isspace((unsigned char)*value_start)) {
-        value_start++;
-      }
-      return (size_t)strtoul(value_start, NULL, 10);
-    }
+static bool http_header_name_is(const char *name, size_t name_length,
+                                const char *expected) {
+  return strlen(expected) == name_length &&
+         strncasecmp(name, expected, name_length) == 0;
+}
 
-    cursor = line_end + 2;
+static bool http_header_has_token(const char *value, size_t value_length,
+                                  const char *token) {
+  const size_t token_length = strlen(token);
+  const char *end = value + value_length;
+
+  while (value < end) {
+    while (value < end && (*value == ',' || isspace((unsigned char)*value))) {
+      value++;
+    }
+    if ((size_t)(end - value) >= token_length &&
+        strncasecmp(value, token, token_length) == 0 &&
+        (value + token_length == end || value[token_length] == ',' ||
+         value[token_length] == ';' || isspace((unsigned char)value[token_length]))) {
+      return true;
+    }
+    while (value < end && *value != ',') {
+      value++;
+    }
   }
 
-  return 0u;
+  return false;
 }
 
-static bool http_receive_request(struct netconn *connection, char *request_buffer,
-                                 size_t request_buffer_size, size_t *out_total_size,
-                                 size_t *out_header_size,
-                                 size_t *out_content_length) {
-  size_t total_size = 0u;
-  size_t header_size = 0u;
-  size_t content_length = 0u;
-  bool headers_ready = false;
-  bool request_complete = false;
+// Returns false when the client reset the connection while it was queued:
+// lwIP has already freed the pcb, and only the netconn is left to delete.
+static bool http_connection_open(http_connection_t *connection,
+                                 struct netconn *netconn) {
+  bool open = false;
+
+  connection->netconn = netconn;
+  connection->pending = NULL;
+  connection->pending_offset = 0u;
+  connection->served = 0u;
+  connection->keep_alive = true;
+
+  // Headers and bodies go out in separate writes; with Nagle the second one
+  // would wait for the client's delayed ACK on every reused connection.
+  LOCK_TCPIP_CORE();
+  open = netconn->pcb.tcp != NULL;
+  if (open) {
+    tcp_nagle_disable(netconn->pcb.tcp);
+  }
+  UNLOCK_TCPIP_CORE();
+  return open;
+}
 
-  if (connection == NULL || request_buffer == NULL || out_total_size == NULL ||
-      out_header_size == NULL || out_content_length == NULL ||
-      request_buffer_size < 8u) {
-    return false;
+static void http_connection_release(http_connection_t *connection) {
+  if (connection->pending != NULL) {
+    netbuf_delete(connection->pending);
+    connection->pending = NULL;
   }
+}
 
-  request_buffer[0] = '\0';
-  *out_total_size = 0u;
-  *out_header_size = 0u;
-  *out_content_length = 0u;
+// Waits for the first byte of the next request. The wait runs in short slices
+// so an idle keep-alive connection gives way as soon as a client is queued
+// for a worker, which means every worker is busy.
+static bool http_connection_wait_request(http_connection_t *connection) {
+  uint32_t waited_ms = 0u;
+  bool has_data = connection->pending != NULL;
 
-  while (!request_complete && total_size < (request_buffer_size - 1u)) {
-    struct netbuf *input_buffer = NULL;
-    err_t receive_status = netconn_recv(connection, &input_buffer);
+  netconn_set_recvtimeout(connection->netconn, (int)HTTP_KEEPALIVE_POLL_MS);
+  while (!has_data && waited_ms < APP_HTTP_KEEPALIVE_IDLE_MS) {
+    const err_t status = netconn_recv(connection->netconn, &connection->pending);
 
-    if (receive_status != ERR_OK || input_buffer == NULL) {
+    if (status == ERR_OK && connection->pending != NULL) {
+      connection->pending_offset = 0u;
+      has_data = true;
+      break;
+    }
+    connection->pending = NULL;
+    if (status != ERR_TIMEOUT) {
       break;
     }
 
-    do {
-      char *chunk_data = NULL;
-      u16_t chunk_length = 0u;
-      size_t writable_length = 0u;
+    waited_ms += HTTP_KEEPALIVE_POLL_MS;
+    // A fresh connection keeps waiting for its first request.
+    if (connection->served > 0u && uxQueueMessagesWaiting(g_http_accept_queue) > 0u) {
+      break;
+    }
+  }
+  netconn_set_recvtimeout(connection->netconn, (int)APP_HTTP_REQUEST_TIMEOUT_MS);
 
-      netbuf_data(input_buffer, (void **)&chunk_data, &chunk_length);
-      if (chunk_data == NULL || chunk_length == 0u) {
-        continue;
-      }
+  return has_data;
+}
 
-      writable_length = request_buffer_size - 1u - total_size;
-      if (writable_length == 0u) {
-        break;
-      }
+// Feeds the parser from the received pbufs in place, blocking for a netbuf
+// only when none is pending, until the request is complete.
+static bool http_connection_read_request(http_connection_t *connection) {
+  http_request_parser_t *parser = &connection->parser;
 
-      if ((size_t)chunk_length > writable_length) {
-        chunk_length = (u16_t)writable_length;
-      }
+  while (parser->state != HTTP_REQUEST_PARSER_DONE) {
+    const struct pbuf *segment = NULL;
+    u16_t skip = 0u;
 
-      memcpy(request_buffer + total_size, chunk_data, (size_t)chunk_length);
-      total_size += (size_t)chunk_length;
-      request_buffer[total_size] = '\0';
-
-      if (!headers_ready) {
-        char *header_end = strstr(request_buffer, "\r\n\r\n");
-        if (header_end != NULL) {
-          headers_ready = true;
-          header_size = (size_t)(header_end - request_buffer) + 4u;
-          content_length = http_extract_content_length(request_buffer, header_size);
-
-          if (header_size + content_length > request_buffer_size - 1u) {
-            netbuf_delete(input_buffer);
-            return false;
-          }
-        }
+    if (connection->pending == NULL) {
+      if (netconn_recv(connection->netconn, &connection->pending) != ERR_OK ||
+          connection->pending == NULL) {
+        connection->pending = NULL;
+        return false;
       }
+      connection->pending_offset = 0u;
+    }
+
+    skip = connection->pending_offset;
+    for (segment = connection->pending->p; segment != NULL; segment = segment->next) {
+      size_t available = 0u;
+      size_t consumed = 0u;
 
-      if (headers_ready && total_size >= header_size + content_length) {
-        request_complete = true;
+      if (skip >= segment->len) {
+        skip = (u16_t)(skip - segment->len);
+        continue;
+      }
+      available = (size_t)(segment->len - skip);
+      consumed = http_request_parser_feed(
+          parser, (const uint8_t *)segment->payload + skip, available);
+      connection->pending_offset = (u16_t)(connection->pending_offset + consumed);
+      skip = 0u;
+      if (consumed < available) {
         break;
       }
-    } while (netbuf_next(input_buffer) >= 0);
-
-    netbuf_delete(input_buffer);
-  }
+    }
 
-  if (!headers_ready || total_size < header_size + content_length) {
-    return false;
+    if (parser->state == HTTP_REQUEST_PARSER_ERROR) {
+      return false;
+    }
+    if (connection->pending_offset >= netbuf_len(connection->pending)) {
+      netbuf_delete(connection->pending);
+      connection->pending = NULL;
+    }
   }
 
-  *out_total_size = header_size + content_length;
-  *out_header_size = header_size;
-  *out_content_length = content_length;
   return true;
 }
 
@@ -710,6 +979,117 @@ static bool json_extract_uint32_field(const char *json_body,
   return true;
 }
 
+static bool json_extract_float_field(const char *json_body, const char *field_name,
+                                     float *out_value) {
+  char token[32];
+  const char *field = NULL;
+  const char *colon = NULL;
+  char *end_ptr = NULL;
+  float parsed_value = 0.0f;
+
+  if (json_body == NULL || field_name == NULL || out_value == NULL) {
+    return false;
+  }
+
+  if (snprintf(token, sizeof(token), "\"%s\"", field_name) <= 0) {
+    return false;
+  }
+
+  field = strstr(json_body, token);
+  if (field == NULL) {
+    return false;
+  }
+
+  colon = strchr(field, ':');
+  if (colon == NULL) {
+    return false;
+  }
+
+  colon++;
+  while (*colon != '\0' && isspace((unsigned char)*colon)) {
+    colon++;
+  }
+
+  parsed_value = strtof(colon, &end_ptr);
+  if (end_ptr == colon) {
+    return false;
+  }
+
+  *out_value = parsed_value;
+  return true;
+}
+
+static bool json_extract_float_array_field(const char *json_body,
+                                           const char *field_name,
+                                           float *out_values, uint8_t capacity,
+                                           uint8_t *out_count) {
+  char token[32];
+  const char *field = NULL;
+  const char *cursor = NULL;
+  uint8_t count = 0u;
+
+  if (json_body == NULL || field_name == NULL || out_values == NULL ||
+      out_count == NULL) {
+    return false;
+  }
+
+  if (snprintf(token, sizeof(token), "\"%s\"", field_name) <= 0) {
+    return false;
+  }
+
+  field = strstr(json_body, token);
+  if (field == NULL) {
+    return false;
+  }
+
+  cursor = strchr(field, ':');
+  if (cursor == NULL) {
+    return false;
+  }
+
+  cursor++;
+  while (*cursor != '\0' && isspace((unsigned char)*cursor)) {
+    cursor++;
+  }
+  if (*cursor != '[') {
+    return false;
+  }
+  cursor++;
+
+  while (1) {
+    char *end_ptr = NULL;
+    float parsed_value = 0.0f;
+
+    while (*cursor != '\0' && isspace((unsigned char)*cursor)) {
+      cursor++;
+    }
+    if (*cursor == ']' && count == 0u) {
+      break;
+    }
+
+    parsed_value = strtof(cursor, &end_ptr);
+    if (end_ptr == cursor || count >= capacity) {
+      return false;
+    }
+    out_values[count++] = parsed_value;
+
+    cursor = end_ptr;
+    while (*cursor != '\0' && isspace((unsigned char)*cursor)) {
+      cursor++;
+    }
+    if (*cursor == ']') {
+      break;
+    }
+    if (*cursor != ',') {
+      return false;
+    }
+    cursor++;
+  }
+
+  *out_count = count;
+  return true;
+}
+
 static bool json_extract_string_field(const char *json_body,
                                       const char *field_name, char *out_value,
                                       size_t out_value_size) {
@@ -793,88 +1173,158 @@ static int base64_decode_char(char value) {
   return -1;
 }
 
-static bool base64_decode_payload(const char *input, uint8_t *output,
-                                  size_t output_capacity,
-                                  size_t *out_output_length) {
-  int values[4];
-  size_t output_length = 0u;
-  size_t values_count = 0u;
-  bool found_padding = false;
-  const char *cursor = input;
+static void base64_stream_init(base64_stream_t *stream, uint8_t *output,
+                               size_t capacity) {
+  stream->values_count = 0u;
+  stream->found_padding = false;
+  stream->output = output;
+  stream->capacity = capacity;
+  stream->length = 0u;
+}
 
-  if (input == NULL || output == NULL || out_output_length == NULL) {
+static bool base64_stream_put(base64_stream_t *stream, uint8_t value) {
+  if (stream->length >= stream->capacity) {
     return false;
   }
+  stream->output[stream->length++] = value;
+  return true;
+}
 
-  while (*cursor != '\0') {
-    const int decoded = base64_decode_char(*cursor++);
-    if (decoded < -1) {
-      found_padding = true;
-    }
-    if (decoded == -1) {
-      if (!isspace((unsigned char)cursor[-1])) {
-        return false;
-      }
-      continue;
-    }
-    if (found_padding && decoded >= 0) {
-      return false;
-    }
-
-    values[values_count++] = decoded;
-    if (values_count < 4u) {
-      continue;
-    }
+// Decodes one character; whitespace is skipped and '=' padding may only end
+// the input.
+static bool base64_stream_feed(base64_stream_t *stream, char character) {
+  const int decoded = base64_decode_char(character);
+  int *values = stream->values;
 
-    if (values[0] < 0 || values[1] < 0) {
-      return false;
-    }
-    if (output_length + 1u > output_capacity) {
-      return false;
-    }
-    output[output_length++] =
-        (uint8_t)((values[0] << 2) | ((values[1] & 0x30) >> 4));
+  if (decoded < -1) {
+    stream->found_padding = true;
+  }
+  if (decoded == -1) {
+    return isspace((unsigned char)character) != 0;
+  }
+  if (stream->found_padding && decoded >= 0) {
+    return false;
+  }
 
-    if (values[2] == -2) {
-      if (values[3] != -2) {
-        return false;
-      }
-    } else {
-      if (values[2] < 0) {
-        return false;
+  values[stream->values_count++] = decoded;
+  if (stream->values_count < 4u) {
+    return true;
+  }
+  stream->values_count = 0u;
+
+  if (values[0] < 0 || values[1] < 0 ||
+      !base64_stream_put(stream,
+                         (uint8_t)((values[0] << 2) | ((values[1] & 0x30) >> 4)))) {
+    return false;
+  }
+  if (values[2] == -2) {
+    return values[3] == -2;
+  }
+  if (values[2] < 0 ||
+      !base64_stream_put(stream, (uint8_t)(((values[1] & 0x0f) << 4) |
+                                           ((values[2] & 0x3c) >> 2)))) {
+    return false;
+  }
+  if (values[3] == -2) {
+    return true;
+  }
+  return values[3] >= 0 &&
+         base64_stream_put(stream, (uint8_t)(((values[2] & 0x03) << 6) | values[3]));
+}
+
+static bool base64_stream_finish(const base64_stream_t *stream) {
+  return stream->values_count == 0u;
+}
+
+static void http_ota_chunk_begin(http_ota_chunk_t *chunk) {
+  chunk->scan = HTTP_OTA_CHUNK_SCAN_JSON;
+  chunk->string_start = 0u;
+  chunk->data_key = false;
+  chunk->data_value_next = false;
+  chunk->has_data = false;
+  chunk->failed = false;
+  chunk->fields_length = 0u;
+  chunk->fields[0] = '\0';
+  base64_stream_init(&chunk->base64, chunk->decoded, sizeof(chunk->decoded));
+}
+
+static bool http_ota_chunk_keep(http_ota_chunk_t *chunk, char character) {
+  if (chunk->fields_length + 1u >= sizeof(chunk->fields)) {
+    return false;
+  }
+  chunk->fields[chunk->fields_length++] = character;
+  chunk->fields[chunk->fields_length] = '\0';
+  return true;
+}
+
+static bool http_ota_chunk_scan(http_ota_chunk_t *chunk, char character) {
+  switch (chunk->scan) {
+    case HTTP_OTA_CHUNK_SCAN_DATA:
+      if (character == '"') {
+        chunk->scan = HTTP_OTA_CHUNK_SCAN_JSON;
+        return http_ota_chunk_keep(chunk, character);
       }
-      if (output_length + 1u > output_capacity) {
-        return false;
+      if (character == '\\') {
+        chunk->scan = HTTP_OTA_CHUNK_SCAN_DATA_ESCAPE;
+        return true;
       }
-      output[output_length++] =
-          (uint8_t)(((values[1] & 0x0f) << 4) | ((values[2] & 0x3c) >> 2));
-
-      if (values[3] != -2) {
-        if (values[3] < 0) {
-          return false;
-        }
-        if (output_length + 1u > output_capacity) {
-          return false;
-        }
-        output[output_length++] =
-            (uint8_t)(((values[2] & 0x03) << 6) | values[3]);
+      return base64_stream_feed(&chunk->base64, character);
+    case HTTP_OTA_CHUNK_SCAN_DATA_ESCAPE:
+      // Only "\/" can appear in base64.
+      chunk->scan = HTTP_OTA_CHUNK_SCAN_DATA;
+      return base64_stream_feed(&chunk->base64, character);
+    case HTTP_OTA_CHUNK_SCAN_STRING:
+      if (character == '\\') {
+        chunk->scan = HTTP_OTA_CHUNK_SCAN_STRING_ESCAPE;
+      } else if (character == '"') {
+        chunk->scan = HTTP_OTA_CHUNK_SCAN_JSON;
+        chunk->data_key = chunk->fields_length - chunk->string_start == 4u &&
+                          memcmp(chunk->fields + chunk->string_start, "data", 4u) == 0;
       }
-    }
+      return http_ota_chunk_keep(chunk, character);
+    case HTTP_OTA_CHUNK_SCAN_STRING_ESCAPE:
+      chunk->scan = HTTP_OTA_CHUNK_SCAN_STRING;
+      return http_ota_chunk_keep(chunk, character);
+    case HTTP_OTA_CHUNK_SCAN_JSON:
+    default:
+      break;
+  }
 
-    values_count = 0u;
+  if (isspace((unsigned char)character)) {
+    return true;
   }
+  if (character == '"' && chunk->data_value_next) {
+    chunk->scan = HTTP_OTA_CHUNK_SCAN_DATA;
+    chunk->has_data = true;
+  } else if (character == '"') {
+    chunk->scan = HTTP_OTA_CHUNK_SCAN_STRING;
+    chunk->string_start = chunk->fields_length + 1u;
+  }
+  chunk->data_value_next = character == ':' && chunk->data_key;
+  chunk->data_key = false;
+  return http_ota_chunk_keep(chunk, character);
+}
 
-  if (values_count != 0u) {
-    return false;
+// A malformed chunk is remembered rather than failing the parse, so the body
+// is still consumed and the route can answer with the reason.
+static void http_ota_chunk_feed(http_ota_chunk_t *chunk, const uint8_t *data,
+                                size_t length) {
+  size_t index = 0u;
+
+  for (index = 0u; index < length && !chunk->failed; ++index) {
+    chunk->failed = !http_ota_chunk_scan(chunk, (char)data[index]);
   }
+}
 
-  *out_output_length = output_length;
-  return true;
+static bool http_ota_chunk_finish(const http_ota_chunk_t *chunk) {
+  return !chunk->failed && chunk->has_data &&
+         chunk->scan == HTTP_OTA_CHUNK_SCAN_JSON && base64_stream_finish(&chunk->base64);
 }
 
 static bool web_collect_status_snapshot(web_status_snapshot_t *out_snapshot) {
   blower_control_snapshot_t control_snapshot = {0};
   blower_metrics_snapshot_t metrics_snapshot = {0};
+  blower_test_runtime_status_t test_runtime = {0};
   const bool has_metrics = blower_metrics_service_get_snapshot(&metrics_snapshot);
 
   if (out_snapshot == NULL) {
@@ -882,6 +1332,7 @@ static bool web_collect_status_snapshot(web_status_snapshot_t *out_snapshot) {
   }
 
   blower_control_get_snapshot(&control_snapshot);
+  blower_test_service_get_runtime(&test_runtime);
 
   *out_snapshot = (web_status_snapshot_t){
       .pwm = control_snapshot.output_pwm_percent,
@@ -889,6 +1340,8 @@ static bool web_collect_status_snapshot(web_status_snapshot_t *out_snapshot) {
       .relay = control_snapshot.relay_enabled ? 1u : 0u,
       .line_sync = control_snapshot.line_sync ? 1u : 0u,
       .frequency_hz = control_snapshot.line_frequency_hz,
+      .pll_locked = control_snapshot.line_pll_locked ? 1u : 0u,
+      .phase_error_us = control_snapshot.line_phase_error_us,
       .dp1_pressure_pa = has_metrics ? metrics_snapshot.fan_pressure_pa : 0.0f,
       .dp1_temperature_c = has_metrics ? metrics_snapshot.fan_temperature_c : 0.0f,
       .dp1_ok = has_metrics && metrics_snapshot.fan_sample_valid,
@@ -907,6 +1360,13 @@ static bool web_collect_status_snapshot(web_status_snapshot_t *out_snapshot) {
       .cal_pct = has_metrics ? metrics_snapshot.calibration_progress_pct : 0u,
       .cal_fan_offset = has_metrics ? metrics_snapshot.calibration_fan_offset : 0.0f,
       .cal_env_offset = has_metrics ? metrics_snapshot.calibration_envelope_offset : 0.0f,
+      .test_state = (uint8_t)test_runtime.state,
+      .test_point = test_runtime.current_point_index,
+      .test_points = test_runtime.total_points,
+      .test_verdict = (uint8_t)test_runtime.provisional_verdict,
+      .test_ach_ref_h1 = test_runtime.provisional_ach_ref_h1,
+      .test_ach_ci_low_h1 = test_runtime.provisional_ach_ci_low_h1,
+      .test_ach_ci_high_h1 = test_runtime.provisional_ach_ci_high_h1,
   };
 
   if (has_metrics && metrics_snapshot.fan_sample_valid) {
@@ -939,9 +1399,14 @@ static bool web_status_changed(const web_status_snapshot_t *current,
 
   if (current->pwm != last->pwm || current->led != last->led ||
       current->relay != last->relay || current->line_sync != last->line_sync ||
+      current->pll_locked != last->pll_locked ||
       current->dp1_ok != last->dp1_ok || current->dp2_ok != last->dp2_ok ||
       current->cal_state != last->cal_state ||
-      current->cal_pct != last->cal_pct) {
+      current->cal_pct != last->cal_pct ||
+      current->test_state != last->test_state ||
+      current->test_point != last->test_point ||
+      current->test_verdict != last->test_verdict ||
+      current->test_ach_ref_h1 != last->test_ach_ref_h1) {
     return true;
   }
 
@@ -988,149 +1453,201 @@ static inline float safe_json_float(float v) {
   return isfinite(v) ? v : 0.0f;
 }
 
-static int web_status_json_write_common(const web_status_snapshot_t *status,
-                                        char *payload, size_t payload_size,
-                                        bool logs_enabled,
-                                        const char *escaped_logs) {
-  const float frequency     = safe_json_float(status->frequency_hz);
-  const float dp1_p         = safe_json_float(status->dp1_pressure_pa);
-  const float dp1_t         = safe_json_float(status->dp1_temperature_c);
-  const float dp2_p         = safe_json_float(status->dp2_pressure_pa);
-  const float dp2_t         = safe_json_float(status->dp2_temperature_c);
-  const float wind_ms       = safe_json_float(status->fan_wind_speed_ms);
-  const float wind_kmh      = safe_json_float(status->fan_wind_speed_kmh);
-  const float flow          = safe_json_float(status->fan_flow_m3h);
-  const float target_pa     = safe_json_float(status->target_pressure_pa);
-  const float cal_fan       = safe_json_float(status->cal_fan_offset);
-  const float cal_env       = safe_json_float(status->cal_env_offset);
+static bool http_begin_stream(http_stream_writer_t *stream,
+                              http_connection_t *connection,
+                              const http_request_t *request, const char *content_type) {
+  return http_stream_begin_response(stream, connection->netconn, "200 OK", content_type,
+                                    request->method == HTTP_METHOD_HEAD,
+                                    connection->keep_alive);
+}
 
-  if (logs_enabled) {
-    return snprintf(
-        payload, payload_size,
-        "{\"fw\":\"" APP_FIRMWARE_VERSION "\","
-        "\"pwm\":%u,\"led\":%u,\"relay\":%u,\"line_sync\":%u,"
-        "\"input\":%u,\"frequency\":%.1f,\"dp1_pressure\":%.3f,"
-        "\"dp1_temperature\":%.3f,\"dp1_ok\":%s,\"dp2_pressure\":%.3f,"
-        "\"dp2_temperature\":%.3f,\"dp2_ok\":%s,\"dp_pressure\":%.3f,"
-        "\"dp_temperature\":%.3f,\"fan_wind_speed_ms\":%.2f,"
-        "\"fan_wind_speed_kmh\":%.2f,\"fan_flow_m3h\":%.3f,"
-        "\"target_pressure_pa\":%.2f,\"sample_sequence\":%lu,"
-        "\"cal\":%u,\"cal_pct\":%u,"
-        "\"cal_fan\":%.3f,\"cal_env\":%.3f,"
-        "\"logs_enabled\":true,\"logs\":\"%s\"}",
-        status->pwm, status->led, status->relay, status->line_sync,
-        status->line_sync, frequency, dp1_p,
-        dp1_t, status->dp1_ok ? "true" : "false",
-        dp2_p, dp2_t,
-        status->dp2_ok ? "true" : "false", dp1_p,
-        dp1_t, wind_ms,
-        wind_kmh, flow,
-        target_pa, (unsigned long)status->sample_sequence,
-        (unsigned)status->cal_state, (unsigned)status->cal_pct,
-        cal_fan, cal_env,
-        escaped_logs != NULL ? escaped_logs : "");
-  }
-
-  return snprintf(
-      payload, payload_size,
-      "{\"fw\":\"" APP_FIRMWARE_VERSION "\","
-      "\"pwm\":%u,\"led\":%u,\"relay\":%u,\"line_sync\":%u,\"input\":%u,"
-      "\"frequency\":%.1f,\"dp1_pressure\":%.3f,\"dp1_temperature\":%.3f,"
-      "\"dp1_ok\":%s,\"dp2_pressure\":%.3f,\"dp2_temperature\":%.3f,"
-      "\"dp2_ok\":%s,\"dp_pressure\":%.3f,\"dp_temperature\":%.3f,"
-      "\"fan_wind_speed_ms\":%.2f,\"fan_wind_speed_kmh\":%.2f,"
-      "\"fan_flow_m3h\":%.3f,\"target_pressure_pa\":%.2f,"
-      "\"sample_sequence\":%lu,"
-      "\"cal\":%u,\"cal_pct\":%u,"
-      "\"cal_fan\":%.3f,\"cal_env\":%.3f,"
-      "\"logs_enabled\":false}",
-      status->pwm, status->led, status->relay, status->line_sync,
-      status->line_sync, frequency, dp1_p,
-      dp1_t, status->dp1_ok ? "true" : "false",
-      dp2_p, dp2_t,
-      status->dp2_ok ? "true" : "false", dp1_p,
-      dp1_t, wind_ms,
-      wind_kmh, flow,
-      target_pa, (unsigned long)status->sample_sequence,
-      (unsigned)status->cal_state, (unsigned)status->cal_pct,
-      cal_fan, cal_env);
-}
-
-static bool web_format_status_json(const web_status_snapshot_t *status,
-                                   char *payload, size_t payload_size) {
-  bool logs_enabled = debug_logs_enabled_get();
-  int written = 0;
+static bool http_begin_json_stream(http_stream_writer_t *stream,
+                                   http_connection_t *connection,
+                                   const http_request_t *request) {
+  return http_begin_stream(stream, connection, request, "application/json");
+}
 
-  if (status == NULL || payload == NULL || payload_size == 0u) {
-    return false;
+// A body that did not complete leaves the client waiting for the terminating
+// chunk, so the connection cannot carry another response.
+static void http_end_stream(http_connection_t *connection, http_stream_writer_t *stream,
+                            bool body_ok) {
+  if (!body_ok || !http_stream_end(stream)) {
+    connection->keep_alive = false;
   }
+}
+
+static bool web_write_status_json(http_stream_writer_t *stream,
+                                  const web_status_snapshot_t *status) {
+  bool logs_enabled = debug_logs_enabled_get();
 
 #if !APP_ENABLE_DEBUG_HTTP_ROUTES
   logs_enabled = false;
 #endif
 
+  if (!http_stream_printf(
+          stream,
+          "{\"fw\":\"" APP_FIRMWARE_VERSION "\","
+          "\"pwm\":%u,\"led\":%u,\"relay\":%u,\"line_sync\":%u,\"input\":%u,"
+          "\"frequency\":%.1f,\"pll_locked\":%u,\"phase_error_us\":%.1f,"
+          "\"dp1_pressure\":%.3f,\"dp1_temperature\":%.3f,"
+          "\"dp1_ok\":%s,\"dp2_pressure\":%.3f,\"dp2_temperature\":%.3f,"
+          "\"dp2_ok\":%s,\"dp_pressure\":%.3f,\"dp_temperature\":%.3f,"
+          "\"fan_wind_speed_ms\":%.2f,\"fan_wind_speed_kmh\":%.2f,"
+          "\"fan_flow_m3h\":%.3f,\"target_pressure_pa\":%.2f,"
+          "\"sample_sequence\":%lu,"
+          "\"cal\":%u,\"cal_pct\":%u,"
+          "\"cal_fan\":%.3f,\"cal_env\":%.3f,"
+          "\"test_state\":\"%s\",\"test_point\":%u,\"test_points\":%u,"
+          "\"test_ach\":%.3f,\"test_ach_ci\":[%.3f,%.3f],\"test_verdict\":\"%s\",",
+          status->pwm, status->led, status->relay, status->line_sync,
+          status->line_sync, safe_json_float(status->frequency_hz),
+          (unsigned)status->pll_locked, safe_json_float(status->phase_error_us),
+          safe_json_float(status->dp1_pressure_pa),
+          safe_json_float(status->dp1_temperature_c), status->dp1_ok ? "true" : "false",
+          safe_json_float(status->dp2_pressure_pa),
+          safe_json_float(status->dp2_temperature_c), status->dp2_ok ? "true" : "false",
+          safe_json_float(status->dp1_pressure_pa),
+          safe_json_float(status->dp1_temperature_c),
+          safe_json_float(status->fan_wind_speed_ms),
+          safe_json_float(status->fan_wind_speed_kmh),
+          safe_json_float(status->fan_flow_m3h),
+          safe_json_float(status->target_pressure_pa),
+          (unsigned long)status->sample_sequence, (unsigned)status->cal_state,
+          (unsigned)status->cal_pct, safe_json_float(status->cal_fan_offset),
+          safe_json_float(status->cal_env_offset),
+          blower_test_state_name((blower_test_state_t)status->test_state),
+          (unsigned)status->test_point, (unsigned)status->test_points,
+          safe_json_float(status->test_ach_ref_h1),
+          safe_json_float(status->test_ach_ci_low_h1),
+          safe_json_float(status->test_ach_ci_high_h1),
+          blower_test_verdict_name((blower_test_verdict_t)status->test_verdict))) {
+    return false;
+  }
+
   if (!logs_enabled) {
-    written = web_status_json_write_common(status, payload, payload_size, false,
-                                           NULL);
-    return written > 0 && (size_t)written < payload_size;
+    return http_stream_puts(stream, "\"logs_enabled\":false}");
   }
 
   {
     char logs_tail[DEBUG_LOG_TAIL_CHARS + 1u];
-    char escaped_logs[(DEBUG_LOG_TAIL_CHARS * 2u) + 1u];
-    size_t escaped_length = 0u;
 
     debug_logs_copy_tail(logs_tail, sizeof(logs_tail));
-    if (!json_escape_string(logs_tail, escaped_logs, sizeof(escaped_logs))) {
-      return false;
-    }
-
-    escaped_length = strlen(escaped_logs);
-    while (1) {
-      escaped_logs[escaped_length] = '\0';
-      written = web_status_json_write_common(status, payload, payload_size, true,
-                                             escaped_logs);
-      if (written > 0 && (size_t)written < payload_size) {
-        return true;
-      }
+    return http_stream_puts(stream, "\"logs_enabled\":true,\"logs\":") &&
+           http_stream_json_string(stream, logs_tail) && http_stream_puts(stream, "}");
+  }
+}
 
-      if (escaped_length == 0u) {
-        break;
-      }
+enum {
+  WEB_STATUS_FLAG_LED = 1u << 0,
+  WEB_STATUS_FLAG_RELAY = 1u << 1,
+  WEB_STATUS_FLAG_LINE_SYNC = 1u << 2,
+  WEB_STATUS_FLAG_PLL_LOCKED = 1u << 3,
+  WEB_STATUS_FLAG_DP1_OK = 1u << 4,
+  WEB_STATUS_FLAG_DP2_OK = 1u << 5,
+  WEB_STATUS_FLAG_LOGS_ENABLED = 1u << 6,
+};
+
+_Static_assert(sizeof(APP_FIRMWARE_VERSION) - 1u <= 0xFFu,
+               "firmware version length must fit one byte");
+_Static_assert(DEBUG_LOG_TAIL_CHARS <= 0xFFu, "logs tail length must fit one byte");
+
+static uint8_t *web_put_u32(uint8_t *out, uint32_t value) {
+  out[0] = (uint8_t)value;
+  out[1] = (uint8_t)(value >> 8);
+  out[2] = (uint8_t)(value >> 16);
+  out[3] = (uint8_t)(value >> 24);
+  return out + 4;
+}
 
-      escaped_length /= 2u;
-    }
-  }
+static uint8_t *web_put_f32(uint8_t *out, float value) {
+  uint32_t bits = 0u;
 
-  written = web_status_json_write_common(status, payload, payload_size, true, "");
-  return written > 0 && (size_t)written < payload_size;
+  value = safe_json_float(value);
+  memcpy(&bits, &value, sizeof(bits));
+  return web_put_u32(out, bits);
 }
 
-static bool sse_write_event(struct netconn *connection, const char *json_payload) {
-  static const char k_prefix[] = "data:";
-  static const char k_suffix[] = "\n\n";
+// Same content as web_write_status_json() without the field names or the
+// duplicated fields (dp_*, input, fan_wind_speed_kmh), which the decoder
+// derives. Returns the frame length, 0 when it does not fit.
+static size_t web_write_status_frame(uint8_t *out, size_t capacity, uint32_t seq,
+                                     const web_status_snapshot_t *status) {
+  static const char k_firmware_version[] = APP_FIRMWARE_VERSION;
+  const size_t version_length = sizeof(k_firmware_version) - 1u;
+  const float values[WEB_STATUS_FRAME_FLOAT_COUNT] = {
+      status->frequency_hz,      status->phase_error_us,     status->dp1_pressure_pa,
+      status->dp1_temperature_c, status->dp2_pressure_pa,    status->dp2_temperature_c,
+      status->fan_wind_speed_ms, status->fan_flow_m3h,       status->target_pressure_pa,
+      status->cal_fan_offset,    status->cal_env_offset,     status->test_ach_ref_h1,
+      status->test_ach_ci_low_h1, status->test_ach_ci_high_h1,
+  };
+  char logs_tail[DEBUG_LOG_TAIL_CHARS + 1u];
+  size_t logs_length = 0u;
+  bool logs_enabled = debug_logs_enabled_get();
+  uint8_t *cursor = out;
+  size_t index = 0u;
+
+#if !APP_ENABLE_DEBUG_HTTP_ROUTES
+  logs_enabled = false;
+#endif
 
-  if (connection == NULL || json_payload == NULL) {
-    return false;
+  if (logs_enabled) {
+    debug_logs_copy_tail(logs_tail, sizeof(logs_tail));
+    logs_length = strlen(logs_tail);
+  }
+  if (capacity < WEB_STATUS_FRAME_FIXED_BYTES + version_length +
+                     (logs_enabled ? 1u + logs_length : 0u)) {
+    return 0u;
+  }
+
+  *cursor++ = WEB_STATUS_FRAME_VERSION;
+  *cursor++ = (uint8_t)((status->led != 0u ? WEB_STATUS_FLAG_LED : 0u) |
+                        (status->relay != 0u ? WEB_STATUS_FLAG_RELAY : 0u) |
+                        (status->line_sync != 0u ? WEB_STATUS_FLAG_LINE_SYNC : 0u) |
+                        (status->pll_locked != 0u ? WEB_STATUS_FLAG_PLL_LOCKED : 0u) |
+                        (status->dp1_ok ? WEB_STATUS_FLAG_DP1_OK : 0u) |
+                        (status->dp2_ok ? WEB_STATUS_FLAG_DP2_OK : 0u) |
+                        (logs_enabled ? WEB_STATUS_FLAG_LOGS_ENABLED : 0u));
+  *cursor++ = status->pwm;
+  *cursor++ = status->cal_state;
+  *cursor++ = status->cal_pct;
+  *cursor++ = status->test_state;
+  *cursor++ = status->test_point;
+  *cursor++ = status->test_points;
+  *cursor++ = status->test_verdict;
+  *cursor++ = (uint8_t)version_length;
+  cursor = web_put_u32(cursor, seq);
+  cursor = web_put_u32(cursor, status->sample_sequence);
+  for (index = 0u; index < WEB_STATUS_FRAME_FLOAT_COUNT; ++index) {
+    cursor = web_put_f32(cursor, values[index]);
+  }
+  memcpy(cursor, k_firmware_version, version_length);
+  cursor += version_length;
+  if (logs_enabled) {
+    *cursor++ = (uint8_t)logs_length;
+    memcpy(cursor, logs_tail, logs_length);
+    cursor += logs_length;
   }
 
-  if (netconn_write(connection, k_prefix, sizeof(k_prefix) - 1u, NETCONN_COPY) !=
-      ERR_OK) {
-    return false;
-  }
-  if (netconn_write(connection, json_payload, strlen(json_payload), NETCONN_COPY) !=
-      ERR_OK) {
-    return false;
-  }
-  if (netconn_write(connection, k_suffix, sizeof(k_suffix) - 1u, NETCONN_COPY) !=
-      ERR_OK) {
-    return false;
-  }
+  return (size_t)(cursor - out);
+}
 
-  return true;
+static bool web_stream_slot_claim(web_stream_slot_t *slot) {
+  bool claimed = false;
+
+  // Workers run concurrently, so taking the slot must be atomic.
+  taskENTER_CRITICAL();
+  claimed = !slot->active;
+  slot->active = true;
+  taskEXIT_CRITICAL();
+  return claimed;
 }
 
-static void http_send_sse_headers(struct netconn *connection) {
+static void web_stream_slot_release(web_stream_slot_t *slot) {
+  slot->active = false;
+}
+
+static bool http_send_sse_headers(struct netconn *connection) {
   static const char k_sse_headers[] =
       "HTTP/1.1 200 OK\r\n"
       "Content-Type: text/event-stream\r\n"
@@ -1138,260 +1655,1265 @@ static void http_send_sse_headers(struct netconn *connection) {
       "Connection: keep-alive\r\n"
       "X-Accel-Buffering: no\r\n"
       "\r\n";
-  netconn_write(connection, k_sse_headers, sizeof(k_sse_headers) - 1u,
-                NETCONN_COPY);
+  return netconn_write(connection, k_sse_headers, sizeof(k_sse_headers) - 1u,
+                       NETCONN_NOCOPY) == ERR_OK;
+}
+
+static uint8_t sse_hub_slot(uint32_t frame_seq) {
+  return (uint8_t)(frame_seq % APP_SSE_BACKLOG_FRAMES);
+}
+
+// Called with the core locked. Aborting discards whatever is still queued, so
+// no segment keeps pointing into a ring slot that is about to be reused.
+static void sse_hub_abort_locked(sse_subscriber_t *subscriber, bool slow) {
+  if (subscriber->connection->pcb.tcp != NULL) {
+    tcp_abort(subscriber->connection->pcb.tcp);
+  }
+  subscriber->state = SSE_SUBSCRIBER_ABORTED;
+  if (slow) {
+    g_sse_hub.stats.dropped_slow += 1u;
+  } else {
+    g_sse_hub.stats.dropped_closed += 1u;
+  }
 }
 
-static void sse_stream_task(void *params) {
-  sse_stream_context_t *context = (sse_stream_context_t *)params;
-  struct netconn *connection = NULL;
-  char json_payload[HTTP_RESPONSE_PAYLOAD_BUFFER_SIZE];
-  const char *close_reason = "stop_requested";
-  uint32_t sent_events = 0u;
+// Frees the subscribers aborted by sse_hub_abort_locked(); netconn_delete()
+// cannot run with the core locked.
+static void sse_hub_release_aborted(void) {
+  size_t index = 0u;
 
-  if (context == NULL) {
-    printf("[SSE] close reason=context_null\n");
-    g_sse_active = false;
-    vTaskDelete(NULL);
-    return;
+  for (index = 0u; index < APP_SSE_MAX_CLIENTS; ++index) {
+    sse_subscriber_t *subscriber = &g_sse_hub.subscribers[index];
+
+    if (subscriber->state != SSE_SUBSCRIBER_ABORTED) {
+      continue;
+    }
+    netconn_delete(subscriber->connection);
+    *subscriber = (sse_subscriber_t){0};
+    g_sse_hub.subscriber_count -= 1u;
   }
+}
 
-  connection = context->connection;
-  if (connection == NULL) {
-    printf("[SSE] close reason=connection_null\n");
-    g_sse_active = false;
-    vPortFree(context);
-    vTaskDelete(NULL);
+// Retires the frames each subscriber has acknowledged and drops the ones whose
+// peer went away. A subscriber still holding reuse_slot (when one is about to
+// be overwritten) is too slow and dropped as well.
+static void sse_hub_sweep(int reuse_slot) {
+  size_t index = 0u;
+  bool aborted = false;
+
+  LOCK_TCPIP_CORE();
+  for (index = 0u; index < APP_SSE_MAX_CLIENTS; ++index) {
+    sse_subscriber_t *subscriber = &g_sse_hub.subscribers[index];
+    const struct tcp_pcb *pcb = NULL;
+    uint8_t slot = 0u;
+
+    if (subscriber->state != SSE_SUBSCRIBER_ACTIVE) {
+      continue;
+    }
+    pcb = subscriber->connection->pcb.tcp;
+    if (pcb == NULL || pcb->state != ESTABLISHED) {
+      sse_hub_abort_locked(subscriber, false);
+      aborted = true;
+      continue;
+    }
+    for (slot = 0u; slot < APP_SSE_BACKLOG_FRAMES; ++slot) {
+      if ((subscriber->pending_mask & (1u << slot)) != 0u &&
+          (int32_t)(pcb->lastack - subscriber->end_seq[slot]) >= 0) {
+        subscriber->pending_mask &= (uint8_t)~(1u << slot);
+      }
+    }
+    if (reuse_slot >= 0 && (subscriber->pending_mask & (1u << reuse_slot)) != 0u) {
+      sse_hub_abort_locked(subscriber, true);
+      aborted = true;
+    }
+  }
+  UNLOCK_TCPIP_CORE();
+
+  if (aborted) {
+    sse_hub_release_aborted();
+  }
+}
+
+static bool sse_hub_render(const web_status_snapshot_t *status) {
+  const uint32_t frame_seq = g_sse_hub.frame_seq + 1u;
+  const uint8_t slot = sse_hub_slot(frame_seq);
+  http_stream_writer_t stream;
+  uint32_t start_us = 0u;
+  uint32_t elapsed_us = 0u;
+
+  sse_hub_sweep(slot);
+  start_us = time_us_32();
+  http_stream_begin_memory(&stream, g_sse_hub.frames[slot], APP_SSE_FRAME_BYTES);
+  if (!http_stream_puts(&stream, "data:") || !web_write_status_json(&stream, status) ||
+      !http_stream_puts(&stream, "\n\n") || !http_stream_end(&stream)) {
+    debug_logs_append("SSE frame too large");
+    return false;
+  }
+
+  g_sse_hub.frame_length[slot] = stream.total_bytes;
+  g_sse_hub.frame_seq = frame_seq;
+  elapsed_us = time_us_32() - start_us;
+  g_sse_hub.stats.frames += 1u;
+  g_sse_hub.stats.render_us_total += elapsed_us;
+  if (elapsed_us > g_sse_hub.stats.render_us_max) {
+    g_sse_hub.stats.render_us_max = elapsed_us;
+  }
+  return true;
+}
+
+// Called with the core locked. A client is slow when its own send buffer or
+// queue has no room for the frame: a header and a reference pbuf per segment.
+static bool sse_hub_has_room_locked(const struct tcp_pcb *pcb, size_t length) {
+  const size_t segments = (length + TCP_MSS - 1u) / TCP_MSS;
+
+  return tcp_sndbuf(pcb) >= length &&
+         (size_t)tcp_sndqueuelen(pcb) + 2u * segments <= TCP_SND_QUEUELEN;
+}
+
+// Queues the current frame to every subscriber (only to those it is due to
+// unless everyone is). A write never blocks. A send buffer without room drops
+// the client instead of stalling the others; with room, a failed write means
+// the shared pbuf or segment pools are used up (a page load in progress), and
+// the frame is retried on the next tick.
+static void sse_hub_fan_out(bool everyone) {
+  const uint8_t slot = sse_hub_slot(g_sse_hub.frame_seq);
+  const size_t length = g_sse_hub.frame_length[slot];
+  const uint32_t start_us = time_us_32();
+  uint32_t deliveries = 0u;
+  uint32_t elapsed_us = 0u;
+  size_t index = 0u;
+  bool aborted = false;
+
+  for (index = 0u; index < APP_SSE_MAX_CLIENTS; ++index) {
+    sse_subscriber_t *subscriber = &g_sse_hub.subscribers[index];
+    size_t written = 0u;
+    err_t err = ERR_OK;
+    bool has_room = false;
+
+    if (subscriber->state != SSE_SUBSCRIBER_ACTIVE ||
+        (!everyone && !subscriber->frame_due)) {
+      continue;
+    }
+
+    LOCK_TCPIP_CORE();
+    has_room = subscriber->connection->pcb.tcp != NULL &&
+               sse_hub_has_room_locked(subscriber->connection->pcb.tcp, length);
+    if (!has_room) {
+      sse_hub_abort_locked(subscriber, subscriber->connection->pcb.tcp != NULL);
+      aborted = true;
+    }
+    UNLOCK_TCPIP_CORE();
+    if (!has_room) {
+      continue;
+    }
+
+    // tcp_write() queues all of the frame or none of it.
+    err = netconn_write_partly(subscriber->connection, g_sse_hub.frames[slot], length,
+                               NETCONN_NOCOPY | NETCONN_DONTBLOCK, &written);
+
+    LOCK_TCPIP_CORE();
+    if (subscriber->connection->pcb.tcp == NULL ||
+        (err != ERR_OK && err != ERR_WOULDBLOCK && err != ERR_MEM) ||
+        (written != 0u && written != length)) {
+      sse_hub_abort_locked(subscriber, false);
+      aborted = true;
+    } else if (written == 0u) {
+      subscriber->frame_due = true;
+      g_sse_hub.stats.deferred += 1u;
+    } else {
+      subscriber->end_seq[slot] = subscriber->connection->pcb.tcp->snd_lbb;
+      subscriber->pending_mask |= (uint8_t)(1u << slot);
+      subscriber->frame_due = false;
+      deliveries += 1u;
+    }
+    UNLOCK_TCPIP_CORE();
+  }
+
+  if (aborted) {
+    sse_hub_release_aborted();
+  }
+  if (deliveries == 0u) {
     return;
   }
+  elapsed_us = time_us_32() - start_us;
+  g_sse_hub.stats.deliveries += deliveries;
+  g_sse_hub.stats.fanout_us_total += elapsed_us;
+  if (elapsed_us > g_sse_hub.stats.fanout_us_max) {
+    g_sse_hub.stats.fanout_us_max = elapsed_us;
+  }
+}
+
+static bool sse_hub_has_due_subscriber(void) {
+  size_t index = 0u;
+
+  for (index = 0u; index < APP_SSE_MAX_CLIENTS; ++index) {
+    if (g_sse_hub.subscribers[index].state == SSE_SUBSCRIBER_ACTIVE &&
+        g_sse_hub.subscribers[index].frame_due) {
+      return true;
+    }
+  }
+  return false;
+}
 
-  http_send_sse_headers(connection);
-  printf("[SSE] opened\n");
-  context->last_emit_ms = to_ms_since_boot(get_absolute_time());
+static void sse_hub_task(void *params) {
+  (void)params;
 
   while (1) {
-    if (g_sse_stop_requested) {
-      close_reason = "stop_requested";
-      break;
+    vTaskDelay(pdMS_TO_TICKS(SSE_LOOP_INTERVAL_MS));
+    if (g_sse_hub.subscriber_count == 0u) {
+      g_sse_hub.has_last_status = false;
+      continue;
     }
 
     web_status_snapshot_t status_snapshot = {0};
     const uint32_t now_ms = to_ms_since_boot(get_absolute_time());
     const bool has_status = web_collect_status_snapshot(&status_snapshot);
-    const bool should_push =
+    const bool should_publish =
         has_status &&
-        (!context->has_last_status ||
-         web_status_changed(&status_snapshot, &context->last_status) ||
-         (now_ms - context->last_emit_ms) >= SSE_FORCE_PUBLISH_INTERVAL_MS);
-
-    if (should_push) {
-      const bool json_ok = web_format_status_json(&status_snapshot, json_payload,
-                                                  sizeof(json_payload));
-      if (!json_ok) {
-        static const char k_fallback_payload[] =
-            "{\"logs_enabled\":false,\"error\":\"payload\"}";
-        debug_logs_append("SSE payload fallback");
-        if (!sse_write_event(connection, k_fallback_payload)) {
-          debug_logs_append("SSE write fail fallback");
-          close_reason = "write_fail_fallback";
-          break;
-        }
-        sent_events += 1u;
-        context->last_emit_ms = now_ms;
-        vTaskDelay(pdMS_TO_TICKS(SSE_LOOP_INTERVAL_MS));
-        continue;
+        (!g_sse_hub.has_last_status ||
+         web_status_changed(&status_snapshot, &g_sse_hub.last_status) ||
+         (now_ms - g_sse_hub.last_emit_ms) >= SSE_FORCE_PUBLISH_INTERVAL_MS);
+
+    xSemaphoreTake(g_sse_hub.mutex, portMAX_DELAY);
+    if (should_publish && sse_hub_render(&status_snapshot)) {
+      g_sse_hub.last_status = status_snapshot;
+      g_sse_hub.has_last_status = true;
+      g_sse_hub.last_emit_ms = now_ms;
+      sse_hub_fan_out(true);
+    } else {
+      sse_hub_sweep(-1);
+      if (g_sse_hub.frame_seq != 0u && sse_hub_has_due_subscriber()) {
+        sse_hub_fan_out(false);
       }
+    }
+    xSemaphoreGive(g_sse_hub.mutex);
+  }
+}
 
-      if (!sse_write_event(connection, json_payload)) {
-        debug_logs_append("SSE write fail data");
-        close_reason = "write_fail_data";
-        break;
-      }
+static bool sse_hub_start(void) {
+  g_sse_hub.mutex = xSemaphoreCreateMutex();
+  if (g_sse_hub.mutex == NULL) {
+    return false;
+  }
+  return xTaskCreate(sse_hub_task, "SSEHub", 2048u, NULL, APP_WIFI_TASK_PRIORITY,
+                     NULL) == pdPASS;
+}
 
-      sent_events += 1u;
-      if ((sent_events % 10u) == 0u) {
-        printf("[SSE] sent=%lu seq=%lu fan_ok=%u env_ok=%u\n",
-               (unsigned long)sent_events,
-               (unsigned long)status_snapshot.sample_sequence,
-               status_snapshot.dp1_ok ? 1u : 0u,
-               status_snapshot.dp2_ok ? 1u : 0u);
-      }
+// GET /events: the worker sends the headers and adds the connection to the
+// hub, which sends it the latest frame on its next tick.
+static bool http_start_sse_stream(http_connection_t *connection) {
+  sse_subscriber_t *subscriber = NULL;
+  size_t index = 0u;
 
-      context->last_status = status_snapshot;
-      context->has_last_status = true;
-      context->last_emit_ms = now_ms;
+  xSemaphoreTake(g_sse_hub.mutex, portMAX_DELAY);
+  for (index = 0u; index < APP_SSE_MAX_CLIENTS; ++index) {
+    if (g_sse_hub.subscribers[index].state == SSE_SUBSCRIBER_FREE) {
+      subscriber = &g_sse_hub.subscribers[index];
+      subscriber->state = SSE_SUBSCRIBER_RESERVED;
+      break;
     }
+  }
+  if (subscriber == NULL) {
+    g_sse_hub.stats.rejected += 1u;
+  }
+  xSemaphoreGive(g_sse_hub.mutex);
 
-    vTaskDelay(pdMS_TO_TICKS(SSE_LOOP_INTERVAL_MS));
+  if (subscriber == NULL) {
+    printf("[SSE] reject reason=full\n");
+    http_send_text_response(connection, "503 Service Unavailable", "text/plain",
+                            "SSE clients full");
+    return false;
   }
 
-  netconn_close(connection);
-  netconn_delete(connection);
-  printf("[SSE] closed reason=%s sent=%lu\n", close_reason,
-         (unsigned long)sent_events);
-  debug_logs_append("SSE closed");
-  g_sse_stop_requested = false;
-  g_sse_active = false;
-  vPortFree(context);
-  vTaskDelete(NULL);
+  if (!http_send_sse_headers(connection->netconn)) {
+    xSemaphoreTake(g_sse_hub.mutex, portMAX_DELAY);
+    subscriber->state = SSE_SUBSCRIBER_FREE;
+    xSemaphoreGive(g_sse_hub.mutex);
+    connection->keep_alive = false;
+    return false;
+  }
+
+  xSemaphoreTake(g_sse_hub.mutex, portMAX_DELAY);
+  *subscriber = (sse_subscriber_t){
+      .state = SSE_SUBSCRIBER_ACTIVE,
+      .connection = connection->netconn,
+      .frame_due = true,
+  };
+  g_sse_hub.subscriber_count += 1u;
+  xSemaphoreGive(g_sse_hub.mutex);
+  printf("[SSE] subscribed clients=%u\n", (unsigned)g_sse_hub.subscriber_count);
+  return true;
 }
 
-static bool http_start_sse_stream(struct netconn *connection) {
-  sse_stream_context_t *context = NULL;
+static bool http_on_request_line(void *context, const char *method,
+                                 size_t method_length, const char *target,
+                                 size_t target_length, bool http_1_1) {
+  http_request_t *request = &((http_worker_t *)context)->request;
+
+  if (method_length == 3u && memcmp(method, "GET", 3u) == 0) {
+    request->method = HTTP_METHOD_GET;
+  } else if (method_length == 4u && memcmp(method, "HEAD", 4u) == 0) {
+    request->method = HTTP_METHOD_HEAD;
+  } else if (method_length == 4u && memcmp(method, "POST", 4u) == 0) {
+    request->method = HTTP_METHOD_POST;
+  } else {
+    return false;
+  }
 
-  if (g_sse_active) {
-    const uint32_t wait_start_ms = to_ms_since_boot(get_absolute_time());
-    const uint32_t handover_timeout_ms = 1200u;
+  // HTTP/1.1 connections persist unless the client asks to close; HTTP/1.0
+  // ones only when the client asks to keep them.
+  request->keep_alive = http_1_1;
+  return http_parse_request_target(target, target_length, request);
+}
 
-    printf("[SSE] handover requested\n");
-    g_sse_stop_requested = true;
-    while (g_sse_active &&
-           (to_ms_since_boot(get_absolute_time()) - wait_start_ms) <
-               handover_timeout_ms) {
-      vTaskDelay(pdMS_TO_TICKS(20u));
+static bool http_on_request_header(void *context, const char *name,
+                                   size_t name_length, const char *value,
+                                   size_t value_length) {
+  http_worker_t *worker = (http_worker_t *)context;
+  http_request_t *request = &worker->request;
+
+  if (http_header_name_is(name, name_length, "Connection")) {
+    if (http_header_has_token(value, value_length, "close")) {
+      request->keep_alive = false;
+    } else if (http_header_has_token(value, value_length, "keep-alive")) {
+      request->keep_alive = true;
     }
-
-    if (g_sse_active) {
-      printf("[SSE] reject reason=busy\n");
-      http_send_text_response(connection, "503 Service Unavailable", "text/plain",
-                              "SSE busy");
-      return false;
+  } else if (http_header_name_is(name, name_length, "Accept-Encoding")) {
+    request->accepts_gzip = http_header_has_token(value, value_length, "gzip");
+  } else if (http_header_name_is(name, name_length, "If-None-Match")) {
+    if (value_length >= sizeof(request->if_none_match)) {
+      value_length = sizeof(request->if_none_match) - 1u;
+    }
+    memcpy(request->if_none_match, value, value_length);
+    request->if_none_match[value_length] = '\0';
+  } else if (http_header_name_is(name, name_length, "Upgrade")) {
+    request->websocket_upgrade = http_header_has_token(value, value_length, "websocket");
+  } else if (http_header_name_is(name, name_length, "Sec-WebSocket-Version")) {
+    request->websocket_version =
+        value_length == 2u && value[0] == '1' && value[1] == '3' ? 13u : 0u;
+  } else if (http_header_name_is(name, name_length, "Sec-WebSocket-Key")) {
+    if (value_length >= sizeof(request->websocket_key)) {
+      value_length = 0u;
+    }
+    memcpy(request->websocket_key, value, value_length);
+    request->websocket_key[value_length] = '\0';
+  } else if (http_header_name_is(name, name_length, "Sec-WebSocket-Protocol")) {
+    // The header may repeat; binary wins over JSON whatever the order.
+    if (http_header_has_token(value, value_length, k_ws_protocol_names[WS_PROTOCOL_BINARY])) {
+      request->websocket_protocol = WS_PROTOCOL_BINARY;
+    } else if (request->websocket_protocol == WS_PROTOCOL_NONE &&
+               http_header_has_token(value, value_length,
+                                     k_ws_protocol_names[WS_PROTOCOL_JSON])) {
+      request->websocket_protocol = WS_PROTOCOL_JSON;
     }
+  } else if (http_header_name_is(name, name_length, "X-OTA-CRC32")) {
+    worker->ota_upload.has_crc32 =
+        http_parse_hex_uint32(value, value_length, &worker->ota_upload.crc32);
+  } else if (http_header_name_is(name, name_length, "X-OTA-Version")) {
+    if (value_length >= sizeof(worker->ota_upload.version)) {
+      value_length = sizeof(worker->ota_upload.version) - 1u;
+    }
+    memcpy(worker->ota_upload.version, value, value_length);
+    worker->ota_upload.version[value_length] = '\0';
   }
 
-  context = (sse_stream_context_t *)pvPortMalloc(sizeof(*context));
-  if (context == NULL) {
-    http_send_text_response(connection, "500 Internal Server Error", "text/plain",
-                            "SSE allocation failed");
+  return true;
+}
+
+static bool http_ota_upload_begin(http_ota_upload_t *upload, size_t content_length) {
+  upload->offset = 0u;
+  upload->result = OTA_UPDATE_RESULT_INVALID_ARGUMENT;
+  if (!upload->has_crc32 || content_length > UINT32_MAX) {
     return false;
   }
 
-  *context = (sse_stream_context_t){
-      .connection = connection,
-      .last_status = {0},
-      .has_last_status = false,
-      .last_emit_ms = 0u,
-  };
+  upload->result = ota_update_service_begin(
+      (uint32_t)content_length, upload->crc32,
+      upload->version[0] != '\0' ? upload->version : "unspecified");
+  upload->begun = upload->result == OTA_UPDATE_RESULT_OK;
+  return upload->begun;
+}
 
-  g_sse_active = true;
-  g_sse_stop_requested = false;
-  if (xTaskCreate(sse_stream_task, "SSETask", 2048u, context,
-                  APP_WIFI_TASK_PRIORITY, NULL) != pdPASS) {
-    g_sse_active = false;
-    vPortFree(context);
-    http_send_text_response(connection, "500 Internal Server Error", "text/plain",
-                            "SSE task creation failed");
-    return false;
+// Every slice is written as it arrives; the OTA service fills flash pages
+// from it and programs each one as soon as it is complete.
+static bool http_ota_upload_write(http_ota_upload_t *upload, const uint8_t *data,
+                                  size_t length) {
+  upload->result = ota_update_service_write_chunk(upload->offset, data, length);
+  upload->offset += (uint32_t)length;
+  return upload->result == OTA_UPDATE_RESULT_OK;
+}
+
+// The route is known before the body arrives, so OTA bodies are decoded or
+// written as they stream in instead of being buffered.
+static bool http_on_request_headers_complete(void *context, size_t content_length) {
+  http_worker_t *worker = (http_worker_t *)context;
+  http_request_t *request = &worker->request;
+
+  request->route_entry = web_routes_find(request->path);
+  request->route = request->route_entry != NULL
+                       ? (http_route_t)request->route_entry->route
+                       : HTTP_ROUTE_NONE;
+  request->body_streamed = request->method == HTTP_METHOD_POST &&
+                           (request->route == HTTP_ROUTE_OTA_CHUNK ||
+                            request->route == HTTP_ROUTE_OTA_UPLOAD);
+  if (request->body_streamed && request->route == HTTP_ROUTE_OTA_UPLOAD) {
+    return http_ota_upload_begin(&worker->ota_upload, content_length);
+  }
+  if (request->body_streamed) {
+    http_ota_chunk_begin(&worker->ota_chunk);
+    return content_length <= OTA_MAX_CHUNK_BODY_SIZE;
   }
 
-  printf("[SSE] task_started\n");
-  return true;
+  return content_length <= HTTP_MAX_BODY_SIZE;
 }
 
-static bool http_parse_request(struct netconn *connection,
-                               http_request_t *out_request) {
-  char request_buffer[HTTP_REQUEST_BUFFER_SIZE];
-  size_t total_size = 0u;
-  size_t header_size = 0u;
-  size_t content_length = 0u;
-  http_method_t method = HTTP_METHOD_UNKNOWN;
-  char path[96];
+static bool http_on_request_body(void *context, const uint8_t *data, size_t length) {
+  http_worker_t *worker = (http_worker_t *)context;
+  http_request_t *request = &worker->request;
+
+  if (request->body_streamed && request->route == HTTP_ROUTE_OTA_UPLOAD) {
+    return http_ota_upload_write(&worker->ota_upload, data, length);
+  }
+  if (request->body_streamed) {
+    http_ota_chunk_feed(&worker->ota_chunk, data, length);
+    return true;
+  }
 
-  if (out_request == NULL) {
+  if (length > HTTP_MAX_BODY_SIZE - request->body_length) {
     return false;
   }
+  memcpy(request->body + request->body_length, data, length);
+  request->body_length += length;
+  request->body[request->body_length] = '\0';
+  return true;
+}
 
-  memset(out_request, 0, sizeof(*out_request));
+static const http_request_parser_callbacks_t k_http_request_callbacks = {
+    .on_request_line = http_on_request_line,
+    .on_header = http_on_request_header,
+    .on_headers_complete = http_on_request_headers_complete,
+    .on_body = http_on_request_body,
+};
+
+static bool http_parse_request(http_worker_t *worker) {
+  http_connection_t *connection = &worker->connection;
+  http_request_t *request = &worker->request;
+  bool parsed = false;
+
+  request->method = HTTP_METHOD_UNKNOWN;
+  request->route = HTTP_ROUTE_NONE;
+  request->route_entry = NULL;
+  request->keep_alive = false;
+  request->body_streamed = false;
+  request->path[0] = '\0';
+  request->query[0] = '\0';
+  request->body[0] = '\0';
+  request->body_length = 0u;
+  request->accepts_gzip = false;
+  request->if_none_match[0] = '\0';
+  request->websocket_upgrade = false;
+  request->websocket_version = 0u;
+  request->websocket_key[0] = '\0';
+  request->websocket_protocol = WS_PROTOCOL_NONE;
+  worker->ota_upload.has_crc32 = false;
+  worker->ota_upload.version[0] = '\0';
+  worker->ota_upload.begun = false;
+
+  http_request_parser_init(&connection->parser, &k_http_request_callbacks, worker);
+  parsed = http_connection_read_request(connection);
+
+  connection->served += 1u;
+  connection->keep_alive =
+      request->keep_alive && connection->served < APP_HTTP_KEEPALIVE_MAX_REQUESTS;
+  return parsed;
+}
 
-  if (!http_receive_request(connection, request_buffer, sizeof(request_buffer),
-                            &total_size, &header_size, &content_length)) {
+static bool http_handle_status_route(http_connection_t *connection,
+                                     const http_request_t *request) {
+  web_status_snapshot_t status_snapshot = {0};
+  http_stream_writer_t stream;
+
+  if (!web_collect_status_snapshot(&status_snapshot)) {
+    http_send_text_response(connection, "500 Internal Server Error",
+                            "application/json", "{\"error\":\"status\"}");
     return false;
   }
 
-  if (!http_parse_request_path_and_method(request_buffer, header_size, &method,
-                                          path, sizeof(path))) {
+  http_end_stream(connection, &stream,
+                  http_begin_json_stream(&stream, connection, request) &&
+                      web_write_status_json(&stream, &status_snapshot));
+  return false;
+}
+
+static bool http_append_test_summary_json(http_stream_writer_t *stream,
+                                          const blower_test_curve_summary_t *summary) {
+  if (!summary->valid) {
+    return http_stream_puts(stream, "null");
+  }
+
+  return http_stream_printf(
+      stream,
+      "{\"cl\":%.4f,\"n\":%.4f,\"r\":%.5f,\"q_ref_m3h\":%.2f,\"ach_ref\":%.3f,"
+      "\"w_ref\":%.3f,\"q_ref_envelope\":%.3f,\"eqla10_cm2\":%.1f,"
+      "\"eqla10_cm2_m2\":%.3f,\"ela4_cm2\":%.1f,\"ela4_cm2_m2\":%.3f,"
+      "\"uncertainty_pct\":%.2f,\"cl_ci\":[%.4f,%.4f],\"n_ci\":[%.4f,%.4f],"
+      "\"q_ref_ci\":[%.2f,%.2f],\"outliers\":%u}",
+      safe_json_float(summary->cl_m3h_pan), safe_json_float(summary->exponent_n),
+      safe_json_float(summary->correlation_r), safe_json_float(summary->q_ref_m3h),
+      safe_json_float(summary->ach_ref_h1), safe_json_float(summary->w_ref_m3h_m2),
+      safe_json_float(summary->q_ref_envelope_m3h_m2),
+      safe_json_float(summary->eqla10_cm2),
+      safe_json_float(summary->eqla10_cm2_per_m2_envelope),
+      safe_json_float(summary->lbl_ela4_cm2),
+      safe_json_float(summary->lbl_ela4_cm2_per_m2_envelope),
+      safe_json_float(summary->uncertainty_pct),
+      safe_json_float(summary->cl_ci_low_m3h_pan),
+      safe_json_float(summary->cl_ci_high_m3h_pan),
+      safe_json_float(summary->exponent_n_ci_low),
+      safe_json_float(summary->exponent_n_ci_high),
+      safe_json_float(summary->q_ref_ci_low_m3h),
+      safe_json_float(summary->q_ref_ci_high_m3h),
+      (unsigned)summary->downweighted_points);
+}
+
+static bool http_append_test_direction_json(http_stream_writer_t *stream,
+                                            const blower_test_report_view_t *view,
+                                            blower_test_direction_t direction,
+                                            bool present) {
+  blower_test_report_direction_info_t info = {0};
+  blower_test_report_point_iter_t points = {0};
+  blower_test_point_result_t point = {0};
+  blower_test_curve_summary_t summary = {0};
+  uint8_t index = 0u;
+
+  if (!blower_test_report_get_direction(view, direction, &info) ||
+      (!present && info.point_count == 0u)) {
+    return http_stream_puts(stream, "null");
+  }
+
+  if (!http_stream_puts(stream, "{\"points\":[")) {
+    return false;
+  }
+
+  (void)blower_test_report_points_begin(view, direction, &points);
+  for (index = 0u; blower_test_report_points_next(&points, &point); ++index) {
+    if (!http_stream_printf(
+            stream,
+            "%s{\"target_pa\":%.1f,\"pressure_pa\":%.2f,\"flow_m3h\":%.2f,"
+            "\"fan_temp_c\":%.2f,\"envelope_temp_c\":%.2f,\"pwm\":%.1f,"
+            "\"settle_s\":%.1f,\"pressure_se_pa\":%.3f,\"flow_se_m3h\":%.3f,"
+            "\"ci_pct\":%.2f,\"samples\":%u,\"raw_samples\":%u,\"valid\":%s}",
+            index == 0u ? "" : ",", safe_json_float(point.target_pressure_pa),
+            safe_json_float(point.avg_pressure_pa),
+            safe_json_float(point.avg_fan_flow_m3h),
+            safe_json_float(point.avg_fan_temperature_c),
+            safe_json_float(point.avg_envelope_temperature_c),
+            safe_json_float(point.avg_pwm_percent),
+            safe_json_float(point.settle_time_s),
+            safe_json_float(point.pressure_std_error_pa),
+            safe_json_float(point.flow_std_error_m3h),
+            safe_json_float(point.log_flow_ci_pct), (unsigned)point.sample_count,
+            (unsigned)point.raw_sample_count, point.valid ? "true" : "false")) {
+      return false;
+    }
+  }
+
+  (void)blower_test_report_get_summary(view, direction, &summary);
+  return http_stream_printf(stream, "],\"confidence_stop\":%s,\"summary\":",
+                            info.confidence_stop ? "true" : "false") &&
+         http_append_test_summary_json(stream, &summary) && http_stream_puts(stream, "}");
+}
+
+// null for a measured report, else the id of the report it re-analyzes.
+static bool http_append_report_source_json(http_stream_writer_t *stream,
+                                           uint32_t source_report_id) {
+  return source_report_id == 0u
+             ? http_stream_puts(stream, "null")
+             : http_stream_printf(stream, "%lu", (unsigned long)source_report_id);
+}
+
+static bool http_format_test_report_json(http_stream_writer_t *stream,
+                                         const blower_test_report_view_t *view) {
+  blower_test_report_header_t header = {0};
+  blower_test_curve_summary_t mean = {0};
+
+  if (!blower_test_report_get_header(view, &header) ||
+      !blower_test_report_get_summary(view, BLOWER_TEST_DIRECTION_NONE, &mean)) {
+    return http_stream_puts(stream, "null");
+  }
+
+  return http_stream_printf(stream, "{\"id\":%lu,\"source_id\":",
+                            (unsigned long)header.report_id) &&
+         http_append_report_source_json(stream, header.source_report_id) &&
+         http_stream_printf(stream,
+                            ",\"completed_ms\":%lu,\"reference_pa\":%u,"
+                            "\"pressurization\":",
+                            (unsigned long)header.completed_tick_ms,
+                            (unsigned)header.reference_pressure_pa) &&
+         http_append_test_direction_json(stream, view,
+                                         BLOWER_TEST_DIRECTION_PRESSURIZATION,
+                                         header.has_pressurization) &&
+         http_stream_puts(stream, ",\"depressurization\":") &&
+         http_append_test_direction_json(stream, view,
+                                         BLOWER_TEST_DIRECTION_DEPRESSURIZATION,
+                                         header.has_depressurization) &&
+         http_stream_puts(stream, ",\"mean\":") &&
+         http_append_test_summary_json(stream, &mean) && http_stream_puts(stream, "}");
+}
+
+// One row per point: the direction's fit repeats on each of its rows so the
+// file stays a single flat table.
+static bool http_format_test_report_csv(http_stream_writer_t *stream,
+                                        const blower_test_report_view_t *view) {
+  static const blower_test_direction_t k_directions[] = {
+      BLOWER_TEST_DIRECTION_PRESSURIZATION, BLOWER_TEST_DIRECTION_DEPRESSURIZATION};
+  blower_test_report_header_t header = {0};
+  size_t direction_index = 0u;
+
+  if (!http_stream_puts(stream,
+                        "report_id,direction,point,target_pa,pressure_pa,flow_m3h,"
+                        "fan_temp_c,envelope_temp_c,pwm,settle_s,pressure_se_pa,"
+                        "flow_se_m3h,ci_pct,samples,raw_samples,valid,cl,n,"
+                        "q_ref_m3h,ach_ref\r\n") ||
+      !blower_test_report_get_header(view, &header)) {
+    return !stream->failed;
+  }
+
+  for (direction_index = 0u;
+       direction_index < sizeof(k_directions) / sizeof(k_directions[0]);
+       ++direction_index) {
+    const blower_test_direction_t direction = k_directions[direction_index];
+    blower_test_report_point_iter_t points = {0};
+    blower_test_point_result_t point = {0};
+    blower_test_curve_summary_t summary = {0};
+    uint8_t index = 0u;
+
+    if (!blower_test_report_points_begin(view, direction, &points)) {
+      continue;
+    }
+    (void)blower_test_report_get_summary(view, direction, &summary);
+    for (index = 0u; blower_test_report_points_next(&points, &point); ++index) {
+      if (!http_stream_printf(
+              stream,
+              "%lu,%s,%u,%.1f,%.2f,%.2f,%.2f,%.2f,%.1f,%.1f,%.3f,%.3f,%.2f,%u,%u,%u,"
+              "%.4f,%.4f,%.2f,%.3f\r\n",
+              (unsigned long)header.report_id, blower_test_direction_name(direction),
+              (unsigned)index, safe_json_float(point.target_pressure_pa),
+              safe_json_float(point.avg_pressure_pa),
+              safe_json_float(point.avg_fan_flow_m3h),
+              safe_json_float(point.avg_fan_temperature_c),
+              safe_json_float(point.avg_envelope_temperature_c),
+              safe_json_float(point.avg_pwm_percent),
+              safe_json_float(point.settle_time_s),
+              safe_json_float(point.pressure_std_error_pa),
+              safe_json_float(point.flow_std_error_m3h),
+              safe_json_float(point.log_flow_ci_pct), (unsigned)point.sample_count,
+              (unsigned)point.raw_sample_count, point.valid ? 1u : 0u,
+              safe_json_float(summary.valid ? summary.cl_m3h_pan : 0.0f),
+              safe_json_float(summary.valid ? summary.exponent_n : 0.0f),
+              safe_json_float(summary.valid ? summary.q_ref_m3h : 0.0f),
+              safe_json_float(summary.valid ? summary.ach_ref_h1 : 0.0f))) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool http_format_test_config_json(http_stream_writer_t *stream,
+                                         const blower_test_config_t *config) {
+  uint8_t index = 0u;
+
+  if (!http_stream_printf(
+          stream,
+          "{\"building_volume_m3\":%.2f,\"floor_area_m2\":%.2f,"
+          "\"envelope_area_m2\":%.2f,\"building_height_m\":%.2f,"
+          "\"dimensions_uncertainty_pct\":%.1f,\"altitude_m\":%.0f,"
+          "\"fan_aperture_cm\":%.1f,\"fan_curve_c\":%.4f,\"fan_curve_n\":%.4f,"
+          "\"target_tolerance_pa\":%.2f,\"settle_time_s\":%u,"
+          "\"measure_min_time_s\":%u,\"measure_time_s\":%u,"
+          "\"measure_target_ci_pct\":%.2f,\"target_ach_ref_h1\":%.2f,"
+          "\"confidence_stop_enabled\":%s,\"reference_pressure_pa\":%u,"
+          "\"min_points_required\":%u,\"enforce_iso_9972_rules\":%s,"
+          "\"pressure_points_pa\":[",
+          safe_json_float(config->building_volume_m3),
+          safe_json_float(config->floor_area_m2),
+          safe_json_float(config->envelope_area_m2),
+          safe_json_float(config->building_height_m),
+          safe_json_float(config->dimensions_uncertainty_pct),
+          safe_json_float(config->altitude_m), safe_json_float(config->fan_aperture_cm),
+          safe_json_float(config->fan_curve_c), safe_json_float(config->fan_curve_n),
+          safe_json_float(config->target_tolerance_pa), (unsigned)config->settle_time_s,
+          (unsigned)config->measure_min_time_s, (unsigned)config->measure_time_s,
+          safe_json_float(config->measure_target_ci_pct),
+          safe_json_float(config->target_ach_ref_h1),
+          config->confidence_stop_enabled ? "true" : "false",
+          (unsigned)config->reference_pressure_pa,
+          (unsigned)config->min_points_required,
+          config->enforce_iso_9972_rules ? "true" : "false")) {
+    return false;
+  }
+
+  for (index = 0u; index < config->pressure_points_count &&
+                   index < BLOWER_TEST_MAX_PRESSURE_POINTS;
+       ++index) {
+    if (!http_stream_printf(stream, "%s%.1f", index == 0u ? "" : ",",
+                            safe_json_float(config->pressure_points_pa[index]))) {
+      return false;
+    }
+  }
+
+  return http_stream_puts(stream, "]}");
+}
+
+static void http_apply_test_config_float(const char *body, const char *field_name,
+                                         float *value) {
+  float parsed_value = 0.0f;
+
+  if (json_extract_float_field(body, field_name, &parsed_value)) {
+    *value = parsed_value;
+  }
+}
+
+static bool http_query_uint32(const char *query, const char *name,
+                              uint32_t *out_value) {
+  const size_t name_length = strlen(name);
+  const char *cursor = query;
+
+  while (cursor != NULL && *cursor != '\0') {
+    if (strncmp(cursor, name, name_length) == 0 && cursor[name_length] == '=') {
+      const char *value_start = cursor + name_length + 1u;
+      char *end_ptr = NULL;
+      const unsigned long parsed_value = strtoul(value_start, &end_ptr, 10);
+      if (end_ptr == value_start || *value_start == '-') {
+        return false;
+      }
+      *out_value = parsed_value > UINT32_MAX ? UINT32_MAX : (uint32_t)parsed_value;
+      return true;
+    }
+    cursor = strchr(cursor, '&');
+    if (cursor != NULL) {
+      cursor++;
+    }
+  }
+
+  return false;
+}
+
+static bool http_query_equals(const char *query, const char *name, const char *value) {
+  const size_t name_length = strlen(name);
+  const size_t value_length = strlen(value);
+  const char *cursor = query;
+
+  while (cursor != NULL && *cursor != '\0') {
+    if (strncmp(cursor, name, name_length) == 0 && cursor[name_length] == '=') {
+      const char *value_start = cursor + name_length + 1u;
+      return strncmp(value_start, value, value_length) == 0 &&
+             (value_start[value_length] == '\0' || value_start[value_length] == '&');
+    }
+    cursor = strchr(cursor, '&');
+    if (cursor != NULL) {
+      cursor++;
+    }
+  }
+
+  return false;
+}
+
+// Partial update: fields missing from the body keep their current value.
+static bool http_apply_test_config_json(const char *body,
+                                        blower_test_config_t *config) {
+  uint32_t parsed_uint = 0u;
+  bool parsed_bool = false;
+  uint8_t points_count = 0u;
+
+  http_apply_test_config_float(body, "building_volume_m3", &config->building_volume_m3);
+  http_apply_test_config_float(body, "floor_area_m2", &config->floor_area_m2);
+  http_apply_test_config_float(body, "envelope_area_m2", &config->envelope_area_m2);
+  http_apply_test_config_float(body, "building_height_m", &config->building_height_m);
+  http_apply_test_config_float(body, "dimensions_uncertainty_pct",
+                               &config->dimensions_uncertainty_pct);
+  http_apply_test_config_float(body, "altitude_m", &config->altitude_m);
+  http_apply_test_config_float(body, "fan_aperture_cm", &config->fan_aperture_cm);
+  http_apply_test_config_float(body, "fan_curve_c", &config->fan_curve_c);
+  http_apply_test_config_float(body, "fan_curve_n", &config->fan_curve_n);
+  http_apply_test_config_float(body, "target_tolerance_pa",
+                               &config->target_tolerance_pa);
+  http_apply_test_config_float(body, "measure_target_ci_pct",
+                               &config->measure_target_ci_pct);
+  http_apply_test_config_float(body, "target_ach_ref_h1", &config->target_ach_ref_h1);
+
+  if (json_extract_uint32_field(body, "settle_time_s", &parsed_uint)) {
+    config->settle_time_s = (uint16_t)(parsed_uint > 0xffffu ? 0xffffu : parsed_uint);
+  }
+  if (json_extract_uint32_field(body, "measure_min_time_s", &parsed_uint)) {
+    config->measure_min_time_s =
+        (uint16_t)(parsed_uint > 0xffffu ? 0xffffu : parsed_uint);
+  }
+  if (json_extract_uint32_field(body, "measure_time_s", &parsed_uint)) {
+    config->measure_time_s = (uint16_t)(parsed_uint > 0xffffu ? 0xffffu : parsed_uint);
+  }
+  if (json_extract_uint32_field(body, "reference_pressure_pa", &parsed_uint)) {
+    config->reference_pressure_pa = (uint8_t)(parsed_uint > 0xffu ? 0xffu : parsed_uint);
+  }
+  if (json_extract_uint32_field(body, "min_points_required", &parsed_uint)) {
+    config->min_points_required = (uint8_t)(parsed_uint > 0xffu ? 0xffu : parsed_uint);
+  }
+  if (json_extract_bool_field(body, "enforce_iso_9972_rules", &parsed_bool)) {
+    config->enforce_iso_9972_rules = parsed_bool;
+  }
+  if (json_extract_bool_field(body, "confidence_stop_enabled", &parsed_bool)) {
+    config->confidence_stop_enabled = parsed_bool;
+  }
+
+  if (strstr(body, "\"pressure_points_pa\"") != NULL) {
+    if (!json_extract_float_array_field(body, "pressure_points_pa",
+                                        config->pressure_points_pa,
+                                        BLOWER_TEST_MAX_PRESSURE_POINTS,
+                                        &points_count)) {
+      return false;
+    }
+    config->pressure_points_count = points_count;
+  }
+
+  return true;
+}
+
+static bool http_parse_test_mode(const char *body, blower_test_mode_t *out_mode) {
+  char mode_name[24];
+
+  *out_mode = BLOWER_TEST_MODE_BOTH;
+  if (!json_extract_string_field(body, "mode", mode_name, sizeof(mode_name))) {
+    return true;
+  }
+
+  if (strcmp(mode_name, "pressurization") == 0) {
+    *out_mode = BLOWER_TEST_MODE_PRESSURIZATION;
+  } else if (strcmp(mode_name, "depressurization") == 0) {
+    *out_mode = BLOWER_TEST_MODE_DEPRESSURIZATION;
+  } else if (strcmp(mode_name, "both") != 0) {
     return false;
   }
+  return true;
+}
 
-  out_request->method = method;
-  strncpy(out_request->path, path, sizeof(out_request->path) - 1u);
+static bool http_handle_test_report_route(http_connection_t *connection,
+                                          const http_request_t *request) {
+  const bool is_latest_route = request->route == HTTP_ROUTE_TEST_REPORT_LATEST;
+  const bool is_reanalyze_route = request->route == HTTP_ROUTE_TEST_REANALYZE;
+  const bool as_csv = http_query_equals(request->query, "format", "csv");
+  http_stream_writer_t stream;
+  blower_test_report_handle_t handle = {0};
+  blower_test_config_t config;
+  bool by_id = false;
+  bool has_report = false;
+  bool body_ok = false;
+  uint32_t report_id = 0u;
+
+  if (is_reanalyze_route) {
+    blower_test_service_get_config(&config);
+    if (!http_apply_test_config_json(request->body, &config)) {
+      http_send_text_response(connection, "400 Bad Request", "application/json",
+                              "{\"status\":\"error\",\"reason\":\"invalid_config\"}");
+      return false;
+    }
+    // Without ?id= the latest report is re-analyzed.
+    (void)http_query_uint32(request->query, "id", &report_id);
+    switch (blower_test_service_reanalyze(report_id, &config, &report_id)) {
+      case BLOWER_TEST_REANALYZE_OK:
+        break;
+      case BLOWER_TEST_REANALYZE_INVALID_CONFIG:
+        http_send_text_response(connection, "400 Bad Request", "application/json",
+                                "{\"status\":\"error\",\"reason\":\"invalid_config\"}");
+        return false;
+      case BLOWER_TEST_REANALYZE_BUSY:
+        http_send_text_response(connection, "409 Conflict", "application/json",
+                                "{\"status\":\"error\",\"reason\":\"test_running\"}");
+        return false;
+      case BLOWER_TEST_REANALYZE_NOT_FOUND:
+        http_send_text_response(connection, "404 Not Found", "application/json",
+                                "{\"status\":\"error\",\"reason\":\"report_not_found\"}");
+        return false;
+      default:
+        http_send_text_response(
+            connection, "409 Conflict", "application/json",
+            "{\"status\":\"error\",\"reason\":\"raw_samples_unavailable\"}");
+        return false;
+    }
+    debug_logs_append("CMD TEST REANALYZE");
+    by_id = true;
+  } else if (!is_latest_route) {
+    by_id = http_query_uint32(request->query, "id", &report_id);
+  }
 
-  if (content_length > 0u) {
-    const size_t body_copy_length =
-        content_length > HTTP_MAX_BODY_SIZE ? HTTP_MAX_BODY_SIZE : content_length;
-    memcpy(out_request->body, request_buffer + header_size, body_copy_length);
-    out_request->body[body_copy_length] = '\0';
-    out_request->body_length = body_copy_length;
+  if (by_id) {
+    has_report = blower_test_service_open_report(report_id, &handle);
+    if (!has_report) {
+      http_send_text_response(connection, "404 Not Found", "application/json",
+                              "{\"status\":\"error\",\"reason\":\"report_not_found\"}");
+      return false;
+    }
+  } else if (is_latest_route) {
+    has_report = blower_test_service_open_latest_report(&handle);
+  } else {
+    has_report = blower_test_service_open_current_report(&handle);
+  }
+
+  if (as_csv) {
+    if (!has_report) {
+      http_send_text_response(connection, "404 Not Found", "application/json",
+                              "{\"status\":\"error\",\"reason\":\"report_not_found\"}");
+      return false;
+    }
+    body_ok = http_begin_stream(&stream, connection, request, "text/csv") &&
+              http_format_test_report_csv(&stream, &handle.view);
+  } else {
+    body_ok =
+        http_begin_json_stream(&stream, connection, request) &&
+        (by_id || is_latest_route
+             ? http_stream_puts(&stream, "{\"report\":")
+             : http_stream_printf(&stream, "{\"active\":%s,\"report\":",
+                                  has_report && handle.is_active ? "true" : "false")) &&
+        (has_report ? http_format_test_report_json(&stream, &handle.view)
+                    : http_stream_puts(&stream, "null")) &&
+        http_stream_puts(&stream, "}");
+  }
+
+  // The report is formatted straight from flash or the service's RAM slot
+  // without holding its lock, and the headers are long gone by the time a
+  // rewrite could be noticed: leave the stream unterminated so the client
+  // sees a truncated response instead of a torn report.
+  http_end_stream(connection, &stream,
+                  body_ok &&
+                      (!has_report || blower_test_service_report_is_current(&handle)));
+  return false;
+}
 
-    if (content_length > HTTP_MAX_BODY_SIZE) {
-      return false;
+static bool http_handle_test_reports_route(http_connection_t *connection,
+                                           const http_request_t *request) {
+  const bool as_csv = http_query_equals(request->query, "format", "csv");
+  http_stream_writer_t stream;
+  blower_test_report_info_t infos[HTTP_TEST_REPORT_LIST_BATCH];
+  flash_journal_stats_t stats = {0};
+  blower_test_runtime_status_t runtime = {0};
+  uint32_t list_offset = 0u;
+  uint32_t limit = HTTP_TEST_REPORT_LIST_DEFAULT_LIMIT;
+  uint32_t total = 0u;
+  uint32_t listed = 0u;
+  bool body_ok = false;
+
+  (void)http_query_uint32(request->query, "offset", &list_offset);
+  (void)http_query_uint32(request->query, "limit", &limit);
+  if (limit == 0u) {
+    limit = HTTP_TEST_REPORT_LIST_DEFAULT_LIMIT;
+  }
+
+  (void)blower_test_service_list_reports(list_offset, infos, 0u, &total);
+  body_ok =
+      as_csv ? http_begin_stream(&stream, connection, request, "text/csv") &&
+                   http_stream_puts(&stream,
+                                    "id,completed_ms,pressurization,depressurization,"
+                                    "valid,ach_ref,n,q_ref_m3h,uncertainty_pct\r\n")
+             : http_begin_json_stream(&stream, connection, request) &&
+                   http_stream_printf(&stream,
+                                      "{\"total\":%lu,\"offset\":%lu,\"reports\":[",
+                                      (unsigned long)total, (unsigned long)list_offset);
+
+  // Entries are fetched a batch at a time so the page size is not bounded
+  // by a buffer.
+  while (body_ok && listed < limit) {
+    uint32_t wanted = limit - listed;
+    uint32_t count = 0u;
+    uint32_t index = 0u;
+
+    if (wanted > HTTP_TEST_REPORT_LIST_BATCH) {
+      wanted = HTTP_TEST_REPORT_LIST_BATCH;
+    }
+    count = blower_test_service_list_reports(list_offset + listed, infos, wanted, NULL);
+    for (index = 0u; body_ok && index < count; ++index) {
+      const blower_test_report_info_t *info = &infos[index];
+
+      body_ok =
+          as_csv ? http_stream_printf(&stream, "%lu,", (unsigned long)info->report_id)
+                 : http_stream_printf(&stream, "%s{\"id\":%lu,\"source_id\":",
+                                      listed + index == 0u ? "" : ",",
+                                      (unsigned long)info->report_id) &&
+                       http_append_report_source_json(&stream, info->source_report_id);
+      body_ok = body_ok &&
+                http_stream_printf(
+                    &stream,
+                    as_csv ? "%lu,%s,%s,%s,%.3f,%.4f,%.2f,%.2f\r\n"
+                           : ",\"completed_ms\":%lu,\"pressurization\":%s,"
+                             "\"depressurization\":%s,\"valid\":%s,\"ach_ref\":%.3f,"
+                             "\"n\":%.4f,\"q_ref_m3h\":%.2f,\"uncertainty_pct\":%.2f}",
+                    (unsigned long)info->completed_tick_ms,
+                    info->has_pressurization ? "true" : "false",
+                    info->has_depressurization ? "true" : "false",
+                    info->valid ? "true" : "false", safe_json_float(info->ach_ref_h1),
+                    safe_json_float(info->exponent_n), safe_json_float(info->q_ref_m3h),
+                    safe_json_float(info->uncertainty_pct));
+    }
+    listed += count;
+    if (count < wanted) {
+      break;
     }
   }
 
-  return true;
+  if (!as_csv) {
+    blower_test_service_get_storage_stats(&stats);
+    blower_test_service_get_runtime(&runtime);
+    body_ok =
+        body_ok &&
+        http_stream_printf(&stream,
+                           "],\"storage\":{\"sectors\":%u,\"free_sectors\":%u,"
+                           "\"erase_min\":%lu,\"erase_max\":%lu,\"records\":%lu,"
+                           "\"used_bytes\":%lu,\"capacity_bytes\":%lu,"
+                           "\"compactions\":%lu,\"evicted\":%lu,"
+                           "\"persist_failed\":%s,\"persist_failures\":%lu}}",
+                           (unsigned)stats.sector_count, (unsigned)stats.free_sectors,
+                           (unsigned long)stats.min_erase_count,
+                           (unsigned long)stats.max_erase_count,
+                           (unsigned long)stats.live_records,
+                           (unsigned long)stats.live_bytes,
+                           (unsigned long)stats.capacity_bytes,
+                           (unsigned long)stats.compactions,
+                           (unsigned long)stats.evicted_records,
+                           runtime.persist_failed ? "true" : "false",
+                           (unsigned long)runtime.persist_failures);
+  }
+  http_end_stream(connection, &stream, body_ok);
+  return false;
 }
 
-static bool http_handle_status_route(struct netconn *connection,
-                                     const http_request_t *request) {
-  web_status_snapshot_t status_snapshot = {0};
-  char payload[HTTP_RESPONSE_PAYLOAD_BUFFER_SIZE];
-  const bool has_snapshot = web_collect_status_snapshot(&status_snapshot);
-  const bool payload_ok = has_snapshot &&
-                          web_format_status_json(&status_snapshot, payload,
-                                                 sizeof(payload));
-
-  if (request->method == HTTP_METHOD_HEAD) {
-    http_send_headers_only(connection,
-                           payload_ok ? "200 OK" : "500 Internal Server Error",
-                           "application/json",
-                           payload_ok ? strlen(payload) : 0u);
-    return false;
-  }
+static bool http_handle_test_queue_route(http_connection_t *connection,
+                                         const http_request_t *request) {
+  http_stream_writer_t stream;
+  blower_test_queue_status_t status;
+  blower_test_config_t config;
+  blower_test_mode_t mode = BLOWER_TEST_MODE_BOTH;
+  const blower_test_queue_aggregate_t *aggregate = &status.aggregate;
+  uint8_t index = 0u;
+  bool body_ok = false;
+
+  if (request->method == HTTP_METHOD_POST && request->route == HTTP_ROUTE_TEST_QUEUE) {
+    // Fields not in the body are taken from the current test config.
+    blower_test_service_get_config(&config);
+    if (!http_parse_test_mode(request->body, &mode) ||
+        !http_apply_test_config_json(request->body, &config)) {
+      http_send_text_response(connection, "400 Bad Request", "application/json",
+                              "{\"status\":\"error\",\"reason\":\"invalid_config\"}");
+      return false;
+    }
+    if (!blower_test_service_queue_add(&config, mode)) {
+      http_send_text_response(connection, "409 Conflict", "application/json",
+                              "{\"status\":\"error\",\"reason\":\"queue_rejected\"}");
+      return false;
+    }
+    debug_logs_append("CMD TEST QUEUE ADD");
+  } else if (request->route == HTTP_ROUTE_TEST_QUEUE_START) {
+    if (!blower_test_service_queue_start()) {
+      http_send_text_response(connection, "409 Conflict", "application/json",
+                              "{\"status\":\"error\",\"reason\":\"start_rejected\"}");
+      return false;
+    }
+    debug_logs_append("CMD TEST QUEUE START");
+  } else if (request->route == HTTP_ROUTE_TEST_QUEUE_CLEAR) {
+    if (!blower_test_service_queue_clear()) {
+      http_send_text_response(connection, "409 Conflict", "application/json",
+                              "{\"status\":\"error\",\"reason\":\"queue_running\"}");
+      return false;
+    }
+    debug_logs_append("CMD TEST QUEUE CLEAR");
+  }
+
+  blower_test_service_get_queue(&status);
+  body_ok = http_begin_json_stream(&stream, connection, request) &&
+            http_stream_printf(&stream, "{\"state\":\"%s\",\"run\":%u,\"runs\":[",
+                               blower_test_queue_state_name(status.state),
+                               (unsigned)status.current_run);
+  for (index = 0u; body_ok && index < status.run_count; ++index) {
+    const blower_test_queue_run_t *run = &status.runs[index];
+    body_ok = http_stream_printf(
+        &stream,
+        "%s{\"mode\":\"%s\",\"aperture_cm\":%.1f,\"finished\":%s,"
+        "\"report_id\":%lu,\"valid\":%s,\"ach_ref\":%.3f,\"q_ref_m3h\":%.2f,"
+        "\"n\":%.4f,\"rezeroed\":%s,\"baseline_shift_pa\":%.3f}",
+        index == 0u ? "" : ",", blower_test_mode_name(run->mode),
+        safe_json_float(run->fan_aperture_cm), run->finished ? "true" : "false",
+        (unsigned long)run->report_id, run->valid ? "true" : "false",
+        safe_json_float(run->ach_ref_h1), safe_json_float(run->q_ref_m3h),
+        safe_json_float(run->exponent_n), run->rezeroed ? "true" : "false",
+        safe_json_float(run->baseline_shift_pa));
+  }
+  body_ok =
+      body_ok &&
+      http_stream_printf(&stream,
+                         "],\"aggregate\":{\"valid_runs\":%u,\"ach_mean\":%.3f,"
+                         "\"ach_stddev\":%.3f,\"ach_cov_pct\":%.2f,\"ach_min\":%.3f,"
+                         "\"ach_max\":%.3f,\"q_ref_mean_m3h\":%.2f,"
+                         "\"q_ref_stddev_m3h\":%.2f,\"n_mean\":%.4f,\"n_stddev\":%.4f}}",
+                         (unsigned)aggregate->valid_runs,
+                         safe_json_float(aggregate->ach_mean_h1),
+                         safe_json_float(aggregate->ach_stddev_h1),
+                         safe_json_float(aggregate->ach_cov_pct),
+                         safe_json_float(aggregate->ach_min_h1),
+                         safe_json_float(aggregate->ach_max_h1),
+                         safe_json_float(aggregate->q_ref_mean_m3h),
+                         safe_json_float(aggregate->q_ref_stddev_m3h),
+                         safe_json_float(aggregate->n_mean),
+                         safe_json_float(aggregate->n_stddev));
+  http_end_stream(connection, &stream, body_ok);
+  return false;
+}
 
-  if (!payload_ok) {
-    http_send_text_response(connection, "500 Internal Server Error",
-                            "application/json", "{\"error\":\"status\"}");
-    return false;
+static bool http_handle_test_route(http_connection_t *connection,
+                                   const http_request_t *request) {
+  http_stream_writer_t stream;
+  blower_test_config_t config;
+  blower_test_runtime_status_t runtime;
+  blower_test_mode_t mode = BLOWER_TEST_MODE_BOTH;
+  bool body_ok = false;
+
+  if (request->route == HTTP_ROUTE_TEST_START) {
+    if (!http_parse_test_mode(request->body, &mode)) {
+      http_send_text_response(connection, "400 Bad Request", "application/json",
+                              "{\"status\":\"error\",\"reason\":\"invalid_mode\"}");
+      return false;
+    }
+    if (!blower_test_service_start(mode)) {
+      http_send_text_response(connection, "409 Conflict", "application/json",
+                              "{\"status\":\"error\",\"reason\":\"start_rejected\"}");
+      return false;
+    }
+    debug_logs_append("CMD TEST START");
+  } else if (request->route == HTTP_ROUTE_TEST_STOP) {
+    blower_test_service_stop();
+    debug_logs_append("CMD TEST STOP");
+  } else if (request->method == HTTP_METHOD_POST &&
+             request->route == HTTP_ROUTE_TEST_CONFIG) {
+    blower_test_set_config_result_t result = BLOWER_TEST_SET_CONFIG_INVALID;
+    bool reset_to_defaults = false;
+
+    if (json_extract_bool_field(request->body, "reset", &reset_to_defaults) &&
+        reset_to_defaults) {
+      result = blower_test_service_reset_config_to_defaults();
+    } else {
+      blower_test_service_get_config(&config);
+      if (http_apply_test_config_json(request->body, &config)) {
+        result = blower_test_service_set_config(&config);
+      }
+    }
+    switch (result) {
+      case BLOWER_TEST_SET_CONFIG_OK:
+        break;
+      case BLOWER_TEST_SET_CONFIG_BUSY:
+        http_send_text_response(connection, "409 Conflict", "application/json",
+                                "{\"status\":\"error\",\"reason\":\"test_running\"}");
+        return false;
+      case BLOWER_TEST_SET_CONFIG_STORAGE_UNAVAILABLE:
+        // Applied for this session, but it would not survive a reboot.
+        http_send_text_response(
+            connection, "503 Service Unavailable", "application/json",
+            "{\"status\":\"error\",\"reason\":\"storage_unavailable\"}");
+        return false;
+      default:
+        http_send_text_response(connection, "400 Bad Request", "application/json",
+                                "{\"status\":\"error\",\"reason\":\"invalid_config\"}");
+        return false;
+    }
   }
 
-  http_send_response(connection, "200 OK", "application/json",
-                     (const uint8_t *)payload, strlen(payload));
+  if (request->route == HTTP_ROUTE_TEST_CONFIG) {
+    blower_test_service_get_config(&config);
+    http_end_stream(connection, &stream,
+                    http_begin_json_stream(&stream, connection, request) &&
+                        http_format_test_config_json(&stream, &config));
+    return false;
+  }
+
+  blower_test_service_get_runtime(&runtime);
+  body_ok =
+      http_begin_json_stream(&stream, connection, request) &&
+      http_stream_printf(
+          &stream,
+          "{\"active\":%s,\"state\":\"%s\",\"mode\":\"%s\",\"direction\":\"%s\","
+          "\"point\":%u,\"points\":%u,\"target_pa\":%.2f,\"pressure_pa\":%.2f,"
+          "\"flow_m3h\":%.2f,\"state_elapsed_ms\":%lu,\"samples\":%u,"
+          "\"ci_pct\":%.2f,\"settle_saved_ms\":%lu,\"fit\":{\"valid\":%s,"
+          "\"points\":%u,\"n\":%.4f,\"q_ref_m3h\":%.2f,\"ach_ref\":%.3f,"
+          "\"ach_ci\":[%.3f,%.3f],\"verdict\":\"%s\"},"
+          "\"report_ready\":%s,\"report_id\":%lu,\"ach_ref\":%.3f,"
+          "\"persist_failed\":%s}",
+          runtime.active ? "true" : "false", blower_test_state_name(runtime.state),
+          blower_test_mode_name(runtime.requested_mode),
+          blower_test_direction_name(runtime.current_direction),
+          (unsigned)runtime.current_point_index, (unsigned)runtime.total_points,
+          safe_json_float(runtime.current_target_pressure_pa),
+          safe_json_float(runtime.current_measured_pressure_pa),
+          safe_json_float(runtime.current_measured_flow_m3h),
+          (unsigned long)runtime.state_elapsed_ms,
+          (unsigned)runtime.active_sample_count,
+          safe_json_float(runtime.active_log_flow_ci_pct),
+          (unsigned long)runtime.settle_time_saved_ms,
+          runtime.provisional_valid ? "true" : "false",
+          (unsigned)runtime.provisional_point_count,
+          safe_json_float(runtime.provisional_exponent_n),
+          safe_json_float(runtime.provisional_q_ref_m3h),
+          safe_json_float(runtime.provisional_ach_ref_h1),
+          safe_json_float(runtime.provisional_ach_ci_low_h1),
+          safe_json_float(runtime.provisional_ach_ci_high_h1),
+          blower_test_verdict_name(runtime.provisional_verdict),
+          runtime.report_ready ? "true" : "false",
+          (unsigned long)runtime.latest_report_id,
+          safe_json_float(runtime.latest_ach_ref_h1),
+          runtime.persist_failed ? "true" : "false");
+  http_end_stream(connection, &stream, body_ok);
   return false;
 }
 
-static bool http_handle_test_report_compat_route(struct netconn *connection,
-                                                 const http_request_t *request) {
-  static const char k_report_payload[] = "{\"active\":false,\"report\":null}";
-  static const char k_latest_report_payload[] = "{\"report\":null}";
-  const bool is_latest_route =
-      strcmp(request->path, "/api/test/report/latest") == 0;
-  const char *payload =
-      is_latest_route ? k_latest_report_payload : k_report_payload;
-  const size_t payload_length = strlen(payload);
-
-  if (request->method == HTTP_METHOD_HEAD) {
-    http_send_headers_only(connection, "200 OK", "application/json",
-                           payload_length);
-    return false;
+// Manual commands shared by POST /api/pwm|led|relay and the WebSocket.
+// Returns NULL once applied, else why the value was refused.
+static const char *web_apply_command(http_route_t route, int value) {
+  switch (route) {
+    case HTTP_ROUTE_PWM:
+      if (value < 0 || value > 100) {
+        return "PWM value must be between 0 and 100";
+      }
+      blower_control_set_manual_pwm_percent((uint8_t)value);
+      debug_logs_append("CMD PWM updated");
+      return NULL;
+    case HTTP_ROUTE_LED:
+      if (value != 0 && value != 1) {
+        return "LED value must be 0 or 1";
+      }
+      blower_control_set_auto_hold_enabled(value == 1);
+      debug_logs_append(value == 1 ? "CMD AUTO_HOLD ON" : "CMD AUTO_HOLD OFF");
+      return NULL;
+    case HTTP_ROUTE_RELAY:
+      if (value != 0 && value != 1) {
+        return "Relay value must be 0 or 1";
+      }
+      blower_control_set_relay_enabled(value == 1);
+      debug_logs_append(value == 1 ? "CMD RELAY ON" : "CMD RELAY OFF");
+      return NULL;
+    default:
+      return "Unknown command";
   }
-
-  http_send_response(connection, "200 OK", "application/json",
-                     (const uint8_t *)payload, payload_length);
-  return false;
 }
 
-static bool http_handle_api_post_route(struct netconn *connection,
+static bool http_handle_api_post_route(http_connection_t *connection,
                                        const http_request_t *request) {
   int value = 0;
+  const char *error = NULL;
   char response_payload[192];
 
   if (request->method != HTTP_METHOD_POST) {
-    http_send_text_response(connection, "405 Method Not Allowed", "text/plain",
-                            "Method Not Allowed");
+    http_send_method_not_allowed(connection, request);
     return false;
   }
 
-  if (strcmp(request->path, "/api/calibrate") == 0) {
+  if (request->route == HTTP_ROUTE_CALIBRATE) {
     blower_metrics_snapshot_t metrics_snapshot = {0};
     const bool has_metrics = blower_metrics_service_get_snapshot(&metrics_snapshot);
     int written = 0;
@@ -1441,33 +2963,9 @@ static bool http_handle_api_post_route(struct netconn *connection,
     return false;
   }
 
-  if (strcmp(request->path, "/api/pwm") == 0) {
-    if (value < 0 || value > 100) {
-      http_send_text_response(connection, "400 Bad Request", "text/plain",
-                              "PWM value must be between 0 and 100");
-      return false;
-    }
-    blower_control_set_manual_pwm_percent((uint8_t)value);
-    debug_logs_append("CMD PWM updated");
-  } else if (strcmp(request->path, "/api/led") == 0) {
-    if (value != 0 && value != 1) {
-      http_send_text_response(connection, "400 Bad Request", "text/plain",
-                              "LED value must be 0 or 1");
-      return false;
-    }
-    blower_control_set_auto_hold_enabled(value == 1);
-    debug_logs_append(value == 1 ? "CMD AUTO_HOLD ON" : "CMD AUTO_HOLD OFF");
-  } else if (strcmp(request->path, "/api/relay") == 0) {
-    if (value != 0 && value != 1) {
-      http_send_text_response(connection, "400 Bad Request", "text/plain",
-                              "Relay value must be 0 or 1");
-      return false;
-    }
-    blower_control_set_relay_enabled(value == 1);
-    debug_logs_append(value == 1 ? "CMD RELAY ON" : "CMD RELAY OFF");
-  } else {
-    http_send_text_response(connection, "404 Not Found", "text/plain",
-                            "Not Found");
+  error = web_apply_command(request->route, value);
+  if (error != NULL) {
+    http_send_text_response(connection, "400 Bad Request", "text/plain", error);
     return false;
   }
 
@@ -1487,10 +2985,293 @@ static bool http_handle_api_post_route(struct netconn *connection,
   return false;
 }
 
-static bool http_handle_debug_route(struct netconn *connection,
+static const struct {
+  const char *name;
+  http_route_t route;
+} k_ws_commands[] = {
+    {"pwm", HTTP_ROUTE_PWM},
+    {"led", HTTP_ROUTE_LED},
+    {"relay", HTTP_ROUTE_RELAY},
+};
+
+static bool ws_send_control(struct netconn *connection, uint8_t opcode,
+                            const uint8_t *payload, size_t length) {
+  uint8_t frame[2u + WEBSOCKET_MAX_CONTROL_BYTES];
+  const size_t header_length = websocket_frame_header(frame, true, opcode, length);
+
+  memcpy(frame + header_length, payload, length);
+  return netconn_write(connection, frame, header_length + length, NETCONN_COPY) == ERR_OK;
+}
+
+static void ws_send_close(struct netconn *connection, uint16_t code) {
+  const uint8_t payload[2] = {(uint8_t)(code >> 8), (uint8_t)code};
+
+  (void)ws_send_control(connection, WEBSOCKET_OPCODE_CLOSE, payload, sizeof(payload));
+}
+
+static bool ws_send_status(ws_session_t *session, http_stream_writer_t *stream,
+                           const web_status_snapshot_t *status) {
+  if (session->protocol == WS_PROTOCOL_BINARY) {
+    uint8_t frame[WEB_STATUS_FRAME_MAX_BYTES];
+    const size_t length =
+        web_write_status_frame(frame, sizeof(frame), ++session->tx_seq, status);
+
+    http_stream_begin_websocket(stream, session->connection, WEBSOCKET_OPCODE_BINARY);
+    return length > 0u && http_stream_write(stream, (const char *)frame, length) &&
+           http_stream_end(stream);
+  }
+
+  http_stream_begin_websocket(stream, session->connection, WEBSOCKET_OPCODE_TEXT);
+  return http_stream_printf(stream, "{\"type\":\"status\",\"seq\":%lu,\"data\":",
+                            (unsigned long)++session->tx_seq) &&
+         web_write_status_json(stream, status) && http_stream_puts(stream, "}") &&
+         http_stream_end(stream);
+}
+
+// {"seq":N,"cmd":"pwm"|"led"|"relay","value":V} is applied right away and
+// answered with {"type":"ack","seq":M,"ack":N,"status":"ok"|"error",...};
+// the next status message follows without waiting for the poll interval.
+static bool ws_handle_command(ws_session_t *session, http_stream_writer_t *stream,
+                              const uint8_t *payload, size_t length) {
+  char message[WEBSOCKET_MAX_MESSAGE_BYTES + 1u];
+  char command[16];
+  uint32_t command_seq = 0u;
+  int value = 0;
+  const char *error = "Unknown command";
+  size_t index = 0u;
+  bool written = false;
+
+  memcpy(message, payload, length);
+  message[length] = '\0';
+  (void)json_extract_uint32_field(message, "seq", &command_seq);
+  if (!json_extract_string_field(message, "cmd", command, sizeof(command)) ||
+      !json_extract_int_field(message, "value", &value)) {
+    error = "Invalid command message";
+  } else {
+    for (index = 0u; index < sizeof(k_ws_commands) / sizeof(k_ws_commands[0]); ++index) {
+      if (strcmp(command, k_ws_commands[index].name) == 0) {
+        error = web_apply_command(k_ws_commands[index].route, value);
+        break;
+      }
+    }
+  }
+  session->status_due = session->status_due || error == NULL;
+
+  http_stream_begin_websocket(stream, session->connection, WEBSOCKET_OPCODE_TEXT);
+  written = http_stream_printf(stream,
+                               "{\"type\":\"ack\",\"seq\":%lu,\"ack\":%lu,\"status\":\"%s\"",
+                               (unsigned long)++session->tx_seq,
+                               (unsigned long)command_seq, error == NULL ? "ok" : "error");
+  if (error == NULL) {
+    written = written && http_stream_printf(stream, ",\"value\":%d}", value);
+  } else {
+    written = written && http_stream_puts(stream, ",\"reason\":") &&
+              http_stream_json_string(stream, error) && http_stream_puts(stream, "}");
+  }
+  return written && http_stream_end(stream);
+}
+
+// Returns false when the session is over. *close_code is the status to close
+// with, or 0 when the connection is already unusable.
+static bool ws_handle_message(ws_session_t *session, http_stream_writer_t *stream,
+                              uint16_t *close_code) {
+  const websocket_parser_t *parser = &session->parser;
+
+  *close_code = 0u;
+  switch (parser->opcode) {
+    case WEBSOCKET_OPCODE_PING:
+      return ws_send_control(session->connection, WEBSOCKET_OPCODE_PONG,
+                             parser->payload, parser->payload_length);
+    case WEBSOCKET_OPCODE_PONG:
+      return true;
+    case WEBSOCKET_OPCODE_CLOSE:
+      *close_code = parser->close_code != 0u ? parser->close_code : WEBSOCKET_CLOSE_NORMAL;
+      return false;
+    case WEBSOCKET_OPCODE_TEXT:
+      return ws_handle_command(session, stream, parser->payload, parser->payload_length);
+    default:
+      *close_code = WEBSOCKET_CLOSE_UNSUPPORTED_DATA;
+      return false;
+  }
+}
+
+static bool ws_receive(ws_session_t *session, http_stream_writer_t *stream,
+                       const struct netbuf *netbuf, uint16_t *close_code) {
+  const struct pbuf *segment = NULL;
+
+  for (segment = netbuf->p; segment != NULL; segment = segment->next) {
+    const uint8_t *data = (const uint8_t *)segment->payload;
+    size_t remaining = segment->len;
+
+    while (remaining > 0u) {
+      const size_t consumed = websocket_parser_feed(&session->parser, data, remaining);
+
+      data += consumed;
+      remaining -= consumed;
+      if (session->parser.state == WEBSOCKET_PARSER_ERROR) {
+        *close_code = session->parser.close_code;
+        return false;
+      }
+      if (session->parser.state == WEBSOCKET_PARSER_MESSAGE) {
+        if (!ws_handle_message(session, stream, close_code)) {
+          return false;
+        }
+        websocket_parser_next(&session->parser);
+      }
+    }
+  }
+
+  return true;
+}
+
+static void ws_session_task(void *params) {
+  ws_session_t *session = (ws_session_t *)params;
+  struct netconn *connection = session->connection;
+  http_stream_writer_t stream;
+  const char *close_reason = "closed";
+  uint16_t close_code = WEBSOCKET_CLOSE_NORMAL;
+
+  netconn_set_recvtimeout(connection, (int)WS_RECEIVE_POLL_MS);
+  printf("[WS] opened\n");
+
+  while (1) {
+    struct netbuf *netbuf = NULL;
+    const err_t status = netconn_recv(connection, &netbuf);
+    uint32_t now_ms = 0u;
+
+    if (status == ERR_OK && netbuf != NULL) {
+      const bool open = ws_receive(session, &stream, netbuf, &close_code);
+
+      netbuf_delete(netbuf);
+      if (!open) {
+        close_reason = close_code != 0u ? "closed" : "write_fail";
+        break;
+      }
+    } else if (status != ERR_TIMEOUT) {
+      close_reason = "peer_gone";
+      close_code = 0u;
+      break;
+    }
+
+    now_ms = to_ms_since_boot(get_absolute_time());
+    if (!session->status_due && (now_ms - session->last_poll_ms) < SSE_LOOP_INTERVAL_MS) {
+      continue;
+    }
+    session->last_poll_ms = now_ms;
+
+    {
+      web_status_snapshot_t status_snapshot = {0};
+      const bool has_status = web_collect_status_snapshot(&status_snapshot);
+
+      if (has_status &&
+          (session->status_due || !session->has_last_status ||
+           web_status_changed(&status_snapshot, &session->last_status) ||
+           (now_ms - session->last_emit_ms) >= SSE_FORCE_PUBLISH_INTERVAL_MS)) {
+        if (!ws_send_status(session, &stream, &status_snapshot)) {
+          close_reason = "write_fail";
+          close_code = 0u;
+          break;
+        }
+        session->last_status = status_snapshot;
+        session->has_last_status = true;
+        session->last_emit_ms = now_ms;
+      }
+      session->status_due = false;
+    }
+  }
+
+  if (close_code != 0u) {
+    ws_send_close(connection, close_code);
+  }
+  netconn_close(connection);
+  netconn_delete(connection);
+  printf("[WS] closed reason=%s sent=%lu\n", close_reason,
+         (unsigned long)session->tx_seq);
+  debug_logs_append("WS closed");
+  web_stream_slot_release(&g_ws_slot);
+  vPortFree(session);
+  vTaskDelete(NULL);
+}
+
+// GET /ws with Upgrade: websocket. The worker answers the handshake and then
+// hands the connection to a task of its own.
+static bool http_start_websocket(http_connection_t *connection,
+                                 const http_request_t *request) {
+  static const char k_upgrade_required[] = "WebSocket upgrade required";
+  char accept[WEBSOCKET_ACCEPT_KEY_LENGTH + 1u];
+  char protocol_header[48] = "";
+  char response[208];
+  ws_session_t *session = NULL;
+  int written = 0;
+
+  if (!request->websocket_upgrade || request->websocket_version != 13u ||
+      !websocket_accept_key(request->websocket_key, strlen(request->websocket_key),
+                            accept)) {
+    http_send_body(connection, "426 Upgrade Required", "text/plain",
+                   "Upgrade: websocket\r\nSec-WebSocket-Version: 13\r\n",
+                   (const uint8_t *)k_upgrade_required, sizeof(k_upgrade_required) - 1u,
+                   NETCONN_COPY);
+    return false;
+  }
+
+  if (!web_stream_slot_claim(&g_ws_slot)) {
+    printf("[WS] reject reason=busy\n");
+    http_send_text_response(connection, "503 Service Unavailable", "text/plain",
+                            "WebSocket busy");
+    return false;
+  }
+
+  session = (ws_session_t *)pvPortMalloc(sizeof(*session));
+  if (session == NULL) {
+    web_stream_slot_release(&g_ws_slot);
+    http_send_text_response(connection, "500 Internal Server Error", "text/plain",
+                            "WebSocket allocation failed");
+    return false;
+  }
+  *session = (ws_session_t){
+      .connection = connection->netconn,
+      .protocol = request->websocket_protocol,
+      .has_last_status = false,
+      .status_due = true,
+      .last_emit_ms = 0u,
+      .last_poll_ms = 0u,
+      .tx_seq = 0u,
+  };
+  websocket_parser_init(&session->parser);
+
+  if (session->protocol != WS_PROTOCOL_NONE) {
+    (void)snprintf(protocol_header, sizeof(protocol_header),
+                   "Sec-WebSocket-Protocol: %s\r\n",
+                   k_ws_protocol_names[session->protocol]);
+  }
+  written = snprintf(response, sizeof(response),
+                     "HTTP/1.1 101 Switching Protocols\r\n"
+                     "Upgrade: websocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: %s\r\n"
+                     "%s"
+                     "\r\n",
+                     accept, protocol_header);
+  if (written <= 0 || (size_t)written >= sizeof(response) ||
+      netconn_write(connection->netconn, response, (size_t)written, NETCONN_COPY) !=
+          ERR_OK ||
+      xTaskCreate(ws_session_task, "WSTask", 2048u, session, APP_WIFI_TASK_PRIORITY,
+                  NULL) != pdPASS) {
+    web_stream_slot_release(&g_ws_slot);
+    vPortFree(session);
+    connection->keep_alive = false;
+    return false;
+  }
+
+  debug_logs_append("WS opened");
+  printf("[WS] task_started\n");
+  return true;
+}
+
+static bool http_handle_debug_route(http_connection_t *connection,
                                     const http_request_t *request) {
 #if APP_ENABLE_DEBUG_HTTP_ROUTES
-  if (strcmp(request->path, "/debug/stream") == 0 &&
+  if (request->route == HTTP_ROUTE_DEBUG_STREAM &&
       request->method == HTTP_METHOD_POST) {
     bool enabled = false;
     char payload[64];
@@ -1522,7 +3303,7 @@ static bool http_handle_debug_route(struct netconn *connection,
     return false;
   }
 
-  if (strcmp(request->path, "/debug/stream") == 0 &&
+  if (request->route == HTTP_ROUTE_DEBUG_STREAM &&
       request->method == HTTP_METHOD_GET) {
     const bool enabled = debug_logs_enabled_get();
     char payload[64];
@@ -1539,7 +3320,7 @@ static bool http_handle_debug_route(struct netconn *connection,
     return false;
   }
 
-  if (strcmp(request->path, "/debug/clear") == 0 &&
+  if (request->route == HTTP_ROUTE_DEBUG_CLEAR &&
       request->method == HTTP_METHOD_POST) {
     static const char k_ok_payload[] =
         "{\"status\":\"ok\",\"message\":\"Debug buffer cleared\"}";
@@ -1549,7 +3330,7 @@ static bool http_handle_debug_route(struct netconn *connection,
     return false;
   }
 
-  if (strcmp(request->path, "/debug/logs") == 0 &&
+  if (request->route == HTTP_ROUTE_DEBUG_LOGS &&
       request->method == HTTP_METHOD_GET) {
     char logs[DEBUG_LOG_BUFFER_SIZE];
     debug_logs_copy(logs, sizeof(logs));
@@ -1567,16 +3348,12 @@ static bool http_handle_debug_route(struct netconn *connection,
 #endif
 }
 
-static bool http_handle_ota_status_route(struct netconn *connection,
+static bool http_handle_ota_status_route(http_connection_t *connection,
                                          const http_request_t *request) {
+  http_stream_writer_t stream;
   ota_update_status_t status = {0};
-  char firmware_version_escaped[96];
-  char staged_version_escaped[(OTA_UPDATE_VERSION_LABEL_MAX_LEN * 2u) + 1u];
-  char last_error_escaped[(OTA_UPDATE_ERROR_TEXT_MAX_LEN * 2u) + 1u];
-  char payload[HTTP_RESPONSE_PAYLOAD_BUFFER_SIZE];
-  const char *firmware_version = ota_update_service_get_firmware_version();
   uint32_t progress_percent = 0u;
-  int written = 0;
+  bool body_ok = false;
 
   ota_update_service_get_status(&status);
   progress_percent = status.expected_size_bytes == 0u
@@ -1584,47 +3361,250 @@ static bool http_handle_ota_status_route(struct netconn *connection,
                          : (status.received_size_bytes * 100u) /
                                status.expected_size_bytes;
 
-  if (!json_escape_string(firmware_version, firmware_version_escaped,
-                          sizeof(firmware_version_escaped)) ||
-      !json_escape_string(status.staged_version, staged_version_escaped,
-                          sizeof(staged_version_escaped)) ||
-      !json_escape_string(status.last_error, last_error_escaped,
-                          sizeof(last_error_escaped))) {
-    http_send_text_response(connection, "500 Internal Server Error",
-                            "application/json", "{\"error\":\"ota_status\"}");
-    return false;
-  }
-
-  written = snprintf(
-      payload, sizeof(payload),
-      "{\"firmware_version\":\"%s\",\"state\":\"%s\","
-      "\"expected_size\":%lu,\"received_size\":%lu,\"progress_percent\":%lu,"
-      "\"expected_crc32\":%lu,\"computed_crc32\":%lu,\"staged_version\":\"%s\","
-      "\"apply_task_active\":%s,\"last_error\":\"%s\"}",
-      firmware_version_escaped, ota_update_service_state_name(status.state),
-      (unsigned long)status.expected_size_bytes,
-      (unsigned long)status.received_size_bytes, (unsigned long)progress_percent,
-      (unsigned long)status.expected_crc32, (unsigned long)status.computed_crc32,
-      staged_version_escaped, status.apply_task_active ? "true" : "false",
-      last_error_escaped);
-  if (written <= 0 || (size_t)written >= sizeof(payload)) {
-    http_send_text_response(connection, "500 Internal Server Error",
-                            "application/json", "{\"error\":\"ota_payload\"}");
+  body_ok =
+      http_begin_json_stream(&stream, connection, request) &&
+      http_stream_puts(&stream, "{\"firmware_version\":") &&
+      http_stream_json_string(&stream, ota_update_service_get_firmware_version()) &&
+      http_stream_printf(
+          &stream,
+          ",\"state\":\"%s\",\"expected_size\":%lu,\"received_size\":%lu,"
+          "\"progress_percent\":%lu,\"expected_crc32\":%lu,"
+          "\"computed_crc32\":%lu,\"staged_version\":",
+          ota_update_service_state_name(status.state),
+          (unsigned long)status.expected_size_bytes,
+          (unsigned long)status.received_size_bytes, (unsigned long)progress_percent,
+          (unsigned long)status.expected_crc32,
+          (unsigned long)status.computed_crc32) &&
+      http_stream_json_string(&stream, status.staged_version) &&
+      http_stream_printf(&stream, ",\"apply_task_active\":%s,\"last_error\":",
+                         status.apply_task_active ? "true" : "false") &&
+      http_stream_json_string(&stream, status.last_error) &&
+      http_stream_puts(&stream, "}");
+  http_end_stream(connection, &stream, body_ok);
+  return false;
+}
+
+static bool http_handle_dimmer_diag_route(http_connection_t *connection,
+                                          const http_request_t *request) {
+  http_stream_writer_t stream;
+  shared_dimmer_health_t health;
+  dimmer_control_actuation_t actuation;
+  blower_control_snapshot_t control_snapshot = {0};
+  flash_writer_stats_t flash_stats;
+  bool body_ok = false;
+
+  shared_dimmer_get_health(&health);
+  dimmer_control_get_actuation(&actuation);
+  blower_control_get_snapshot(&control_snapshot);
+  flash_writer_get_stats(&flash_stats);
+
+  body_ok =
+      http_begin_json_stream(&stream, connection, request) &&
+      http_stream_printf(
+          &stream,
+          "{\"timing_core\":\"%s\",\"zero_cross_count\":%lu,"
+          "\"gate_pulse_count\":%lu,\"missed_alarm_count\":%lu,"
+          "\"fire_latency_last_us\":%lu,\"fire_latency_max_us\":%lu,"
+          "\"fire_latency_avg_us\":%.2f,\"line_sync\":%s,\"pll_locked\":%s,"
+          "\"frequency\":%.3f,\"phase_error_us\":%.1f,",
+          APP_DIMMER_ON_CORE1 ? "core1" : "core0",
+          (unsigned long)health.zero_cross_count,
+          (unsigned long)health.gate_pulse_count,
+          (unsigned long)health.missed_alarm_count,
+          (unsigned long)health.fire_latency_last_us,
+          (unsigned long)health.fire_latency_max_us,
+          health.gate_pulse_count == 0u
+             ? 0.0
+             : (double)health.fire_latency_total_us /
+                   (double)health.gate_pulse_count,
+          control_snapshot.line_sync ? "true" : "false",
+          control_snapshot.line_pll_locked ? "true" : "false",
+          safe_json_float(control_snapshot.line_frequency_hz),
+          safe_json_float(control_snapshot.line_phase_error_us)) &&
+      http_stream_printf(
+          &stream,
+          "\"submitted_sequence\":%lu,\"command_sequence\":%lu,"
+          "\"power_percent\":%u,\"half_cycle_sequence\":%lu,"
+          "\"fire_delay_us\":%lu,\"command_latency_last_us\":%lu,"
+          "\"command_latency_max_us\":%lu,\"asymmetric_cycle_count\":%lu,"
+          "\"last_asymmetry_us\":%ld,\"blanked_half_cycle_count\":%lu,",
+          (unsigned long)actuation.submitted_sequence,
+          (unsigned long)actuation.command_sequence, (unsigned)actuation.power_percent,
+          (unsigned long)actuation.half_cycle_sequence,
+          (unsigned long)actuation.fire_delay_us,
+          (unsigned long)actuation.command_latency_last_us,
+          (unsigned long)actuation.command_latency_max_us,
+          (unsigned long)actuation.asymmetric_cycle_count,
+          (long)actuation.last_asymmetry_us,
+          (unsigned long)health.blanked_half_cycle_count) &&
+      http_stream_printf(
+          &stream,
+          "\"flash\":{\"erases\":%lu,\"pages\":%lu,\"failed\":%lu,"
+          "\"window_waits\":%lu,\"forced\":%lu,\"erase_refused\":%lu,"
+          "\"lockout_last_us\":%lu,\"lockout_max_us\":%lu,\"missed_alarm_count\":%lu}}",
+          (unsigned long)flash_stats.erase_count,
+          (unsigned long)flash_stats.program_count,
+          (unsigned long)flash_stats.failed_count,
+          (unsigned long)flash_stats.window_wait_count,
+          (unsigned long)flash_stats.forced_count,
+          (unsigned long)flash_stats.erase_refused_count,
+          (unsigned long)flash_stats.lockout_last_us,
+          (unsigned long)flash_stats.lockout_max_us,
+          (unsigned long)flash_stats.missed_alarm_count);
+  http_end_stream(connection, &stream, body_ok);
+  return false;
+}
+
+static bool http_write_trace_histogram(http_stream_writer_t *stream,
+                                       const dimmer_trace_histogram_t *histogram,
+                                       uint32_t bin_unit) {
+  uint32_t index = 0u;
+
+  if (!http_stream_printf(
+          stream, "{\"count\":%lu,\"max\":%lu,\"avg\":%.2f,\"bin_unit\":%lu,\"bins\":[",
+          (unsigned long)histogram->count, (unsigned long)histogram->max,
+          histogram->count == 0u ? 0.0
+                                 : (double)histogram->total / (double)histogram->count,
+          (unsigned long)bin_unit)) {
     return false;
   }
 
-  if (request->method == HTTP_METHOD_HEAD) {
-    http_send_headers_only(connection, "200 OK", "application/json",
-                           strlen(payload));
-    return false;
+  for (index = 0u; index < DIMMER_TRACE_BIN_COUNT; ++index) {
+    if (!http_stream_printf(stream, "%s%lu", index == 0u ? "" : ",",
+                            (unsigned long)histogram->bins[index])) {
+      return false;
+    }
   }
 
-  http_send_response(connection, "200 OK", "application/json",
-                     (const uint8_t *)payload, strlen(payload));
+  return http_stream_puts(stream, "]}");
+}
+
+static bool http_handle_dimmer_trace_route(http_connection_t *connection,
+                                           const http_request_t *request) {
+  http_stream_writer_t stream;
+  dimmer_trace_snapshot_t trace;
+  bool body_ok = false;
+
+  if (request->method == HTTP_METHOD_POST) {
+    dimmer_trace_request_reset();
+    http_send_text_response(connection, "202 Accepted", "application/json",
+                            "{\"status\":\"reset_requested\"}");
+    return false;
+  }
+
+  dimmer_trace_get_snapshot(&trace);
+  body_ok =
+      http_begin_json_stream(&stream, connection, request) &&
+      http_stream_printf(
+          &stream,
+          "{\"timing_core\":\"%s\",\"cpu_hz\":%lu,\"resets\":%lu,"
+          "\"late_threshold_us\":%lu,\"early_pulses\":%lu,\"late_pulses\":%lu,"
+          "\"missed_pulses\":%lu,\"edge_latency_us\":",
+          APP_DIMMER_ON_CORE1 ? "core1" : "core0", (unsigned long)trace.cpu_hz,
+          (unsigned long)trace.reset_count, (unsigned long)APP_DIMMER_TRACE_LATE_US,
+          (unsigned long)trace.early_pulse_count,
+          (unsigned long)trace.late_pulse_count,
+          (unsigned long)trace.missed_pulse_count) &&
+      http_write_trace_histogram(&stream, &trace.edge_latency_us, 1u) &&
+      http_stream_puts(&stream, ",\"zero_cross_isr_cycles\":") &&
+      http_write_trace_histogram(&stream, &trace.zero_cross_isr_cycles,
+                                 1u << DIMMER_TRACE_CYCLE_BIN_SHIFT) &&
+      http_stream_puts(&stream, ",\"fire_error_us\":") &&
+      http_write_trace_histogram(&stream, &trace.fire_error_us, 1u) &&
+      http_stream_puts(&stream, "}");
+  http_end_stream(connection, &stream, body_ok);
+  return false;
+}
+
+static bool http_write_lwip_mem_stats(http_stream_writer_t *stream, const char *name,
+                                      const struct stats_mem *mem) {
+  return http_stream_printf(
+      stream, "\"%s\":{\"avail\":%lu,\"used\":%lu,\"max\":%lu,\"errors\":%lu}", name,
+      (unsigned long)mem->avail, (unsigned long)mem->used, (unsigned long)mem->max,
+      (unsigned long)mem->err);
+}
+
+// SSE hub cost: render once per frame, then fan-out per delivered frame.
+// per_client_us is what one more subscriber adds to a frame.
+static bool http_write_sse_hub_stats(http_stream_writer_t *stream,
+                                     const sse_hub_stats_t *stats, uint8_t clients) {
+  const uint32_t frames = stats->frames > 0u ? stats->frames : 1u;
+  const uint32_t deliveries = stats->deliveries > 0u ? stats->deliveries : 1u;
+
+  return http_stream_printf(
+      stream,
+      "\"sse\":{\"clients\":%u,\"max_clients\":%u,\"backlog_frames\":%u,"
+      "\"frames\":%lu,\"deliveries\":%lu,\"render_us_avg\":%lu,\"render_us_max\":%lu,"
+      "\"fanout_us_avg\":%lu,\"fanout_us_max\":%lu,\"per_client_us\":%lu,"
+      "\"dropped_slow\":%lu,\"dropped_closed\":%lu,\"deferred\":%lu,\"rejected\":%lu}",
+      (unsigned)clients, (unsigned)APP_SSE_MAX_CLIENTS, (unsigned)APP_SSE_BACKLOG_FRAMES,
+      (unsigned long)stats->frames, (unsigned long)stats->deliveries,
+      (unsigned long)(stats->render_us_total / frames),
+      (unsigned long)stats->render_us_max,
+      (unsigned long)(stats->fanout_us_total / frames),
+      (unsigned long)stats->fanout_us_max,
+      (unsigned long)(stats->fanout_us_total / deliveries),
+      (unsigned long)stats->dropped_slow, (unsigned long)stats->dropped_closed,
+      (unsigned long)stats->deferred, (unsigned long)stats->rejected);
+}
+
+// lwIP heap and the pools that hold outgoing TCP data: PBUF_RAM copies come
+// from the heap, flash references from the pbuf pool. "max" is the high-water
+// mark since boot or the last reset.
+static bool http_handle_net_diag_route(http_connection_t *connection,
+                                       const http_request_t *request) {
+  http_stream_writer_t stream;
+  struct stats_mem heap;
+  struct stats_mem pbuf_ref;
+  struct stats_mem tcp_seg;
+  sse_hub_stats_t sse_stats;
+  uint8_t sse_clients = 0u;
+  bool body_ok = false;
+
+  if (request->method == HTTP_METHOD_POST) {
+    LOCK_TCPIP_CORE();
+    lwip_stats.mem.max = lwip_stats.mem.used;
+    lwip_stats.mem.err = 0u;
+    lwip_stats.memp[MEMP_PBUF]->max = lwip_stats.memp[MEMP_PBUF]->used;
+    lwip_stats.memp[MEMP_PBUF]->err = 0u;
+    lwip_stats.memp[MEMP_TCP_SEG]->max = lwip_stats.memp[MEMP_TCP_SEG]->used;
+    lwip_stats.memp[MEMP_TCP_SEG]->err = 0u;
+    UNLOCK_TCPIP_CORE();
+    xSemaphoreTake(g_sse_hub.mutex, portMAX_DELAY);
+    g_sse_hub.stats = (sse_hub_stats_t){0};
+    xSemaphoreGive(g_sse_hub.mutex);
+    http_send_text_response(connection, "200 OK", "application/json",
+                            "{\"status\":\"ok\"}");
+    return false;
+  }
+
+  LOCK_TCPIP_CORE();
+  heap = lwip_stats.mem;
+  pbuf_ref = *lwip_stats.memp[MEMP_PBUF];
+  tcp_seg = *lwip_stats.memp[MEMP_TCP_SEG];
+  UNLOCK_TCPIP_CORE();
+  xSemaphoreTake(g_sse_hub.mutex, portMAX_DELAY);
+  sse_stats = g_sse_hub.stats;
+  sse_clients = g_sse_hub.subscriber_count;
+  xSemaphoreGive(g_sse_hub.mutex);
+
+  body_ok = http_begin_json_stream(&stream, connection, request) &&
+            http_stream_printf(&stream, "{\"asset_zero_copy\":%s,\"tcp_mss\":%u,",
+                               APP_HTTP_ASSET_ZERO_COPY ? "true" : "false",
+                               (unsigned)TCP_MSS) &&
+            http_write_lwip_mem_stats(&stream, "heap", &heap) &&
+            http_stream_puts(&stream, ",") &&
+            http_write_lwip_mem_stats(&stream, "pbuf_ref", &pbuf_ref) &&
+            http_stream_puts(&stream, ",") &&
+            http_write_lwip_mem_stats(&stream, "tcp_seg", &tcp_seg) &&
+            http_stream_puts(&stream, ",") &&
+            http_write_sse_hub_stats(&stream, &sse_stats, sse_clients) &&
+            http_stream_puts(&stream, "}");
+  http_end_stream(connection, &stream, body_ok);
   return false;
 }
 
-static void http_send_ota_result_response(struct netconn *connection,
+static void http_send_ota_result_response(http_connection_t *connection,
                                           const char *status_line,
                                           ota_update_result_t result) {
   char payload[128];
@@ -1641,17 +3621,17 @@ static void http_send_ota_result_response(struct netconn *connection,
                      (const uint8_t *)payload, strlen(payload));
 }
 
-static bool http_handle_ota_post_route(struct netconn *connection,
-                                       const http_request_t *request) {
+static bool http_handle_ota_post_route(http_connection_t *connection,
+                                       const http_request_t *request,
+                                       const http_ota_chunk_t *chunk) {
   ota_update_result_t result = OTA_UPDATE_RESULT_INVALID_ARGUMENT;
 
   if (request->method != HTTP_METHOD_POST) {
-    http_send_text_response(connection, "405 Method Not Allowed", "text/plain",
-                            "Method Not Allowed");
+    http_send_method_not_allowed(connection, request);
     return false;
   }
 
-  if (strcmp(request->path, "/api/ota/begin") == 0) {
+  if (request->route == HTTP_ROUTE_OTA_BEGIN) {
     uint32_t image_size = 0u;
     uint32_t expected_crc32 = 0u;
     char version_label[OTA_UPDATE_VERSION_LABEL_MAX_LEN];
@@ -1679,30 +3659,24 @@ static bool http_handle_ota_post_route(struct netconn *connection,
     return false;
   }
 
-  if (strcmp(request->path, "/api/ota/chunk") == 0) {
+  if (request->route == HTTP_ROUTE_OTA_CHUNK) {
     uint32_t offset = 0u;
-    char encoded_chunk[HTTP_MAX_BODY_SIZE + 1u];
-    size_t decoded_size = 0u;
 
-    if (!json_extract_uint32_field(request->body, "offset", &offset) ||
-        !json_extract_string_field(request->body, "data", encoded_chunk,
-                                   sizeof(encoded_chunk))) {
+    if (!json_extract_uint32_field(chunk->fields, "offset", &offset) ||
+        !chunk->has_data) {
       http_send_text_response(connection, "400 Bad Request", "text/plain",
                               "Missing offset or data");
       return false;
     }
 
-    if (!base64_decode_payload(encoded_chunk, g_ota_decoded_chunk_buffer,
-                               sizeof(g_ota_decoded_chunk_buffer),
-                               &decoded_size) ||
-        decoded_size == 0u) {
+    if (!http_ota_chunk_finish(chunk) || chunk->base64.length == 0u) {
       http_send_text_response(connection, "400 Bad Request", "text/plain",
                               "Invalid base64 chunk");
       return false;
     }
 
-    result = ota_update_service_write_chunk(offset, g_ota_decoded_chunk_buffer,
-                                            decoded_size);
+    result = ota_update_service_write_chunk(offset, chunk->decoded,
+                                            chunk->base64.length);
     if (result == OTA_UPDATE_RESULT_OK) {
       http_send_ota_result_response(connection, "200 OK", result);
       return false;
@@ -1712,7 +3686,7 @@ static bool http_handle_ota_post_route(struct netconn *connection,
     return false;
   }
 
-  if (strcmp(request->path, "/api/ota/finish") == 0) {
+  if (request->route == HTTP_ROUTE_OTA_FINISH) {
     result = ota_update_service_finish();
     if (result == OTA_UPDATE_RESULT_OK) {
       http_send_ota_result_response(connection, "200 OK", result);
@@ -1723,7 +3697,7 @@ static bool http_handle_ota_post_route(struct netconn *connection,
     return false;
   }
 
-  if (strcmp(request->path, "/api/ota/apply") == 0) {
+  if (request->route == HTTP_ROUTE_OTA_APPLY) {
     result = ota_update_service_request_apply_async();
     if (result == OTA_UPDATE_RESULT_OK) {
       http_send_ota_result_response(connection, "202 Accepted", result);
@@ -1738,131 +3712,238 @@ static bool http_handle_ota_post_route(struct netconn *connection,
   return false;
 }
 
-static bool http_path_equals_any(const char *path, const char *const *candidates,
-                                 size_t candidates_count) {
-  size_t index = 0u;
+// Runs once the whole image has been written.
+static bool http_handle_ota_upload_route(http_connection_t *connection) {
+  ota_update_result_t result = ota_update_service_finish();
 
-  if (path == NULL || candidates == NULL) {
+  if (result == OTA_UPDATE_RESULT_OK) {
+    debug_logs_append("CMD OTA UPLOAD");
+    http_send_ota_result_response(connection, "200 OK", result);
     return false;
   }
 
-  for (index = 0u; index < candidates_count; ++index) {
-    if (strcmp(path, candidates[index]) == 0) {
-      return true;
-    }
-  }
-
+  http_send_ota_result_response(connection, "400 Bad Request", result);
   return false;
 }
 
-static bool http_server_serve_connection(struct netconn *connection) {
-  http_request_t request;
-  static const char *const k_control_post_routes[] = {"/api/pwm", "/api/led",
-                                                       "/api/relay",
-                                                       "/api/calibrate"};
-  static const char *const k_ota_post_routes[] = {"/api/ota/begin",
-                                                   "/api/ota/chunk",
-                                                   "/api/ota/finish",
-                                                   "/api/ota/apply"};
-  bool method_is_get_or_head = false;
-
-  if (!http_parse_request(connection, &request)) {
-    http_send_text_response(connection, "400 Bad Request", "text/plain",
-                            "Bad Request");
-    netconn_close(connection);
-    return false;
-  }
-
-  method_is_get_or_head = request.method == HTTP_METHOD_GET ||
-                          request.method == HTTP_METHOD_HEAD;
+// A rejected or broken upload is answered with the OTA result and ends the
+// session, so the next attempt can begin.
+static void http_send_ota_upload_failure(http_connection_t *connection,
+                                         const http_ota_upload_t *upload) {
+  if (upload->begun) {
+    ota_update_service_abort("upload_aborted");
+  }
+  http_send_ota_result_response(
+      connection,
+      upload->result == OTA_UPDATE_RESULT_BUSY ? "409 Conflict" : "400 Bad Request",
+      upload->result == OTA_UPDATE_RESULT_OK ? OTA_UPDATE_RESULT_INVALID_STATE
+                                             : upload->result);
+}
 
-  if (strcmp(request.path, "/favicon.ico") == 0) {
-    http_send_headers_only(connection, "204 No Content", "image/x-icon", 0u);
-    netconn_close(connection);
-    return false;
+static uint8_t http_route_method_bit(http_method_t method) {
+  switch (method) {
+    case HTTP_METHOD_GET:
+      return WEB_ROUTE_METHOD_GET;
+    case HTTP_METHOD_HEAD:
+      return WEB_ROUTE_METHOD_HEAD;
+    case HTTP_METHOD_POST:
+      return WEB_ROUTE_METHOD_POST;
+    default:
+      return WEB_ROUTE_METHOD_OTHER;
   }
+}
 
-  if (method_is_get_or_head && strcmp(request.path, "/api/status") == 0) {
-    (void)http_handle_status_route(connection, &request);
-    netconn_close(connection);
+// Routes come from the generated path table (src/tasks/http_routes.txt plus
+// the embedded assets): one perfect-hash lookup, then a switch on the id.
+static bool http_server_serve_request(http_worker_t *worker) {
+  http_connection_t *connection = &worker->connection;
+  http_request_t *request = &worker->request;
+  const web_route_t *route = NULL;
+
+  if (!http_parse_request(worker)) {
+    connection->keep_alive = false;
+    if (request->body_streamed && request->route == HTTP_ROUTE_OTA_UPLOAD) {
+      http_send_ota_upload_failure(connection, &worker->ota_upload);
+    } else if (connection->parser.error == HTTP_REQUEST_PARSER_ERROR_NOT_IMPLEMENTED) {
+      http_send_text_response(connection, "501 Not Implemented", "text/plain",
+                              "Transfer-Encoding not supported");
+    } else {
+      http_send_text_response(connection, "400 Bad Request", "text/plain",
+                              "Bad Request");
+    }
     return false;
   }
 
-  if (method_is_get_or_head && strcmp(request.path, "/api/ota/status") == 0) {
-    (void)http_handle_ota_status_route(connection, &request);
-    netconn_close(connection);
+  route = request->route_entry;
+  if (route == NULL) {
+    http_send_text_response(connection, "404 Not Found", "text/plain", "Not Found");
     return false;
   }
-
-  if (method_is_get_or_head &&
-      (strcmp(request.path, "/api/test/report") == 0 ||
-       strcmp(request.path, "/api/test/report/latest") == 0)) {
-    (void)http_handle_test_report_compat_route(connection, &request);
-    netconn_close(connection);
+  if ((route->methods & http_route_method_bit(request->method)) == 0u) {
+    http_send_method_not_allowed(connection, request);
     return false;
   }
 
-  if (request.method == HTTP_METHOD_POST &&
-      http_path_equals_any(request.path, k_control_post_routes,
-                           sizeof(k_control_post_routes) /
-                               sizeof(k_control_post_routes[0]))) {
-    (void)http_handle_api_post_route(connection, &request);
-    netconn_close(connection);
-    return false;
+  switch (request->route) {
+    case HTTP_ROUTE_FAVICON:
+      http_send_headers_only(connection, "204 No Content", "image/x-icon", 0u, "");
+      break;
+    case HTTP_ROUTE_STATUS:
+      (void)http_handle_status_route(connection, request);
+      break;
+    case HTTP_ROUTE_OTA_STATUS:
+      (void)http_handle_ota_status_route(connection, request);
+      break;
+    case HTTP_ROUTE_OTA_BEGIN:
+    case HTTP_ROUTE_OTA_CHUNK:
+    case HTTP_ROUTE_OTA_FINISH:
+    case HTTP_ROUTE_OTA_APPLY:
+      (void)http_handle_ota_post_route(connection, request, &worker->ota_chunk);
+      break;
+    case HTTP_ROUTE_OTA_UPLOAD:
+      (void)http_handle_ota_upload_route(connection);
+      break;
+    case HTTP_ROUTE_PWM:
+    case HTTP_ROUTE_LED:
+    case HTTP_ROUTE_RELAY:
+    case HTTP_ROUTE_CALIBRATE:
+      (void)http_handle_api_post_route(connection, request);
+      break;
+    case HTTP_ROUTE_DIMMER_DIAG:
+      (void)http_handle_dimmer_diag_route(connection, request);
+      break;
+    case HTTP_ROUTE_DIMMER_TRACE:
+    case HTTP_ROUTE_DIMMER_TRACE_RESET:
+      (void)http_handle_dimmer_trace_route(connection, request);
+      break;
+    case HTTP_ROUTE_NET_DIAG:
+    case HTTP_ROUTE_NET_DIAG_RESET:
+      (void)http_handle_net_diag_route(connection, request);
+      break;
+    case HTTP_ROUTE_TEST_STATUS:
+    case HTTP_ROUTE_TEST_CONFIG:
+    case HTTP_ROUTE_TEST_START:
+    case HTTP_ROUTE_TEST_STOP:
+      (void)http_handle_test_route(connection, request);
+      break;
+    case HTTP_ROUTE_TEST_REPORT:
+    case HTTP_ROUTE_TEST_REPORT_LATEST:
+    case HTTP_ROUTE_TEST_REANALYZE:
+      (void)http_handle_test_report_route(connection, request);
+      break;
+    case HTTP_ROUTE_TEST_REPORTS:
+      (void)http_handle_test_reports_route(connection, request);
+      break;
+    case HTTP_ROUTE_TEST_QUEUE:
+    case HTTP_ROUTE_TEST_QUEUE_START:
+    case HTTP_ROUTE_TEST_QUEUE_CLEAR:
+      (void)http_handle_test_queue_route(connection, request);
+      break;
+    case HTTP_ROUTE_DEBUG_STREAM:
+    case HTTP_ROUTE_DEBUG_CLEAR:
+    case HTTP_ROUTE_DEBUG_LOGS:
+      (void)http_handle_debug_route(connection, request);
+      break;
+    case HTTP_ROUTE_EVENTS:
+      return http_start_sse_stream(connection);
+    case HTTP_ROUTE_WS:
+      return http_start_websocket(connection, request);
+    case HTTP_ROUTE_NONE:
+    default:
+      if (route->asset != NULL) {
+        http_send_asset(connection, request, route->asset);
+      } else {
+        http_send_text_response(connection, "404 Not Found", "text/plain",
+                                "Not Found");
+      }
+      break;
   }
 
-  if (request.method == HTTP_METHOD_POST &&
-      http_path_equals_any(request.path, k_ota_post_routes,
-                           sizeof(k_ota_post_routes) /
-                               sizeof(k_ota_post_routes[0]))) {
-    (void)http_handle_ota_post_route(connection, &request);
-    netconn_close(connection);
+  return false;
+}
+
+// Serves requests on one connection until the client closes it, asks for
+// close, goes idle or reaches APP_HTTP_KEEPALIVE_MAX_REQUESTS. Returns true
+// when the connection was handed to the SSE hub or the WebSocket task.
+static bool http_server_serve_connection(http_worker_t *worker, struct netconn *netconn) {
+  http_connection_t *connection = &worker->connection;
+  bool handed_off = false;
+
+  if (!http_connection_open(connection, netconn)) {
     return false;
   }
+  while (http_connection_wait_request(connection)) {
+    handed_off = http_server_serve_request(worker);
+    if (handed_off || !connection->keep_alive) {
+      break;
+    }
+  }
 
-#if APP_ENABLE_DEBUG_HTTP_ROUTES
-  if ((strncmp(request.path, "/debug/", 7u) == 0 ||
-       strcmp(request.path, "/debug/stream") == 0) &&
-      (request.method == HTTP_METHOD_GET || request.method == HTTP_METHOD_POST)) {
-    (void)http_handle_debug_route(connection, &request);
-    netconn_close(connection);
-    return false;
+  http_connection_release(connection);
+  if (!handed_off) {
+    netconn_close(netconn);
   }
-#endif
+  return handed_off;
+}
 
-  if (request.method == HTTP_METHOD_GET && strcmp(request.path, "/events") == 0) {
-    if (http_start_sse_stream(connection)) {
-      return true;
+static void http_worker_task(void *params) {
+  http_worker_t *worker = (http_worker_t *)params;
+
+  while (1) {
+    struct netconn *netconn = NULL;
+
+    if (xQueueReceive(g_http_accept_queue, &netconn, portMAX_DELAY) != pdTRUE ||
+        netconn == NULL) {
+      continue;
+    }
+    if (!http_server_serve_connection(worker, netconn)) {
+      netconn_delete(netconn);
     }
+  }
+}
+
+static bool http_server_start_workers(void) {
+  size_t index = 0u;
 
-    netconn_close(connection);
+  g_http_accept_queue =
+      xQueueCreate(APP_HTTP_ACCEPT_QUEUE_LENGTH, sizeof(struct netconn *));
+  if (g_http_accept_queue == NULL) {
+    return false;
+  }
+  if (!sse_hub_start()) {
     return false;
   }
 
-  if (method_is_get_or_head) {
-    const char *content_type = NULL;
-    const uint8_t *body = NULL;
-    size_t body_length = 0u;
+  for (index = 0u; index < APP_HTTP_WORKER_COUNT; ++index) {
+    char task_name[configMAX_TASK_NAME_LEN];
 
-    if (web_assets_get(request.path, &content_type, &body, &body_length)) {
-      if (request.method == HTTP_METHOD_HEAD) {
-        http_send_headers_only(connection, "200 OK", content_type, body_length);
-      } else {
-        http_send_response(connection, "200 OK", content_type, body, body_length);
-      }
-    } else {
-      http_send_text_response(connection, "404 Not Found", "text/plain",
-                              "Not Found");
+    (void)snprintf(task_name, sizeof(task_name), "HTTPWorker%u", (unsigned)index);
+    if (xTaskCreate(http_worker_task, task_name, APP_HTTP_WORKER_STACK_WORDS,
+                    &g_http_workers[index], APP_HTTP_WORKER_PRIORITY,
+                    NULL) != pdPASS) {
+      return false;
     }
-
-    netconn_close(connection);
-    return false;
   }
 
-  http_send_text_response(connection, "405 Method Not Allowed", "text/plain",
-                          "Method Not Allowed");
-  netconn_close(connection);
-  return false;
+  return true;
+}
+
+// Every worker is busy and the accept queue stayed full: answer right away
+// instead of leaving the client to time out.
+static void http_server_reject_busy(struct netconn *netconn) {
+  static const char k_busy_response[] =
+      "HTTP/1.1 503 Service Unavailable\r\n"
+      "Content-Type: text/plain\r\n"
+      "Content-Length: 11\r\n"
+      "Retry-After: 1\r\n"
+      "Connection: close\r\n"
+      "\r\n"
+      "Server busy";
+
+  (void)netconn_write(netconn, k_busy_response, sizeof(k_busy_response) - 1u,
+                      NETCONN_COPY);
+  netconn_close(netconn);
+  netconn_delete(netconn);
 }
 
 static void wifi_log_ip_address(void) {
@@ -1935,7 +4016,7 @@ void wifi_task_entry(void *params) {
   }
 
   listener = http_server_create_listener();
-  if (listener == NULL) {
+  if (listener == NULL || !http_server_start_workers()) {
     printf("[WiFi] HTTP init failed\n");
     vTaskDelete(NULL);
     return;
@@ -1943,17 +4024,18 @@ void wifi_task_entry(void *params) {
 
   while (1) {
     struct netconn *client_connection = NULL;
-    const err_t accept_status = netconn_accept(listener, &client_connection);
+
+    if (netconn_accept(listener, &client_connection) != ERR_OK ||
+        client_connection == NULL) {
+      continue;
+    }
 
     led_state = !led_state;
     cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, led_state);
 
-    if (accept_status == ERR_OK && client_connection != NULL) {
-      const bool handed_to_worker =
-          http_server_serve_connection(client_connection);
-      if (!handed_to_worker) {
-        netconn_delete(client_connection);
-      }
+    if (xQueueSend(g_http_accept_queue, &client_connection,
+                   pdMS_TO_TICKS(APP_HTTP_ACCEPT_QUEUE_WAIT_MS)) != pdTRUE) {
+      http_server_reject_busy(client_connection);
     }
   }
 }